@@ -2,6 +2,11 @@
 #include "shader.h"
 #include "glquake.h"	//we need some of the gl format enums
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+static qboolean image_nosimd;	//r_imagebench sets this to time the scalar paths.
+#endif
+
 #ifdef __GNUC__
 #pragma
 #endif
@@ -7752,7 +7757,29 @@ static void Image_MipMap4X8 (qbyte *in, int inwidth, int inheight, qbyte *out, i
 	{
 		for (i=0 ; i<outheight ; i++, inrow+=rowwidth*2)
 		{
-			for (in = inrow, j=0 ; j<outwidth ; j++, out+=4, in+=8)
+			in = inrow;
+			j = 0;
+#ifdef __SSE2__
+			for (; j+4<=outwidth && !image_nosimd ; j+=4, out+=16, in+=32)
+			{	//4 output pixels at a time, same maths in 16bit lanes.
+				__m128i z = _mm_setzero_si128();
+				__m128i a = _mm_loadu_si128((const __m128i*)in), b = _mm_loadu_si128((const __m128i*)(in+16));
+				__m128i c = _mm_loadu_si128((const __m128i*)(in+rowwidth)), d = _mm_loadu_si128((const __m128i*)(in+rowwidth+16));
+				__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a, z), _mm_unpacklo_epi8(c, z));	//input pixels 0,1 (top+bottom)
+				__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a, z), _mm_unpackhi_epi8(c, z));	//2,3
+				__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(b, z), _mm_unpacklo_epi8(d, z));	//4,5
+				__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(b, z), _mm_unpackhi_epi8(d, z));	//6,7
+				//add each pixel to its horizontal neighbour (the low half ends up with the sum)
+				s0 = _mm_add_epi16(s0, _mm_shuffle_epi32(s0, _MM_SHUFFLE(1,0,3,2)));
+				s1 = _mm_add_epi16(s1, _mm_shuffle_epi32(s1, _MM_SHUFFLE(1,0,3,2)));
+				s2 = _mm_add_epi16(s2, _mm_shuffle_epi32(s2, _MM_SHUFFLE(1,0,3,2)));
+				s3 = _mm_add_epi16(s3, _mm_shuffle_epi32(s3, _MM_SHUFFLE(1,0,3,2)));
+				s0 = _mm_srli_epi16(_mm_unpacklo_epi64(s0, s1), 2);
+				s2 = _mm_srli_epi16(_mm_unpacklo_epi64(s2, s3), 2);
+				_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(s0, s2));
+			}
+#endif
+			for (; j<outwidth ; j++, out+=4, in+=8)
 			{
 				out[0] = (in[0] + in[4] + in[rowwidth+0] + in[rowwidth+4])>>2;
 				out[1] = (in[1] + in[5] + in[rowwidth+1] + in[rowwidth+5])>>2;
@@ -7949,7 +7976,9 @@ static void Image_MipMap4X16F (unsigned short *in, int inwidth, int inheight, un
 	{
 		for (i=0 ; i<outheight ; i++, inrow+=rowwidth*2)
 		{
-			for (in = inrow, j=0 ; j<outwidth ; j++, out+=4, in+=8)
+			in = inrow;
+			j = 0;
+			for (; j<outwidth ; j++, out+=4, in+=8)
 			{
 				out[0] = HalfFloatBlend4(in[0], in[4], in[rowwidth+0], in[rowwidth+4]);
 				out[1] = HalfFloatBlend4(in[1], in[5], in[rowwidth+1], in[rowwidth+5]);
@@ -8335,6 +8364,25 @@ static void Image_Resample32Lerp(const void *indata, int inwidth, int inheight,
 				oldy = yi;
 			}
 			j = outwidth - 4;
+#ifdef __SSE2__
+			if (j >= 0 && !image_nosimd)
+			{	//(d*lerp)>>16 is the high half of the product. mulhi_epi16 sees lerp as signed, so add d back when the top bit is set.
+				__m128i z = _mm_setzero_si128(), l = _mm_set1_epi16((short)lerp), lfix = (lerp&0x8000)?_mm_set1_epi16(-1):z;
+				__m128i a, b, r0, r1;
+				for (; j >= 0; j -= 4, out += 16, row1 += 16, row2 += 16)
+				{
+					a = _mm_loadu_si128((const __m128i*)row1);
+					b = _mm_loadu_si128((const __m128i*)row2);
+					r0 = _mm_unpacklo_epi8(a, z);
+					r1 = _mm_sub_epi16(_mm_unpacklo_epi8(b, z), r0);
+					r0 = _mm_add_epi16(r0, _mm_add_epi16(_mm_mulhi_epi16(r1, l), _mm_and_si128(r1, lfix)));
+					a = _mm_unpackhi_epi8(a, z);
+					r1 = _mm_sub_epi16(_mm_unpackhi_epi8(b, z), a);
+					r1 = _mm_add_epi16(a, _mm_add_epi16(_mm_mulhi_epi16(r1, l), _mm_and_si128(r1, lfix)));
+					_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(r0, r1));
+				}
+			}
+#endif
 			while(j >= 0)
 			{
 				LERPBYTE( 0);
@@ -8772,22 +8820,35 @@ static void Image_Tr_NoTransform(struct pendingtextureinfo *mips, int dummy)
 static void Image_Tr_PalettedtoRGBX8(struct pendingtextureinfo *mips, int alphapix)
 {
 	unsigned int mip;
+	union
+	{
+		qbyte b[4];
+		unsigned int u;
+	} lut[256];	//whole pixels, so its one load+store per pixel instead of four of each.
+	for (mip = 0; mip < 256; mip++)
+	{
+		lut[mip].b[0] = host_basepal[mip*3+0];
+		lut[mip].b[1] = host_basepal[mip*3+1];
+		lut[mip].b[2] = host_basepal[mip*3+2];
+		lut[mip].b[3] = (mip==alphapix)?0:255;
+	}
 	for (mip = 0; mip < mips->mipcount; mip++)
 	{
 		qbyte *in = mips->mip[mip].data;
 		unsigned int p = mips->mip[mip].width*mips->mip[mip].height*mips->mip[mip].depth;
-		qbyte *out;
-		size_t datasize = sizeof(*out)*4*p;
+		unsigned int *out;
+		size_t datasize = sizeof(*out)*p;
 		void *newdata = out = BZ_Malloc(datasize);
 
-		while(p-->0)
+		for (; p >= 4; p -= 4, in += 4, out += 4)
 		{
-			unsigned int l = *in++;
-			*out++ = host_basepal[l*3+0];
-			*out++ = host_basepal[l*3+1];
-			*out++ = host_basepal[l*3+2];
-			*out++ = (l==alphapix)?0:255;
+			out[0] = lut[in[0]].u;
+			out[1] = lut[in[1]].u;
+			out[2] = lut[in[2]].u;
+			out[3] = lut[in[3]].u;
 		}
+		while(p-->0)
+			*out++ = lut[*in++].u;
 		if (mips->mip[mip].needfree)
 			BZ_Free(mips->mip[mip].data);
 		mips->mip[mip].needfree = true;
@@ -9941,6 +10002,36 @@ static void Image_Decode_EAC_RG11U_Block(qbyte *fte_restrict in, pixel32_t *fte_
 #ifdef DECOMPRESS_S3TC
 static void Image_Decode_S3TC_Block_Internal(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, qbyte blackalpha)
 {
+#ifdef __SSE2__
+	//same results as below, but with the endpoints in 16bit lanes (r0 g0 b0 a0 r1 g1 b1 a1) and mask-selects instead of per-pixel lookups.
+	unsigned int c0 = in[0]|(in[1]<<8), c1 = in[2]|(in[3]<<8);
+	unsigned int bits = in[4] | (in[5]<<8) | (in[6]<<16) | (in[7]<<24);
+	__m128i e = _mm_setr_epi16(c0>>8&0xf8, c0>>3&0xfc, c0<<3&0xf8, 0xff, c1>>8&0xf8, c1>>3&0xfc, c1<<3&0xf8, 0xff);
+	__m128i l, t0, t1, t2, t3, b, sel;
+	int y;
+	e = _mm_or_si128(e, _mm_srli_epi16(_mm_and_si128(e, _mm_setr_epi16(0xff,0,0xff,0, 0xff,0,0xff,0)), 5));	//expand 5bit red+blue
+	e = _mm_or_si128(e, _mm_srli_epi16(_mm_and_si128(e, _mm_setr_epi16(0,0xff,0,0, 0,0xff,0,0)), 6));	//expand 6bit green
+	l = _mm_shuffle_epi32(e, _MM_SHUFFLE(1,0,3,2));	//swapped endpoints
+	if (c0 > c1)	//(2a+b)/3, (a+2b)/3. x*0xaaab>>17 is x/3 for any 16bit x.
+		l = _mm_srli_epi16(_mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(e, e), l), _mm_set1_epi16((short)0xaaab)), 1);
+	else			//(a+b)/2, transparent black
+		l = _mm_unpacklo_epi64(_mm_srli_epi16(_mm_add_epi16(e, l), 1), _mm_setr_epi16(0,0,0,blackalpha, 0,0,0,0));
+	l = _mm_packus_epi16(e, l);	//the full 4-colour table.
+	t0 = _mm_shuffle_epi32(l, 0x00);
+	t1 = _mm_shuffle_epi32(l, 0x55);
+	t2 = _mm_shuffle_epi32(l, 0xaa);
+	t3 = _mm_shuffle_epi32(l, 0xff);
+	b = _mm_set1_epi32(bits);
+	for (y = 0; y < 4; y++, out += w, b = _mm_srli_epi32(b, 8))
+	{
+		sel = _mm_and_si128(b, _mm_setr_epi32(3<<0, 3<<2, 3<<4, 3<<6));
+		_mm_storeu_si128((__m128i*)out, _mm_or_si128(
+				_mm_or_si128(	_mm_and_si128(t0, _mm_cmpeq_epi32(sel, _mm_setzero_si128())),
+								_mm_and_si128(t1, _mm_cmpeq_epi32(sel, _mm_setr_epi32(1<<0, 1<<2, 1<<4, 1<<6)))),
+				_mm_or_si128(	_mm_and_si128(t2, _mm_cmpeq_epi32(sel, _mm_setr_epi32(2<<0, 2<<2, 2<<4, 2<<6))),
+								_mm_and_si128(t3, _mm_cmpeq_epi32(sel, _mm_setr_epi32(3<<0, 3<<2, 3<<4, 3<<6))))));
+	}
+#else
 	pixel32_t tab[4];
 	unsigned int bits;
 
@@ -9973,6 +10064,7 @@ static void Image_Decode_S3TC_Block_Internal(qbyte *fte_restrict in, pixel32_t *
 	BC1_Row(out, 8);
 	out += w;
 	BC1_Row(out, 12);
+#endif
 }
 static void Image_Decode_BC1_Block(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, uploadfmt_t fmt)
 {
@@ -10103,6 +10195,8 @@ fte_inlinestatic int ReadBits(qbyte *in, int *bit, int n)
 	in += first>>3;
 	first &= 7;
 	second = max(0,n - (8-first));
+	if (!second)	//don't read past the end of the block
+		return (in[0]>>first)&mask;
 	return ((in[0]>>first)&mask) ^ (in[1]<<(n-second)&mask);
 }
 fte_inlinestatic int ReadBitsL(qbyte *in, int *bit, int n)
@@ -10894,16 +10988,27 @@ static void Image_Decode_BC7_Block(qbyte *fte_restrict in, pixel32_t *fte_restri
 		{1, 0, 0, 0, 0, 0, 0, {0, 0}},	//mode 8 - reserved
     };
 
-	pixel32_t palette[3][2];
-	pixel32_t tab[3][16];
-	int mode, i, j, bit, partition, ss, cb;
-	const int *weight;
+	pixel32_t palette[3][2], *e;
+	qbyte idx[2][16];
+	int mode, i, j, k, bit, partition, ss, cb;
+	const int *cweight, *aweight;
 	const qbyte *p;
 	int rot;
-	int idxsel;
+	int idxsel, asel;
 	for (mode = 0; mode < 8; mode++)
 		if (*in & (1u<<mode))
 			break;
+	if (mode == 8)
+	{	//reserved mode, transparent black
+		for (i = 0; i < 16; )
+		{
+			out[i].u = 0;
+			i++;
+			if (!(i & 3))
+				out += w-4;
+		}
+		return;
+	}
 	ss = m[mode].numsubsets;
 	bit = mode+1;
 	partition = ReadBits(in, &bit, m[mode].partitionbits);
@@ -10928,7 +11033,7 @@ static void Image_Decode_BC7_Block(qbyte *fte_restrict in, pixel32_t *fte_restri
 
 	if(m[mode].pmode)
 	{
-		for (i = 0; i < m[mode].numsubsets; i++)
+		for (i = 0; i < ss; i++)
 		{
 			qbyte p = ReadBits(in, &bit, 1);
 			for (j = 0; j < 3; j++)
@@ -10941,95 +11046,67 @@ static void Image_Decode_BC7_Block(qbyte *fte_restrict in, pixel32_t *fte_restri
 				palette[i][1].v[j] |= p<<(7-m[mode].colourbits);
 			palette[i][1].v[3] |= p<<(7-m[mode].alphabits);
 		}
-		etc_expandv(palette[i][0], m[mode].colourbits+1, m[mode].colourbits+1, m[mode].colourbits+1); palette[i][0].v[3]|=palette[i][0].v[3]>>(m[mode].alphabits+1);
-		etc_expandv(palette[i][1], m[mode].colourbits+1, m[mode].colourbits+1, m[mode].colourbits+1); palette[i][0].v[3]|=palette[i][0].v[3]>>(m[mode].alphabits+1);
+		for (i = 0; i < ss; i++)
+		{
+			etc_expandv(palette[i][0], m[mode].colourbits+1, m[mode].colourbits+1, m[mode].colourbits+1); palette[i][0].v[3]|=palette[i][0].v[3]>>(m[mode].alphabits+1);
+			etc_expandv(palette[i][1], m[mode].colourbits+1, m[mode].colourbits+1, m[mode].colourbits+1); palette[i][1].v[3]|=palette[i][1].v[3]>>(m[mode].alphabits+1);
+		}
 	}
 	else
 	{
-		etc_expandv(palette[i][0], m[mode].colourbits, m[mode].colourbits, m[mode].colourbits); palette[i][0].v[3]|=palette[i][0].v[3]>>m[mode].alphabits;
-		etc_expandv(palette[i][1], m[mode].colourbits, m[mode].colourbits, m[mode].colourbits);	palette[i][1].v[3]|=palette[i][0].v[3]>>m[mode].alphabits;
+		for (i = 0; i < ss; i++)
+		{
+			etc_expandv(palette[i][0], m[mode].colourbits, m[mode].colourbits, m[mode].colourbits); palette[i][0].v[3]|=palette[i][0].v[3]>>m[mode].alphabits;
+			etc_expandv(palette[i][1], m[mode].colourbits, m[mode].colourbits, m[mode].colourbits); palette[i][1].v[3]|=palette[i][1].v[3]>>m[mode].alphabits;
+		}
 	}
 
-	cb = m[mode].indexbits[idxsel];
-	weight = wsz[cb];
+	//this stuff is annoying, but saves a bit or two
+	anchor[0] = 0;
+	for (i = 1; i < ss; i++)
+		anchor[i] = anchortable[(ss>2)?i:0][partition];
 
-	//build lerps table (could do it per pixel?)
-	for (i = 0; i < m[mode].numsubsets; i++)
+	//the first index set, then modes 4+5 have a second set. the anchors drop their top bit.
+	for (k = 0; k < 2; k++)
 	{
-		for (j = 0; j < (1<<cb); j++)
+		cb = m[mode].indexbits[k];
+		for (i = 0; i < 16; i++)
 		{
-			tab[i][j].v[0] = (palette[i][0].v[0]*(64-weight[j]) + palette[i][1].v[0]*weight[j] + 32)>>6;
-			tab[i][j].v[1] = (palette[i][0].v[1]*(64-weight[j]) + palette[i][1].v[1]*weight[j] + 32)>>6;
-			tab[i][j].v[2] = (palette[i][0].v[2]*(64-weight[j]) + palette[i][1].v[2]*weight[j] + 32)>>6;
-			tab[i][j].v[3] = (palette[i][0].v[3]*(64-weight[j]) + palette[i][1].v[3]*weight[j] + 32)>>6;
+			if (!cb)
+				idx[k][i] = 0;
+			else if (i == (k?0:anchor[p[i]]))
+				idx[k][i] = ReadBits(in, &bit, cb-1);
+			else
+				idx[k][i] = ReadBits(in, &bit, cb);
 		}
-
-		//this stuff is annoying, but saves a bit or two
-		if (!cb)
-			anchor[i] = 16;	//don't allow the cb-1 to read negative bits!
-		else if (i)
-			anchor[i] = anchortable[(ss>2)?i:0][partition];
-		else
-			anchor[i] = 0;
 	}
+	//idxsel picks which set is for colour and which is for alpha. one set is used for both when there's only one.
+	asel = m[mode].indexbits[1]?!idxsel:idxsel;
+	cweight = wsz[m[mode].indexbits[idxsel]];
+	aweight = wsz[m[mode].indexbits[asel]];
 
 	//okay, tables are all set up, spew out the pixels
 	for (i = 0; i < 16; )
 	{
-		int pidx = p[i];
-		int idx;
-		if (i == anchor[pidx])
-			idx = ReadBits(in, &bit, cb-1);
-		else
-			idx = ReadBits(in, &bit, cb);
-		out[i].u = tab[pidx][idx].u;
-		i++;
-		if (!(i & 3))
-			out += w-4;
-	}
-
-	//mode has separate alpha indexes, spew those out too, clobbering any alpha from dodgy rgb blends
-	if (m[mode].indexbits[idxsel^1])
-	{	//FIXME: untested
-		out -= w*4;
-		cb = m[mode].indexbits[idxsel^1];
-		weight = wsz[cb];
-		for (i = 0; i < m[mode].numsubsets; i++)
-		{
-			for (j = 0; j < (1<<cb); j++)
-				tab[i][j].v[3] = (palette[i][0].v[3]*(64-weight[j]) + palette[i][1].v[3]*weight[j] + 32)>>6;
-		}
+		e = palette[p[i]];
+		j = cweight[idx[idxsel][i]];
+		out[i].v[0] = (e[0].v[0]*(64-j) + e[1].v[0]*j + 32)>>6;
+		out[i].v[1] = (e[0].v[1]*(64-j) + e[1].v[1]*j + 32)>>6;
+		out[i].v[2] = (e[0].v[2]*(64-j) + e[1].v[2]*j + 32)>>6;
+		j = aweight[idx[asel][i]];
+		out[i].v[3] = (e[0].v[3]*(64-j) + e[1].v[3]*j + 32)>>6;
 
-		for (i = 0; i < 16; )
+		//some modes allow swapping the alpha with an rgb channel (per block). 1=red, 2=green, 3=blue
+		if (rot)
 		{
-			int idx;
-			if (i == 0)
-				idx = ReadBits(in, &bit, cb-1);
-			else
-				idx = ReadBits(in, &bit, cb);
-			out[i].v[3] = tab[p[i]][idx].v[3];
-			i++;
-			if (!(i & 3))
-				out += w-4;
+			qbyte t = out[i].v[3];
+			out[i].v[3] = out[i].v[rot-1];
+			out[i].v[rot-1] = t;
 		}
-	}
 
-	//some modes allow swapping the alpha with an rgb channel (per block)
-	if (rot)
-	{	//FIXME: untested
-		qbyte t;
-		rot--; //0=disable, 1=red, 2=green, 3=blue
-		out -= w*4;
-		for (i = 0; i < 16; )
-		{
-			t = out[i].v[3];
-			out[i].v[3] = out[i].v[rot];
-			out[i].v[rot] = t;
-
-			i++;
-			if (!(i & 3))
-				out += w-4;
-		}
+		i++;
+		if (!(i & 3))
+			out += w-4;
 	}
 }
 #endif
@@ -11691,91 +11768,74 @@ const char *Image_FormatName(uploadfmt_t fmt)
 	return "Unknown";
 }
 
-static pixel32_t *Image_Block_Decode(qbyte *fte_restrict in, size_t insize, int w, int h, int d, void(*decodeblock)(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, uploadfmt_t srcfmt), uploadfmt_t encoding)
-{
 #define TMPBLOCKSIZE 16u
-	pixel32_t *ret, *out;
-	pixel32_t tmp[TMPBLOCKSIZE*TMPBLOCKSIZE];
-	int x, y, z, i, j;
-	int sizediff;
-	int rows, columns, layers;
-
-	unsigned int blockbytes, blockwidth, blockheight, blockdepth;
-	Image_BlockSizeForEncoding(encoding, &blockbytes, &blockwidth, &blockheight, &blockdepth);
-
-	if (blockwidth > TMPBLOCKSIZE || blockheight > TMPBLOCKSIZE || blockdepth != 1)
-		Sys_Error("Image_Block_Decode only supports up to %u*%u blocks.\n", TMPBLOCKSIZE,TMPBLOCKSIZE);
-
-	sizediff = insize - blockbytes*((w+blockwidth-1)/blockwidth)*((h+blockheight-1)/blockheight)*d;
-	if (sizediff)
-	{
-		Con_Printf("Image_Block_Decode: %s data size is %u, expected %u\n\n", Image_FormatName(encoding), (unsigned int)insize, (unsigned int)(insize-sizediff));
-		if (sizediff < 0)
-			return NULL;
-	}
-
-	ret = out = BZ_Malloc(w*h*d*sizeof(*out));
+#define BLOCKBANDPIXELS (256*256)	//roughly how many pixels each worker decodes at a time.
+struct blockdecode_s
+{
+	qbyte *in;
+	qbyte *out;
+	int w, h;
+	unsigned int pixelbytes;
+	unsigned int blockbytes, blockwidth, blockheight;
+	unsigned int blocksx, blocksy;	//blocks per row, block rows per layer
+	unsigned int blockrows;			//total block rows (over all layers)
+	unsigned int bandrows;			//block rows per band
+	void(*decode32)(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, uploadfmt_t srcfmt);
+	void(*decode64)(qbyte *fte_restrict in, pixel64_t *fte_restrict out, int w, uploadfmt_t srcfmt);
+	uploadfmt_t encoding;
+};
+//each block row is independant of the others, so these can be done in any order (and on any thread).
+static void Image_Block_DecodeRows(void *vctx, size_t first, size_t last)
+{
+	const struct blockdecode_s *ctx = vctx;
+	pixel64_t tmp[TMPBLOCKSIZE*TMPBLOCKSIZE];
+	size_t rowbytes = ctx->w*ctx->pixelbytes;
+	size_t row;
+	unsigned int x, y, by, cw, ch;
+	qbyte *in, *out;
 
-	rows = h/blockheight;
-	rows *= blockheight;
-	columns = w/blockwidth;
-	columns *= blockwidth;
-	layers = d;
-	for (z = 0; z < layers; z++)
+	for (row = first; row < last; row++)
 	{
-		for (y = 0; y < rows; y+=blockheight, out += w*(blockheight-1))
+		by = row % ctx->blocksy;
+		in = ctx->in + (size_t)row*ctx->blocksx*ctx->blockbytes;
+		out = ctx->out + ((size_t)(row/ctx->blocksy)*ctx->h + by*ctx->blockheight)*rowbytes;
+		ch = min(ctx->blockheight, ctx->h - by*ctx->blockheight);
+		for (x = 0; x < ctx->w; x+=ctx->blockwidth, in+=ctx->blockbytes, out+=ctx->blockwidth*ctx->pixelbytes)
 		{
-			for (x = 0; x < columns; x+=blockwidth, in+=blockbytes, out+=blockwidth)
-				decodeblock(in, out, w, encoding);
-			if (w%blockwidth)
+			cw = min(ctx->blockwidth, ctx->w - x);
+			if (cw == ctx->blockwidth && ch == ctx->blockheight)
 			{
-				decodeblock(in, tmp, TMPBLOCKSIZE, encoding);
-				for (i = 0; x < w; x++, out++, i++)
-				{
-					for (j = 0; j < blockheight; j++)
-						out[w*j] = tmp[i+TMPBLOCKSIZE*j];
-				}
-				in+=blockbytes;
+				if (ctx->decode64)
+					ctx->decode64(in, (pixel64_t*)out, ctx->w, ctx->encoding);
+				else
+					ctx->decode32(in, (pixel32_t*)out, ctx->w, ctx->encoding);
 			}
-		}
-		if (h%blockheight)
-		{	//now walk along the bottom of the image
-			h %= blockheight;
-			for (x = 0; x < w; )
-			{
-				decodeblock(in, tmp, TMPBLOCKSIZE, encoding);
-				i = 0;
-				do
-				{
-					if (x == w)
-						break;
-					for (y = 0; y < h; y++)
-						out[w*y] = tmp[i+TMPBLOCKSIZE*y];
-					out++;
-					i++;
-				} while (++x % blockwidth);
-				in+=blockbytes;
+			else
+			{	//partial block along the right or bottom edge of the image
+				if (ctx->decode64)
+					ctx->decode64(in, tmp, TMPBLOCKSIZE, ctx->encoding);
+				else
+					ctx->decode32(in, (pixel32_t*)tmp, TMPBLOCKSIZE, ctx->encoding);
+				for (y = 0; y < ch; y++)
+					memcpy(out + y*rowbytes, (qbyte*)tmp + y*TMPBLOCKSIZE*ctx->pixelbytes, cw*ctx->pixelbytes);
 			}
 		}
 	}
-	return ret;
 }
-static pixel64_t *Image_Block_Decode64(qbyte *fte_restrict in, size_t insize, int w, int h, int d, void(*decodeblock)(qbyte *fte_restrict in, pixel64_t *fte_restrict out, int w, uploadfmt_t srcfmt), uploadfmt_t encoding)
+static void *Image_Block_DecodeCommon(qbyte *fte_restrict in, size_t insize, int w, int h, int d, unsigned int pixelbytes, uploadfmt_t encoding,
+		void(*decode32)(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, uploadfmt_t srcfmt),
+		void(*decode64)(qbyte *fte_restrict in, pixel64_t *fte_restrict out, int w, uploadfmt_t srcfmt))
 {
-#define TMPBLOCKSIZE 16u
-	pixel64_t *ret, *out;
-	pixel64_t tmp[TMPBLOCKSIZE*TMPBLOCKSIZE];
-	int x, y, z, i, j;
+	struct blockdecode_s ctx;
+	void *ret;
 	int sizediff;
-	int rows, columns, layers;
-
 	unsigned int blockbytes, blockwidth, blockheight, blockdepth;
 	Image_BlockSizeForEncoding(encoding, &blockbytes, &blockwidth, &blockheight, &blockdepth);
 
 	if (blockwidth > TMPBLOCKSIZE || blockheight > TMPBLOCKSIZE || blockdepth != 1)
-		Sys_Error("Image_Block_Decode only supports up to %u*%u*%u blocks.\n", TMPBLOCKSIZE,TMPBLOCKSIZE,1);
+		Sys_Error("Image_Block_Decode only supports up to %u*%u blocks.\n", TMPBLOCKSIZE,TMPBLOCKSIZE);
 
-	sizediff = insize - blockbytes*((w+blockwidth-1)/blockwidth)*((h+blockheight-1)/blockheight)*((d+blockdepth-1)/blockdepth);
+	sizediff = insize - blockbytes*((w+blockwidth-1)/blockwidth)*((h+blockheight-1)/blockheight)*d;
 	if (sizediff)
 	{
 		Con_Printf("Image_Block_Decode: %s data size is %u, expected %u\n\n", Image_FormatName(encoding), (unsigned int)insize, (unsigned int)(insize-sizediff));
@@ -11783,53 +11843,35 @@ static pixel64_t *Image_Block_Decode64(qbyte *fte_restrict in, size_t insize, in
 			return NULL;
 	}
 
-	ret = out = BZ_Malloc(w*h*d*sizeof(*out));
-
-	rows = h/blockheight;
-	rows *= blockheight;
-	columns = w/blockwidth;
-	columns *= blockwidth;
-	layers = d/blockdepth;
-	layers *= blockdepth;
-	for (z = 0; z < layers; z+=blockdepth)
-	{
-		for (y = 0; y < rows; y+=blockheight, out += w*(blockheight-1))
-		{
-			for (x = 0; x < columns; x+=blockwidth, in+=blockbytes, out+=blockwidth)
-				decodeblock(in, out, w, encoding);
-			if (w%blockwidth)
-			{
-				decodeblock(in, tmp, TMPBLOCKSIZE, encoding);
-				for (i = 0; x < w; x++, out++, i++)
-				{
-					for (j = 0; j < blockheight; j++)
-						out[w*j] = tmp[i+TMPBLOCKSIZE*j];
-				}
-				in+=blockbytes;
-			}
-		}
-		if (h%blockheight)
-		{	//now walk along the bottom of the image
-			h %= blockheight;
-			for (x = 0; x < w; )
-			{
-				decodeblock(in, tmp, TMPBLOCKSIZE, encoding);
-				i = 0;
-				do
-				{
-					if (x == w)
-						break;
-					for (y = 0; y < h; y++)
-						out[w*y] = tmp[i+TMPBLOCKSIZE*y];
-					out++;
-					i++;
-				} while (++x % blockwidth);
-				in+=blockbytes;
-			}
-		}
-	}
+	ret = BZ_Malloc(w*h*d*pixelbytes);
+	ctx.in = in;
+	ctx.out = ret;
+	ctx.w = w;
+	ctx.h = h;
+	ctx.pixelbytes = pixelbytes;
+	ctx.blockbytes = blockbytes;
+	ctx.blockwidth = blockwidth;
+	ctx.blockheight = blockheight;
+	ctx.blocksx = (w+blockwidth-1)/blockwidth;
+	ctx.blocksy = (h+blockheight-1)/blockheight;
+	ctx.blockrows = ctx.blocksy*d;
+	ctx.bandrows = max(1, BLOCKBANDPIXELS / (w*blockheight));
+	ctx.decode32 = decode32;
+	ctx.decode64 = decode64;
+	ctx.encoding = encoding;
+
+	//get any idle compute workers to help out, while we chew through it too.
+	COM_ParallelFor(ctx.blockrows, ctx.bandrows, Image_Block_DecodeRows, &ctx);
 	return ret;
 }
+static pixel32_t *Image_Block_Decode(qbyte *fte_restrict in, size_t insize, int w, int h, int d, void(*decodeblock)(qbyte *fte_restrict in, pixel32_t *fte_restrict out, int w, uploadfmt_t srcfmt), uploadfmt_t encoding)
+{
+	return Image_Block_DecodeCommon(in, insize, w, h, d, sizeof(pixel32_t), encoding, decodeblock, NULL);
+}
+static pixel64_t *Image_Block_Decode64(qbyte *fte_restrict in, size_t insize, int w, int h, int d, void(*decodeblock)(qbyte *fte_restrict in, pixel64_t *fte_restrict out, int w, uploadfmt_t srcfmt), uploadfmt_t encoding)
+{
+	return Image_Block_DecodeCommon(in, insize, w, h, d, sizeof(pixel64_t), encoding, NULL, decodeblock);
+}
 
 static qboolean Image_DecompressFormat(struct pendingtextureinfo *mips, const char *imagename)
 {
@@ -14945,6 +14987,7 @@ void Image_Shutdown(void)
 	int i = 0, j = 0;
 	Cmd_RemoveCommand("r_imagelist");
 	Cmd_RemoveCommand("r_imageformats");
+	Cmd_RemoveCommand("r_imagebench");
 	while (imagelist)
 	{
 		tex = imagelist;
@@ -14966,6 +15009,60 @@ void Image_Shutdown(void)
 }
 #endif
 
+#if defined(HAVE_CLIENT) && defined(__SSE2__)
+//runs one of the simd conversion kernels over a size*size image.
+static void Image_BenchKernel(int kernel, void *in, void *out, int size, size_t *bytes)
+{
+	if (kernel == 0)
+	{
+		Image_MipMap4X8(in, size, size, out, size/2, size/2);
+		*bytes = (size/2)*(size/2)*4;
+	}
+	else
+	{
+		Image_Resample32Lerp(in, size, size, out, size*3/2, size*3/2);
+		*bytes = (size*3/2)*(size*3/2)*4;
+	}
+}
+//times the scalar and sse2 paths of the conversion kernels against each other, and checks that they still agree.
+//any textures loading at the same time will also take the scalar paths while this runs.
+static void Image_Bench_f(void)
+{
+	static const char *names[] = {"mip8", "resample"};
+	int size = (Cmd_Argc() > 1)?atoi(Cmd_Argv(1)):2048;
+	int reps = (Cmd_Argc() > 2)?atoi(Cmd_Argv(2)):10;
+	qbyte *in, *out[2];
+	size_t i, bytes = 0;
+	double start, t[2];
+	int k, r, pass;
+
+	size = bound(2, size, 8192) & ~1;
+	reps = bound(1, reps, 1000);
+	in = BZ_Malloc((size_t)size*size*4);
+	out[0] = BZ_Malloc((size_t)size*size*9);	//big enough for the 1.5x resample
+	out[1] = BZ_Malloc((size_t)size*size*9);
+	for (i = 0; i < (size_t)size*size*4; i++)
+		in[i] = rand();
+
+	for (k = 0; k < countof(names); k++)
+	{
+		for (pass = 0; pass < 2; pass++)
+		{
+			image_nosimd = !pass;
+			start = Sys_DoubleTime();
+			for (r = 0; r < reps; r++)
+				Image_BenchKernel(k, in, out[pass], size, &bytes);
+			t[pass] = (Sys_DoubleTime() - start)*1000/reps;
+		}
+		image_nosimd = false;
+		Con_Printf("%-12s %8.2fms scalar %8.2fms sse2  %s\n", names[k], t[0], t[1], memcmp(out[0], out[1], bytes)?CON_ERROR"MISMATCH":"bit-exact");
+	}
+	BZ_Free(in);
+	BZ_Free(out[0]);
+	BZ_Free(out[1]);
+}
+#endif
+
 //may not create any images yet.
 void Image_Init(void)
 {
@@ -14991,6 +15088,9 @@ void Image_Init(void)
 
 	Cmd_AddCommandD("r_imagelist", Image_List_f, "Prints out a list of the currently-known textures.");
 	Cmd_AddCommandD("r_imageformats", Image_Formats_f, "Prints out a list of the usable hardware pixel formats.");
+#ifdef __SSE2__
+	Cmd_AddCommandD("r_imagebench", Image_Bench_f, "r_imagebench [size] [reps]\nTimes the scalar and sse2 image conversion kernels on random data, and checks that their results match.");
+#endif
 #endif
 }
 
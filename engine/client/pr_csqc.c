@@ -8123,6 +8123,7 @@ qboolean CSQC_Init (qboolean anycsqc, const char *csprogsname, unsigned int chec
 #ifdef MULTITHREAD
 	csqcprogparms.usethreadedgc = pr_gc_threaded.ival;
 #endif
+	csqcprogparms.nojit = !pr_jit.ival;
 
 	csqcprogparms.edicts = (struct edict_s **)&csqc_world.edicts;
 	csqcprogparms.num_edicts = &csqc_world.num_edicts;
@@ -1350,6 +1350,7 @@ typedef struct menuedict_s
 	int				entnum;
 	unsigned int	fieldsize;
 	pbool			readonly;	//world
+	pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 
 	void			*fields;
 } menuedict_t;
@@ -3281,6 +3282,7 @@ qboolean MP_Init (void)
 #ifdef MULTITHREAD
 	menuprogparms.usethreadedgc = pr_gc_threaded.ival;
 #endif
+	menuprogparms.nojit = !pr_jit.ival;
 
 	menuprogparms.edicts = (struct edict_s **)&menu_edicts;
 	menuprogparms.num_edicts = &num_menu_edicts;
@@ -373,6 +373,7 @@ unsigned int COM_HasWorkers(wgroup_t tg);
 void COM_AddWork(wgroup_t thread, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b);	//low priority
 void COM_InsertWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b);	//high priority
 qboolean COM_HasWork(void);
+void COM_ParallelFor(size_t count, size_t grain, void(*func)(void *ctx, size_t first, size_t last), void *ctx);	//blocks until all done
 void COM_WorkerFullSync(void);
 void COM_WorkerLock(void);	//callable on main thread to temporarily suspend workers (in a safe location)
 void COM_WorkerUnlock(void);
@@ -390,6 +391,7 @@ void COM_AssertMainThread(const char *msg);
 #define COM_HasWorkers(t) 0
 #define COM_AddWork(t,f,a,b,c,d) (f)((a),(b),(c),(d))
 #define COM_InsertWork(t,f,a,b,c,d) (f)((a),(b),(c),(d))
+#define COM_ParallelFor(n,g,f,c) ((n)?(f)((c),0,(n)):(void)0)
 #define COM_WorkerPartialSync(c,a,v)
 #define COM_WorkerFullSync()
 #define COM_WorkerLock()
@@ -781,9 +781,11 @@ void Renderer_Init(void)
 	extern cvar_t sw_interlace;
 	extern cvar_t sw_vthread;
 	extern cvar_t sw_fthreads;
+	void SW_Bench_f(void);
 	Cvar_Register(&sw_interlace, "Software Rendering Options");
 	Cvar_Register(&sw_vthread, "Software Rendering Options");
 	Cvar_Register(&sw_fthreads, "Software Rendering Options");
+	Cmd_AddCommandD("sw_bench", SW_Bench_f, "Times the software rasterizer drawing a fixed scene into memory. Args: frames, fragment threads, width, height.");
 	}
 #endif
 
@@ -148,10 +148,10 @@ cvar_t snd_playbackrate			= CVARFD(	"snd_playbackrate", "1", CVAR_CHEAT, "Debugg
 cvar_t snd_ignoregamespeed		= CVARFD(	"snd_ignoregamespeed", "0", 0, "When set, allows sounds to desynchronise with game time or demo speeds.");
 
 cvar_t snd_ignorecueloops		= CVARD(	"snd_ignorecueloops", "0", "Ignores cue commands in wav files, for q3 compat.");
-cvar_t snd_linearresample		= CVARAF(	"s_linearresample", "1",
-											"snd_linearresample", 0);
-cvar_t snd_linearresample_stream = CVARAF(	"s_linearresample_stream", "0",
-											"snd_linearresample_stream", 0);
+cvar_t snd_linearresample		= CVARAFD(	"s_linearresample", "3",
+											"snd_linearresample", 0, "How to resample sounds that don't match the output rate.\n0: nearest.\n1: linear when upsampling.\n2: linear.\n3-5: windowed sinc, low to high quality.");
+cvar_t snd_linearresample_stream = CVARAFD(	"s_linearresample_stream", "0",
+											"snd_linearresample_stream", 0, "How to resample streamed audio like music, voice chat and videos. Same values as s_linearresample.");
 
 cvar_t snd_mixerthread			= CVARAD(	"s_mixerthread", "1",
 											"snd_mixerthread", "When enabled sound mixing will be run on a separate thread. Currently supported only by directsound. Other drivers may unconditionally thread audio. Set to 0 only if you have issues.");
@@ -2313,6 +2313,10 @@ void S_Init (void)
 	Cmd_AddCommand("stopsound", S_StopAllSounds_f);
 	Cmd_AddCommand("soundlist", S_SoundList_f);
 	Cmd_AddCommand("soundinfo", S_SoundInfo_f);
+#ifdef HAVE_MIXER
+	Cmd_AddCommandD("snd_mixbench", S_MixBench_f, "Times the software mixer on random channels, comparing the sse2 paths against the scalar ones. Args: channels, repeats.");
+#endif
+	Cmd_AddCommandD("snd_resamplebench", SND_ResampleBench_f, "Resamples generated tones with each s_linearresample style, reporting speed, passband gain, residual noise and alias rejection. Args: repeats.");
 
 	Cmd_AddCommand("snd_restart", S_Restart_f);
 
@@ -4213,12 +4217,16 @@ typedef struct {
 	qaudiofmt_t format;
 	int length;
 	void *data;
+	resamplestate_t resample;
 } streaming_t;
 #define MAX_RAW_SOURCES (MAX_CLIENTS+3)
 streaming_t s_streamers[MAX_RAW_SOURCES];
 
 void S_ClearRaw(void)
 {
+	int i;
+	for (i = 0; i < MAX_RAW_SOURCES; i++)
+		SND_ResampleFreeState(&s_streamers[i].resample);
 	memset(s_streamers, 0, sizeof(s_streamers));
 }
 
@@ -4337,6 +4345,7 @@ void S_RawAudio(int sourceid, const qbyte *data, int speed, int samples, int cha
 			}
 		BZ_Free(s->data);
 		s->data = NULL;
+		SND_ResampleFreeState(&s->resample);
 		S_UnlockMixer();
 		return;
 	}
@@ -4377,6 +4386,7 @@ void S_RawAudio(int sourceid, const qbyte *data, int speed, int samples, int cha
 		s->format = format;
 		s->numchannels = channels;
 		s->length = 0;
+		s->resample.primed = false;
 		Con_Printf("Restarting raw stream\n");
 	}
 
@@ -4399,6 +4409,7 @@ void S_RawAudio(int sourceid, const qbyte *data, int speed, int samples, int cha
 	{
 		if (snd_show.ival)
 			Con_Printf("Wasn't playing\n");
+		s->resample.primed = false;	//whatever was left over from last time would be stale.
 		prepadl = 0;
 		spare = 0;
 		if (spare > snd_speed)
@@ -4422,18 +4433,16 @@ void S_RawAudio(int sourceid, const qbyte *data, int speed, int samples, int cha
 		}
 	}
 
-	newcache = BZ_Malloc((spare+outsamples) * (s->numchannels) * QAF_BYTES(s->format));
+	newcache = BZ_Malloc((spare+outsamples+1) * (s->numchannels) * QAF_BYTES(s->format));	//+1 for the resampler's rounding.
 	memcpy(newcache, (qbyte*)s->data + prepadl * (s->numchannels) * QAF_BYTES(s->format), spare * (s->numchannels) * QAF_BYTES(s->format));
 
 	BZ_Free(s->data);
 	s->data = newcache;
 
-	s->length = spare + outsamples;
-
 	{
 		extern cvar_t snd_linearresample_stream;
 		short *outpos = (short *)((char*)s->data + spare * (s->numchannels) * QAF_BYTES(s->format));
-		SND_ResampleStream(data,
+		outsamples = SND_ResampleStreamChunk(&s->resample, data,
 			speed,
 			format,
 			channels,
@@ -4444,6 +4453,7 @@ void S_RawAudio(int sourceid, const qbyte *data, int speed, int samples, int cha
 			s->numchannels,
 			snd_linearresample_stream.ival);
 	}
+	s->length = spare + outsamples;
 
 	for (si = sndcardinfo; si; si=si->next)
 	{
@@ -23,6 +23,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include <inttypes.h>
 #include "winquake.h"
 #include "fs.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 typedef struct
 {
@@ -289,9 +292,501 @@ static wavinfo_t GetWavinfo(char *name, qbyte *wav, int wavlength);
 		}                                                                                            \
 	}
 
+//polyphase windowed-sinc resampling, for resampstyle 3+.
+//each filter is tabulated once for every phase that its rate ratio can land on (capped, for awkward ratios), so the per-sample work is just a dot product.
+#define SINC_MAXPHASES	1024
+#define SINC_MAXTAPS	256
+typedef struct sincfilter_s
+{
+	struct sincfilter_s *next;
+	int quality;
+	int inrate, outrate;	//reduced by their gcd
+	int taps;				//multiple of 4, for simd
+	int phases;
+	int rows;
+	float *coeff;			//[rows][taps], 32-byte aligned so that rows don't straddle cache lines. one per phase, or in schedule order when there is one.
+	int *schedofs;			//[outrate+3], each output's input offset from the start of its period. only when phases==outrate.
+	int *schedidx;			//[outrate], phase -> schedule index.
+} sincfilter_t;
+static sincfilter_t *sincfilters;	//never freed. there's only a handful of rate combinations in practice.
+static const struct
+{
+	int halftaps;	//zero crossings each side when upsampling. downsampling stretches it.
+	double rolloff;	//cutoff, as a fraction of the lower of the two nyquist frequencies.
+	double beta;	//kaiser window shape, trading transition width for stopband attenuation.
+} sincquality[] = {
+	{4,		0.80,	5.0},
+	{8,		0.88,	7.0},
+	{16,	0.94,	9.0},
+};
+
+static double SND_Sinc_BesselI0(double x)
+{
+	double sum = 1, term = 1;
+	int k;
+	for (k = 1; k < 32; k++)
+	{
+		term *= (x/(2*k)) * (x/(2*k));
+		sum += term;
+	}
+	return sum;
+}
+
+static const sincfilter_t *SND_Sinc_GetFilter(int quality, int inrate, int outrate)
+{
+	sincfilter_t *f;
+	int a = inrate, b = outrate, t;
+	int taps, phases, rows, r, p, k;
+	quint64_t pos = 0;
+	double fc, halfwidth, x, norm, ibeta = 1 / SND_Sinc_BesselI0(sincquality[quality].beta);
+	float *row;
+
+	while (b)
+	{
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	inrate /= a;
+	outrate /= a;
+
+	for (f = sincfilters; f; f = f->next)
+		if (f->quality == quality && f->inrate == inrate && f->outrate == outrate)
+			return f;
+
+	fc = sincquality[quality].rolloff;
+	halfwidth = sincquality[quality].halftaps;
+	if (outrate < inrate)
+	{	//downsampling needs to cut off below the output's nyquist, so the kernel gets wider.
+		fc *= outrate / (double)inrate;
+		halfwidth *= inrate / (double)outrate;
+	}
+	taps = ((int)(2*ceil(halfwidth)) + 3) & ~3;
+	if (taps > SINC_MAXTAPS)
+	{
+		taps = SINC_MAXTAPS;
+		halfwidth = taps/2;
+	}
+	phases = min(outrate, SINC_MAXPHASES);
+
+	//when every phase gets a row, the outputs repeat the same pattern every outrate outputs.
+	//so the rows are stored in the order they'll be used along with where their inputs start, and the loops can just walk through them.
+	//3 extra rows wrap around so that four outputs can be done at a time without checking each one for the end.
+	rows = (phases == outrate)?outrate+3:phases;
+
+	f = BZ_Malloc(sizeof(*f) + sizeof(float)*taps*rows + 31 + ((phases == outrate)?sizeof(int)*(rows+outrate):0));
+	f->coeff = (float*)(((size_t)(f+1) + 31) & ~(size_t)31);
+	if (phases == outrate)
+	{
+		f->schedofs = (int*)(f->coeff + taps*rows);
+		f->schedidx = f->schedofs + rows;
+	}
+	else
+	{
+		f->schedofs = NULL;
+		f->schedidx = NULL;
+	}
+	f->quality = quality;
+	f->inrate = inrate;
+	f->outrate = outrate;
+	f->taps = taps;
+	f->phases = phases;
+	f->rows = rows;
+	for (r = 0; r < rows; r++)
+	{
+		if (f->schedofs)
+		{
+			pos = (quint64_t)r * inrate;
+			p = pos % outrate;
+			f->schedofs[r] = pos / outrate;
+			if (r < outrate)
+				f->schedidx[p] = r;
+		}
+		else
+			p = r;
+		row = f->coeff + r*taps;
+		norm = 0;
+		for (k = 0; k < taps; k++)
+		{	//tap k reads the input sample at floor(pos)+k+1-taps/2
+			x = k + 1 - taps/2 - p / (double)phases;
+			if (fabs(x) >= halfwidth)
+				row[k] = 0;
+			else
+			{
+				row[k] = SND_Sinc_BesselI0(sincquality[quality].beta * sqrt(1 - (x/halfwidth)*(x/halfwidth))) * ibeta;
+				if (x)
+					row[k] *= sin(M_PI * fc * x) / (M_PI * x);
+				else
+					row[k] *= fc;
+			}
+			norm += row[k];
+		}
+		for (k = 0; k < taps; k++)	//unity gain at dc, whatever the phase.
+			row[k] /= norm;
+	}
+
+	FTE_Atomic_Insert(sincfilters, f, f->next);
+	return f;
+}
+
+#ifdef __SSE2__
+//leaves the four partial sums unadded, so four outputs can be reduced together.
+static __m128 SND_Sinc_Dot(const float *fte_restrict a, const float *fte_restrict b, int taps)
+{
+	__m128 sum = _mm_setzero_ps();
+	int k;
+	for (k = 0; k < taps; k += 4)
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a+k), _mm_loadu_ps(b+k)));
+	return sum;
+}
+#else
+static float SND_Sinc_Dot(const float *fte_restrict a, const float *fte_restrict b, int taps)
+{
+	float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int k;
+	for (k = 0; k < taps; k += 4)
+	{
+		s0 += a[k+0]*b[k+0];
+		s1 += a[k+1]*b[k+1];
+		s2 += a[k+2]*b[k+2];
+		s3 += a[k+3]*b[k+3];
+	}
+	return (s0+s1) + (s2+s3);
+}
+#endif
+
+static void SND_Sinc_Store(void *out, qaudiofmt_t outformat, int idx, float v)
+{
+	int i;
+	switch(outformat)
+	{
+	case QAF_S8:
+		v *= 1.f/256;
+		//fallthrough
+	case QAF_S16:
+#ifdef __SSE2__
+		i = _mm_cvtss_si32(_mm_set_ss(v));	//rounds to nearest, same as the 4-wide path.
+#else
+		i = floor(v + 0.5f);
+#endif
+		if (outformat == QAF_S8)
+			((signed char*)out)[idx] = bound(-128, i, 127);
+		else
+			((short*)out)[idx] = bound(-32768, i, 32767);
+		break;
+#ifdef MIXER_F32
+	case QAF_F32:
+		((float*)out)[idx] = v * (1.f/32768);
+		break;
+#endif
+	default:
+		break;
+	}
+}
+
+//converts one channel to 16bit-scaled floats.
+static void SND_Sinc_Deinterleave(float *plane, const void *in, qaudiofmt_t informat, int channels, int c, int insamps)
+{
+	int i;
+	switch(informat)
+	{
+	case QAF_S8:
+		for (i = 0; i < insamps; i++)
+			plane[i] = ((const signed char*)in)[i*channels+c] * 256.f;
+		break;
+	case QAF_S16:
+		if (channels == 1)	//lets the compiler vectorise the common case.
+			for (i = 0; i < insamps; i++)
+				plane[i] = ((const short*)in)[i];
+		else
+			for (i = 0; i < insamps; i++)
+				plane[i] = ((const short*)in)[i*channels+c];
+		break;
+#ifdef MIXER_F32
+	case QAF_F32:
+		for (i = 0; i < insamps; i++)
+			plane[i] = ((const float*)in)[i*channels+c] * 32768.f;
+		break;
+#endif
+	default:
+		memset(plane, 0, sizeof(*plane)*insamps);
+		break;
+	}
+}
+
+#ifdef __SSE2__
+//does four outputs at a time with their sums kept in registers, walking through the filter's schedule. inlined with constant taps for the common sizes, so the taps loop unrolls away.
+//returns how many it did, which is outsamps rounded down to a multiple of 4.
+fte_inlinestatic int SND_Sinc_Filter4(const sincfilter_t *f, const int taps, const float *plane, int *pfrem, int *pipos, int outsamps, void *out, qaudiofmt_t outformat, int channels, int c)
+{
+	const int *ofs = f->schedofs, inrate = f->inrate, outrate = f->outrate;
+	int m = f->schedidx[*pfrem];
+	const float *base = plane + *pipos - ofs[m] + 1;	//where the current period's input starts
+	const float *cf = f->coeff + m*taps;
+	const float *in0, *in1, *in2, *in3;
+	int n, j, k;
+	__m128 a0, a1, a2, a3;
+	__m128i s;
+	float t[4];
+
+	for (n = 0; n+4 <= outsamps; n += 4)
+	{
+		in0 = base + ofs[m+0];
+		in1 = base + ofs[m+1];
+		in2 = base + ofs[m+2];
+		in3 = base + ofs[m+3];
+		a0 = a1 = a2 = a3 = _mm_setzero_ps();
+		for (k = 0; k < taps; k += 4)
+		{
+			a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_load_ps(cf+0*taps+k), _mm_loadu_ps(in0+k)));
+			a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_load_ps(cf+1*taps+k), _mm_loadu_ps(in1+k)));
+			a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_load_ps(cf+2*taps+k), _mm_loadu_ps(in2+k)));
+			a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_load_ps(cf+3*taps+k), _mm_loadu_ps(in3+k)));
+		}
+		m += 4;
+		cf += 4*taps;
+		while (m >= outrate)
+		{	//into the next period (maybe more than one, for ratios like 2:1). the extra rows covered the overrun.
+			m -= outrate;
+			cf -= outrate*taps;
+			base += inrate;
+		}
+		_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+		a0 = _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3));
+
+		if (outformat == QAF_S16)
+		{
+			s = _mm_packs_epi32(_mm_cvtps_epi32(a0), _mm_setzero_si128());
+			if (channels == 1)
+				_mm_storel_epi64((__m128i*)((short*)out+n), s);
+			else
+			{
+				((short*)out)[(n+0)*channels+c] = _mm_extract_epi16(s, 0);
+				((short*)out)[(n+1)*channels+c] = _mm_extract_epi16(s, 1);
+				((short*)out)[(n+2)*channels+c] = _mm_extract_epi16(s, 2);
+				((short*)out)[(n+3)*channels+c] = _mm_extract_epi16(s, 3);
+			}
+		}
+		else
+		{
+			_mm_storeu_ps(t, a0);
+			for (j = 0; j < 4; j++)
+				SND_Sinc_Store(out, outformat, (n+j)*channels+c, t[j]);
+		}
+	}
+	*pfrem = ((quint64_t)m * inrate) % outrate;
+	*pipos = base - plane - 1 + ofs[m];
+	return n;
+}
+#endif
+
+//writes outsamps frames of channel c, the first being centred between plane[pad] and plane[pad+1] at phase frem.
+static void SND_Sinc_Filter(const sincfilter_t *f, const float *plane, int frem, int outsamps, void *out, qaudiofmt_t outformat, int channels, int c)
+{
+	int taps = f->taps;
+	int istep = f->inrate / f->outrate, fstep = f->inrate % f->outrate;
+	int n = 0, ipos = 0, phase;
+#ifdef __SSE2__
+	__m128 v;
+
+	if (f->schedofs)
+	switch(taps)
+	{	//the usual sizes get their own copies. 12, 20 and 24 are what 48000<->44100 ends up with.
+	case 8:		n = SND_Sinc_Filter4(f, 8, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	case 12:	n = SND_Sinc_Filter4(f, 12, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	case 16:	n = SND_Sinc_Filter4(f, 16, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	case 20:	n = SND_Sinc_Filter4(f, 20, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	case 24:	n = SND_Sinc_Filter4(f, 24, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	case 32:	n = SND_Sinc_Filter4(f, 32, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	default:	n = SND_Sinc_Filter4(f, taps, plane, &frem, &ipos, outsamps, out, outformat, channels, c);	break;
+	}
+#endif
+
+	for (; n < outsamps; n++)
+	{
+		if (f->schedidx)
+			phase = f->schedidx[frem];	//rows are in schedule order
+		else
+			phase = (int)(((quint64_t)frem * f->phases) / f->outrate);
+#ifdef __SSE2__
+		v = SND_Sinc_Dot(f->coeff + phase*taps, plane + ipos + 1, taps);
+		v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+		SND_Sinc_Store(out, outformat, n*channels+c, _mm_cvtss_f32(v));
+#else
+		SND_Sinc_Store(out, outformat, n*channels+c, SND_Sinc_Dot(f->coeff + phase*taps, plane + ipos + 1, taps));
+#endif
+
+		ipos += istep;
+		frem += fstep;
+		if (frem >= f->outrate)
+		{
+			frem -= f->outrate;
+			ipos++;
+		}
+	}
+}
+
+//channel counts must match. writes the same number of frames as STANDARDRESCALE.
+static void SND_ResampleSinc(const void *in, int inrate, qaudiofmt_t informat, int channels, int insamps, void *out, int outrate, qaudiofmt_t outformat, int quality)
+{
+	const sincfilter_t *f = SND_Sinc_GetFilter(quality, inrate, outrate);
+	int taps = f->taps, pad = taps/2;
+	int outsamps = insamps / (inrate / (double)outrate);
+	float *plane = BZ_Malloc(sizeof(*plane) * (insamps + taps));
+	int c, i;
+
+	for (c = 0; c < channels; c++)
+	{
+		//repeat the edge samples so the kernel never reads outside.
+		SND_Sinc_Deinterleave(plane+pad, in, informat, channels, c, insamps);
+		for (i = 0; i < pad; i++)
+		{
+			plane[i] = plane[pad];
+			plane[pad+insamps+i] = plane[pad+insamps-1];
+		}
+		SND_Sinc_Filter(f, plane, 0, outsamps, out, outformat, channels, c);
+	}
+	BZ_Free(plane);
+}
+
+//like SND_ResampleStream, but for one chunk of a longer stream. the sinc styles keep the tail of each chunk in the state so that the next one carries on smoothly, instead of restarting with a discontinuity.
+//returns the number of frames written. out needs room for one frame more than insamps*outrate/inrate, as the count varies a little with the fractional position.
+int SND_ResampleStreamChunk(resamplestate_t *st, const void *in, int inrate, qaudiofmt_t informat, int inchannels, int insamps, void *out, int outrate, qaudiofmt_t outformat, int outchannels, int resampstyle)
+{
+	const sincfilter_t *f;
+	int taps, pad, istep, fstep;
+	int len, ipos, frem, outsamps, keep, c, i;
+	float *plane;
+
+	if (insamps <= 0)
+		return 0;
+	if (resampstyle < 3 || inrate == outrate || inchannels != outchannels)
+	{
+		st->primed = false;	//if it goes back to sinc then it'll have to start over.
+		SND_ResampleStream(in, inrate, informat, inchannels, insamps, out, outrate, outformat, outchannels, resampstyle);
+		return insamps / (inrate / (double)outrate);
+	}
+
+	f = SND_Sinc_GetFilter(min(resampstyle-3, countof(sincquality)-1), inrate, outrate);
+	taps = f->taps;
+	pad = taps/2;
+	istep = f->inrate / f->outrate;
+	fstep = f->inrate % f->outrate;
+	if (!st->primed || st->filter != f || st->channels != inchannels)
+	{	//new stream, or its format changed.
+		st->filter = f;
+		st->channels = inchannels;
+		st->frem = 0;
+		st->count = 0;
+		st->skip = 0;
+		st->hist = BZ_Realloc(st->hist, sizeof(*st->hist)*taps*inchannels);
+	}
+
+	if (st->skip)
+	{	//the last chunk's outputs stepped past its end.
+		i = min(st->skip, insamps);
+		st->skip -= i;
+		insamps -= i;
+		in = (const qbyte*)in + i*inchannels*QAF_BYTES(informat);
+		if (!insamps)
+			return 0;
+	}
+
+	//figure out how many outputs have all of their input now, and where the next one will start.
+	len = (st->primed?st->count:pad) + insamps;
+	for (outsamps = 0, ipos = 0, frem = st->frem; ipos + taps < len; outsamps++)
+	{
+		ipos += istep;
+		frem += fstep;
+		if (frem >= f->outrate)
+		{
+			frem -= f->outrate;
+			ipos++;
+		}
+	}
+	keep = max(0, len - ipos);
+
+	plane = BZ_Malloc(sizeof(*plane) * len);
+	for (c = 0; c < inchannels; c++)
+	{
+		if (st->primed)
+		{
+			memcpy(plane, st->hist + c*taps, sizeof(*plane)*st->count);
+			SND_Sinc_Deinterleave(plane+st->count, in, informat, inchannels, c, insamps);
+		}
+		else
+		{	//nothing before the start, so repeat the first sample like SND_ResampleSinc does.
+			SND_Sinc_Deinterleave(plane+pad, in, informat, inchannels, c, insamps);
+			for (i = 0; i < pad; i++)
+				plane[i] = plane[pad];
+		}
+		SND_Sinc_Filter(f, plane, st->frem, outsamps, out, outformat, inchannels, c);
+		memcpy(st->hist + c*taps, plane+len-keep, sizeof(*plane)*keep);
+	}
+	BZ_Free(plane);
+
+	st->primed = true;
+	st->count = keep;
+	st->skip = max(0, ipos - len);
+	st->frem = frem;
+	return outsamps;
+}
+//finishes a stream by repeating its last sample, like SND_ResampleSinc does at the end, so the outputs still waiting on history get written too.
+//with a null out it only says how many frames it would write. afterwards the state starts over.
+int SND_ResampleStreamFlush(resamplestate_t *st, void *out, qaudiofmt_t outformat)
+{
+	const sincfilter_t *f = st->filter;
+	int taps, pad, istep, fstep;
+	int ipos, frem, outsamps, c, i;
+	float *plane;
+
+	if (!st->primed || !f || st->skip)
+		return 0;	//nothing held back, or the outputs already went past the end.
+	taps = f->taps;
+	pad = taps/2;
+	istep = f->inrate / f->outrate;
+	fstep = f->inrate % f->outrate;
+
+	//one output for every one that lands on real input.
+	for (outsamps = 0, ipos = 0, frem = st->frem; ipos + pad < st->count; outsamps++)
+	{
+		ipos += istep;
+		frem += fstep;
+		if (frem >= f->outrate)
+		{
+			frem -= f->outrate;
+			ipos++;
+		}
+	}
+	if (!out)
+		return outsamps;
+
+	if (outsamps)
+	{
+		plane = BZ_Malloc(sizeof(*plane) * (st->count+pad));
+		for (c = 0; c < st->channels; c++)
+		{
+			memcpy(plane, st->hist + c*taps, sizeof(*plane)*st->count);
+			for (i = 0; i < pad; i++)
+				plane[st->count+i] = plane[st->count-1];
+			SND_Sinc_Filter(f, plane, st->frem, outsamps, out, outformat, st->channels, c);
+		}
+		BZ_Free(plane);
+	}
+	st->primed = false;
+	return outsamps;
+}
+void SND_ResampleFreeState(resamplestate_t *st)
+{
+	BZ_Free(st->hist);
+	memset(st, 0, sizeof(*st));
+}
+
 // SND_ResampleStream: takes a sound stream and converts with given parameters. Limited to
 // 8-16-bit signed conversions and mono-to-mono/stereo-to-stereo conversions.
 // Not an in-place algorithm.
+// resampstyle: 0=nearest, 1=linear upsampling, 2=linear, 3+=windowed sinc of increasing quality.
 void SND_ResampleStream(const void *in, int inrate, qaudiofmt_t informat, int inchannels, int insamps, void *out, int outrate, qaudiofmt_t outformat, int outchannels, int resampstyle)
 {
 	double scale;
@@ -307,7 +802,13 @@ void SND_ResampleStream(const void *in, int inrate, qaudiofmt_t informat, int in
 
 	if (inchannels == outchannels && informat == outformat && inrate == outrate)
 	{
-		memcpy(out, in, informat * insamps * inchannels);
+		memcpy(out, in, QAF_BYTES(informat) * insamps * inchannels);
+		return;
+	}
+
+	if (resampstyle >= 3 && inrate != outrate && inchannels == outchannels)
+	{
+		SND_ResampleSinc(in, inrate, informat, inchannels, insamps, out, outrate, outformat, min(resampstyle-3, countof(sincquality)-1));
 		return;
 	}
 
@@ -549,6 +1050,102 @@ void SND_ResampleStream(const void *in, int inrate, qaudiofmt_t informat, int in
 #endif
 }
 
+//fits a sinusoid of the given frequency to the output, returning its amplitude and (via resid) the rms of everything else.
+static double SND_ResampleBench_Fit(const short *s, int count, double freq, int rate, double *resid)
+{
+	double a = 0, b = 0, e = 0, w = 2*M_PI*freq/rate, y;
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		a += s[i] * cos(w*i);
+		b += s[i] * sin(w*i);
+	}
+	a *= 2.0/count;
+	b *= 2.0/count;
+	for (i = 0; i < count; i++)
+	{
+		y = s[i] - (a*cos(w*i) + b*sin(w*i));
+		e += y*y;
+	}
+	*resid = sqrt(e/count);
+	return sqrt(a*a+b*b);
+}
+//resamples generated tones with each style, reporting speed, passband gain, the residual left after removing the tone, and how well an out-of-band tone is rejected.
+void SND_ResampleBench_f(void)
+{
+	static const char *stylename[] = {"nearest", "linear-up", "linear", "sinc-low", "sinc-med", "sinc-high"};
+	static const int rates[][2] = {{11025,44100}, {22050,48000}, {44100,48000}, {48000,44100}, {44100,22050}};
+	int reps = (Cmd_Argc() > 1)?atoi(Cmd_Argv(1)):20;
+	const double amp = 16000;
+	int r, style, i, n, inrate, outrate, outsamps, ofs, len, chunk, got, diff;
+	short *in, *out, *chunked;
+	double pass, stop, start, time, gain, resid, alias;
+	resamplestate_t st;
+
+	reps = bound(1, reps, 1000);
+	for (r = 0; r < countof(rates); r++)
+	{
+		inrate = rates[r][0];
+		outrate = rates[r][1];
+		//whole cycles over the analysed half second
+		pass = 2*floor(0.2*min(inrate,outrate)/2);
+		stop = 2*floor((inrate+outrate)/8);	//between the output's nyquist and the input's, only matters when downsampling
+		in = BZ_Malloc(sizeof(*in)*inrate*2);
+		out = BZ_Malloc(sizeof(*out)*(outrate+16));
+		ofs = outrate/4;
+		len = outrate/2;
+
+		Con_Printf("%i -> %i, %gHz tone%s\n", inrate, outrate, pass, (outrate<inrate)?va(", %gHz alias", stop):"");
+		for (i = 0; i < inrate; i++)
+		{
+			in[i] = amp * sin(2*M_PI*pass*i/inrate);
+			in[inrate+i] = amp * sin(2*M_PI*stop*i/inrate);
+		}
+		for (style = 0; style < countof(stylename); style++)
+		{
+			start = Sys_DoubleTime();
+			for (n = 0; n < reps; n++)
+				SND_ResampleStream(in, inrate, QAF_S16, 1, inrate, out, outrate, QAF_S16, 1, style);
+			time = Sys_DoubleTime() - start;
+			outsamps = inrate / (inrate / (double)outrate);
+
+			gain = SND_ResampleBench_Fit(out+ofs, len, pass, outrate, &resid);
+			resid = 20*log10(max(resid, 1e-3) / (gain*M_SQRT1_2));
+			gain = 20*log10(gain / amp);
+
+			if (style >= 3)
+			{	//the same again in awkward chunks, like a stream would, then flushed. it should match the one-shot output.
+				memset(&st, 0, sizeof(st));
+				chunked = BZ_Malloc(sizeof(*chunked)*(outrate+16));
+				for (i = 0, got = 0; i < inrate; i += chunk)
+				{
+					chunk = min(inrate-i, 1 + (i*7919)%997);
+					got += SND_ResampleStreamChunk(&st, in+i, inrate, QAF_S16, 1, chunk, chunked+got, outrate, QAF_S16, 1, style);
+				}
+				got += SND_ResampleStreamFlush(&st, chunked+got, QAF_S16);
+				SND_ResampleFreeState(&st);
+				for (i = 0, diff = 0; i < min(got, outsamps); i++)
+					diff = max(diff, abs(chunked[i]-out[i]));
+				BZ_Free(chunked);
+			}
+			else
+				got = diff = 0;
+			if (outrate < inrate)
+			{
+				SND_ResampleStream(in+inrate, inrate, QAF_S16, 1, inrate, out, outrate, QAF_S16, 1, style);
+				SND_ResampleBench_Fit(out+ofs, len, pass, outrate, &alias);	//there should be nothing left of it, so it's all residual.
+				Con_Printf("  %-10s %7.1f Mframes/s, gain %6.2fdB, residual %6.1fdB, alias %6.1fdB\n", stylename[style], outsamps*(double)reps/(time*1000000), gain, resid, 20*log10(max(alias, 1e-3)/(amp*M_SQRT1_2)));
+			}
+			else
+				Con_Printf("  %-10s %7.1f Mframes/s, gain %6.2fdB, residual %6.1fdB\n", stylename[style], outsamps*(double)reps/(time*1000000), gain, resid);
+			if (style >= 3)
+				Con_Printf("  %-10s streamed %i of %i frames, max difference %i\n", "", got, outsamps, diff);
+		}
+		BZ_Free(in);
+		BZ_Free(out);
+	}
+}
+
 /*
 ================
 ResampleSfx
@@ -44,6 +44,15 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 static portable_samplegroup_t paintbuffer[PAINTBUFFER_SIZE];	//FIXME: we really ought to be using SSE and floats or something.
 
+#if defined(__SSE2__) && !defined(MIXER_PAINT_F32)
+	#include <emmintrin.h>
+	#define MIXER_SSE2	//the common (non-resampling) mixers and the output conversion have simd versions. these give identical results.
+	#if defined(MIXER_F32) && (!defined(__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0)
+		#define MIXER_SSE2_FLOAT	//scalar float maths matches sse, so the float mixers can stay bit-exact too.
+	#endif
+	static qboolean snd_mixsimd = true;	//so snd_mixbench can compare against the scalar code.
+#endif
+
 void S_TransferPaintBuffer(soundcardinfo_t *sc, int endtime)
 {
 	unsigned int 	out_idx;
@@ -137,6 +146,17 @@ void S_TransferPaintBuffer(soundcardinfo_t *sc, int endtime)
 			short *out = (short *) pbuf;
 			while (count)
 			{
+#ifdef MIXER_SSE2
+				if (numc == 2 && snd_mixsimd)
+				{	//the usual case. saturating packs do the clamping for us. stops at the end of the ring buffer.
+					for (; count >= 8 && out_idx+8 <= outlimit; count -= 8, out_idx = (out_idx+8) % outlimit, p += MAXSOUNDCHANNELS*4)
+						_mm_storeu_si128((__m128i*)(out+out_idx), _mm_packs_epi32(
+								_mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)p), _mm_loadl_epi64((const __m128i*)(p+MAXSOUNDCHANNELS))),
+								_mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(p+MAXSOUNDCHANNELS*2)), _mm_loadl_epi64((const __m128i*)(p+MAXSOUNDCHANNELS*3)))));
+					if (!count)
+						break;
+				}
+#endif
 				for (i = 0; i < numc; i++)
 				{
 #ifdef MIXER_PAINT_F32
@@ -161,6 +181,16 @@ void S_TransferPaintBuffer(soundcardinfo_t *sc, int endtime)
 			float *out = (float *) pbuf;
 			while (count)
 			{
+#ifdef MIXER_SSE2
+				if (numc == 2 && snd_mixsimd)
+				{	//scaling by a power of two is exact, so this matches the scalar version.
+					for (; count >= 4 && out_idx+4 <= outlimit; count -= 4, out_idx = (out_idx+4) % outlimit, p += MAXSOUNDCHANNELS*2)
+						_mm_storeu_ps(out+out_idx, _mm_mul_ps(_mm_set1_ps(1.0 / 32768), _mm_cvtepi32_ps(
+								_mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)p), _mm_loadl_epi64((const __m128i*)(p+MAXSOUNDCHANNELS))))));
+					if (!count)
+						break;
+				}
+#endif
 				for (i = 0; i < numc; i++)
 				{
 #ifdef MIXER_PAINT_F32	//FIXME: replace with a memcpy.
@@ -208,6 +238,217 @@ static void SND_PaintChannel32F_O8I1(channel_t *ch, sfxcache_t *sc, int count, i
 static void SND_PaintChannel32F_O2I2(channel_t *ch, sfxcache_t *sc, int starttime, int count, int rate);
 #endif
 
+#ifdef MIXER_SSE2
+//widens 8 samples to 16bit lanes
+static __m128i SND_Load8_SSE2(const void *sfx, qboolean bits8)
+{
+	__m128i d;
+	if (bits8)
+	{
+		d = _mm_loadl_epi64((const __m128i*)sfx);
+		return _mm_srai_epi16(_mm_unpacklo_epi8(d, d), 8);
+	}
+	return _mm_loadu_si128((const __m128i*)sfx);
+}
+//packs the channel's volumes into 16bit lanes (repeating every numchans), if they fit (they're normally 0-255). the products are then exact.
+static qboolean SND_Vol16_SSE2(channel_t *ch, int numchans, __m128i *out)
+{
+	short v[8];
+	int i;
+	if (!snd_mixsimd)
+		return false;
+	for (i = 0; i < 8; i++)
+	{
+		v[i] = ch->vol[i%numchans];
+		if (v[i] != ch->vol[i%numchans])
+			return false;
+	}
+	*out = _mm_loadu_si128((const __m128i*)v);
+	return true;
+}
+//adds two frames of left+right to the paint buffer
+static void SND_AddLR_SSE2(portable_samplegroup_t *pb, __m128i lr)
+{
+	_mm_storel_epi64((__m128i*)pb[0].s, _mm_add_epi32(_mm_loadl_epi64((const __m128i*)pb[0].s), lr));
+	_mm_storel_epi64((__m128i*)pb[1].s, _mm_add_epi32(_mm_loadl_epi64((const __m128i*)pb[1].s), _mm_unpackhi_epi64(lr, lr)));
+}
+//mono input without resampling. products are shifted down like MIX_16_8 for 16bit data, and left as-is for 8bit. returns how many frames were done.
+static int SND_PaintMono_SSE2(portable_samplegroup_t *pb, channel_t *ch, const void *sfx, qboolean bits8, int count, int numchans)
+{
+	__m128i vol, d, lo, hi, l, r;
+	__m128i shift = _mm_cvtsi32_si128(bits8?0:8);
+	int i = 0;
+
+	if (numchans == 2)
+	{	//the output frames are sparse, so do 8 at a time to get some use out of the multiplies
+		if (!SND_Vol16_SSE2(ch, 2, &vol))
+			return 0;
+		lo = _mm_shufflelo_epi16(vol, _MM_SHUFFLE(0,0,0,0));
+		hi = _mm_shufflelo_epi16(vol, _MM_SHUFFLE(1,1,1,1));
+		l = _mm_unpacklo_epi64(lo, lo);	//left volume in every lane
+		r = _mm_unpacklo_epi64(hi, hi);	//right volume in every lane
+		for (; i+8 <= count; i += 8, pb += 8)
+		{
+			__m128i ll, lh, rl, rh;
+			d = SND_Load8_SSE2((const qbyte*)sfx + (bits8?i:i*2), bits8);
+			lo = _mm_mullo_epi16(d, l);
+			hi = _mm_mulhi_epi16(d, l);
+			ll = _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift);
+			lh = _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift);
+			lo = _mm_mullo_epi16(d, r);
+			hi = _mm_mulhi_epi16(d, r);
+			rl = _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift);
+			rh = _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift);
+			SND_AddLR_SSE2(pb+0, _mm_unpacklo_epi32(ll, rl));
+			SND_AddLR_SSE2(pb+2, _mm_unpackhi_epi32(ll, rl));
+			SND_AddLR_SSE2(pb+4, _mm_unpacklo_epi32(lh, rh));
+			SND_AddLR_SSE2(pb+6, _mm_unpackhi_epi32(lh, rh));
+		}
+		return i;
+	}
+
+	//one frame at a time, with a lane per speaker
+	if (!SND_Vol16_SSE2(ch, numchans, &vol))
+		return 0;
+	for (; i < count; i++, pb++)
+	{
+		d = _mm_set1_epi16(bits8?((const signed char*)sfx)[i]:((const short*)sfx)[i]);
+		lo = _mm_mullo_epi16(d, vol);
+		hi = _mm_mulhi_epi16(d, vol);
+		l = _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift);
+		_mm_storeu_si128((__m128i*)pb->s, _mm_add_epi32(_mm_loadu_si128((const __m128i*)pb->s), l));
+		if (numchans > 4)
+		{
+			r = _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift);
+			if (numchans > 6)
+				_mm_storeu_si128((__m128i*)(pb->s+4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(pb->s+4)), r));
+			else
+				_mm_storel_epi64((__m128i*)(pb->s+4), _mm_add_epi32(_mm_loadl_epi64((const __m128i*)(pb->s+4)), r));
+		}
+	}
+	return i;
+}
+//interleaved stereo input without resampling, into stereo output.
+static int SND_PaintStereo_SSE2(portable_samplegroup_t *pb, channel_t *ch, const void *sfx, qboolean bits8, int count)
+{
+	__m128i vol, d, lo, hi;
+	__m128i shift = _mm_cvtsi32_si128(bits8?0:8);
+	int i = 0;
+
+	if (!SND_Vol16_SSE2(ch, 2, &vol))	//l,r,l,r...
+		return 0;
+	for (; i+4 <= count; i += 4, pb += 4)
+	{
+		d = SND_Load8_SSE2((const qbyte*)sfx + (bits8?i*2:i*4), bits8);
+		lo = _mm_mullo_epi16(d, vol);
+		hi = _mm_mulhi_epi16(d, vol);
+		SND_AddLR_SSE2(pb+0, _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift));
+		SND_AddLR_SSE2(pb+2, _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift));
+	}
+	return i;
+}
+#ifdef MIXER_SSE2_FLOAT
+//float mono input without resampling. vol is already scaled up to 16bit. truncproduct matches code that converts the product to an int before adding, otherwise the sum is done as a float like 'int += float' does.
+static int SND_PaintMonoF_SSE2(portable_samplegroup_t *pb, const float *sfx, int count, const int *vol, int numchans, qboolean truncproduct)
+{
+	__m128 v0, v1, d;
+	__m128i *o;
+	int i = 0;
+	if (!snd_mixsimd)
+		return 0;
+	v0 = _mm_setr_ps(vol[0], vol[1], (numchans>2)?vol[2]:0, (numchans>3)?vol[3]:0);
+	v1 = _mm_setr_ps((numchans>4)?vol[4]:0, (numchans>5)?vol[5]:0, (numchans>6)?vol[6]:0, (numchans>7)?vol[7]:0);
+	for (; i < count; i++, pb++)
+	{
+		d = _mm_set1_ps(sfx[i]);
+		o = (__m128i*)pb->s;
+		if (truncproduct)
+			_mm_storel_epi64(o, _mm_add_epi32(_mm_loadl_epi64(o), _mm_cvttps_epi32(_mm_mul_ps(d, v0))));
+		else if (numchans == 2)
+			_mm_storel_epi64(o, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadl_epi64(o)), _mm_mul_ps(d, v0))));
+		else
+		{
+			_mm_storeu_si128(o, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadu_si128(o)), _mm_mul_ps(d, v0))));
+			if (numchans > 6)
+				_mm_storeu_si128(o+1, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadu_si128(o+1)), _mm_mul_ps(d, v1))));
+			else if (numchans > 4)
+				_mm_storel_epi64(o+1, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadl_epi64(o+1)), _mm_mul_ps(d, v1))));
+		}
+	}
+	return i;
+}
+//float stereo input without resampling, into stereo output.
+static int SND_PaintStereoF_SSE2(portable_samplegroup_t *pb, const float *sfx, int count, float leftvol, float rightvol)
+{
+	__m128 vol, d;
+	__m128i *o;
+	int i = 0;
+	if (!snd_mixsimd)
+		return 0;
+	vol = _mm_setr_ps(leftvol, rightvol, leftvol, rightvol);
+	for (; i+2 <= count; i += 2, pb += 2)
+	{
+		d = _mm_mul_ps(_mm_loadu_ps(sfx+i*2), vol);
+		o = (__m128i*)pb[0].s;
+		_mm_storel_epi64(o, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadl_epi64(o)), d)));
+		o = (__m128i*)pb[1].s;
+		_mm_storel_epi64(o, _mm_cvttps_epi32(_mm_add_ps(_mm_cvtepi32_ps(_mm_loadl_epi64(o)), _mm_movehl_ps(d, d))));
+	}
+	return i;
+}
+#endif
+#endif
+
+//picks the right mixer for the sound's format and the output's speaker count.
+static void SND_PaintChannel(channel_t *ch, sfxcache_t *scache, int starttime, int count, int rate, int outchans)
+{
+	switch(scache->format)
+	{
+	case QAF_S8:
+		if (scache->numchannels==2)
+			SND_PaintChannel8_O2I2(ch, scache, starttime, count, rate);
+		else if (outchans <= 2)
+			SND_PaintChannel8_O2I1(ch, scache, starttime, count, rate);
+		else if (outchans <= 4)
+			SND_PaintChannel8_O4I1(ch, scache, count, rate);
+		else if (outchans <= 6)
+			SND_PaintChannel8_O6I1(ch, scache, count, rate);
+		else
+			SND_PaintChannel8_O8I1(ch, scache, count, rate);
+		break;
+	case QAF_S16:
+		if (scache->numchannels==2)
+			SND_PaintChannel16_O2I2(ch, scache, starttime, count, rate);
+		else if (outchans <= 2)
+			SND_PaintChannel16_O2I1(ch, scache, starttime, count, rate);
+		else if (outchans <= 4)
+			SND_PaintChannel16_O4I1(ch, scache, count, rate);
+		else if (outchans <= 6)
+			SND_PaintChannel16_O6I1(ch, scache, count, rate);
+		else
+			SND_PaintChannel16_O8I1(ch, scache, count, rate);
+		break;
+#ifdef MIXER_F32
+	case QAF_F32:
+		if (scache->numchannels==2)
+			SND_PaintChannel32F_O2I2(ch, scache, starttime, count, rate);
+		else if (outchans <= 2)
+			SND_PaintChannel32F_O2I1(ch, scache, starttime, count, rate);
+		else if (outchans <= 4)
+			SND_PaintChannel32F_O4I1(ch, scache, count, rate);
+		else if (outchans <= 6)
+			SND_PaintChannel32F_O6I1(ch, scache, count, rate);
+		else
+			SND_PaintChannel32F_O8I1(ch, scache, count, rate);
+		break;
+#endif
+#ifdef FTE_TARGET_WEB
+	case QAF_BLOB:
+		break;
+#endif
+	}
+}
+
 //NOTE: MAY NOT CALL SYS_ERROR
 void S_PaintChannels(soundcardinfo_t *sc, int endtime)
 {
@@ -354,51 +595,7 @@ void S_PaintChannels(soundcardinfo_t *sc, int endtime)
 						continue;
 					}
 
-					switch(scache->format)
-					{
-					case QAF_S8:
-						if (scache->numchannels==2)
-							SND_PaintChannel8_O2I2(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 2)
-							SND_PaintChannel8_O2I1(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 4)
-							SND_PaintChannel8_O4I1(ch, scache, count, rate);
-						else if (sc->sn.numchannels <= 6)
-							SND_PaintChannel8_O6I1(ch, scache, count, rate);
-						else
-							SND_PaintChannel8_O8I1(ch, scache, count, rate);
-						break;
-					case QAF_S16:
-						if (scache->numchannels==2)
-							SND_PaintChannel16_O2I2(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 2)
-							SND_PaintChannel16_O2I1(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 4)
-							SND_PaintChannel16_O4I1(ch, scache, count, rate);
-						else if (sc->sn.numchannels <= 6)
-							SND_PaintChannel16_O6I1(ch, scache, count, rate);
-						else
-							SND_PaintChannel16_O8I1(ch, scache, count, rate);
-						break;
-#ifdef MIXER_F32
-					case QAF_F32:
-						if (scache->numchannels==2)
-							SND_PaintChannel32F_O2I2(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 2)
-							SND_PaintChannel32F_O2I1(ch, scache, ltime-sc->paintedtime, count, rate);
-						else if (sc->sn.numchannels <= 4)
-							SND_PaintChannel32F_O4I1(ch, scache, count, rate);
-						else if (sc->sn.numchannels <= 6)
-							SND_PaintChannel32F_O6I1(ch, scache, count, rate);
-						else
-							SND_PaintChannel32F_O8I1(ch, scache, count, rate);
-						break;
-#endif
-#ifdef FTE_TARGET_WEB
-					case QAF_BLOB:
-						break;
-#endif
-					}
+					SND_PaintChannel(ch, scache, ltime-sc->paintedtime, count, rate, sc->sn.numchannels);
 					ltime += count;
 					ch->pos += rate * count;
 				}
@@ -434,7 +631,11 @@ static void SND_PaintChannel8_O2I1 (channel_t *ch, sfxcache_t *sc, int starttime
 	else
 	{
 		sfx = (signed char *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer+starttime, ch, sfx, true, count, 2);
+#endif
+		for (; i<count ; i++)
 		{
 			data = sfx[i];
 			paintbuffer[starttime+i].s[0] += MIX_8_8(ch->vol[0] * data);
@@ -463,7 +664,11 @@ static void SND_PaintChannel8_O2I2 (channel_t *ch, sfxcache_t *sc, int starttime
 	else
 	{
 		sfx = (signed char *fte_restrict)sc->data + (pos>>PITCHSHIFT)*2;
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintStereo_SSE2(paintbuffer+starttime, ch, sfx, true, count);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[starttime+i].s[0] += MIX_8_8(ch->vol[0] * sfx[(i<<1)]);
 			paintbuffer[starttime+i].s[1] += MIX_8_8(ch->vol[1] * sfx[(i<<1)+1]);
@@ -494,7 +699,11 @@ static void SND_PaintChannel8_O4I1 (channel_t *ch, sfxcache_t *sc, int count, in
 	else
 	{
 		sfx = (signed char *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, true, count, 4);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_8_8(ch->vol[0] * sfx[i]);
 			paintbuffer[i].s[1] += MIX_8_8(ch->vol[1] * sfx[i]);
@@ -529,7 +738,11 @@ static void SND_PaintChannel8_O6I1 (channel_t *ch, sfxcache_t *sc, int count, in
 	else
 	{
 		sfx = (signed char *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, true, count, 6);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_8_8(ch->vol[0] * sfx[i]);
 			paintbuffer[i].s[1] += MIX_8_8(ch->vol[1] * sfx[i]);
@@ -568,7 +781,11 @@ static void SND_PaintChannel8_O8I1 (channel_t *ch, sfxcache_t *sc, int count, in
 	else
 	{
 		sfx = (signed char *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, true, count, 8);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_8_8(ch->vol[0] * sfx[i]);
 			paintbuffer[i].s[1] += MIX_8_8(ch->vol[1] * sfx[i]);
@@ -610,7 +827,11 @@ static void SND_PaintChannel16_O2I1 (channel_t *ch, sfxcache_t *sc, int starttim
 	else
 	{
 		sfx = (signed short *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer+starttime, ch, sfx, false, count, 2);
+#endif
+		for (; i<count ; i++)
 		{
 			data = sfx[i];
 			paintbuffer[starttime+i].s[0] += MIX_16_8(data * leftvol);
@@ -645,7 +866,12 @@ static void SND_PaintChannel16_O2I2 (channel_t *ch, sfxcache_t *sc, int starttim
 	else
 	{
 		sfx = (signed short *fte_restrict)sc->data + (pos>>PITCHSHIFT)*2;
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintStereo_SSE2(paintbuffer+starttime, ch, sfx, false, count);
+		sfx += i*2;
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[starttime+i].s[0] += MIX_16_8(*sfx++ * leftvol);
 			paintbuffer[starttime+i].s[1] += MIX_16_8(*sfx++ * rightvol);
@@ -682,7 +908,11 @@ static void SND_PaintChannel16_O4I1 (channel_t *ch, sfxcache_t *sc, int count, i
 	else
 	{
 		sfx = (signed short *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, false, count, 4);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_16_8(sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += MIX_16_8(sfx[i] * vol[1]);
@@ -725,7 +955,11 @@ static void SND_PaintChannel16_O6I1 (channel_t *ch, sfxcache_t *sc, int count, i
 	else
 	{
 		sfx = (signed short *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, false, count, 6);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_16_8(sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += MIX_16_8(sfx[i] * vol[1]);
@@ -774,7 +1008,11 @@ static void SND_PaintChannel16_O8I1 (channel_t *ch, sfxcache_t *sc, int count, i
 	else
 	{
 		sfx = (signed short *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2
+		i = SND_PaintMono_SSE2(paintbuffer, ch, sfx, false, count, 8);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += MIX_16_8(sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += MIX_16_8(sfx[i] * vol[1]);
@@ -816,7 +1054,14 @@ static void SND_PaintChannel32F_O2I1 (channel_t *ch, sfxcache_t *sc, int startti
 	else
 	{
 		sfx = (float *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2_FLOAT
+		{
+			int vol[2] = {leftvol, rightvol};
+			i = SND_PaintMonoF_SSE2(paintbuffer+starttime, sfx, count, vol, 2, true);
+		}
+#endif
+		for (; i<count ; i++)
 		{
 			data = sfx[i];
 			left = (data * leftvol);
@@ -853,7 +1098,12 @@ static void SND_PaintChannel32F_O2I2 (channel_t *ch, sfxcache_t *sc, int startti
 	else
 	{
 		sfx = (float *fte_restrict)sc->data + (pos>>PITCHSHIFT)*2;
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2_FLOAT
+		i = SND_PaintStereoF_SSE2(paintbuffer+starttime, sfx, count, leftvol, rightvol);
+		sfx += i*2;
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[starttime+i].s[0] += (*sfx++ * leftvol);
 			paintbuffer[starttime+i].s[1] += (*sfx++ * rightvol);
@@ -890,7 +1140,11 @@ static void SND_PaintChannel32F_O4I1 (channel_t *ch, sfxcache_t *sc, int count,
 	else
 	{
 		sfx = (float *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2_FLOAT
+		i = SND_PaintMonoF_SSE2(paintbuffer, sfx, count, vol, 4, false);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += (sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += (sfx[i] * vol[1]);
@@ -933,7 +1187,11 @@ static void SND_PaintChannel32F_O6I1 (channel_t *ch, sfxcache_t *sc, int count,
 	else
 	{
 		sfx = (float *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2_FLOAT
+		i = SND_PaintMonoF_SSE2(paintbuffer, sfx, count, vol, 6, false);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += (sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += (sfx[i] * vol[1]);
@@ -983,7 +1241,11 @@ static void SND_PaintChannel32F_O8I1 (channel_t *ch, sfxcache_t *sc, int count,
 	else
 	{
 		sfx = (float *fte_restrict)sc->data + (pos>>PITCHSHIFT);
-		for (i=0 ; i<count ; i++)
+		i = 0;
+#ifdef MIXER_SSE2_FLOAT
+		i = SND_PaintMonoF_SSE2(paintbuffer, sfx, count, vol, 8, false);
+#endif
+		for (; i<count ; i++)
 		{
 			paintbuffer[i].s[0] += (sfx[i] * vol[0]);
 			paintbuffer[i].s[1] += (sfx[i] * vol[1]);
@@ -997,4 +1259,164 @@ static void SND_PaintChannel32F_O8I1 (channel_t *ch, sfxcache_t *sc, int count,
 	}
 }
 #endif
+
+static void *SND_MixBench_Lock(soundcardinfo_t *sc, unsigned int *startoffset)
+{
+	return sc->sn.buffer;
+}
+static void SND_MixBench_Unlock(soundcardinfo_t *sc, void *buffer)
+{
+}
+static qboolean SND_MixBench_Transfer(int fmt, double *time, int reps)
+{	//paints the same random buffer out with and without simd, starting near the end of the ring so that it wraps. caller must hold the mixer lock.
+	static portable_samplegroup_t ref[PAINTBUFFER_SIZE];
+	soundcardinfo_t *sc = Z_Malloc(sizeof(*sc));
+	int bytes = (fmt == QSF_F32)?4:2;
+	int samples = 3000*2;
+	qbyte *out[2];
+	int pass, r, i, j;
+	double start;
+	qboolean match;
+
+	for (i = 0; i < PAINTBUFFER_SIZE; i++)
+		for (j = 0; j < MAXSOUNDCHANNELS; j++)
+			ref[i].s[j] = (rand()&0x3ffff) - 0x20000;	//exceed the 16bit range, to test the clamping too.
+	sc->sn.numchannels = 2;
+	sc->sn.samples = samples;
+	sc->sn.samplebytes = bytes;
+	sc->sn.sampleformat = fmt;
+	sc->Lock = SND_MixBench_Lock;
+	sc->Unlock = SND_MixBench_Unlock;
+	for (pass = 0; pass < 2; pass++)
+	{
+		out[pass] = Z_Malloc(samples*bytes);
+		sc->sn.buffer = out[pass];
+#ifdef MIXER_SSE2
+		snd_mixsimd = pass;
+#endif
+		memcpy(paintbuffer, ref, sizeof(paintbuffer));
+		start = Sys_DoubleTime();
+		for (r = 0; r < reps; r++)
+		{
+			sc->paintedtime = samples/2 - 1001;
+			S_TransferPaintBuffer(sc, sc->paintedtime + PAINTBUFFER_SIZE);
+		}
+		time[pass] = Sys_DoubleTime() - start;
+	}
+#ifdef MIXER_SSE2
+	snd_mixsimd = true;
+#endif
+	match = !memcmp(out[0], out[1], samples*bytes);
+	Z_Free(out[0]);
+	Z_Free(out[1]);
+	Z_Free(sc);
+	return match;
+}
+//mixes a load of random channels and compares the simd mixers against the scalar ones.
+void S_MixBench_f(void)
+{
+	static const struct
+	{
+		const char *name;
+		qaudiofmt_t format;
+		int numchannels;
+	} in[] = {
+		{"s8 mono",		QAF_S8,		1},
+		{"s16 mono",	QAF_S16,	1},
+		{"s8 stereo",	QAF_S8,		2},
+		{"s16 stereo",	QAF_S16,	2},
+#ifdef MIXER_F32
+		{"f32 mono",	QAF_F32,	1},
+		{"f32 stereo",	QAF_F32,	2},
+#endif
+	};
+	static portable_samplegroup_t ref[PAINTBUFFER_SIZE];
+	int numchans = (Cmd_Argc() > 1)?atoi(Cmd_Argv(1)):256;
+	int reps = (Cmd_Argc() > 2)?atoi(Cmd_Argv(2)):8;
+	int f, o, c, r, pass, i, j;
+	sfxcache_t sfx;
+	channel_t *ch;
+	double start, time[2];
+	size_t frames;
+
+	numchans = bound(1, numchans, 4096);
+	reps = bound(1, reps, 1000);
+	frames = (size_t)numchans*PAINTBUFFER_SIZE*reps;
+	ch = Z_Malloc(sizeof(*ch)*numchans);
+	for (c = 0; c < numchans; c++)
+	{
+		for (j = 0; j < MAXSOUNDCHANNELS; j++)
+			ch[c].vol[j] = rand()&255;
+		ch[c].rate = 1<<PITCHSHIFT;
+	}
+
+	//the paintbuffer and snd_mixsimd are shared with the real mixer, so keep it out until we're done (the audio will stall meanwhile).
+	S_LockMixer();
+	Con_Printf("Mixing %i channels of %i frames, %i times\n", numchans, PAINTBUFFER_SIZE, reps);
+	for (f = 0; f < countof(in); f++)
+	{
+		memset(&sfx, 0, sizeof(sfx));
+		sfx.format = in[f].format;
+		sfx.numchannels = in[f].numchannels;
+		sfx.length = PAINTBUFFER_SIZE;
+		sfx.data = BZ_Malloc(sfx.length*sfx.numchannels*QAF_BYTES(sfx.format));
+		for (i = 0; i < sfx.length*sfx.numchannels; i++)
+		{
+			switch(sfx.format)
+			{
+			case QAF_S8:	((signed char*)sfx.data)[i] = rand();	break;
+			case QAF_S16:	((short*)sfx.data)[i] = rand();			break;
+#ifdef MIXER_F32
+			case QAF_F32:	((float*)sfx.data)[i] = (rand()&0xffff)/32768.0 - 1;	break;
+#endif
+			default:	break;
+			}
+		}
+
+		for (o = 2; o <= MAXSOUNDCHANNELS; o += 2)
+		{
+			if (sfx.numchannels == 2 && o > 2)
+				break;	//stereo sources only have the one mixer.
+			for (pass = 0; pass < 2; pass++)
+			{
+#ifdef MIXER_SSE2
+				snd_mixsimd = pass;
+#else
+				if (pass)
+					break;
+#endif
+				start = Sys_DoubleTime();
+				for (r = 0; r < reps; r++)
+				{
+					memset(paintbuffer, 0, sizeof(paintbuffer));
+					for (c = 0; c < numchans; c++)
+						SND_PaintChannel(&ch[c], &sfx, 0, PAINTBUFFER_SIZE, ch[c].rate, o);
+				}
+				time[pass] = Sys_DoubleTime() - start;
+				if (!pass)
+					memcpy(ref, paintbuffer, sizeof(ref));
+			}
+#ifdef MIXER_SSE2
+			snd_mixsimd = true;
+			Con_Printf("%-10s -> %i: scalar %7.1f, sse2 %7.1f Mframes/s%s\n", in[f].name, o, frames/(time[0]*1000000), frames/(time[1]*1000000), memcmp(ref, paintbuffer, sizeof(ref))?" ^1MISMATCH":"");
+#else
+			Con_Printf("%-10s -> %i: %7.1f Mframes/s\n", in[f].name, o, frames/(time[0]*1000000));
+#endif
+		}
+		BZ_Free(sfx.data);
+	}
+	Z_Free(ch);
+
+	for (f = 0; f < 2; f++)
+	{
+		qboolean same = SND_MixBench_Transfer(f?QSF_F32:QSF_S16, time, reps*16);
+		frames = PAINTBUFFER_SIZE*reps*16;
+#ifdef MIXER_SSE2
+		Con_Printf("transfer %s: scalar %7.1f, sse2 %7.1f Mframes/s%s\n", f?"f32":"s16", frames/(time[0]*1000000), frames/(time[1]*1000000), same?"":" ^1MISMATCH");
+#else
+		Con_Printf("transfer %s: %7.1f Mframes/s%s\n", f?"f32":"s16", frames/(time[0]*1000000), same?"":" ^1MISMATCH");
+#endif
+	}
+	S_UnlockMixer();
+}
 #endif
@@ -67,6 +67,7 @@ typedef struct {
 
 	char *tempbuffer;
 	int tempbufferbytes;
+	resamplestate_t resample;	//so the sinc resampler doesn't restart at every chunk
 
 	char *decodedbuffer;
 	int decodedbufferbytes;
@@ -152,6 +153,7 @@ static sfxcache_t *QDECL OV_DecodeSome(struct sfx_s *sfx, struct sfxcache_s *buf
 				/*something rewound, purge clear the buffer*/
 				dec->decodedbytecount = 0;
 				dec->decodedbytestart = start;
+				dec->resample.primed = false;
 			}
 		}
 
@@ -180,6 +182,7 @@ static sfxcache_t *QDECL OV_DecodeSome(struct sfx_s *sfx, struct sfxcache_s *buf
 				{
 					dec->decodedbytecount = 0;
 					dec->decodedbytestart = start;
+					dec->resample.primed = false;
 				}
 	//			Con_Printf("trim > count\n");
 			}
@@ -226,7 +229,7 @@ static sfxcache_t *QDECL OV_DecodeSome(struct sfx_s *sfx, struct sfxcache_s *buf
 				double scale = dec->srcspeed / (double)outspeed;
 				int decodesize = dec->decodedbufferbytes-dec->decodedbytecount; //bytes available
 				decodesize /= 2*dec->srcchannels; //convert bytes to frames
-				decodesize = floor(decodesize * scale); //round down, so that the SND_ResampleStream won't overflow the target buffer.
+				decodesize = floor((decodesize-1) * scale); //round down, so that the SND_ResampleStreamChunk won't overflow the target buffer (it can write one extra frame).
 				decodesize *= 2*dec->srcchannels; //convert from frames back to bytes
 				if (decodesize > dec->tempbufferbytes)
 				{
@@ -244,12 +247,25 @@ static sfxcache_t *QDECL OV_DecodeSome(struct sfx_s *sfx, struct sfxcache_s *buf
 						Con_Printf("ogg decoding failed %i\n", bytesread);
 						return NULL;
 					}
+					//the resampler is still holding back the last few frames, waiting for input that won't come.
+					bytesread = SND_ResampleStreamFlush(&dec->resample, NULL, 2) * 2*dec->srcchannels;
+					if (bytesread)
+					{
+						if (dec->decodedbytecount+bytesread > dec->decodedbufferbytes)
+						{
+							dec->decodedbufferbytes = dec->decodedbytecount+bytesread;
+							dec->decodedbuffer = BZ_Realloc(dec->decodedbuffer, dec->decodedbufferbytes);
+						}
+						SND_ResampleStreamFlush(&dec->resample, dec->decodedbuffer+dec->decodedbytecount, 2);
+						dec->decodedbytecount += bytesread;
+						continue;
+					}
 					if (start >= dec->decodedbytestart+dec->decodedbytecount)
 						return NULL;	//let the mixer know that we hit the end
 					break;
 				}
 
-				SND_ResampleStream(dec->tempbuffer,
+				bytesread = SND_ResampleStreamChunk(&dec->resample, dec->tempbuffer,
 					dec->srcspeed,
 					2,
 					dec->srcchannels,
@@ -259,8 +275,6 @@ static sfxcache_t *QDECL OV_DecodeSome(struct sfx_s *sfx, struct sfxcache_s *buf
 					2,
 					dec->srcchannels,
 					snd_linearresample_stream.ival);
-				bytesread /= 2*dec->srcchannels;	//convert bytes to frames
-				bytesread = bytesread / scale;		//calculate the same ammount that SND_ResampleStream will have splurged (we should probably make the output count explicit).
 				bytesread *= 2*dec->srcchannels;	//convert frames to bytes
 			}
 
@@ -303,6 +317,7 @@ static void QDECL OV_CancelDecoder(sfx_t *s)
 		BZ_Free(dec->tempbuffer);
 		dec->tempbufferbytes = 0;
 	}
+	SND_ResampleFreeState(&dec->resample);
 
 	BZ_Free(dec->decodedbuffer);
 	dec->decodedbuffer = NULL;
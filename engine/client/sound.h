@@ -231,6 +231,7 @@ void S_BeginPrecaching (void);
 void S_EndPrecaching (void);
 
 void S_PaintChannels(soundcardinfo_t *sc, int endtime);
+void S_MixBench_f(void);
 void S_InitPaintChannels (soundcardinfo_t *sc);
 
 soundcardinfo_t *S_SetupDeviceSeat(char *driver, char *device, int seat);
@@ -263,6 +264,21 @@ qboolean S_IsPlayingSomewhere(sfx_t *s);
 channel_t *SND_PickChannel(soundcardinfo_t *sc, int entnum, int entchannel);
 
 void SND_ResampleStream (const void *in, int inrate, qaudiofmt_t inwidth, int inchannels, int insamps, void *out, int outrate, qaudiofmt_t outwidth, int outchannels, int resampstyle);
+//carries the sinc resampler from one chunk of a stream to the next. zero it to start, SND_ResampleStreamFlush at the end of the stream, SND_ResampleFreeState when done.
+typedef struct
+{
+	const void *filter;	//what the history is for
+	int channels;
+	qboolean primed;
+	int frem;			//where the next output lands between input samples
+	int count;			//history samples per channel
+	int skip;			//input samples that the outputs already stepped over
+	float *hist;		//[channels][taps]
+} resamplestate_t;
+int SND_ResampleStreamChunk(resamplestate_t *st, const void *in, int inrate, qaudiofmt_t informat, int inchannels, int insamps, void *out, int outrate, qaudiofmt_t outformat, int outchannels, int resampstyle);
+int SND_ResampleStreamFlush(resamplestate_t *st, void *out, qaudiofmt_t outformat);
+void SND_ResampleFreeState(resamplestate_t *st);
+void SND_ResampleBench_f(void);
 
 // restart entire sound subsystem (doesn't flush old sounds, so make sure that happens)
 void S_DoRestart (qboolean onlyifneeded);
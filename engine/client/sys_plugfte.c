@@ -548,6 +548,10 @@ vfsfile_t *VFSPIPE_Open(void)
 	newf->funcs.Tell = VFSPIPE_Tell;
 	newf->funcs.WriteBytes = VFSPIPE_WriteBytes;
 	newf->funcs.seekingisabadplan = true;
+	newf->funcs.ReadBytesAt = NULL;
+	newf->funcs.GetMapping = NULL;
+	newf->funcs.MapPrivate = NULL;
+	newf->funcs.UnmapPrivate = NULL;
 
 	return &newf->funcs;
 }
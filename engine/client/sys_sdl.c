@@ -886,6 +886,10 @@ static vfsfile_t *IOF_Setup(sdlfile_t *r, SDL_IOStream *f)
 		r->f.GetLen = IOF_GetLen;
 		r->f.Close = IOF_Close;
 		r->f.Flush = IOF_Flush;
+		r->f.ReadBytesAt = NULL;
+		r->f.GetMapping = NULL;
+		r->f.MapPrivate = NULL;
+		r->f.UnmapPrivate = NULL;
 		r->f.seekstyle = SS_SEEKABLE;
 		return &r->f;
 	}
@@ -1698,6 +1702,7 @@ static int FTESDLThread(void *args)
 		r = 0;	//aborted...
 	else
 		r = tinfo->threadfunc(tinfo->args);
+	Z_FlushThreadCache();
 #if SDL_VERSION_ATLEAST(3,0,0)
 	SDL_SetTLS(&tls_threadinfo, NULL, NULL);
 #else
@@ -1601,7 +1601,7 @@ static int QDECL BIH_Sort_X (const void *va, const void *vb)
 	float bm = b->maxs[0]+b->mins[0];
 	if (am == bm)
 		return 0;
-	return am > bm;
+	return (am > bm)?1:-1;
 }
 static int QDECL BIH_Sort_Y (const void *va, const void *vb)
 {
@@ -1610,7 +1610,7 @@ static int QDECL BIH_Sort_Y (const void *va, const void *vb)
 	float bm = b->maxs[1]+b->mins[1];
 	if (am == bm)
 		return 0;
-	return am > bm;
+	return (am > bm)?1:-1;
 }
 static int QDECL BIH_Sort_Z (const void *va, const void *vb)
 {
@@ -1619,191 +1619,259 @@ static int QDECL BIH_Sort_Z (const void *va, const void *vb)
 	float bm = b->maxs[2]+b->mins[2];
 	if (am == bm)
 		return 0;
-	return am > bm;
+	return (am > bm)?1:-1;
 }
-#endif
-static struct bihbox_s BIH_BuildNode (struct bihnode_s *node, struct bihnode_s **freenodes, struct bihleaf_s *leafs, size_t numleafs)
+
+#define BIH_SAHBINS		16	//number of candidate split positions per axis (+1)
+#define BIH_SAHMAXDEPTH	64	//sah can split off one leaf at a time in pathological cases, fall back to the median split past this to keep our stack depth sane.
+#define BIH_MINJOB		256	//subtrees smaller than this are not worth handing to another thread.
+
+struct bihbin_s
 {
+	size_t count;
 	struct bihbox_s bounds;
-	if (numleafs == 1)	//the leaf just gives the brush pointer.
+};
+
+static void BIH_AddToBox(struct bihbox_s *box, const vec3_t mins, const vec3_t maxs)
+{
+	int j;
+	for (j = 0; j < 3; j++)
 	{
-		size_t i;
-		VectorCopy(leafs[0].mins, bounds.min);
-		VectorCopy(leafs[0].maxs, bounds.max);
-		node->type = leafs[0].type;
-		node->data = leafs[0].data;
+		if (box->min[j] > mins[j])
+			box->min[j] = mins[j];
+		if (box->max[j] < maxs[j])
+			box->max[j] = maxs[j];
+	}
+}
+static float BIH_BoxArea(const struct bihbox_s *box)
+{	//half the surface area, which is all we need for comparisons.
+	vec3_t d;
+	VectorSubtract(box->max, box->min, d);
+	return d[0]*d[1] + d[1]*d[2] + d[2]*d[0];
+}
+static int BIH_SAHBin(const struct bihleaf_s *leaf, int axis, float min, float scale)
+{	//uses the same doubled centroid as the sort functions.
+	int b = (leaf->mins[axis]+leaf->maxs[axis] - min)*scale;
+	return bound(0, b, BIH_SAHBINS-1);
+}
 
-		//expand by 1qu, to avoid precision issues.
-		for (i = 0; i < 3; i++)
+//picks a split using a binned surface area heuristic, and partitions the leafs (in place) around it.
+//returns the number of leafs on the left, or 0 if there's no way to split them (eg: all centred on the same point).
+static size_t BIH_SplitSAH(struct bihleaf_s *leafs, size_t numleafs, int *outaxis, struct bihbox_s *left, struct bihbox_s *right)
+{
+	struct bihbin_s bins[3][BIH_SAHBINS];
+	struct bihbox_s centres, box;
+	vec3_t c, scale;
+	size_t rightcount[BIH_SAHBINS];
+	float rightarea[BIH_SAHBINS];
+	float cost, bestcost = FLT_MAX;
+	int bestaxis = -1, bestbin = 0;
+	size_t i, end, count;
+	int j, b;
+
+	ClearBounds(centres.min, centres.max);
+	for (i = 0; i < numleafs; i++)
+	{
+		VectorAdd(leafs[i].mins, leafs[i].maxs, c);
+		BIH_AddToBox(&centres, c, c);
+	}
+	for (j = 0; j < 3; j++)
+	{
+		if (centres.max[j] > centres.min[j])
+			scale[j] = BIH_SAHBINS / (centres.max[j]-centres.min[j]);
+		else
+			scale[j] = 0;	//everything is in the same place on this axis.
+		for (b = 0; b < BIH_SAHBINS; b++)
 		{
-			bounds.min[i] -= 1;
-			bounds.max[i] += 1;
+			bins[j][b].count = 0;
+			ClearBounds(bins[j][b].bounds.min, bins[j][b].bounds.max);
 		}
 	}
-#ifdef BIH_USEBIH
-	else if (numleafs >= 8)	//the leaf just gives the brush pointer.
+	for (i = 0; i < numleafs; i++)
 	{
-		size_t i, j;
-		size_t numleft = numleafs / 2;	//this ends up splitting at the median point.
-		size_t numright = numleafs - numleft;
-		struct bihbox_s left, right;
-		struct bihnode_s *cnodes;
-		static int (QDECL *sorts[3]) (const void *va, const void *vb) = {BIH_Sort_X, BIH_Sort_Y, BIH_Sort_Z};
-		VectorCopy(leafs[0].mins, bounds.min);
-		VectorCopy(leafs[0].maxs, bounds.max);
-		for (i = 1; i < numleafs; i++)
+		for (j = 0; j < 3; j++)
+		{
+			b = BIH_SAHBin(&leafs[i], j, centres.min[j], scale[j]);
+			bins[j][b].count++;
+			BIH_AddToBox(&bins[j][b].bounds, leafs[i].mins, leafs[i].maxs);
+		}
+	}
+
+	for (j = 0; j < 3; j++)
+	{
+		if (!scale[j])
+			continue;
+		//sweep from the right to find the cost of everything after each split
+		ClearBounds(box.min, box.max);
+		for (count = 0, b = BIH_SAHBINS-1; b > 0; b--)
 		{
-			for(j = 0; j < 3; j++)
+			if (bins[j][b].count)
 			{
-				if (bounds.min[j] > leafs[i].mins[j])
-					bounds.min[j] = leafs[i].mins[j];
-				if (bounds.max[j] < leafs[i].maxs[j])
-					bounds.max[j] = leafs[i].maxs[j];
+				count += bins[j][b].count;
+				BIH_AddToBox(&box, bins[j][b].bounds.min, bins[j][b].bounds.max);
 			}
+			rightcount[b] = count;
+			rightarea[b] = count?BIH_BoxArea(&box):0;
 		}
-#if 1
-		{	//balanced by counts
-			vec3_t mid;
-			int onleft[3], onright[3], weight[3];
-			VectorAvg(bounds.max, bounds.min, mid);
-			VectorClear(onleft);
-			VectorClear(onright);
-			for (i = 0; i < numleafs; i++)
+		//and then from the left, which gives us the total for each split
+		ClearBounds(box.min, box.max);
+		for (count = 0, b = 1; b < BIH_SAHBINS; b++)
+		{
+			if (bins[j][b-1].count)
 			{
-				for (j = 0; j < 3; j++)
-				{	//ignore leafs that split the node.
-					if (leafs[i].maxs[j] < mid[j])
-						onleft[j]++;
-					if (mid[j] > leafs[i].mins[j])
-						onright[j]++;
-				}
+				count += bins[j][b-1].count;
+				BIH_AddToBox(&box, bins[j][b-1].bounds.min, bins[j][b-1].bounds.max);
+			}
+			if (!count || !rightcount[b])
+				continue;
+			cost = count*BIH_BoxArea(&box) + rightcount[b]*rightarea[b];
+			if (cost < bestcost)
+			{
+				bestcost = cost;
+				bestaxis = j;
+				bestbin = b;
 			}
-			for (j = 0; j < 3; j++)
-				weight[j] = onleft[j]+onright[j] - abs(onleft[j]-onright[j]);
-			//pick the most balanced.
-			if (weight[0] > weight[1] && weight[0] > weight[2])
-				node->type = BIH_X;
-			else if (weight[1] > weight[2])
-				node->type = BIH_Y;
-			else
-				node->type = BIH_Z;
 		}
-#else
-		{	//balanced by volume
-			vec3_t size;
-			VectorSubtract(bounds.max, bounds.min, size);
-			if (size[0] > size[1] && size[0] > size[2])
-				node->type = BIH_X;
-			else if (size[1] > size[2])
-				node->type = BIH_Y;
-			else
-				node->type = BIH_Z;*/
+	}
+	if (bestaxis < 0)
+		return 0;
+
+	//partition them, figuring out the bounds of each side as we go.
+	ClearBounds(left->min, left->max);
+	ClearBounds(right->min, right->max);
+	for (i = 0, end = numleafs; i < end; )
+	{
+		if (BIH_SAHBin(&leafs[i], bestaxis, centres.min[bestaxis], scale[bestaxis]) < bestbin)
+		{
+			BIH_AddToBox(left, leafs[i].mins, leafs[i].maxs);
+			i++;
+		}
+		else
+		{
+			struct bihleaf_s t = leafs[i];
+			leafs[i] = leafs[--end];
+			leafs[end] = t;
+			BIH_AddToBox(right, t.mins, t.maxs);
+		}
+	}
+	*outaxis = bestaxis;
+	return i;
+}
+
+//splits at the median point of the most balanced axis. never fails, but gives worse trees.
+static size_t BIH_SplitMedian(struct bihleaf_s *leafs, size_t numleafs, const struct bihbox_s *bounds, int *outaxis, struct bihbox_s *left, struct bihbox_s *right)
+{
+	static int (QDECL *sorts[3]) (const void *va, const void *vb) = {BIH_Sort_X, BIH_Sort_Y, BIH_Sort_Z};
+	size_t numleft = numleafs / 2;
+	size_t i, j;
+	int axis;
+	{	//balanced by counts
+		vec3_t mid;
+		int onleft[3], onright[3], weight[3];
+		VectorAvg(bounds->max, bounds->min, mid);
+		VectorClear(onleft);
+		VectorClear(onright);
+		for (i = 0; i < numleafs; i++)
+		{
+			for (j = 0; j < 3; j++)
+			{	//ignore leafs that split the node.
+				if (leafs[i].maxs[j] < mid[j])
+					onleft[j]++;
+				if (mid[j] > leafs[i].mins[j])
+					onright[j]++;
+			}
 		}
+		for (j = 0; j < 3; j++)
+			weight[j] = onleft[j]+onright[j] - abs(onleft[j]-onright[j]);
+		//pick the most balanced.
+		if (weight[0] > weight[1] && weight[0] > weight[2])
+			axis = 0;
+		else if (weight[1] > weight[2])
+			axis = 1;
+		else
+			axis = 2;
+	}
+	qsort(leafs, numleafs, sizeof(*leafs), sorts[axis]);
+
+	ClearBounds(left->min, left->max);
+	for (i = 0; i < numleft; i++)
+		BIH_AddToBox(left, leafs[i].mins, leafs[i].maxs);
+	ClearBounds(right->min, right->max);
+	for (; i < numleafs; i++)
+		BIH_AddToBox(right, leafs[i].mins, leafs[i].maxs);
+	*outaxis = axis;
+	return numleft;
+}
 #endif
-		qsort(leafs, numleafs, sizeof(*leafs), sorts[node->type-BIH_X]);
 
-		cnodes = *freenodes;
-		*freenodes += 2;
-		node->bihnode.firstchild = cnodes - node;
-		left = BIH_BuildNode (cnodes+0, freenodes, leafs, numleft);
-		right = BIH_BuildNode (cnodes+1, freenodes, &leafs[numleft], numright);
+//subtrees that are deferred to worker threads. each gets a reserved range of nodes to write into.
+struct bihbuildjob_s
+{
+	struct bihnode_s *node;
+	struct bihnode_s *freenodes;
+	struct bihleaf_s *leafs;
+	size_t numleafs;
+	struct bihbox_s bounds;
+	int depth;
+};
+struct bihbuild_s
+{
+	size_t jobsize;	//subtrees with this many leafs or fewer are queued instead of built immediately.
+	struct bihbuildjob_s *jobs;
+	size_t numjobs;
+	size_t maxjobs;
+};
 
-		node->bihnode.cmin[0] = left.min[node->type-BIH_X];
-		node->bihnode.cmax[0] = left.max[node->type-BIH_X];
-		node->bihnode.cmin[1] = right.min[node->type-BIH_X];
-		node->bihnode.cmax[1] = right.max[node->type-BIH_X];
+static void BIH_BuildSubtree (struct bihbuild_s *build, struct bihnode_s *node, struct bihnode_s **freenodes, struct bihleaf_s *leafs, size_t numleafs, const struct bihbox_s *bounds, int depth);
 
-		bounds = left;
-		AddPointToBounds(right.min, bounds.min, bounds.max);
-		AddPointToBounds(right.max, bounds.min, bounds.max);
+//bounds is the union of the leafs' bounds. leafs may be reordered.
+static void BIH_BuildNode (struct bihbuild_s *build, struct bihnode_s *node, struct bihnode_s **freenodes, struct bihleaf_s *leafs, size_t numleafs, const struct bihbox_s *bounds, int depth)
+{
+	if (numleafs == 1)	//the leaf just gives the brush pointer.
+	{
+		node->type = leafs[0].type;
+		node->data = leafs[0].data;
 	}
-#endif
-#ifdef BIH_USEBVH
-	else if (numleafs >= 8)	//the leaf just gives the brush pointer.
+#if defined(BIH_USEBIH) || defined(BIH_USEBVH)
+	else if (numleafs >= 8)
 	{
-		size_t i, j;
-		size_t numleft = numleafs / 2;	//this ends up splitting at the median point.
-		size_t numright = numleafs - numleft;
+		size_t numleft = 0;
 		struct bihbox_s left, right;
 		struct bihnode_s *cnodes;
-		static int (QDECL *sorts[3]) (const void *va, const void *vb) = {CM_SortBIH_X, CM_SortBIH_Y, CM_SortBIH_Z};
-		VectorCopy(leafs[0].mins, bounds.min);
-		VectorCopy(leafs[0].maxs, bounds.max);
-		for (i = 1; i < numleafs; i++)
-		{
-			for(j = 0; j < 3; j++)
-			{
-				if (bounds.min[j] > leafs[i].mins[j])
-					bounds.min[j] = leafs[i].mins[j];
-				if (bounds.max[j] < leafs[i].maxs[j])
-					bounds.max[j] = leafs[i].maxs[j];
-			}
-		}
-#if 1
-		{	//balanced by counts
-			vec3_t mid;
-			int onleft[3], onright[3], weight[3];
-			VectorAvg(bounds.max, bounds.min, mid);
-			VectorClear(onleft);
-			VectorClear(onright);
-			for (i = 0; i < numleafs; i++)
-			{
-				for (j = 0; j < 3; j++)
-				{	//ignore leafs that split the node.
-					if (leafs[i].maxs[j] < mid[j])
-						onleft[j]++;
-					if (mid[j] > leafs[i].mins[j])
-						onright[j]++;
-				}
-			}
-			for (j = 0; j < 3; j++)
-				weight[j] = onleft[j]+onright[j] - abs(onleft[j]-onright[j]);
-			//pick the most balanced.
-			if (weight[0] > weight[1] && weight[0] > weight[2])
-				node->type = BVH_X;
-			else if (weight[1] > weight[2])
-				node->type = BVH_Y;
-			else
-				node->type = BVH_Z;
-		}
-#else
-		{	//balanced by volume
-			vec3_t size;
-			VectorSubtract(bounds.max, bounds.min, size);
-			if (size[0] > size[1] && size[0] > size[2])
-				node->type = BVH_X;
-			else if (size[1] > size[2])
-				node->type = BVH_Y;
-			else
-				node->type = BVH_Z;*/
-		}
-#endif
-		qsort(leafs, numleafs, sizeof(*leafs), sorts[node->type-BVH_X]);
+		int axis;
+
+		if (depth < BIH_SAHMAXDEPTH)
+			numleft = BIH_SplitSAH(leafs, numleafs, &axis, &left, &right);
+		if (!numleft)
+			numleft = BIH_SplitMedian(leafs, numleafs, bounds, &axis, &left, &right);
 
 		cnodes = *freenodes;
 		*freenodes += 2;
+
+		//child bounds are expanded by 1qu, to avoid precision issues.
+#ifdef BIH_USEBIH
+		node->type = BIH_X+axis;
+		node->bihnode.firstchild = cnodes - node;
+		node->bihnode.cmin[0] = left.min[axis]-1;
+		node->bihnode.cmax[0] = left.max[axis]+1;
+		node->bihnode.cmin[1] = right.min[axis]-1;
+		node->bihnode.cmax[1] = right.max[axis]+1;
+#else
+		node->type = BVH_X+axis;
 		node->bvhnode.firstchild = cnodes - node;
-		left = BIH_BuildNode (cnodes+0, freenodes, leafs, numleft);
-		right = BIH_BuildNode (cnodes+1, freenodes, &leafs[numleft], numright);
-
-		node->bvhnode.min[0] = min(left.min[0], right.min[0]);
-		node->bvhnode.min[1] = min(left.min[1], right.min[1]);
-		node->bvhnode.min[2] = min(left.min[2], right.min[2]);
-		node->bvhnode.cmax = left.max[node->type-BVH_X];
-		node->bvhnode.cmin = right.min[node->type-BVH_X];
-		node->bvhnode.max[0] = max(left.max[0], right.max[0]);
-		node->bvhnode.max[1] = max(left.max[1], right.max[1]);
-		node->bvhnode.max[2] = max(left.max[2], right.max[2]);
-
-		bounds = left;
-		AddPointToBounds(right.min, bounds.min, bounds.max);
-		AddPointToBounds(right.max, bounds.min, bounds.max);
+		VectorSet(node->bvhnode.min, bounds->min[0]-1, bounds->min[1]-1, bounds->min[2]-1);
+		VectorSet(node->bvhnode.max, bounds->max[0]+1, bounds->max[1]+1, bounds->max[2]+1);
+		node->bvhnode.cmax = left.max[axis]+1;
+		node->bvhnode.cmin = right.min[axis]-1;
+#endif
+
+		BIH_BuildSubtree(build, cnodes+0, freenodes, leafs, numleft, &left, depth+1);
+		BIH_BuildSubtree(build, cnodes+1, freenodes, &leafs[numleft], numleafs-numleft, &right, depth+1);
 	}
 #endif
 	else
 	{
 		struct bihnode_s *cnodes;
-		struct bihbox_s cb;
 		size_t i;
 		node->type = BIH_GROUP;
 
@@ -1812,21 +1880,127 @@ static struct bihbox_s BIH_BuildNode (struct bihnode_s *node, struct bihnode_s *
 		node->group.firstchild = cnodes - node;
 		node->group.numchildren = numleafs;
 
-		bounds = BIH_BuildNode(cnodes+0, freenodes, leafs+0, 1);
-		for (i = 1; i < numleafs; i++)
+		for (i = 0; i < numleafs; i++)
 		{
-			cb = BIH_BuildNode(cnodes+i, freenodes, leafs+i, 1);
-			AddPointToBounds(cb.min, bounds.min, bounds.max);
-			AddPointToBounds(cb.max, bounds.min, bounds.max);
+			cnodes[i].type = leafs[i].type;
+			cnodes[i].data = leafs[i].data;
 		}
 	}
-	return bounds;
+}
+
+static void BIH_BuildSubtree (struct bihbuild_s *build, struct bihnode_s *node, struct bihnode_s **freenodes, struct bihleaf_s *leafs, size_t numleafs, const struct bihbox_s *bounds, int depth)
+{
+	if (build && numleafs <= build->jobsize && numleafs >= BIH_MINJOB)
+	{	//queue it for later, reserving enough nodes for the worst case (a subtree never needs more than 2n-2 below its root).
+		struct bihbuildjob_s *job;
+		if (build->numjobs == build->maxjobs)
+		{
+			build->maxjobs += 64;
+			build->jobs = BZ_Realloc(build->jobs, sizeof(*build->jobs)*build->maxjobs);
+		}
+		job = &build->jobs[build->numjobs++];
+		job->node = node;
+		job->freenodes = *freenodes;
+		job->leafs = leafs;
+		job->numleafs = numleafs;
+		job->bounds = *bounds;
+		job->depth = depth;
+		*freenodes += numleafs*2-2;
+		return;
+	}
+	BIH_BuildNode(build, node, freenodes, leafs, numleafs, bounds, depth);
+}
+
+//builds a range of the queued subtrees. each one has its own reserved nodes, so they don't need to lock anything.
+static void BIH_BuildJobs(void *ctx, size_t first, size_t last)
+{
+	struct bihbuild_s *build = ctx;
+	struct bihbuildjob_s *job;
+	for (; first < last; first++)
+	{
+		job = &build->jobs[first];
+		BIH_BuildNode(NULL, job->node, &job->freenodes, job->leafs, job->numleafs, &job->bounds, job->depth);
+	}
+}
+
+static size_t BIH_CountNodes(const struct bihnode_s *node)
+{
+	size_t count = 1, i;
+	switch(node->type)
+	{
+#ifdef BIH_USEBIH
+	case BIH_X:
+	case BIH_Y:
+	case BIH_Z:
+		for (i = 0; i < 2; i++)
+			count += BIH_CountNodes(node+node->bihnode.firstchild+i);
+		break;
+#endif
+#ifdef BIH_USEBVH
+	case BVH_X:
+	case BVH_Y:
+	case BVH_Z:
+		for (i = 0; i < 2; i++)
+			count += BIH_CountNodes(node+node->bvhnode.firstchild+i);
+		break;
+#endif
+	case BIH_GROUP:
+		count += node->group.numchildren;	//always leafs.
+		break;
+	default:
+		break;
+	}
+	return count;
+}
+//copies a tree depth-first, each node's children directly follow it, with the first child's subtree after them.
+//this removes any gaps left over from the worst-case reservations too.
+static void BIH_FlattenNode(struct bihnode_s *out, struct bihnode_s **freenodes, const struct bihnode_s *in)
+{
+	struct bihnode_s *cnodes;
+	int i;
+	*out = *in;
+	switch(in->type)
+	{
+#ifdef BIH_USEBIH
+	case BIH_X:
+	case BIH_Y:
+	case BIH_Z:
+		cnodes = *freenodes;
+		*freenodes += 2;
+		out->bihnode.firstchild = cnodes - out;
+		for (i = 0; i < 2; i++)
+			BIH_FlattenNode(cnodes+i, freenodes, in+in->bihnode.firstchild+i);
+		break;
+#endif
+#ifdef BIH_USEBVH
+	case BVH_X:
+	case BVH_Y:
+	case BVH_Z:
+		cnodes = *freenodes;
+		*freenodes += 2;
+		out->bvhnode.firstchild = cnodes - out;
+		for (i = 0; i < 2; i++)
+			BIH_FlattenNode(cnodes+i, freenodes, in+in->bvhnode.firstchild+i);
+		break;
+#endif
+	case BIH_GROUP:
+		cnodes = *freenodes;
+		*freenodes += in->group.numchildren;
+		out->group.firstchild = cnodes - out;
+		for (i = 0; i < in->group.numchildren; i++)
+			cnodes[i] = in[in->group.firstchild+i];
+		break;
+	default:
+		break;
+	}
 }
 
 void BIH_Build (model_t *mod, struct bihleaf_s *leafs, size_t numleafs)
 {
-	size_t numnodes;
-	struct bihnode_s *nodes, *tmpnodes;
+	size_t numnodes, i;
+	struct bihnode_s *nodes, *tmpnodes, *freenodes;
+	struct bihbuild_s buildjobs, *build = NULL;
+	struct bihbox_s bounds;
 
 	if (!numleafs)
 	{	//if we don't actually have anything solid, we still need SOMETHING so we don't crash.
@@ -1837,13 +2011,37 @@ void BIH_Build (model_t *mod, struct bihleaf_s *leafs, size_t numleafs)
 	}
 	else
 	{
-		numnodes = numleafs*2-1;
-		nodes = ZG_Malloc(&mod->memgroup, sizeof(*nodes)*numnodes);
+		ClearBounds(bounds.min, bounds.max);
+		for (i = 0; i < numleafs; i++)
+			BIH_AddToBox(&bounds, leafs[i].mins, leafs[i].maxs);
 
-		tmpnodes = nodes+1;
-		BIH_BuildNode(nodes, &tmpnodes, leafs, numleafs);
-		if (tmpnodes > nodes+numnodes)
+		//build into a scratch buffer big enough for the worst case, with subtrees possibly being built on other threads.
+		numnodes = numleafs*2-1;
+		tmpnodes = BZ_Malloc(sizeof(*tmpnodes)*numnodes);
+		freenodes = tmpnodes+1;
+		{
+			unsigned int workers = COM_HasWorkers(WG_COMPUTE);
+			if (workers && numleafs >= BIH_MINJOB*4)
+			{
+				build = &buildjobs;
+				memset(build, 0, sizeof(*build));
+				build->jobsize = max(BIH_MINJOB, numleafs/((workers+1)*4));
+			}
+		}
+		BIH_BuildNode(build, tmpnodes, &freenodes, leafs, numleafs, &bounds, 0);
+		if (build)
+		{	//the top of the tree is done, now farm out the subtrees. this blocks until they're all built.
+			COM_ParallelFor(build->numjobs, 1, BIH_BuildJobs, build);
+			BZ_Free(build->jobs);
+		}
+		if (freenodes > tmpnodes+numnodes)
 			Sys_Error("CM_BuildBIH: generated wrong number of nodes");
+
+		numnodes = BIH_CountNodes(tmpnodes);
+		nodes = ZG_Malloc(&mod->memgroup, sizeof(*nodes)*numnodes);
+		freenodes = nodes+1;
+		BIH_FlattenNode(nodes, &freenodes, tmpnodes);
+		BZ_Free(tmpnodes);
 	}
 	mod->cnodes = nodes;
 	mod->funcs.NativeTrace			= BIH_Trace;
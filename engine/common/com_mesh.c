@@ -2585,6 +2585,351 @@ static qboolean Mod_Trace_Trisoup(vecV_t *posedata, index_t *indexes, int numind
 	return impacted;
 }
 
+#ifdef SKELETALMODELS
+//each skeletal surface's triangles get sorted by their dominant bone, and then into small runs along that bone.
+//each pose then gets bounds for every run and for every bone's subtree, so a trace only needs to test the triangles whose bounds it actually passes through.
+//posed results are kept for a handful of poses, keyed by the bones themselves, so that repeated traces against the same entity (within a frame, or if its idle) don't need to reskin.
+#define TRACEBONES_POSES 16
+#define TRACEBONES_CHUNK 32		//triangles per run
+static qboolean mod_tracebones = true;	//so mod_tracebench can compare against the brute-force version.
+typedef struct
+{
+	unsigned int hash;
+	unsigned int lastused;
+	unsigned int users;		//traces currently using it, so it can't be evicted.
+	qboolean ready;			//posed and bounded. only looked up once this is set.
+	float *bonepose;		//[numbones*12] to confirm hash matches
+	vecV_t *xyz;			//[numverts]
+	vec3_t (*bounds)[2];	//[numbones] covering the bone's triangles and those of its children
+	vec3_t (*chunkbounds)[2];	//[numchunks]
+} tracepose_t;
+typedef struct galiastracebones_s
+{
+	int numbones;
+	int numverts;			//only the verts that this surface's triangles actually use.
+	int numchunks;
+	vecV_t *xyz;
+	bone_vec4_t *idx;
+	vec4_t *weight;
+	index_t *indexes;		//grouped by bone
+	int *tri;				//original triangle number, for trace_triangle
+	int *bonechunks;		//[numbones+1] first chunk of each bone
+	int *chunktris;			//[numchunks+1] first triangle of each chunk
+	int *parent;			//-1 for roots. parents always come first.
+	void *lock;				//guards the pose slots. only held while finding or claiming one, not while posing or tracing.
+	unsigned int sequence;
+	tracepose_t pose[TRACEBONES_POSES];
+} galiastracebones_t;
+
+typedef struct
+{
+	int bone;
+	float key;	//distance along the bone's longest axis
+	int tri;
+} tracebonesort_t;
+static int QDECL Mod_Trace_SortBones(const void *va, const void *vb)
+{
+	const tracebonesort_t *a = va, *b = vb;
+	if (a->bone != b->bone)
+		return a->bone - b->bone;
+	if (a->key != b->key)
+		return (a->key < b->key)?-1:1;
+	return a->tri - b->tri;
+}
+
+static galiastracebones_t *Mod_Trace_GenerateBones(model_t *model, galiasinfo_t *surf)
+{
+	galiastracebones_t *tb;
+	int numtris = surf->numindexes/3, t, e, c, v, w, b, axis;
+	int *remap = BZ_Malloc(sizeof(*remap)*surf->numverts);
+	tracebonesort_t *sort = BZ_Malloc(sizeof(*sort)*numtris);
+	vec3_t (*extent)[2] = BZ_Malloc(sizeof(*extent)*surf->numbones);
+	vec3_t mid;
+	unsigned int bone[12];
+	float weight[12], bw;
+	int nb;
+
+	tb = ZG_Malloc(&model->memgroup, sizeof(*tb));
+	tb->numbones = surf->numbones;
+	for (b = 0; b < tb->numbones; b++)
+		ClearBounds(extent[b][0], extent[b][1]);
+
+	//compact the verts and find each triangle's most influential bone
+	for (v = 0; v < surf->numverts; v++)
+		remap[v] = -1;
+	for (t = 0; t < numtris; t++)
+	{
+		nb = 0;
+		VectorClear(mid);
+		for (c = 0; c < 3; c++)
+		{
+			v = surf->ofs_indexes[t*3+c];
+			if (remap[v] < 0)
+				remap[v] = tb->numverts++;
+			VectorMA(mid, 1/3.0, surf->ofs_skel_xyz[v], mid);
+			for (w = 0; w < 4; w++)
+			{
+				bw = (!w && !surf->ofs_skel_weight[v][1])?1:surf->ofs_skel_weight[v][w];	//the transform assumes the first weight is 1 when its alone.
+				if (!bw)
+					break;
+				for (b = 0; b < nb; b++)
+					if (bone[b] == surf->ofs_skel_idx[v][w])
+						break;
+				if (b == nb)
+				{
+					bone[nb] = surf->ofs_skel_idx[v][w];
+					weight[nb++] = 0;
+				}
+				weight[b] += bw;
+			}
+		}
+		for (sort[t].bone = bone[0], b = 1; b < nb; b++)
+			if (weight[b] > weight[0])
+			{
+				weight[0] = weight[b];
+				sort[t].bone = bone[b];
+			}
+		if (sort[t].bone >= tb->numbones)
+			sort[t].bone = 0;
+		sort[t].tri = t;
+		AddPointToBounds(mid, extent[sort[t].bone][0], extent[sort[t].bone][1]);
+	}
+
+	tb->xyz = ZG_Malloc(&model->memgroup, sizeof(*tb->xyz)*tb->numverts);
+	tb->idx = ZG_Malloc(&model->memgroup, sizeof(*tb->idx)*tb->numverts);
+	tb->weight = ZG_Malloc(&model->memgroup, sizeof(*tb->weight)*tb->numverts);
+	for (v = 0; v < surf->numverts; v++)
+	{
+		if (remap[v] < 0)
+			continue;
+		memcpy(tb->xyz[remap[v]], surf->ofs_skel_xyz[v], sizeof(*tb->xyz));
+		memcpy(tb->idx[remap[v]], surf->ofs_skel_idx[v], sizeof(*tb->idx));
+		memcpy(tb->weight[remap[v]], surf->ofs_skel_weight[v], sizeof(*tb->weight));
+	}
+	//sort each bone's triangles along its longest axis, so that runs of them are spatially coherent.
+	for (t = 0; t < numtris; t++)
+	{
+		b = sort[t].bone;
+		VectorSubtract(extent[b][1], extent[b][0], mid);
+		axis = (mid[0] > mid[1])?((mid[0] > mid[2])?0:2):((mid[1] > mid[2])?1:2);
+		for (sort[t].key = 0, c = 0; c < 3; c++)
+			sort[t].key += surf->ofs_skel_xyz[surf->ofs_indexes[t*3+c]][axis];
+	}
+	qsort(sort, numtris, sizeof(*sort), Mod_Trace_SortBones);
+
+	tb->indexes = ZG_Malloc(&model->memgroup, sizeof(*tb->indexes)*numtris*3);
+	tb->tri = ZG_Malloc(&model->memgroup, sizeof(*tb->tri)*numtris);
+	tb->bonechunks = ZG_Malloc(&model->memgroup, sizeof(*tb->bonechunks)*(tb->numbones+1));
+	for (t = 0; t < numtris; t++)
+	{
+		tb->tri[t] = sort[t].tri;
+		for (c = 0; c < 3; c++)
+			tb->indexes[t*3+c] = remap[surf->ofs_indexes[sort[t].tri*3+c]];
+	}
+	//chunks never straddle bones. the last chunk of each bone may be short.
+	tb->chunktris = ZG_Malloc(&model->memgroup, sizeof(*tb->chunktris)*(numtris/TRACEBONES_CHUNK + tb->numbones + 1));
+	for (b = 0, t = 0; b < tb->numbones; b++)
+	{
+		tb->bonechunks[b] = tb->numchunks;
+		for (e = t; e < numtris && sort[e].bone == b; e++)
+			;
+		for (; t < e; t += TRACEBONES_CHUNK)
+			tb->chunktris[tb->numchunks++] = t;
+		t = e;
+	}
+	tb->bonechunks[b] = tb->numchunks;
+	tb->chunktris[tb->numchunks] = numtris;
+
+	//the hierarchy only helps if parents come before their children, otherwise everything is a root.
+	tb->parent = ZG_Malloc(&model->memgroup, sizeof(*tb->parent)*tb->numbones);
+	for (b = 0; b < tb->numbones; b++)
+	{
+		tb->parent[b] = surf->ofsbones?surf->ofsbones[b].parent:-1;
+		if (tb->parent[b] >= b)
+			break;
+	}
+	if (b < tb->numbones)
+		for (b = 0; b < tb->numbones; b++)
+			tb->parent[b] = -1;
+
+	tb->lock = Sys_CreateMutex();
+
+	BZ_Free(remap);
+	BZ_Free(sort);
+	BZ_Free(extent);
+	return tb;
+}
+static galiastracebones_t *Mod_Trace_GetBones(model_t *model, galiasinfo_t *surf)
+{
+	galiastracebones_t *tb = surf->tracebones;
+	if (!tb)
+	{	//first trace against this mesh. this only happens once, so the global lock is fine here (it also protects the model's memgroup).
+#ifdef LOADERTHREAD
+		Sys_LockMutex(com_resourcemutex);
+#endif
+		tb = surf->tracebones;
+		if (!tb)
+			surf->tracebones = tb = Mod_Trace_GenerateBones(model, surf);
+#ifdef LOADERTHREAD
+		Sys_UnlockMutex(com_resourcemutex);
+#endif
+	}
+	return tb;
+}
+
+//finds (or claims and builds) a pose of the mesh. returns NULL if every slot is busy, in which case the caller should skin it itself.
+//release it with Mod_Trace_ReleasePose.
+static tracepose_t *Mod_Trace_AcquirePose(model_t *model, galiastracebones_t *tb, const float *bonepose)
+{
+	tracepose_t *p, *best = NULL;
+	unsigned int hash = 0;
+	const unsigned int *h = (const unsigned int*)bonepose;
+	int i, b, k, t, e;
+
+	for (i = 0; i < tb->numbones*12; i++)
+		hash = (hash ^ h[i]) * 16777619;
+
+	Sys_LockMutex(tb->lock);
+	for (i = 0, p = tb->pose; i < TRACEBONES_POSES; i++, p++)
+	{
+		if (p->ready && p->hash == hash && !memcmp(p->bonepose, bonepose, sizeof(float)*12*tb->numbones))
+		{
+			p->lastused = ++tb->sequence;
+			p->users++;
+			Sys_UnlockMutex(tb->lock);
+			return p;
+		}
+		if (p->users)
+			continue;	//someone's still tracing against it (or building it).
+		if (!best || !p->bonepose || (best->bonepose && p->lastused < best->lastused))
+			best = p;
+	}
+	p = best;
+	if (p)
+	{	//not seen recently, claim the oldest. nobody else will touch it until its ready.
+		p->ready = false;
+		p->users = 1;
+		p->hash = hash;
+		p->lastused = ++tb->sequence;
+	}
+	Sys_UnlockMutex(tb->lock);
+	if (!p)
+		return NULL;
+
+	if (!p->bonepose)
+	{
+#ifdef LOADERTHREAD
+		Sys_LockMutex(com_resourcemutex);	//for the memgroup
+#endif
+		p->bonepose = ZG_Malloc(&model->memgroup, sizeof(float)*12*tb->numbones);
+		p->xyz = ZG_Malloc(&model->memgroup, sizeof(*p->xyz)*tb->numverts);
+		p->bounds = ZG_Malloc(&model->memgroup, sizeof(*p->bounds)*tb->numbones);
+		p->chunkbounds = ZG_Malloc(&model->memgroup, sizeof(*p->chunkbounds)*tb->numchunks);
+#ifdef LOADERTHREAD
+		Sys_UnlockMutex(com_resourcemutex);
+#endif
+	}
+	memcpy(p->bonepose, bonepose, sizeof(float)*12*tb->numbones);
+	Alias_TransformVerticies_V(bonepose, tb->numverts, tb->idx[0], tb->weight[0], tb->xyz[0], p->xyz[0]);
+
+	for (b = 0; b < tb->numbones; b++)
+	{
+		ClearBounds(p->bounds[b][0], p->bounds[b][1]);
+		for (k = tb->bonechunks[b]; k < tb->bonechunks[b+1]; k++)
+		{
+			ClearBounds(p->chunkbounds[k][0], p->chunkbounds[k][1]);
+			for (t = tb->chunktris[k]*3, e = tb->chunktris[k+1]*3; t < e; t++)
+				AddPointToBounds(p->xyz[tb->indexes[t]], p->chunkbounds[k][0], p->chunkbounds[k][1]);
+			AddPointToBounds(p->chunkbounds[k][0], p->bounds[b][0], p->bounds[b][1]);
+			AddPointToBounds(p->chunkbounds[k][1], p->bounds[b][0], p->bounds[b][1]);
+		}
+	}
+	for (b = tb->numbones; b-- > 0; )
+	{	//children come after their parents, so walking backwards accumulates whole subtrees.
+		if (tb->parent[b] >= 0 && p->bounds[b][0][0] <= p->bounds[b][1][0])
+		{
+			AddPointToBounds(p->bounds[b][0], p->bounds[tb->parent[b]][0], p->bounds[tb->parent[b]][1]);
+			AddPointToBounds(p->bounds[b][1], p->bounds[tb->parent[b]][0], p->bounds[tb->parent[b]][1]);
+		}
+	}
+
+	Sys_LockMutex(tb->lock);
+	p->ready = true;
+	Sys_UnlockMutex(tb->lock);
+	return p;
+}
+static void Mod_Trace_ReleasePose(galiastracebones_t *tb, tracepose_t *p)
+{
+	Sys_LockMutex(tb->lock);
+	p->users--;
+	Sys_UnlockMutex(tb->lock);
+}
+
+//returns true if the swept box might touch anything within the bounds before the trace's current best.
+static qboolean Mod_Trace_CrossesBounds(const vec3_t bounds[2], const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, float maxfrac)
+{
+	float t0 = 0, t1 = maxfrac, lo, hi, d, a, b;
+	int j;
+	if (bounds[0][0] > bounds[1][0])
+		return false;	//nothing in there
+	for (j = 0; j < 3; j++)
+	{
+		//Mod_Trace_Trisoup allows DIST_EPSILON of slop, be a little more generous than that to avoid precision issues.
+		lo = bounds[0][j] - maxs[j] - 1;
+		hi = bounds[1][j] - mins[j] + 1;
+		d = end[j] - start[j];
+		if (!d)
+		{
+			if (start[j] < lo || start[j] > hi)
+				return false;
+			continue;
+		}
+		a = (lo - start[j]) / d;
+		b = (hi - start[j]) / d;
+		if (a > b)
+		{
+			d = a;
+			a = b;
+			b = d;
+		}
+		if (a > t0)
+			t0 = a;
+		if (b < t1)
+			t1 = b;
+		if (t0 > t1)
+			return false;
+	}
+	return true;
+}
+
+static qboolean Mod_Trace_Bones(const galiastracebones_t *tb, const tracepose_t *pose, const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, trace_t *fte_restrict trace)
+{
+	qbyte hit[MAX_BONES];
+	qboolean impacted = false;
+	int b, k, first;
+	for (b = 0; b < tb->numbones; b++)
+	{
+		if (tb->parent[b] >= 0 && !hit[tb->parent[b]])
+			hit[b] = false;	//missed the whole subtree
+		else
+			hit[b] = Mod_Trace_CrossesBounds((const void*)pose->bounds[b], start, end, mins, maxs, trace->truefraction);
+		if (!hit[b])
+			continue;
+		for (k = tb->bonechunks[b]; k < tb->bonechunks[b+1]; k++)
+		{
+			if (!Mod_Trace_CrossesBounds((const void*)pose->chunkbounds[k], start, end, mins, maxs, trace->truefraction))
+				continue;
+			first = tb->chunktris[k];
+			if (Mod_Trace_Trisoup(pose->xyz, tb->indexes + first*3, (tb->chunktris[k+1]-first)*3, start, end, mins, maxs, trace))
+			{
+				trace->triangle_id = 1 + tb->tri[first + trace->triangle_id-1];
+				impacted = true;
+			}
+		}
+	}
+	return impacted;
+}
+#endif
 //The whole reason why model loading is supported in the server.
 static qboolean Mod_Trace(model_t *model, int forcehullnum, const framestate_t *framestate, const vec3_t axis[3], const vec3_t start, const vec3_t end, const vec3_t mins, const vec3_t maxs, qboolean capsule, unsigned int contentsmask, trace_t *trace)
 {
@@ -2600,7 +2945,10 @@ static qboolean Mod_Trace(model_t *model, int forcehullnum, const framestate_t *
 	float buffer[MAX_BONES*12];
 	float bufferalt[MAX_BONES*12];
 	const float *bonepose = NULL;
+	galiastracebones_t *tracebones;
+	tracepose_t *tracepose;
 #endif
+	qboolean impacted;
 
 	vec3_t start_l, end_l;
 
@@ -2628,20 +2976,31 @@ static qboolean Mod_Trace(model_t *model, int forcehullnum, const framestate_t *
 
 		indexes = mod->ofs_indexes;
 #ifdef SKELETALMODELS
+		tracebones = NULL;
+		tracepose = NULL;
 		if (mod->ofs_skel_xyz)
 		{
 			if (!mod->ofs_skel_idx || !framestate || !mod->numbones)
 				posedata = mod->ofs_skel_xyz;	//if there's no weights, don't try animating anything.
-			else if (mod->shares_verts != cursurfnum || !posedata)
+			else
 			{
-				cursurfnum = mod->shares_verts;
 				if (curbonesurf != mod->shares_bones)
 				{
 					curbonesurf = mod->shares_bones;
 					bonepose = Alias_GetBoneInformation(mod, framestate, SKEL_INVERSE_ABSOLUTE, buffer, bufferalt, MAX_BONES, NULL);
 				}
-				posedata = alloca(mod->numverts*sizeof(vecV_t));
-				Alias_TransformVerticies_V(bonepose, mod->numverts, mod->ofs_skel_idx[0], mod->ofs_skel_weight[0], mod->ofs_skel_xyz[0], posedata[0]);
+				if (mod_tracebones && mod->ofs_skel_weight)
+				{	//only skin+test the parts of the mesh near the trace, reusing the posed mesh if we saw this pose recently.
+					//the bones themselves still get evaluated every time - traces don't say which entity they're for, and skeletal objects can be changed in place, so there's nothing safe to cache those by.
+					tracebones = Mod_Trace_GetBones(model, mod);
+					tracepose = Mod_Trace_AcquirePose(model, tracebones, bonepose);
+				}
+				if (!tracepose && (mod->shares_verts != cursurfnum || !posedata))
+				{
+					cursurfnum = mod->shares_verts;
+					posedata = alloca(mod->numverts*sizeof(vecV_t));
+					Alias_TransformVerticies_V(bonepose, mod->numverts, mod->ofs_skel_idx[0], mod->ofs_skel_weight[0], mod->ofs_skel_xyz[0], posedata[0]);
+				}
 			}
 			//else posedata = posedata;
 		}
@@ -2670,7 +3029,16 @@ static qboolean Mod_Trace(model_t *model, int forcehullnum, const framestate_t *
 		}
 #endif
 
-		if (Mod_Trace_Trisoup(posedata, indexes, mod->numindexes, start_l, end_l, mins, maxs, trace))
+#ifdef SKELETALMODELS
+		if (tracepose)
+		{
+			impacted = Mod_Trace_Bones(tracebones, tracepose, start_l, end_l, mins, maxs, trace);
+			Mod_Trace_ReleasePose(tracebones, tracepose);
+		}
+		else
+#endif
+			impacted = Mod_Trace_Trisoup(posedata, indexes, mod->numindexes, start_l, end_l, mins, maxs, trace);
+		if (impacted)
 		{
 			trace->contents = mod->contents;
 			trace->surface = &mod->csurface;
@@ -2732,6 +3100,132 @@ static qboolean Mod_Trace(model_t *model, int forcehullnum, const framestate_t *
 	return trace->fraction != 1;
 }
 
+#ifdef SKELETALMODELS
+//fires random rays through a posed model, timing the per-bone traces against the brute-force ones and checking that they agree.
+struct tracebench_s
+{
+	model_t *model;
+	const framestate_t *fs;
+	const vec3_t *ray;
+	const trace_t *ref;
+	qatomic32_t mismatches;
+};
+//odd traces use poses of their own so that the workers keep evicting each other's poses, even ones get checked against the reference.
+static void Mod_TraceBench_Range(void *ctx, size_t first, size_t last)
+{
+	struct tracebench_s *b = ctx;
+	framestate_t fs = *b->fs;
+	vec3_t zero = {0,0,0};
+	trace_t tr;
+	for (; first < last; first++)
+	{
+		fs.g[FS_REG].frametime[0] = b->fs->g[FS_REG].frametime[0] + ((first&1)?0.0001*(first%37+1):0);
+		memset(&tr, 0, sizeof(tr));
+		b->model->funcs.NativeTrace(b->model, 0, &fs, NULL, b->ray[first*2+0], b->ray[first*2+1], zero, zero, false, ~0u, &tr);
+		if (!(first&1) && (fabs(tr.fraction - b->ref[first].fraction) > 0.0001 || (tr.fraction == 1) != (b->ref[first].fraction == 1)))
+			FTE_Atomic32_Inc(&b->mismatches);
+	}
+}
+void Mod_TraceBench_f(void)
+{
+	model_t *model = Mod_ForName(Cmd_Argv(1), MLV_WARNSYNC);
+	int count = (Cmd_Argc() > 2)?atoi(Cmd_Argv(2)):10000;
+	framestate_t fs;
+	vec3_t *ray, org, dir, zero = {0,0,0};
+	float radius;
+	trace_t tr, *ref;
+	double start, brute, cached, posed, threaded;
+	int i, j, hits = 0, mismatches = 0, ties = 0;
+	struct tracebench_s tb;
+
+	if (!model || model->loadstate != MLS_LOADED || model->type != mod_alias || !model->funcs.NativeTrace)
+	{
+		Con_Printf("%s <skeletalmodel> [traces] [frame] [time]\n", Cmd_Argv(0));
+		return;
+	}
+	count = bound(1, count, 1000000);
+
+	memset(&fs, 0, sizeof(fs));
+	fs.g[FS_REG].frame[0] = atoi(Cmd_Argv(3));
+	fs.g[FS_REG].frametime[0] = atof(Cmd_Argv(4));
+	fs.g[FS_REG].lerpweight[0] = 1;
+	fs.g[FS_REG].endbone = 0x7fffffff;
+
+	//rays from outside the model's bounds, aimed at random points inside it.
+	VectorAvg(model->mins, model->maxs, org);
+	VectorSubtract(model->maxs, model->mins, dir);
+	radius = VectorLength(dir);
+	ray = BZ_Malloc(sizeof(*ray)*2*count);
+	ref = BZ_Malloc(sizeof(*ref)*count);
+	for (i = 0; i < count; i++)
+	{
+		do
+		{
+			VectorSet(dir, crandom(), crandom(), crandom());
+		} while (VectorNormalize(dir) == 0);
+		for (j = 0; j < 3; j++)
+		{
+			ray[i*2+1][j] = model->mins[j] + frandom()*(model->maxs[j]-model->mins[j]);
+			ray[i*2+0][j] = org[j] + dir[j]*radius;
+			ray[i*2+1][j] += ray[i*2+1][j]-ray[i*2+0][j];	//continue out the other side
+		}
+	}
+
+	mod_tracebones = false;
+	start = Sys_DoubleTime();
+	for (i = 0; i < count; i++)
+	{
+		memset(&ref[i], 0, sizeof(ref[i]));
+		model->funcs.NativeTrace(model, 0, &fs, NULL, ray[i*2+0], ray[i*2+1], zero, zero, false, ~0u, &ref[i]);
+	}
+	brute = Sys_DoubleTime() - start;
+	mod_tracebones = true;
+
+	start = Sys_DoubleTime();
+	for (i = 0; i < count; i++)
+	{
+		memset(&tr, 0, sizeof(tr));
+		model->funcs.NativeTrace(model, 0, &fs, NULL, ray[i*2+0], ray[i*2+1], zero, zero, false, ~0u, &tr);
+		if (tr.fraction < 1)
+			hits++;
+		if (fabs(tr.fraction - ref[i].fraction) > 0.0001 || (tr.fraction == 1) != (ref[i].fraction == 1))
+			mismatches++;
+		else if (tr.triangle_id != ref[i].triangle_id)
+			ties++;	//hit two triangles at the same point (shared edges, overlapping skin), and the other one got tested first.
+	}
+	cached = Sys_DoubleTime() - start;
+
+	//and again, but with a new pose every trace so that the cache never helps.
+	start = Sys_DoubleTime();
+	for (i = 0; i < count; i++)
+	{
+		fs.g[FS_REG].frametime[0] += 0.0001;
+		memset(&tr, 0, sizeof(tr));
+		model->funcs.NativeTrace(model, 0, &fs, NULL, ray[i*2+0], ray[i*2+1], zero, zero, false, ~0u, &tr);
+	}
+	posed = Sys_DoubleTime() - start;
+	fs.g[FS_REG].frametime[0] = atof(Cmd_Argv(4));
+
+	//and spread over the workers, with different poses mixed in.
+	tb.model = model;
+	tb.fs = &fs;
+	tb.ray = ray;
+	tb.ref = ref;
+	tb.mismatches = 0;
+	start = Sys_DoubleTime();
+	COM_ParallelFor(count, 64, Mod_TraceBench_Range, &tb);
+	threaded = Sys_DoubleTime() - start;
+
+	Con_Printf("%i traces, %i hits, %i mismatches, %i tied triangles\n", count, hits, mismatches, ties);
+	Con_Printf("brute force: %.1f traces/ms\n", count/(brute*1000));
+	Con_Printf("bones: %.1f traces/ms (%.1fx)\n", count/(cached*1000), brute/cached);
+	Con_Printf("bones, new pose each trace: %.1f traces/ms (%.1fx)\n", count/(posed*1000), brute/posed);
+	Con_Printf("bones, %u workers, mixed poses: %.1f traces/ms, %i mismatches\n", COM_HasWorkers(WG_COMPUTE), count/(threaded*1000), (int)tb.mismatches);
+	BZ_Free(ray);
+	BZ_Free(ref);
+}
+#endif
+
 static unsigned int Mod_Mesh_PointContents(struct model_s *model, const vec3_t axis[3], const vec3_t p)
 {	//trisoup doesn't have any actual volumes, thus we can't report anything...
 	return 0;
@@ -3153,6 +3647,15 @@ static void Mod_DefaultMesh(galiasinfo_t *galias, const char *name, unsigned int
 
 void Mod_DestroyMesh(galiasinfo_t *galias)
 {
+#ifdef SKELETALMODELS
+	galiasinfo_t *surf;
+	for (surf = galias; surf; surf = surf->nextsurf)
+	{	//the rest of it is in the model's memgroup
+		if (surf->tracebones)
+			Sys_DestroyMutex(surf->tracebones->lock);
+		surf->tracebones = NULL;
+	}
+#endif
 #ifndef SERVERONLY
 	if (!qrenderer || !BE_VBO_Destroy)
 		return;
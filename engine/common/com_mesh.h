@@ -208,6 +208,7 @@ typedef struct galiasinfo_s
 	vec3_t *ofs_skel_tvect;
 	bone_vec4_t *ofs_skel_idx;
 	vec4_t *ofs_skel_weight;
+	struct galiastracebones_s *tracebones;	//generated on first trace, for hitmodel traces against posed meshes.
 
 	vboarray_t vbo_skel_verts;
 	vboarray_t vbo_skel_normals;
@@ -289,6 +290,7 @@ typedef struct modplugfuncs_s
 #ifdef SKELETALMODELS
 void Alias_TransformVerticies(float *bonepose, galisskeletaltransforms_t *weights, int numweights, vecV_t *xyzout, vec3_t *normout);
 void QDECL Alias_ForceConvertBoneData(skeltype_t sourcetype, const float *sourcedata, size_t bonecount, galiasbone_t *bones, skeltype_t desttype, float *destbuffer, size_t destbonecount);
+void Mod_TraceBench_f(void);
 #endif
 qboolean Alias_GAliasBuildMesh(mesh_t *mesh, vbo_t **vbop, galiasinfo_t *inf, int surfnum, entity_t *e, qboolean allowskel);
 void Mod_DestroyMesh(galiasinfo_t *galias);
@@ -6104,26 +6104,35 @@ static void COM_ErrorMe_f(void)
 static void QDECL COM_WorkerCount_Change(cvar_t *var, char *oldvalue);
 cvar_t worker_flush = CVARD("worker_flush", "1", "If set, process the entire load queue, loading stuff faster but at the risk of stalling the main thread.");
 static cvar_t worker_count = CVARFCD("worker_count", "", CVAR_NOTFROMSERVER, COM_WorkerCount_Change, "Specifies the number of worker threads to utilise.");
+static cvar_t worker_compute = CVARFCD("worker_compute", "", CVAR_NOTFROMSERVER, COM_WorkerCount_Change, "Specifies the number of extra threads to use for splitting up data-parallel work (via COM_ParallelFor). These never block on file access.");
 static cvar_t worker_sleeptime = CVARFD("worker_sleeptime", "0", CVAR_NOTFROMSERVER, "Causes workers to sleep for a period of time after each job.");
 
-#define WORKERTHREADS 16	//max
+#define WORKERTHREADS 16	//max (per group)
+#define WORKPOOLCHUNK 64	//jobs are allocated this many at a time, and recycled instead of freed.
 /*multithreading worker thread stuff*/
 void *com_resourcemutex;
 static int com_liveworkers[WG_COUNT];
+#define NOFLUSH 0x40000000	//set in com_liveworkers by COM_WorkerLock, so queued work waits for COM_WorkerUnlock instead of running on the main thread.
 static void *com_workercondition[WG_COUNT];
+static void *com_parallelforcondition;	//broadcast whenever a COM_ParallelFor finishes its last chunk.
 int com_hadwork[WG_COUNT];
 static volatile int com_workeracksequence;
 static struct com_worker_s
 {
 	void *thread;
+	wgroup_t group;
 	volatile enum {
 		WR_NONE,
 		WR_DIE,
 		WR_ACK	//updates ackseq to com_workeracksequence and sends a signal to WG_MAIN
 	} request;
 	volatile int ackseq;
-} com_worker[WORKERTHREADS];
+} com_worker[WORKERTHREADS], com_computeworker[WORKERTHREADS];
 qboolean com_workererror;
+static struct com_worker_s *COM_GroupWorkers(wgroup_t tg)
+{	//the main thread isn't in either.
+	return (tg == WG_COMPUTE)?com_computeworker:com_worker;
+}
 static struct com_work_s
 {
 	struct com_work_s *next;
@@ -6132,7 +6141,35 @@ static struct com_work_s
 	void *data;
 	size_t a;
 	size_t b;
-} *com_work_head[WG_COUNT], *com_work_tail[WG_COUNT];
+} *com_work_head[WG_COUNT], *com_work_tail[WG_COUNT], *com_work_free[WG_COUNT];	//all protected by the group's conditional
+static struct com_workchunk_s
+{
+	struct com_workchunk_s *next;
+	struct com_work_s work[WORKPOOLCHUNK];
+} *com_work_chunks[WG_COUNT];
+//the group's conditional must be locked (or not in use yet).
+static void COM_GrowWorkPool(wgroup_t tg)
+{
+	struct com_workchunk_s *chunk = Z_Malloc(sizeof(*chunk));
+	int i;
+	chunk->next = com_work_chunks[tg];
+	com_work_chunks[tg] = chunk;
+	for (i = 0; i < WORKPOOLCHUNK; i++)
+	{
+		chunk->work[i].next = com_work_free[tg];
+		com_work_free[tg] = &chunk->work[i];
+	}
+}
+//grabs a recycled job. the group's conditional must be locked.
+static struct com_work_s *COM_AllocWork(wgroup_t tg)
+{
+	struct com_work_s *work;
+	if (!com_work_free[tg])
+		COM_GrowWorkPool(tg);
+	work = com_work_free[tg];
+	com_work_free[tg] = work->next;
+	return work;
+}
 unsigned int COM_HasWorkers(wgroup_t tg)
 {	//simply returns if adding work will block or not (and a hint for how many jobs should be queued at once).
 	return com_liveworkers[tg];
@@ -6148,10 +6185,53 @@ qboolean COM_HasWork(void)
 	}
 	return false;
 }
-void COM_InsertWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b)
+//queues the same job count times, waking up as many workers as needed.
+static void COM_QueueWork(wgroup_t tg, qboolean urgent, unsigned int count, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b)
 {
 	struct com_work_s *work;
+	unsigned int i;
+
+	Sys_LockConditional(com_workercondition[tg]);
+	for (i = 0; i < count; i++)
+	{
+		//build the work
+		work = COM_AllocWork(tg);
+		work->func = func;
+		work->ctx = ctx;
+		work->data = data;
+		work->a = a;
+		work->b = b;
+
+		if (urgent)
+		{	//at the head, so its the next thing seen
+			work->next = com_work_head[tg];
+			if (!com_work_tail[tg])
+				com_work_tail[tg] = work;
+			com_work_head[tg] = work;
+		}
+		else
+		{	//fifo
+			work->next = NULL;
+			if (com_work_tail[tg])
+			{
+				com_work_tail[tg]->next = work;
+				com_work_tail[tg] = work;
+			}
+			else
+				com_work_head[tg] = com_work_tail[tg] = work;
+		}
+	}
+
+//	Sys_Printf("%x: Queued work %p (%s)\n", thread, work->ctx, work->ctx?(char*)work->ctx:"?");
 
+	if (count > 1)
+		Sys_ConditionBroadcast(com_workercondition[tg]);
+	else
+		Sys_ConditionSignal(com_workercondition[tg]);
+	Sys_UnlockConditional(com_workercondition[tg]);
+}
+void COM_InsertWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b)
+{
 	if (tg >= WG_COUNT)
 		return;
 
@@ -6162,30 +6242,10 @@ void COM_InsertWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, si
 		return;
 	}
 
-	//build the work
-	work = Z_Malloc(sizeof(*work));
-	work->func = func;
-	work->ctx = ctx;
-	work->data = data;
-	work->a = a;
-	work->b = b;
-
-	//queue it (fifo)
-	Sys_LockConditional(com_workercondition[tg]);
-	work->next = com_work_head[tg];
-	if (!com_work_tail[tg])
-		com_work_tail[tg] = work;
-	com_work_head[tg] = work;
-
-//	Sys_Printf("%x: Queued work %p (%s)\n", thread, work->ctx, work->ctx?(char*)work->ctx:"?");
-
-	Sys_ConditionSignal(com_workercondition[tg]);
-	Sys_UnlockConditional(com_workercondition[tg]);
+	COM_QueueWork(tg, true, 1, func, ctx, data, a, b);
 }
 void COM_AddWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, size_t b), void *ctx, void *data, size_t a, size_t b)
 {
-	struct com_work_s *work;
-
 	if (tg >= WG_COUNT)
 		return;
 
@@ -6196,28 +6256,89 @@ void COM_AddWork(wgroup_t tg, void(*func)(void *ctx, void *data, size_t a, size_
 		return;
 	}
 
-	//build the work
-	work = Z_Malloc(sizeof(*work));
-	work->func = func;
-	work->ctx = ctx;
-	work->data = data;
-	work->a = a;
-	work->b = b;
+	COM_QueueWork(tg, false, 1, func, ctx, data, a, b);
+}
 
-	//queue it (fifo)
-	Sys_LockConditional(com_workercondition[tg]);
-	if (com_work_tail[tg])
+struct com_parallelfor_s
+{
+	void(*func)(void *ctx, size_t first, size_t last);
+	void *ctx;
+	size_t count;
+	size_t grain;
+	unsigned int chunks;
+	qatomic32_t nextchunk;
+	qatomic32_t pending;	//chunks not yet finished
+	qatomic32_t refs;
+};
+//every thread that's involved grabs the next chunk until there's none left, so nothing sits idle while someone else has a backlog.
+static void COM_ParallelFor_Chunks(struct com_parallelfor_s *pf)
+{
+	unsigned int chunk;
+	size_t first;
+	for(;;)
 	{
-		com_work_tail[tg]->next = work;
-		com_work_tail[tg] = work;
+		chunk = FTE_Atomic32_Inc(&pf->nextchunk)-1;
+		if (chunk >= pf->chunks)
+			break;
+		first = chunk*pf->grain;
+		pf->func(pf->ctx, first, min(first+pf->grain, pf->count));
+		if (!FTE_Atomic32_Dec(&pf->pending))
+		{	//that was the last one, wake up whoever's waiting for it. the lock is needed so that they can't miss it.
+			Sys_LockConditional(com_parallelforcondition);
+			Sys_ConditionBroadcast(com_parallelforcondition);
+			Sys_UnlockConditional(com_parallelforcondition);
+		}
 	}
-	else
-		com_work_head[tg] = com_work_tail[tg] = work;
+}
+static void COM_ParallelFor_Release(struct com_parallelfor_s *pf)
+{
+	if (!FTE_Atomic32_Dec(&pf->refs))
+		Z_Free(pf);
+}
+static void COM_ParallelFor_Thread(void *ctx, void *data, size_t a, size_t b)
+{
+	COM_ParallelFor_Chunks(ctx);
+	COM_ParallelFor_Release(ctx);
+}
+//calls func for each grain-sized slice of [0,count), spread over the compute workers. returns once its all done.
+//func may be called from any thread, in any order. the calling thread helps out, so this is safe to use from workers too.
+void COM_ParallelFor(size_t count, size_t grain, void(*func)(void *ctx, size_t first, size_t last), void *ctx)
+{
+	struct com_parallelfor_s *pf;
+	size_t chunks;
+	unsigned int helpers = com_liveworkers[WG_COMPUTE]&~NOFLUSH;
 
-//	Sys_Printf("%x: Queued work %p (%s)\n", thread, work->ctx, work->ctx?(char*)work->ctx:"?");
+	if (!grain)
+		grain = 1;
+	chunks = (count+grain-1)/grain;
+	if (chunks <= 1 || !helpers || com_workererror || chunks > 0x7fffffff)
+	{	//not worth splitting, or nobody to split it with.
+		if (count)
+			func(ctx, 0, count);
+		return;
+	}
+	helpers = min(helpers, chunks-1);
 
-	Sys_ConditionSignal(com_workercondition[tg]);
-	Sys_UnlockConditional(com_workercondition[tg]);
+	pf = Z_Malloc(sizeof(*pf));
+	pf->func = func;
+	pf->ctx = ctx;
+	pf->count = count;
+	pf->grain = grain;
+	pf->chunks = chunks;
+	pf->nextchunk = 0;
+	pf->pending = chunks;
+	pf->refs = 1+helpers;	//helpers that start late still need it to exist.
+	COM_QueueWork(WG_COMPUTE, true, helpers, COM_ParallelFor_Thread, pf, NULL, 0, 0);
+
+	COM_ParallelFor_Chunks(pf);
+	if (pf->pending)
+	{	//someone else is still busy with the last few.
+		Sys_LockConditional(com_parallelforcondition);
+		while (pf->pending)
+			Sys_ConditionWait(com_parallelforcondition);
+		Sys_UnlockConditional(com_parallelforcondition);
+	}
+	COM_ParallelFor_Release(pf);
 }
 
 /*static void COM_PrintWork(void)
@@ -6260,12 +6381,15 @@ qboolean COM_DoWork(int tg, qboolean leavelocked)
 
 	if (work)
 	{
+		struct com_work_s job = *work;
+		//recycle it now, while we still hold the lock.
+		work->next = com_work_free[tg];
+		com_work_free[tg] = work;
 		com_hadwork[tg]++;
-//		Sys_Printf("%x: Doing work %p (%s)\n", thread, work->ctx, work->ctx?(char*)work->ctx:"?");
+//		Sys_Printf("%x: Doing work %p (%s)\n", thread, job.ctx, job.ctx?(char*)job.ctx:"?");
 		Sys_UnlockConditional(com_workercondition[tg]);
 
-		work->func(work->ctx, work->data, work->a, work->b);
-		Z_Free(work);
+		job.func(job.ctx, job.data, job.a, job.b);
 
 		if (leavelocked)
 			Sys_LockConditional(com_workercondition[tg]);
@@ -6333,7 +6457,7 @@ static void COM_WorkerSync_WorkerStopped(void *ctx, void *data, size_t a, size_t
 static int COM_WorkerThread(void *arg)
 {
 	struct com_worker_s *thread = arg;
-	int group = WG_LOADER;
+	int group = thread->group;
 	Sys_LockConditional(com_workercondition[group]);
 	com_liveworkers[group]++;
 	for(;;)
@@ -6395,12 +6519,20 @@ void COM_WorkerAbort(char *message)
 
 	//find out which worker we are, and tell the main thread to clean us up
 	for (us = 0; us < WORKERTHREADS; us++)
+	{
 		if (com_worker[us].thread && Sys_IsThread(com_worker[us].thread))
 		{
 			group = WG_LOADER;
 			COM_InsertWork(WG_MAIN, Sys_ErrorThread, &com_worker[us], Z_StrDup(message), 0, group);
 			break;
 		}
+		if (com_computeworker[us].thread && Sys_IsThread(com_computeworker[us].thread))
+		{
+			group = WG_COMPUTE;
+			COM_InsertWork(WG_MAIN, Sys_ErrorThread, &com_computeworker[us], Z_StrDup(message), 0, group);
+			break;
+		}
+	}
 
 	if (us == WORKERTHREADS)	//don't know who it was.
 		COM_AddWork(WG_MAIN, Sys_ErrorThread, NULL, Z_StrDup(message), 0, 0);
@@ -6423,6 +6555,11 @@ void COM_DestroyWorkerThread(void)
 	if (!com_resourcemutex)
 		return;
 //	com_workererror = false;
+	Sys_LockConditional(com_workercondition[WG_COMPUTE]);
+	for (i = 0; i < WORKERTHREADS; i++)
+		com_computeworker[i].request = WR_DIE;
+	Sys_ConditionBroadcast(com_workercondition[WG_COMPUTE]);
+	Sys_UnlockConditional(com_workercondition[WG_COMPUTE]);
 	Sys_LockConditional(com_workercondition[WG_LOADER]);
 	for (i = 0; i < WORKERTHREADS; i++)
 		com_worker[i].request = WR_DIE;	//flag them all to die
@@ -6432,16 +6569,30 @@ void COM_DestroyWorkerThread(void)
 	while(COM_DoWork(WG_LOADER, false))	//finish any work that got posted to it that it neglected to finish.
 		;
 	COM_WorkerFullSync();
+	while(COM_DoWork(WG_COMPUTE, false))	//stale helpers, just so they release their refs.
+		;
 	while(COM_DoWork(WG_MAIN, false))
 		;
 
 	for (i = 0; i < WG_COUNT; i++)
 	{
+		struct com_workchunk_s *chunk;
 		if (com_workercondition[i])
 			Sys_DestroyConditional(com_workercondition[i]);
 		com_workercondition[i] = NULL;
+
+		while ((chunk = com_work_chunks[i]))
+		{
+			com_work_chunks[i] = chunk->next;
+			Z_Free(chunk);
+		}
+		com_work_head[i] = com_work_tail[i] = com_work_free[i] = NULL;
 	}
 
+	if (com_parallelforcondition)
+		Sys_DestroyConditional(com_parallelforcondition);
+	com_parallelforcondition = NULL;
+
 	Sys_DestroyMutex(com_resourcemutex);
 	com_resourcemutex = NULL;
 }
@@ -6449,66 +6600,94 @@ void COM_DestroyWorkerThread(void)
 //Dangerous: stops workers WITHOUT flushing their queue. Be SURE to 'unlock' to start them up again.
 void COM_WorkerLock(void)
 {
-#define NOFLUSH 0x40000000
 	int i;
-	if (!com_liveworkers[WG_LOADER])
+	wgroup_t tg;
+	struct com_worker_s *worker;
+	if (!com_liveworkers[WG_LOADER] && !com_liveworkers[WG_COMPUTE])
 		return;	//nothing to do.
 
 	//don't let liveworkers become 0 (so the main thread doesn't flush any pending work) and ask workers to die
-	Sys_LockConditional(com_workercondition[WG_LOADER]);
-	com_liveworkers[WG_LOADER] |= NOFLUSH;
-	for (i = 0; i < WORKERTHREADS; i++)
-		com_worker[i].request = WR_DIE;	//flag them all to die
-	Sys_ConditionBroadcast(com_workercondition[WG_LOADER]);	//and make sure they ALL wake up to check their new death values.
-	Sys_UnlockConditional(com_workercondition[WG_LOADER]);
+	for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
+	{
+		if (!com_liveworkers[tg])
+			continue;
+		worker = COM_GroupWorkers(tg);
+		Sys_LockConditional(com_workercondition[tg]);
+		com_liveworkers[tg] |= NOFLUSH;
+		for (i = 0; i < WORKERTHREADS; i++)
+			worker[i].request = WR_DIE;	//flag them all to die
+		Sys_ConditionBroadcast(com_workercondition[tg]);	//and make sure they ALL wake up to check their new death values.
+		Sys_UnlockConditional(com_workercondition[tg]);
+	}
 
 	//wait for the workers to stop (leaving their work, because of our fake worker)
-	while((com_liveworkers[WG_LOADER]&~NOFLUSH)>0)
+	while((com_liveworkers[WG_LOADER]&~NOFLUSH)>0 || (com_liveworkers[WG_COMPUTE]&~NOFLUSH)>0)
 	{
 		if (!COM_DoWork(WG_MAIN, false))	//need to check this to know they're done.
 			COM_DoWork(WG_LOADER, false);	//might as well, while we're waiting.
 	}
 
 	//remove our flush-blocker now...
-	Sys_LockConditional(com_workercondition[WG_LOADER]);
-	com_liveworkers[WG_LOADER] &= ~NOFLUSH;
-	Sys_UnlockConditional(com_workercondition[WG_LOADER]);
+	for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
+	{
+		Sys_LockConditional(com_workercondition[tg]);
+		com_liveworkers[tg] &= ~NOFLUSH;
+		Sys_UnlockConditional(com_workercondition[tg]);
+	}
 }
 //called after COM_WorkerLock
 void COM_WorkerUnlock(void)
 {
-	qboolean restarted = false;
-	int i;
-	for (i = 0; i < WORKERTHREADS; i++)
+	qboolean restarted;
+	int i, count;
+	wgroup_t tg;
+	struct com_worker_s *worker;
+	for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
 	{
-		if (i >= worker_count.ival)
-			continue;	//worker stays dead
-
-		//lower thread indexes need to be (re)created
-		if (!com_worker[i].thread)
+		worker = COM_GroupWorkers(tg);
+		count = (tg == WG_COMPUTE)?worker_compute.ival:worker_count.ival;
+		restarted = false;
+		for (i = 0; i < WORKERTHREADS; i++)
 		{
-			com_worker[i].request = WR_NONE;
-			com_worker[i].thread = Sys_CreateThread(va("loadworker_%i", i), COM_WorkerThread, &com_worker[i], 0, 256*1024);
-			if (com_worker[i].thread)
-				restarted = true;
+			if (i >= count)
+				continue;	//worker stays dead
+
+			//lower thread indexes need to be (re)created
+			if (!worker[i].thread)
+			{
+				worker[i].request = WR_NONE;
+				worker[i].thread = Sys_CreateThread(va((tg == WG_COMPUTE)?"computeworker_%i":"loadworker_%i", i), COM_WorkerThread, &worker[i], 0, 256*1024);
+				if (worker[i].thread)
+					restarted = true;
+			}
 		}
-	}
 
-	if (!restarted)
-		while (COM_DoWork(WG_LOADER, false))
-			;
+		if (!restarted)
+			while (COM_DoWork(tg, false))
+				;
+	}
 }
 
 //fully flushes ALL pending work.
 void COM_WorkerFullSync(void)
 {
-	qboolean repeat;
+	qboolean repeat, ask;
 	int i;
+	wgroup_t tg;
+	struct com_worker_s *worker;
 
 	while(COM_DoWork(WG_MAIN, false))
 		;
 
-	if (!com_liveworkers[WG_LOADER])
+	//check the handles rather than com_liveworkers, which stays 0 until the thread actually gets going.
+	for (repeat = false, tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
+	{
+		worker = COM_GroupWorkers(tg);
+		for (i = 0; i < WORKERTHREADS; i++)
+			if (worker[i].thread)
+				repeat = true;
+	}
+	if (!repeat)
 		return;
 
 	com_workeracksequence++;
@@ -6516,24 +6695,26 @@ void COM_WorkerFullSync(void)
 	Sys_LockConditional(com_workercondition[WG_MAIN]);
 	do
 	{
-		if (!COM_HasWork())
+		//workers drain their queue before they ack, so ask them even if there's still work around.
+		Sys_UnlockConditional(com_workercondition[WG_MAIN]);
+		for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
 		{
-			Sys_UnlockConditional(com_workercondition[WG_MAIN]);
-			Sys_LockConditional(com_workercondition[WG_LOADER]);
-			repeat = false;
+			worker = COM_GroupWorkers(tg);
+			Sys_LockConditional(com_workercondition[tg]);
+			ask = false;
 			for (i = 0; i < WORKERTHREADS; i++)
 			{
-				if (com_worker[i].ackseq != com_workeracksequence && com_worker[i].request == WR_NONE)
+				if (worker[i].ackseq != com_workeracksequence && worker[i].request == WR_NONE)
 				{
-					com_worker[i].request = WR_ACK;
-					repeat = true;
+					worker[i].request = WR_ACK;
+					ask = true;
 				}
 			}
-			if (repeat)	//we're unable to signal a specific thread due to only having one condition. oh well. WAKE UP GUYS!
-				Sys_ConditionBroadcast(com_workercondition[WG_LOADER]);
-			Sys_UnlockConditional(com_workercondition[WG_LOADER]);
-			Sys_LockConditional(com_workercondition[WG_MAIN]);
+			if (ask)	//we're unable to signal a specific thread due to only having one condition. oh well. WAKE UP GUYS!
+				Sys_ConditionBroadcast(com_workercondition[tg]);
+			Sys_UnlockConditional(com_workercondition[tg]);
 		}
+		Sys_LockConditional(com_workercondition[WG_MAIN]);
 
 		repeat = COM_DoWork(WG_MAIN, true);
 
@@ -6543,10 +6724,14 @@ void COM_WorkerFullSync(void)
 		}
 		else
 		{
-			for (i = 0; i < WORKERTHREADS; i++)
+			for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
 			{
-				if (com_worker[i].thread && com_worker[i].ackseq != com_workeracksequence)
-					repeat = true;
+				worker = COM_GroupWorkers(tg);
+				for (i = 0; i < WORKERTHREADS; i++)
+				{
+					if (worker[i].thread && worker[i].ackseq != com_workeracksequence)
+						repeat = true;
+				}
 			}
 			if (repeat)
 				Sys_ConditionWait(com_workercondition[WG_MAIN]);
@@ -6653,6 +6838,68 @@ static void COM_WorkerTest_f(void)
 	*timestamp = Sys_DoubleTime();
 	COM_AddWork(WG_LOADER, COM_WorkerPing, NULL, timestamp, 0, 0);
 }
+static void COM_WorkerBench_Job(void *ctx, void *data, size_t a, size_t b)
+{
+	if (data)
+		*(double*)data = Sys_DoubleTime();
+	FTE_Atomic32_Inc((qatomic32_t*)ctx);
+}
+static void COM_WorkerBench_Range(void *ctx, size_t first, size_t last)
+{
+	FTE_Atomic32_Inc((qatomic32_t*)ctx);
+}
+static void COM_WorkerBench_f(void)
+{
+	int jobs = atoi(Cmd_Argv(1)), i;
+	wgroup_t tg;
+	qatomic32_t done;
+	double start, elapsed, woke, total, worst;
+	if (jobs <= 0)
+		jobs = 100000;
+
+	for (tg = WG_LOADER; tg <= WG_COMPUTE; tg++)
+	{
+		const char *name = (tg==WG_COMPUTE)?"compute":"loader";
+		if (!com_liveworkers[tg])
+		{
+			Con_Printf("%s: no workers\n", name);
+			continue;
+		}
+
+		//throughput of tiny jobs
+		done = 0;
+		start = Sys_DoubleTime();
+		for (i = 0; i < jobs; i++)
+		{
+			while (i - done >= WORKPOOLCHUNK*4)
+				Sys_Sleep(0);	//don't let the job pool grow (permanently) just for this.
+			COM_AddWork(tg, COM_WorkerBench_Job, &done, NULL, 0, 0);
+		}
+		while (done < jobs)
+			Sys_Sleep(0);
+		elapsed = Sys_DoubleTime() - start;
+
+		//how long an idle worker takes to notice new work
+		for (i = 0, total = worst = 0; i < 50; i++)
+		{
+			Sys_Sleep(0.002);	//give them a chance to go back to sleep
+			done = 0;
+			start = Sys_DoubleTime();
+			COM_AddWork(tg, COM_WorkerBench_Job, &done, &woke, 0, 0);
+			while (!done)
+				Sys_Sleep(0);
+			total += woke-start;
+			worst = max(worst, woke-start);
+		}
+		Con_Printf("%s: %i workers, %.0f jobs/s, wakeup %.1fus average, %.1fus worst\n", name, com_liveworkers[tg], jobs/elapsed, total*1000000/i, worst*1000000);
+	}
+
+	done = 0;
+	start = Sys_DoubleTime();
+	COM_ParallelFor(jobs*64, 64, COM_WorkerBench_Range, &done);
+	elapsed = Sys_DoubleTime() - start;
+	Con_Printf("parallelfor: %i chunks, %.0f chunks/s\n", done, done/elapsed);
+}
 static void COM_WorkerStatus_f(void)
 {
 	struct com_work_s *work;
@@ -6663,6 +6910,12 @@ static void COM_WorkerStatus_f(void)
 			count++;
 	}
 	Con_Printf("%i workers live\n", count);
+	for (i = 0, count = 0; i < WORKERTHREADS; i++)
+	{
+		if (com_computeworker[i].thread)
+			count++;
+	}
+	Con_Printf("%i compute workers live\n", count);
 
 	Sys_LockConditional(com_workercondition[WG_LOADER]);
 	for (count = 0, work = com_work_head[WG_LOADER]; work; work = work->next)
@@ -6674,6 +6927,8 @@ static void COM_WorkerStatus_f(void)
 static void QDECL COM_WorkerCount_Change(cvar_t *var, char *oldvalue)
 {
 	int i, count = var->ival;
+	qboolean compute = (var == &worker_compute);
+	struct com_worker_s *worker = compute?com_computeworker:com_worker;
 
 	if (!*var->string)
 	{
@@ -6689,19 +6944,19 @@ static void QDECL COM_WorkerCount_Change(cvar_t *var, char *oldvalue)
 		if (i >= count)
 		{
 			//higher thread indexes need to die.
-			com_worker[i].request = WR_DIE;	//flag them all to die
+			worker[i].request = WR_DIE;	//flag them all to die
 		}
 		else
 		{
 			//lower thread indexes need to be created
-			if (!com_worker[i].thread)
+			if (!worker[i].thread)
 			{
-				com_worker[i].request = WR_NONE;
-				com_worker[i].thread = Sys_CreateThread(va("loadworker_%i", i), COM_WorkerThread, &com_worker[i], 0, 256*1024);
+				worker[i].request = WR_NONE;
+				worker[i].thread = Sys_CreateThread(va(compute?"computeworker_%i":"loadworker_%i", i), COM_WorkerThread, &worker[i], 0, 256*1024);
 			}
 		}
 	}
-	Sys_ConditionBroadcast(com_workercondition[WG_LOADER]);	//and make sure they ALL wake up to check their new death values.
+	Sys_ConditionBroadcast(com_workercondition[compute?WG_COMPUTE:WG_LOADER]);	//and make sure they ALL wake up to check their new death values.
 }
 static void COM_InitWorkerThread(void)
 {
@@ -6709,9 +6964,16 @@ static void COM_InitWorkerThread(void)
 
 	//in theory, we could run multiple workers, signalling a different one in turn for each bit of work.
 	com_resourcemutex = Sys_CreateMutex();
+	com_parallelforcondition = Sys_CreateConditional();
 	for (i = 0; i < WG_COUNT; i++)
 	{
 		com_workercondition[i] = Sys_CreateConditional();
+		COM_GrowWorkPool(i);	//preallocate, so most jobs never need to allocate anything.
+	}
+	for (i = 0; i < WORKERTHREADS; i++)
+	{
+		com_worker[i].group = WG_LOADER;
+		com_computeworker[i].group = WG_COMPUTE;
 	}
 	com_liveworkers[WG_MAIN] = 1;
 
@@ -6721,14 +6983,19 @@ static void COM_InitWorkerThread(void)
 	{
 		worker_count.enginevalue = "0";
 		worker_count.flags |= CVAR_NOSET;
+		worker_compute.enginevalue = "0";
+		worker_compute.flags |= CVAR_NOSET;
 	}
 	Cvar_Register(&worker_count, NULL);
+	Cvar_Register(&worker_compute, NULL);
 
 	Cmd_AddCommand ("worker_test", COM_WorkerTest_f);
 	Cmd_AddCommand ("worker_status", COM_WorkerStatus_f);
+	Cmd_AddCommandD("worker_bench", COM_WorkerBench_f, "Reports how many tiny jobs per second the workers can get through, and how long they take to wake up.");
 	Cvar_Register(&worker_flush, NULL);
 	Cvar_Register(&worker_sleeptime, NULL);
 	Cvar_ForceCallback(&worker_count);
+	Cvar_ForceCallback(&worker_compute);
 }
 
 qboolean FTE_AtomicPtr_ConditionalReplace(qint32_t *ptr, qint32_t old, qint32_t new)
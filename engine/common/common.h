@@ -231,6 +231,12 @@ typedef struct
 	void *ed;
 } areagridlink_t;
 #endif
+typedef struct
+{
+	struct areahash_s *hash;	//null when not in the world's areahash
+	unsigned int cell;
+	unsigned int slot;	//index within the cell, for cheap removal.
+} areahashlink_t;
 
 
 void ClearLink (link_t *l);
@@ -647,6 +653,12 @@ typedef struct vfsfile_s
 #ifdef _DEBUG
 	char dbgname[MAX_QPATH];
 #endif
+
+	//optional extras (FSVER 4). must be NULL when unsupported, so clear them if you malloc.
+	int (QDECL *ReadBytesAt) (struct vfsfile_s *file, qofs_t pos, void *buffer, int bytestoread);	//optional. reads from an absolute offset without moving the file position, and MUST be safe to call from multiple threads at once (so archives can skip their mutex).
+	const void *(QDECL *GetMapping) (struct vfsfile_s *file, qofs_t *len);	//optional. returns a read-only view of the entire file that stays valid until the file is closed (NOT null terminated), or NULL if it can't be mapped. not thread-safe.
+	void *(QDECL *MapPrivate) (struct vfsfile_s *file, qofs_t pos, size_t len, void **ctx);	//optional. maps part of the file as a private copy-on-write view that can be scribbled over (nothing is written back), with one extra writable byte after it for a null terminator. release with UnmapPrivate before closing. MUST be thread-safe, like ReadBytesAt.
+	void (QDECL *UnmapPrivate) (struct vfsfile_s *file, void *ctx);
 } vfsfile_t;
 
 #define VFS_ERROR_TRYLATER		0	//nothing to write/read yet.
@@ -702,6 +714,9 @@ qboolean FS_SystemPath(const char *fname, enum fs_relative relativeto, char *out
 qboolean FS_DisplayPath(const char *fname, enum fs_relative relativeto, char *out, int outlen);	//retrieves a string for user display. prefixes may be masked for privacy.
 qboolean FS_WriteFile (const char *filename, const void *data, int len, enum fs_relative relativeto);
 void *FS_MallocFile(const char *filename, enum fs_relative relativeto, qofs_t *filesize);
+const qbyte *FS_MapFile(const char *filename, unsigned int locateflags, size_t *filesize, void **viewhandle);	//read-only and NOT null terminated. avoids copying the file where possible (mmapped files or stored archive members). release with FS_UnmapFile.
+qbyte *FS_MapPrivateFile(const char *path, size_t *filesize, qboolean filters, void **viewhandle);	//writable and null terminated like FS_LoadMallocGroupFile, but copy-on-write pages where possible. release with FS_UnmapFile.
+void FS_UnmapFile(void *viewhandle);
 vfsfile_t *QDECL FS_OpenVFS(const char *filename, const char *mode, enum fs_relative relativeto);
 vfsfile_t *FS_OpenTemp(void);
 vfsfile_t *FS_OpenTCP(const char *name, int defaultport, qboolean assumetls);
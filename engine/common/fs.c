@@ -3287,6 +3287,109 @@ void *FS_MallocFile(const char *filename, enum fs_relative relativeto, qofs_t *f
 	VFS_CLOSE(f);
 	return buf;
 }
+typedef struct
+{
+	vfsfile_t *file;	//kept open while the view is borrowed, if it was mapped.
+	void *mapctx;		//for UnmapPrivate.
+	qbyte *copy;		//otherwise we had to read it into memory.
+} fsview_t;
+static qbyte *FS_MapVFS(vfsfile_t *f, qboolean writable, size_t *filesize, void **viewhandle)
+{
+	fsview_t *view;
+	qbyte *data = NULL;
+	qofs_t len = VFS_GETLEN(f);
+
+	*viewhandle = NULL;
+	if (len >= ~(size_t)0)
+	{
+		VFS_CLOSE(f);
+		return NULL;
+	}
+
+	view = Z_Malloc(sizeof(*view));
+	//callers cast the data to structs, so only use mappings that are as aligned as malloc would have been (archive members often aren't).
+	if (f->MapPrivate && len)
+	{	//copy-on-write, so it doesn't matter if the caller patches it.
+		data = f->MapPrivate(f, 0, len, &view->mapctx);
+		if (data && ((size_t)data & 15))
+		{
+			f->UnmapPrivate(f, view->mapctx);
+			view->mapctx = NULL;
+			data = NULL;
+		}
+		if (data)
+			data[len] = 0;
+	}
+	if (!data && !writable && f->GetMapping)
+	{
+		qofs_t maplen = 0;
+		data = (qbyte*)f->GetMapping(f, &maplen);
+		if (maplen != len || ((size_t)data & 15))
+			data = NULL;
+	}
+	if (data)
+		view->file = f;
+	else
+	{
+		view->copy = BZ_Malloc(len+1);
+		view->copy[len] = 0;
+		if (VFS_READ(f, view->copy, len) != len)
+		{
+			VFS_CLOSE(f);
+			BZ_Free(view->copy);
+			Z_Free(view);
+			return NULL;
+		}
+		VFS_CLOSE(f);
+		data = view->copy;
+	}
+	if (filesize)
+		*filesize = len;
+	*viewhandle = view;
+	return data;
+}
+//gets a read-only view of the file. mapped files and stored archive members will use the pagecache directly instead of copying the entire file.
+//the result is not always null terminated.
+const qbyte *FS_MapFile(const char *filename, unsigned int locateflags, size_t *filesize, void **viewhandle)
+{
+	flocation_t loc;
+	vfsfile_t *f;
+
+	*viewhandle = NULL;
+	locateflags &= ~FSLF_DEEPONFAILURE;	//disable any flags that can't be supported here
+	if (!FS_FLocateFile(filename, locateflags, &loc) || !loc.search)
+		return NULL;	//wasn't found
+	fs_accessed_time = realtime;
+	f = loc.search->handle->OpenVFS(loc.search->handle, &loc, "rb");
+	if (!f)
+		return NULL;
+	return FS_MapVFS(f, false, filesize, viewhandle);
+}
+//for loaders that want to patch the data in place. like FS_LoadMallocGroupFile, but only the pages that actually get written are copied.
+qbyte *FS_MapPrivateFile(const char *path, size_t *filesize, qboolean filters, void **viewhandle)
+{
+	vfsfile_t *f = FS_OpenVFS(path, "rb", FS_GAME);
+	*viewhandle = NULL;
+	if (f && filters)
+		f = VFS_Filter(path, f);
+	if (!f)
+		return NULL;
+	return FS_MapVFS(f, true, filesize, viewhandle);
+}
+void FS_UnmapFile(void *viewhandle)
+{
+	fsview_t *view = viewhandle;
+	if (!view)
+		return;
+	if (view->file)
+	{
+		if (view->mapctx)
+			view->file->UnmapPrivate(view->file, view->mapctx);
+		VFS_CLOSE(view->file);
+	}
+	BZ_Free(view->copy);
+	Z_Free(view);
+}
 qboolean FS_WriteFile (const char *filename, const void *data, int len, enum fs_relative relativeto)
 {
 	vfsfile_t *f;
@@ -8,7 +8,7 @@ Files may be shared between threads, but not simultaneously.
 The filesystem driver is responsible for closing the pak/pk3 once all files are closed, and must ensure that opens+reads+closes as well as archive closure are thread safe.
 */
 
-#define FSVER 3
+#define FSVER 4
 
 
 #define FF_NOTFOUND		(0u)	//file wasn't found
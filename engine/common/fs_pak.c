@@ -204,7 +204,13 @@ static int QDECL VFSPAK_ReadBytes(struct vfsfile_s *vfs, void *buffer, int bytes
 		return -1;
 	}
 
-	if (Sys_LockMutex(vfsp->parentpak->mutex))
+	if (vfsp->parentpak->handle->ReadBytesAt)
+	{	//no shared file position to worry about, so no need to lock.
+		read = vfsp->parentpak->handle->ReadBytesAt(vfsp->parentpak->handle, vfsp->currentpos, buffer, bytestoread);
+		if (read > 0)
+			vfsp->currentpos += read;
+	}
+	else if (Sys_LockMutex(vfsp->parentpak->mutex))
 	{
 		if (vfsp->parentpak->filepos != vfsp->currentpos)
 			VFS_SEEK(vfsp->parentpak->handle, vfsp->currentpos);
@@ -218,6 +224,31 @@ static int QDECL VFSPAK_ReadBytes(struct vfsfile_s *vfs, void *buffer, int bytes
 
 	return read;
 }
+static int QDECL VFSPAK_ReadBytesAt(struct vfsfile_s *vfs, qofs_t pos, void *buffer, int bytestoread)
+{
+	vfspack_t *vfsp = (vfspack_t *)vfs;
+	vfsfile_t *h = vfsp->parentpak->handle;
+	if (pos >= vfsp->length)
+		return 0;
+	if (pos + bytestoread > vfsp->length)
+		bytestoread = vfsp->length - pos;
+	return h->ReadBytesAt(h, vfsp->startpos + pos, buffer, bytestoread);
+}
+//each view maps just the member's pages from the pak, so there's no shared state to lock.
+static void *QDECL VFSPAK_MapPrivate(struct vfsfile_s *vfs, qofs_t pos, size_t len, void **ctx)
+{
+	vfspack_t *vfsp = (vfspack_t *)vfs;
+	vfsfile_t *h = vfsp->parentpak->handle;
+	if (pos + len > vfsp->length)
+		return NULL;
+	return h->MapPrivate(h, vfsp->startpos + pos, len, ctx);
+}
+static void QDECL VFSPAK_UnmapPrivate(struct vfsfile_s *vfs, void *ctx)
+{
+	vfspack_t *vfsp = (vfspack_t *)vfs;
+	vfsfile_t *h = vfsp->parentpak->handle;
+	h->UnmapPrivate(h, ctx);
+}
 static int QDECL VFSPAK_WriteBytes(struct vfsfile_s *vfs, const void *buffer, int bytestoread)
 { // not supported.
 	Sys_Error("Cannot write to pak files\n");
@@ -278,6 +309,9 @@ static vfsfile_t *QDECL FSPAK_OpenVFS(searchpathfuncs_t *handle, flocation_t *lo
 	vfs->funcs.Seek = VFSPAK_Seek;
 	vfs->funcs.Tell = VFSPAK_Tell;
 	vfs->funcs.WriteBytes = VFSPAK_WriteBytes; // not supported
+	vfs->funcs.ReadBytesAt = pack->handle->ReadBytesAt?VFSPAK_ReadBytesAt:NULL; // only if the pak itself can do it (nested paks)
+	vfs->funcs.MapPrivate = pack->handle->MapPrivate?VFSPAK_MapPrivate:NULL;
+	vfs->funcs.UnmapPrivate = VFSPAK_UnmapPrivate;
 
 	return (vfsfile_t *)vfs;
 }
@@ -3,6 +3,8 @@
 #include "errno.h"
 #if _POSIX_C_SOURCE >= 200112L
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #endif
 
 #if !defined(FTE_TARGET_WEB) && (!defined(_WIN32) || defined(WEBSVONLY))
@@ -30,6 +32,10 @@ typedef struct {
 typedef struct {
 	vfsfile_t funcs;
 	FILE *handle;
+#if _POSIX_C_SOURCE >= 200112L
+	void *mmap;	//mapped on demand, for read-only files.
+	size_t mmaplen;
+#endif
 } vfsstdiofile_t;
 static int QDECL VFSSTDIO_ReadBytes (struct vfsfile_s *file, void *buffer, int bytestoread)
 {
@@ -41,6 +47,74 @@ static int QDECL VFSSTDIO_WriteBytes (struct vfsfile_s *file, const void *buffer
 	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
 	return fwrite(buffer, 1, bytestoread, intfile->handle);
 }
+#if _POSIX_C_SOURCE >= 200112L
+//bypasses the FILE's buffer entirely, so only valid for files that are never written.
+static int QDECL VFSSTDIO_ReadBytesAt (struct vfsfile_s *file, qofs_t pos, void *buffer, int bytestoread)
+{
+	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
+	ssize_t r;
+	do
+	{
+		r = pread(fileno(intfile->handle), buffer, bytestoread, (off_t)pos);
+	} while (r < 0 && errno == EINTR);
+	return (r < 0)?VFS_ERROR_UNSPECIFIED:r;
+}
+//NOTE: mappings are private, so nothing we do to them is ever written back, but if some other process truncates the file while it's mapped then touching the lost pages raises SIGBUS.
+//we assume nothing rewrites packages while we have them open (windows refuses to even allow it).
+static const void *QDECL VFSSTDIO_GetMapping (struct vfsfile_s *file, qofs_t *len)
+{
+	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
+	if (!intfile->mmap)
+	{
+		struct stat st;
+		void *m;
+		int fd = fileno(intfile->handle);
+		if (fstat(fd, &st) || st.st_size <= 0 || (qofs_t)st.st_size >= (size_t)~0)
+			return NULL;	//can't map empty files, nor ones too large for our address space.
+		m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (m == MAP_FAILED)
+			return NULL;
+		intfile->mmap = m;
+		intfile->mmaplen = st.st_size;
+	}
+	*len = intfile->mmaplen;
+	return intfile->mmap;
+}
+typedef struct
+{
+	void *base;
+	size_t len;
+} stdioview_t;
+static void *QDECL VFSSTDIO_MapPrivate (struct vfsfile_s *file, qofs_t pos, size_t len, void **ctx)
+{
+	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
+	int fd = fileno(intfile->handle);
+	size_t pagesize = sysconf(_SC_PAGESIZE);
+	qofs_t base = pos - (pos % pagesize);
+	struct stat st;
+	stdioview_t *view;
+	void *m;
+
+	if (fstat(fd, &st) || pos+len > (qofs_t)st.st_size || len >= (size_t)~0 - pagesize*2)
+		return NULL;	//can't map past the end of the file, nor stuff too large for our address space.
+	if (pos+len == (qofs_t)st.st_size && !(st.st_size % pagesize))
+		return NULL;	//the terminator would be on a page entirely past the end of the file, which would fault.
+	m = mmap(NULL, (pos-base)+len+1, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, base);
+	if (m == MAP_FAILED)
+		return NULL;
+	view = Z_Malloc(sizeof(*view));
+	view->base = m;
+	view->len = (pos-base)+len+1;
+	*ctx = view;
+	return (qbyte*)m + (pos-base);
+}
+static void QDECL VFSSTDIO_UnmapPrivate (struct vfsfile_s *file, void *ctx)
+{
+	stdioview_t *view = ctx;
+	munmap(view->base, view->len);
+	Z_Free(view);
+}
+#endif
 static qboolean QDECL VFSSTDIO_Seek (struct vfsfile_s *file, qofs_t pos)
 {
 	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
@@ -101,6 +175,10 @@ static qboolean QDECL VFSSTDIO_Close(vfsfile_t *file)
 {
 	qboolean success;
 	vfsstdiofile_t *intfile = (vfsstdiofile_t*)file;
+#if _POSIX_C_SOURCE >= 200112L
+	if (intfile->mmap)
+		munmap(intfile->mmap, intfile->mmaplen);
+#endif
 	success = !ferror(intfile->handle);
 	fclose(intfile->handle);
 	Z_Free(file);
@@ -162,6 +240,14 @@ vfsfile_t *FSSTDIO_OpenTemp(void)
 	file->funcs.Tell = VFSSTDIO_Tell;
 	file->funcs.GetLen = VFSSTDIO_GetSize;
 	file->funcs.Flush = VFSSTDIO_Flush;
+	file->funcs.ReadBytesAt = NULL;
+	file->funcs.GetMapping = NULL;
+	file->funcs.MapPrivate = NULL;
+	file->funcs.UnmapPrivate = NULL;
+#if _POSIX_C_SOURCE >= 200112L
+	file->mmap = NULL;
+	file->mmaplen = 0;
+#endif
 	file->handle = f;
 
 	return (vfsfile_t*)file;
@@ -237,6 +323,19 @@ vfsfile_t *VFSSTDIO_Open(const char *osname, const char *mode, qboolean *needsfl
 	file->funcs.GetLen = VFSSTDIO_GetSize;
 	file->funcs.Close = VFSSTDIO_Close;
 	file->funcs.Flush = VFSSTDIO_Flush;
+#if _POSIX_C_SOURCE >= 200112L
+	file->funcs.ReadBytesAt = (write||append)?NULL:VFSSTDIO_ReadBytesAt;
+	file->funcs.GetMapping = (write||append)?NULL:VFSSTDIO_GetMapping;
+	file->funcs.MapPrivate = (write||append)?NULL:VFSSTDIO_MapPrivate;
+	file->funcs.UnmapPrivate = VFSSTDIO_UnmapPrivate;
+	file->mmap = NULL;
+	file->mmaplen = 0;
+#else
+	file->funcs.ReadBytesAt = NULL;
+	file->funcs.GetMapping = NULL;
+	file->funcs.MapPrivate = NULL;
+	file->funcs.UnmapPrivate = NULL;
+#endif
 	file->handle = f;
 
 	return (vfsfile_t*)file;
@@ -242,6 +242,51 @@ static int QDECL VFSW32_ReadBytes (struct vfsfile_s *file, void *buffer, int byt
 		return 0;
 	return read;
 }
+//only used for read-only mapped files, where we can just memcpy without touching the file pointer.
+static int QDECL VFSW32_ReadBytesAt (struct vfsfile_s *file, qofs_t pos, void *buffer, int bytestoread)
+{
+	vfsw32file_t *intfile = (vfsw32file_t*)file;
+	if (pos >= intfile->length)
+		return 0;
+	if (pos+bytestoread > intfile->length)
+		bytestoread = intfile->length-pos;
+	memcpy(buffer, (char*)intfile->mmap + pos, bytestoread);
+	return bytestoread;
+}
+static const void *QDECL VFSW32_GetMapping (struct vfsfile_s *file, qofs_t *len)
+{
+	vfsw32file_t *intfile = (vfsw32file_t*)file;
+	*len = intfile->length;
+	return intfile->mmap;
+}
+static void *QDECL VFSW32_MapPrivate (struct vfsfile_s *file, qofs_t pos, size_t len, void **ctx)
+{
+	vfsw32file_t *intfile = (vfsw32file_t*)file;
+	SYSTEM_INFO si;
+	qofs_t base;
+	size_t maplen;
+	qbyte *m;
+
+	if (pos+len > intfile->length)
+		return NULL;
+	GetSystemInfo(&si);
+	base = pos - (pos % si.dwAllocationGranularity);
+	if (pos+len+1 <= intfile->length)
+		maplen = (pos-base)+len+1;
+	else if ((pos+len) % si.dwPageSize)
+		maplen = (pos-base)+len;	//the terminator is past the end of the file, but still within the view's last page.
+	else
+		return NULL;	//the terminator would need a page that the view can't have.
+	m = MapViewOfFile(intfile->mmh, FILE_MAP_COPY, (DWORD)((quint64_t)base>>32), (DWORD)base, maplen);
+	if (!m)
+		return NULL;
+	*ctx = m;
+	return m + (pos-base);
+}
+static void QDECL VFSW32_UnmapPrivate (struct vfsfile_s *file, void *ctx)
+{
+	UnmapViewOfFile(ctx);
+}
 static int QDECL VFSW32_WriteBytes (struct vfsfile_s *file, const void *buffer, int bytestoread)
 {
 	DWORD written;
@@ -502,6 +547,10 @@ static vfsfile_t *QDECL VFSW32_OpenInternal(vfsw32path_t *handle, const char *qu
 	file->funcs.GetLen = VFSW32_GetSize;
 	file->funcs.Close = VFSW32_Close;
 	file->funcs.Flush = VFSW32_Flush;
+	file->funcs.ReadBytesAt = (mmap && !write)?VFSW32_ReadBytesAt:NULL;
+	file->funcs.GetMapping = (mmap && !write)?VFSW32_GetMapping:NULL;
+	file->funcs.MapPrivate = (mmap && !write)?VFSW32_MapPrivate:NULL;
+	file->funcs.UnmapPrivate = VFSW32_UnmapPrivate;
 	file->hand = h;
 	file->mmh = mh;
 	file->mmap = mmap;
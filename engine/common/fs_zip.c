@@ -687,6 +687,24 @@ typedef struct zipfile_s
 } zipfile_t;
 
 
+//reads from the underlying archive at a specific offset.
+//if the raw file supports positional reads then we don't need to lock or seek, so multiple threads can read from the same archive at once.
+static int FSZIP_ReadRaw(zipfile_t *zip, qofs_t ofs, void *buffer, int bytes)
+{
+	int read;
+	if (zip->raw->ReadBytesAt)
+		read = zip->raw->ReadBytesAt(zip->raw, ofs, buffer, bytes);
+	else if (Sys_LockMutex(zip->mutex))
+	{
+		VFS_SEEK(zip->raw, ofs);
+		read = VFS_READ(zip->raw, buffer, bytes);
+		Sys_UnlockMutex(zip->mutex);
+	}
+	else
+		read = 0;
+	return max(0, read);
+}
+
 static void QDECL FSZIP_GetPathDetails(searchpathfuncs_t *handle, char *out, size_t outlen)
 {
 	zipfile_t *zip = (void*)handle;
@@ -1003,14 +1021,7 @@ static qofs_t FSZIP_Deflate_Read(struct decompressstate *st, qbyte *buffer, qofs
 			if (sz)
 			{
 				//feed it.
-				if (Sys_LockMutex(st->source->mutex))
-				{
-					VFS_SEEK(st->source->raw, st->cofs);
-					st->strm.avail_in = VFS_READ(st->source->raw, st->inbuffer, sz);
-					Sys_UnlockMutex(st->source->mutex);
-				}
-				else
-					st->strm.avail_in = 0;
+				st->strm.avail_in = FSZIP_ReadRaw(st->source, st->cofs, st->inbuffer, sz);
 				st->strm.next_in = st->inbuffer;
 				st->cofs += st->strm.avail_in;
 #ifdef ZIPCRYPT
@@ -1055,12 +1066,7 @@ static struct decompressstate *FSZIP_Deflate_Init(zipfile_t *source, qofs_t star
 	if (password && csize >= 12)
 	{
 		char entropy[12];
-		if (Sys_LockMutex(source->mutex))
-		{
-			VFS_SEEK(source->raw, start);
-			VFS_READ(source->raw, entropy, sizeof(entropy));
-			Sys_UnlockMutex(source->mutex);
-		}
+		FSZIP_ReadRaw(source, start, entropy, sizeof(entropy));
 		if (!FSZIP_SetupCrytoKeys(st, password, entropy, crc))
 		{
 			Con_Printf("Invalid password, cannot decrypt %s\n", filename);
@@ -1237,14 +1243,7 @@ static qofs_t FSZIP_BZip2_Read(struct decompressstate *st, qbyte *buffer, qofs_t
 			if (sz)
 			{
 				//feed it.
-				if (Sys_LockMutex(st->source->mutex))
-				{
-					VFS_SEEK(st->source->raw, st->cofs);
-					st->bstrm.avail_in = VFS_READ(st->source->raw, st->inbuffer, sz);
-					Sys_UnlockMutex(st->source->mutex);
-				}
-				else
-					st->bstrm.avail_in = 0;
+				st->bstrm.avail_in = FSZIP_ReadRaw(st->source, st->cofs, st->inbuffer, sz);
 				st->bstrm.next_in = st->inbuffer;
 				st->cofs += st->bstrm.avail_in;
 #ifdef ZIPCRYPT
@@ -1289,12 +1288,7 @@ static struct decompressstate *FSZIP_BZip2_Init(zipfile_t *source, qofs_t start,
 	if (password && csize >= 12)
 	{
 		char entropy[12];
-		if (Sys_LockMutex(source->mutex))
-		{
-			VFS_SEEK(source->raw, start);
-			VFS_READ(source->raw, entropy, sizeof(entropy));
-			Sys_UnlockMutex(source->mutex);
-		}
+		FSZIP_ReadRaw(source, start, entropy, sizeof(entropy));
 		if (!FSZIP_SetupCrytoKeys(st, password, entropy, crc))
 		{
 			Con_Printf("Invalid password, cannot decrypt %s\n", filename);
@@ -1403,16 +1397,11 @@ static int QDECL VFSZIP_ReadBytes (struct vfsfile_s *file, void *buffer, int byt
 	}
 	else
 #endif
-	if (Sys_LockMutex(vfsz->parent->mutex))
 	{
-		VFS_SEEK(vfsz->parent->raw, vfsz->pos+vfsz->startpos);
 		if (vfsz->pos + bytestoread > vfsz->length)
 			bytestoread = max(0, vfsz->length - vfsz->pos);
-		read = VFS_READ(vfsz->parent->raw, buffer, bytestoread);
-		Sys_UnlockMutex(vfsz->parent->mutex);
+		read = FSZIP_ReadRaw(vfsz->parent, vfsz->pos+vfsz->startpos, buffer, bytestoread);
 	}
-	else
-		read = 0;
 
 	if (read < bytestoread)
 		((char*)buffer)[read] = 0;
@@ -1420,6 +1409,30 @@ static int QDECL VFSZIP_ReadBytes (struct vfsfile_s *file, void *buffer, int byt
 	vfsz->pos += read;
 	return read;
 }
+//only used for stored files (no decompression state to worry about).
+static int QDECL VFSZIP_ReadBytesAt (struct vfsfile_s *file, qofs_t pos, void *buffer, int bytestoread)
+{
+	vfszip_t *vfsz = (vfszip_t*)file;
+	if (pos >= vfsz->length)
+		return 0;
+	if (pos + bytestoread > vfsz->length)
+		bytestoread = vfsz->length - pos;
+	return FSZIP_ReadRaw(vfsz->parent, vfsz->startpos+pos, buffer, bytestoread);
+}
+//each view maps just the member's pages from the zip, so there's no shared state to lock.
+static void *QDECL VFSZIP_MapPrivate (struct vfsfile_s *file, qofs_t pos, size_t len, void **ctx)
+{
+	vfszip_t *vfsz = (vfszip_t*)file;
+	vfsfile_t *raw = vfsz->parent->raw;
+	if (pos + len > vfsz->length)
+		return NULL;
+	return raw->MapPrivate(raw, vfsz->startpos+pos, len, ctx);
+}
+static void QDECL VFSZIP_UnmapPrivate (struct vfsfile_s *file, void *ctx)
+{
+	vfszip_t *vfsz = (vfszip_t*)file;
+	vfsz->parent->raw->UnmapPrivate(vfsz->parent->raw, ctx);
+}
 static qboolean QDECL VFSZIP_Seek (struct vfsfile_s *file, qofs_t pos)
 {
 	vfszip_t *vfsz = (vfszip_t*)file;
@@ -1625,6 +1638,15 @@ static vfsfile_t *QDECL FSZIP_OpenVFS(searchpathfuncs_t *handle, flocation_t *lo
 		}
 	}
 
+#ifdef DO_ZIP_DECOMPRESS
+	if (!vfsz->decompress)
+#endif
+	{
+		vfsz->funcs.ReadBytesAt = VFSZIP_ReadBytesAt;
+		vfsz->funcs.MapPrivate = zip->raw->MapPrivate?VFSZIP_MapPrivate:NULL;
+		vfsz->funcs.UnmapPrivate = VFSZIP_UnmapPrivate;
+	}
+
 	FTE_Atomic32_Inc(&zip->references);
 	return (vfsfile_t*)vfsz;
 }
@@ -1714,11 +1736,8 @@ static qboolean FSZIP_ValidateLocalHeader(zipfile_t *zip, zpackfile_t *zfile, qo
 	qofs_t localstart = zfile->localpos;
 
 	
-	if (!Sys_LockMutex(zip->mutex))
+	if (FSZIP_ReadRaw(zip, localstart, localdata, sizeof(localdata)) != sizeof(localdata))
 		return false;	//ohnoes
-	VFS_SEEK(zip->raw, localstart);
-	VFS_READ(zip->raw, localdata, sizeof(localdata));
-	Sys_UnlockMutex(zip->mutex);
 
 	//make sure we found the right sort of table.
 	if (localdata[0] != 'P' ||
@@ -1751,11 +1770,8 @@ static qboolean FSZIP_ValidateLocalHeader(zipfile_t *zip, zpackfile_t *zfile, qo
 		unsigned short extrachunk_tag;
 		unsigned short extrachunk_len;
 
-		if (!Sys_LockMutex(zip->mutex))
+		if (!FSZIP_ReadRaw(zip, localstart, extradata, local.extra_len))
 			return false;	//ohnoes
-		VFS_SEEK(zip->raw, localstart);
-		VFS_READ(zip->raw, extradata, sizeof(extradata));
-		Sys_UnlockMutex(zip->mutex);
 
 
 		while(extra+4 < extraend)
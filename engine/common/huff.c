@@ -53,6 +53,8 @@ typedef struct {
 	node_t*		nodePtrs[768];
 } huff_t;
 
+#define HUFF_LOOKUPBITS 11	/* codes this long or shorter are decoded with a single table lookup */
+
 struct huffman_s{
 	int counts[256];
 	unsigned int crc;
@@ -60,6 +62,12 @@ struct huffman_s{
 
 	huff_t		compressor;
 	huff_t		decompressor;
+
+	/* the netchan mode never updates its trees, so we can flatten them into tables */
+	unsigned int	code[HMAX+1];	/* bits in transmission order, first bit in the lsb */
+	qbyte			codelen[HMAX+1];	/* 0 if the code is too long to fit, use the tree instead */
+	unsigned short	lookup[1<<HUFF_LOOKUPBITS];	/* symbol | (length<<9), or 0 if the code is longer than HUFF_LOOKUPBITS */
+	node_t			*lookupnode[1<<HUFF_LOOKUPBITS];	/* where to resume walking the tree for longer codes */
 };
 extern cvar_t net_compress;
 
@@ -367,6 +375,77 @@ static void Huff_offsetTransmit (huff_t *huff, int ch, qbyte *fout, int *offset)
 	*offset = bloc;
 }
 
+/* Get a symbol using the lookup tables. The caller must ensure that 3 bytes are readable from the current offset */
+static int Huff_tableReceive (huffman_t *huff, qbyte *fin, int *offset) {
+	int pos = *offset, ch;
+	const qbyte *in = fin + (pos>>3);
+	unsigned int bits = (in[0] | (in[1]<<8) | (in[2]<<16)) >> (pos&7);
+	unsigned int e = huff->lookup[bits & ((1<<HUFF_LOOKUPBITS)-1)];
+	if (e) {
+		*offset = pos + (e>>9);
+		return e & 511;
+	}
+	/* long code, walk the rest of the way */
+	pos += HUFF_LOOKUPBITS;
+	Huff_offsetReceive(huff->lookupnode[bits & ((1<<HUFF_LOOKUPBITS)-1)], &ch, fin, &pos);
+	*offset = pos;
+	return ch;
+}
+
+/* Send a symbol using the lookup tables, a byte at a time instead of a bit at a time */
+static void Huff_tableTransmit (huffman_t *huff, int ch, qbyte *fout, int *offset) {
+	int pos = *offset, len = huff->codelen[ch], n;
+	unsigned int code = huff->code[ch];
+	if (!len) {
+		Huff_offsetTransmit(&huff->compressor, ch, fout, offset);
+		return;
+	}
+	while (len > 0) {
+		if ((pos&7) == 0) {
+			fout[(pos>>3)] = 0;
+		}
+		n = 8 - (pos&7);
+		if (n > len) {
+			n = len;
+		}
+		fout[(pos>>3)] |= (code & ((1u<<n)-1)) << (pos&7);
+		code >>= n;
+		len -= n;
+		pos += n;
+	}
+	*offset = pos;
+}
+
+static void Huff_buildTables(huffman_t *huff) {
+	node_t *node;
+	unsigned int code;
+	int i, len;
+
+	for (i = 0; i <= HMAX; i++) {
+		code = 0;
+		len = 0;
+		for (node = huff->compressor.loc[i]; node && node->parent; node = node->parent, len++) {
+			code = (code<<1) | (node->parent->right == node);
+		}
+		huff->code[i] = code;
+		huff->codelen[i] = (node && len <= 32)?len:0;
+	}
+
+	for (i = 0; i < (1<<HUFF_LOOKUPBITS); i++) {
+		node = huff->decompressor.tree;
+		for (len = 0; node && node->symbol == INTERNAL_NODE && len < HUFF_LOOKUPBITS; len++) {
+			node = ((i>>len)&1)?node->right:node->left;
+		}
+		if (node && node->symbol != INTERNAL_NODE) {
+			huff->lookup[i] = node->symbol | (len<<9);
+			huff->lookupnode[i] = NULL;
+		} else {
+			huff->lookup[i] = 0;
+			huff->lookupnode[i] = node;
+		}
+	}
+}
+
 static void Huff_Decompress(sizebuf_t *mbuf, int offset) {
 	int			ch, cch, i, j, size;
 	qbyte		seq[65536];
@@ -486,6 +565,7 @@ static void Huff_Init(huffman_t *huff)
 			Huff_addRef(&huff->decompressor,	(qbyte)i);
 		}
 	}
+	Huff_buildTables(huff);
 	huff->built = true;
 }
 
@@ -568,14 +648,17 @@ int Huff_GetByte(qbyte *buffer, int *count)
 }
 void Huff_EmitByte(int ch, qbyte *buffer, int *count)
 {
-	Huff_offsetTransmit(&q3huff.compressor, ch, buffer, count);
+	if (q3huff.built)
+		Huff_tableTransmit(&q3huff, ch, buffer, count);
+	else
+		Huff_offsetTransmit(&q3huff.compressor, ch, buffer, count);
 }
 
 void Huff_CompressPacket(huffman_t *huff, sizebuf_t *msg, int offset)
 {
-	qbyte	buffer[MAX_OVERALLMSGLEN];
+	qbyte	buffer[MAX_OVERALLMSGLEN+8];	//the last symbol can overshoot a little before we notice.
 	qbyte	*data;
-	int		outLen;
+	int		outLen, outBytes;
 	int		inLen;
 	int		i;
 
@@ -587,24 +670,17 @@ void Huff_CompressPacket(huffman_t *huff, sizebuf_t *msg, int offset)
 		return;
 	}
 
-	outLen = 0;
+	outLen = 0;	//in bits
 	for (i=0; i < inLen; i++)
 	{
-		Huff_offsetTransmit(&huff->compressor, data[i], buffer, &outLen);
+		Huff_tableTransmit(huff, data[i], buffer, &outLen);
 
-		if (outLen > inLen)
-			break;
-		if (outLen > MAX_OVERALLMSGLEN-64)
-		{
-			Con_Printf("Huffman overflow\n");
-			//panic
-			data[0] = 0x80;
-			msg->cursize = offset+1;
-			return;
-		}
+		if ((outLen>>3) >= inLen)
+			break;	//its not going to get any smaller now.
 	}
+	outBytes = (outLen+7)>>3;
 
-	if (outLen > inLen)
+	if (outBytes >= inLen)
 	{
 		memmove(data+1, data, inLen);
 		data[0] = 0x80;	//this would have grown the packet.
@@ -612,22 +688,22 @@ void Huff_CompressPacket(huffman_t *huff, sizebuf_t *msg, int offset)
 		return;	//cap it at only 1 qbyte growth.
 	}
 
-	msg->cursize = offset + outLen;
-	{	//add the bitcount
-		data[0] = (outLen<<3) - outLen;
+	msg->cursize = offset + outBytes;
+	{	//add the number of padding bits
+		data[0] = (outBytes<<3) - outLen;
 		data+=1;
 		msg->cursize+=1;
 	}
 	if (msg->cursize > msg->maxsize)
 		Sys_Error("Compression became too large\n");
-	memcpy(data, buffer, outLen);
+	memcpy(data, buffer, outBytes);
 }
 void Huff_DecompressPacket(huffman_t *huff, sizebuf_t *msg, int offset)
 {
 	qbyte	buffer[MAX_OVERALLMSGLEN];
 	qbyte	*data;
 	int		outLen;
-	int		inLen;
+	int		inLen, safeLen;
 	int		i, ch;
 
 	data = msg->data + offset;
@@ -649,12 +725,18 @@ void Huff_DecompressPacket(huffman_t *huff, sizebuf_t *msg, int offset)
 		data+=1;
 	}
 
+	//the lookups read a couple of bytes ahead, so the last few symbols walk the tree instead to stay inside the packet.
+	safeLen = (msg->cursize - offset - 1 - 2)<<3;
+
 	outLen = 0;
 	for(i=0; outLen < inLen; i++)
 	{
 		if (i == MAX_OVERALLMSGLEN)
 			Sys_Error("Decompression became too large\n");
-		Huff_offsetReceive (huff->decompressor.tree, &ch, data, &outLen);
+		if (outLen < safeLen)
+			ch = Huff_tableReceive (huff, data, &outLen);
+		else
+			Huff_offsetReceive (huff->decompressor.tree, &ch, data, &outLen);
 		buffer[i] = ch;
 	}
 	
@@ -149,6 +149,7 @@ qboolean	NET_GetRates(struct ftenet_connections_s *collection, float *pi, float
 qboolean	NET_UpdateRates(struct ftenet_connections_s *collection, qboolean inbound, size_t size);	//for demos to not be weird
 void		NET_ReadPackets (struct ftenet_connections_s *collection);
 neterr_t	NET_SendPacket (struct ftenet_connections_s *col, int length, const void *data, netadr_t *to);
+void		NET_BatchSends(struct ftenet_connections_s *collection, qboolean batch);
 int			NET_LocalAddressForRemote(struct ftenet_connections_s *collection, netadr_t *remote, netadr_t *local, int idx);
 void		NET_PrintAddresses(struct ftenet_connections_s *collection);
 qboolean	NET_AddressSmellsFunny(netadr_t *a);
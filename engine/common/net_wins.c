@@ -18,6 +18,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 */
 // net_wins.c
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE	//for recvmmsg+sendmmsg
+#endif
 #include "quakedef.h"
 #include "netinc.h"
 #include <stddef.h>
@@ -92,6 +95,10 @@ static cvar_t	net_enable_kexlobby			= CVARD("net_enable_"KEXLOBBY,			"0", "If en
 int epoll_fd = -1;
 #endif
 
+#if defined(HAVE_PACKET) && defined(__linux__) && defined(_GNU_SOURCE) && defined(MSG_WAITFORONE) && !defined(ANDROID)
+	#define HAVE_MMSG	//batched datagram syscalls (linux 3.0+), saves a syscall per packet on busy servers.
+#endif
+
 void NET_GetLocalAddress (int socket, netadr_t *out);
 //int TCP_OpenListenSocket (const char *localip, int port);
 #ifdef HAVE_IPV6
@@ -3921,6 +3928,135 @@ int FTENET_Generic_GetLocalAddresses(struct ftenet_generic_connection_s *con, un
 #endif
 }
 
+#ifdef HAVE_MMSG
+#define DGRAM_BATCH		16	//max packets per recvmmsg/sendmmsg call
+struct dgrambatch_s
+{
+	//incoming packets are read in one go and then handed out to net_message one at a time.
+	unsigned int inpos;
+	unsigned int incount;
+	struct mmsghdr inmsg[DGRAM_BATCH];
+	struct iovec iniov[DGRAM_BATCH];
+	struct sockaddr_qstorage infrom[DGRAM_BATCH];
+	qbyte *inbuf;	//DGRAM_BATCH*MAX_OVERALLMSGLEN
+
+	//outgoing packets are copied here while queuing, and flushed when full or when NET_BatchSends ends the batch.
+	qboolean queue;
+	unsigned int outcount;
+	size_t outbytes;
+	struct mmsghdr outmsg[DGRAM_BATCH];
+	struct iovec outiov[DGRAM_BATCH];
+	struct sockaddr_qstorage outto[DGRAM_BATCH];
+	qbyte outbuf[MAX_OVERALLMSGLEN];
+};
+
+static struct dgrambatch_s *FTENET_Datagram_CreateBatch(void)
+{
+	struct dgrambatch_s *b = Z_Malloc(sizeof(*b));
+	int i;
+	b->inbuf = BZ_Malloc(DGRAM_BATCH*MAX_OVERALLMSGLEN);	//not cleared, the kernel only touches pages that are actually used.
+	for (i = 0; i < DGRAM_BATCH; i++)
+	{
+		b->iniov[i].iov_base = b->inbuf + i*MAX_OVERALLMSGLEN;
+		b->iniov[i].iov_len = MAX_OVERALLMSGLEN;
+		b->inmsg[i].msg_hdr.msg_iov = &b->iniov[i];
+		b->inmsg[i].msg_hdr.msg_iovlen = 1;
+		b->inmsg[i].msg_hdr.msg_name = &b->infrom[i];
+
+		b->outmsg[i].msg_hdr.msg_iov = &b->outiov[i];
+		b->outmsg[i].msg_hdr.msg_iovlen = 1;
+		b->outmsg[i].msg_hdr.msg_name = &b->outto[i];
+	}
+	return b;
+}
+
+//same semantics as recvfrom into net_message_buffer, but only does a syscall once the previous batch is used up.
+static int FTENET_Datagram_BatchRecv(struct dgrambatch_s *b, SOCKET sock, struct sockaddr_qstorage *from, int *fromlen)
+{
+	struct mmsghdr *m;
+	int i, ret;
+	if (b->inpos == b->incount)
+	{
+		b->inpos = b->incount = 0;
+		for (i = 0; i < DGRAM_BATCH; i++)
+		{
+			b->inmsg[i].msg_hdr.msg_namelen = sizeof(b->infrom[i]);
+			((struct sockaddr*)&b->infrom[i])->sa_family = AF_UNSPEC;
+		}
+		ret = recvmmsg(sock, b->inmsg, DGRAM_BATCH, MSG_DONTWAIT, NULL);
+		if (ret < 1)
+			return -1;	//errno is left for the caller to report.
+		b->incount = ret;
+	}
+	i = b->inpos++;
+	m = &b->inmsg[i];
+	*fromlen = m->msg_hdr.msg_namelen;
+	memcpy(from, &b->infrom[i], *fromlen);
+	if (m->msg_hdr.msg_flags & MSG_TRUNC)
+		return sizeof(net_message_buffer);	//caller will complain about it being oversized.
+	memcpy(net_message_buffer, b->iniov[i].iov_base, m->msg_len);
+	return m->msg_len;
+}
+
+static void FTENET_Datagram_Flush(struct dgrambatch_s *b, SOCKET sock)
+{
+	unsigned int i = 0;
+	int ret;
+	while (i < b->outcount)
+	{
+		ret = sendmmsg(sock, b->outmsg+i, b->outcount-i, 0);
+		if (ret > 0)
+			i += ret;
+		else if (neterrno() == NET_EWOULDBLOCK)
+			break;	//buffers are full, the rest would have been dropped by sendto too.
+		else
+			i++;	//failed to send to that one (unreachable or whatever). its a datagram, so just skip it.
+	}
+	b->outcount = 0;
+	b->outbytes = 0;
+}
+
+//returns false if the packet needs to be sent directly
+static qboolean FTENET_Datagram_BatchSend(struct dgrambatch_s *b, SOCKET sock, int length, const void *data, struct sockaddr_qstorage *addr, int addrsize)
+{
+	unsigned int i;
+	if (b->outcount == DGRAM_BATCH || b->outbytes + length > sizeof(b->outbuf))
+		FTENET_Datagram_Flush(b, sock);	//make space (also keeps ordering for huge packets)
+	if (length > sizeof(b->outbuf))
+		return false;
+	i = b->outcount++;
+	memcpy(b->outbuf+b->outbytes, data, length);
+	b->outiov[i].iov_base = b->outbuf+b->outbytes;
+	b->outiov[i].iov_len = length;
+	memcpy(&b->outto[i], addr, addrsize);
+	b->outmsg[i].msg_hdr.msg_namelen = addrsize;
+	b->outbytes += length;
+	return true;
+}
+#endif
+
+//queues packets sent via udp sockets in this collection until batch is cleared again, at which point they're all flushed with as few syscalls as possible.
+//errors are not reported back while batching, so only use it for traffic where the only response to an error would be to drop the packet.
+void NET_BatchSends(ftenet_connections_t *collection, qboolean batch)
+{
+#ifdef HAVE_MMSG
+	ftenet_generic_connection_t *con;
+	size_t c;
+	if (!collection)
+		return;
+	for (c = 0; c < MAX_CONNECTIONS; c++)
+	{
+		con = collection->conn[c];
+		if (con && con->batch)
+		{
+			con->batch->queue = batch;
+			if (!batch)
+				FTENET_Datagram_Flush(con->batch, con->thesocket);
+		}
+	}
+#endif
+}
+
 qboolean FTENET_Datagram_GetPacket(ftenet_generic_connection_t *con)
 {
 #ifndef HAVE_PACKET
@@ -3937,6 +4073,11 @@ qboolean FTENET_Datagram_GetPacket(ftenet_generic_connection_t *con)
 
 	fromlen = sizeof(from);
 	((struct sockaddr*)&from)->sa_family = AF_UNSPEC;
+#ifdef HAVE_MMSG
+	if (con->batch)
+		ret = FTENET_Datagram_BatchRecv(con->batch, con->thesocket, &from, &fromlen);
+	else
+#endif
 	ret = recvfrom (con->thesocket, (char *)net_message_buffer, sizeof(net_message_buffer), 0, (struct sockaddr*)&from, &fromlen);
 
 	if (ret == -1)
@@ -4051,6 +4192,10 @@ neterr_t FTENET_Datagram_SendPacket(ftenet_generic_connection_t *con, int length
 
 	if (!data)
 		ret = 0;	//don't send a runt, but pretend we did... yes, this'll confuse EnsureRoute, but at least it'll ensure there's a udp socket open, somewhere.
+#ifdef HAVE_MMSG
+	else if (con->batch && con->batch->queue && FTENET_Datagram_BatchSend(con->batch, con->thesocket, length, data, &addr, size))
+		return NETERR_SENT;	//we'll find out if it actually went later... or not.
+#endif
 	else
 		ret = sendto (con->thesocket, data, length, 0, (struct sockaddr*)&addr, size );
 	if (ret == -1)
@@ -4152,11 +4297,22 @@ static void FTENET_Datagram_Close(ftenet_generic_connection_t *con)
 {
 	if (con->thesocket != INVALID_SOCKET)
 	{
+#ifdef HAVE_MMSG
+		if (con->batch)
+			FTENET_Datagram_Flush(con->batch, con->thesocket);
+#endif
 #ifdef HAVE_EPOLL
 		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, con->thesocket, NULL);
 #endif
 		closesocket(con->thesocket);
 	}
+#ifdef HAVE_MMSG
+	if (con->batch)
+	{
+		BZ_Free(con->batch->inbuf);
+		Z_Free(con->batch);
+	}
+#endif
 	Z_Free(con);
 }
 #endif
@@ -4403,6 +4559,10 @@ ftenet_generic_connection_t *FTENET_Datagram_EstablishConnection(ftenet_connecti
 		}
 
 		newcon->thesocket = newsocket;
+#ifdef HAVE_MMSG
+		if (isserver)	//clients don't really receive enough to benefit.
+			newcon->batch = FTENET_Datagram_CreateBatch();
+#endif
 
 #ifdef HAVE_EPOLL
 		{
@@ -343,6 +343,7 @@ typedef struct ftenet_generic_connection_s {
 
 #ifdef HAVE_PACKET
 	SOCKET thesocket;
+	struct dgrambatch_s *batch;	//for recvmmsg/sendmmsg, where supported.
 #else
 	int thesocket;
 #endif
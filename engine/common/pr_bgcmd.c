@@ -22,6 +22,7 @@ cvar_t sv_gameplayfix_linknonsolid = CVARD("sv_gameplayfix_nolinknonsolid", "1",
 cvar_t sv_gameplayfix_blowupfallenzombies = CVARD("sv_gameplayfix_blowupfallenzombies", "0", "Allow findradius to find non-solid entities. This may break certain mods. It is better for mods to use FL_FINDABLE_NONSOLID instead.");
 cvar_t sv_gameplayfix_findradiusdistancetobox = CVARD("sv_gameplayfix_findradiusdistancetobox", "0", "When 1, findradius checks to the nearest part of the entity instead of only its origin, making it find slightly more entities.");
 cvar_t sv_gameplayfix_droptofloorstartsolid = CVARD("sv_gameplayfix_droptofloorstartsolid", "0", "When droptofloor fails, this causes a second attemp, but with traceline instead.");
+cvar_t sv_areahash = CVARD("sv_areahash", "0", "When set, entities smaller than this many units across are tracked in a spatial hash with cells of this size, instead of the world's regular collision nodes. This can be much faster on huge maps with lots of entities. Takes effect on the next map.");
 cvar_t dpcompat_findradiusarealinks = CVARD("dpcompat_findradiusarealinks", "0", "Use the world collision info to accelerate findradius instead of looping through every single entity. May actually be slower for large radiuses, or fail to find entities which have not been linked properly with setorigin.");
 #ifdef HAVE_LEGACY
 cvar_t dpcompat_strcat_limit = CVARD("dpcompat_strcat_limit", "", "When set, cripples strcat (and related function) string lengths to the value specified.\nSet to 16383 to replicate DP's limit, otherwise leave as 0 to avoid limits.");
@@ -37,6 +38,11 @@ cvar_t pr_gc_threaded = CVARD("pr_gc_threaded", "1", "Says whether to use a sepa
 #else
 cvar_t pr_gc_threaded = CVARFD("pr_gc_threaded", "0", CVAR_NOSET|CVAR_NOSAVE, "Says whether to use a separate thread for tempstring garbage collections. This avoids main-thread stalls but at the expense of more memory usage.");
 #endif
+#ifdef QCJIT
+cvar_t pr_jit = CVARD("pr_jit", "1", "Translate QC into native code when the progs is loaded, falling back to the interpreter for anything it can't handle. Set to 0 to always use the interpreter. Takes effect on the next map.");
+#else
+cvar_t pr_jit = CVARFD("pr_jit", "0", CVAR_NOSET|CVAR_NOSAVE, "Translate QC into native code when the progs is loaded. Not supported by this build.");
+#endif
 cvar_t	pr_sourcedir = CVARD("pr_sourcedir", "src", "Subdirectory where your qc source is located. Used by the internal compiler and qc debugging functionality.");
 cvar_t pr_enable_uriget = CVARD("pr_enable_uriget", "1", "Allows gamecode to make direct http requests");
 cvar_t pr_enable_profiling = CVARD("pr_enable_profiling", "0", "Enables profiling support. Will run more slowly. Change the map and then use the profile_ssqc/profile_csqc commands to see the results.");
@@ -51,6 +57,7 @@ void skel_info_f(void);
 void skel_generateragdoll_f(void);
 void *PR_PointerToNative_Resize(pubprogfuncs_t *inst, pint_t ptr, size_t offset, size_t datasize);			//dangerous version
 void *PR_PointerToNative_MoInvalidate(pubprogfuncs_t *inst, pint_t ptr, size_t offset, size_t datasize);	//safer faily version.
+void PR_WakePointer(pubprogfuncs_t *inst, pint_t ptr, size_t datasize);	//wakes any sleeping entity that a write there would change.
 
 #ifdef __SSE2__
 #include "xmmintrin.h"
@@ -90,6 +97,7 @@ void PF_Common_RegisterCvars(void)
 	Cvar_Register (&sv_gameplayfix_findradiusdistancetobox, cvargroup_progs);
 	Cvar_Register (&sv_gameplayfix_linknonsolid, cvargroup_progs);
 	Cvar_Register (&sv_gameplayfix_droptofloorstartsolid, cvargroup_progs);
+	Cvar_Register (&sv_areahash, cvargroup_progs);
 	Cvar_Register (&dpcompat_findradiusarealinks, cvargroup_progs);
 #ifdef HAVE_LEGACY
 	Cvar_Register (&dpcompat_strcat_limit, cvargroup_progs);
@@ -99,6 +107,7 @@ void PF_Common_RegisterCvars(void)
 	Cvar_Register (&pr_tempstringcount, cvargroup_progs);
 	Cvar_Register (&pr_tempstringsize, cvargroup_progs);
 	Cvar_Register (&pr_gc_threaded, cvargroup_progs);
+	Cvar_Register (&pr_jit, cvargroup_progs);
 #ifdef WEBCLIENT
 	Cvar_Register (&pr_enable_uriget, cvargroup_progs);
 #endif
@@ -4230,6 +4239,7 @@ void QCBUILTIN PF_copyentity (pubprogfuncs_t *prinst, struct globalvars_s *pr_gl
 	if (out->fieldsize != in->fieldsize)
 		PR_BIError(prinst, "PF_copyentity: different object types");
 
+	WPhys_WakeEdict(w, out);
 	memcpy(out->v, in->v, out->fieldsize);
 	World_LinkEdict(w, out, false);
 
@@ -6627,6 +6637,7 @@ void QCBUILTIN PF_droptofloor (pubprogfuncs_t *prinst, struct globalvars_s *pr_g
 	const pvec_t *gravitydir;
 
 	ent = PROG_TO_WEDICT(prinst, *world->g.self);
+	WPhys_WakeEdict(world, ent);
 
 	if (ent->xv->gravitydir[2] || ent->xv->gravitydir[1] || ent->xv->gravitydir[0])
 		gravitydir = ent->xv->gravitydir;
@@ -7978,7 +7989,10 @@ void *PR_GetWriteQCPtr(pubprogfuncs_t *prinst, int qcptr, int qcsize)
 	if (qcptr >= 0 && qcptr <= prinst->stringtablemaxsize)
 	{
 		if (qcptr + qcsize <= prinst->stringtablemaxsize)
+		{
+			PR_WakePointer(prinst, qcptr, qcsize);
 			return prinst->stringtable+qcptr;	//its in bounds
+		}
 	}
 	/*else
 	{
@@ -16,6 +16,7 @@ extern "C" {
 		int				entnum;
 		unsigned int	fieldsize;
 		pbool			readonly;	//world
+		pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 #ifdef VM_Q1
 		comentvars_t* v;
 		comextentvars_t* xv;
@@ -32,6 +33,7 @@ extern "C" {
 #else
 		link_t	area;
 #endif
+		areahashlink_t	areahash;
 		pvscache_t pvsinfo;
 		int lastruntime;
 		int solidsize;
@@ -86,6 +88,7 @@ extern "C" {
 	extern cvar_t pr_enable_profiling;
 	extern cvar_t pr_fixbrokenqccarrays;
 	extern cvar_t pr_gc_threaded;
+	extern cvar_t pr_jit;
 
 	extern int qcinput_scan;
 	extern int qcinput_unicode;
@@ -1261,6 +1264,7 @@ extern "C" {
 		int				entnum;
 		unsigned int	fieldsize;
 		pbool			readonly;	//world
+		pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 #ifdef VM_Q1
 		csqcentvars_t* v;
 		csqcextentvars_t* xv;
@@ -1277,6 +1281,7 @@ extern "C" {
 #else
 		link_t	area;
 #endif
+		areahashlink_t	areahash;
 		pvscache_t pvsinfo;
 		int lastruntime;
 		int solidsize;
@@ -109,11 +109,15 @@ qboolean Sys_GetDesktopParameters(int *width, int *height, int *bpp, int *refres
 	#define FTE_Atomic32_Inc(ptr) __sync_add_and_fetch(ptr, 1)	//returns the AFTER the operation.
 	#define FTE_Atomic32_Dec(ptr) __sync_add_and_fetch(ptr, -1)	//returns the AFTER the operation.
 	#define FTE_Atomic_Insert(head, newnode, newnodenext) do newnodenext = head; while(!__sync_bool_compare_and_swap(&head, newnodenext, newnode)) //atomically insert into a linked list, being sure to not corrupt the pointers
+	#define FTE_AtomicPtr_Load(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)	//sees everything written before the matching store.
+	#define FTE_AtomicPtr_Store(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
 #elif defined(_WIN32)
 	#define qatomic32_t long
 	#define FTE_Atomic32_Inc(ptr) _InterlockedIncrement(ptr)
 	#define FTE_Atomic32_Dec(ptr) _InterlockedDecrement(ptr)
 	#define FTE_Atomic_Insert(head, newnode, newnodenext) do newnodenext = head; while(newnodenext != _InterlockedCompareExchangePointer(&head, newnode, newnodenext))
+	#define FTE_AtomicPtr_Load(ptr) _InterlockedCompareExchangePointer((void*volatile*)(ptr), NULL, NULL)
+	#define FTE_AtomicPtr_Store(ptr, val) _InterlockedExchangePointer((void*volatile*)(ptr), val)
 #else
 	#define qatomic32_t qint32_t
 	#define FTE_Atomic32_Inc(ptr) FTE_Atomic32Mutex_Add(ptr, 1)
@@ -126,7 +130,8 @@ typedef enum wgroup_e
 {
 	WG_MAIN		= 0,
 	WG_LOADER	= 1,
-	WG_COUNT	= 2 //main and loaders
+	WG_COMPUTE	= 2,	//for COM_ParallelFor. these never block on anything, unlike loaders.
+	WG_COUNT	= 3 //main, loaders, compute
 } wgroup_t;
 typedef struct
 {
@@ -59,6 +59,7 @@ static void *Sys_CreatedThread(void *v)
 	qintptr_t r;
 
 	r = qthread->func(qthread->args);
+	Z_FlushThreadCache();
 
 	return (void*)r;
 }
@@ -120,6 +120,7 @@ unsigned int WINAPI threadwrapper(void *args)
 		free(args);
 		tw.func(tw.args);
 	}
+	Z_FlushThreadCache();
 
 #ifndef WIN32CRTDLL
 	_endthreadex(0);
@@ -175,6 +175,23 @@ typedef struct wedict_s wedict_t;
 #define WEDICT_NUM_PB (wedict_t *)EDICT_NUM_PB	//pre-bound
 #define G_WEDICT (wedict_t *)G_EDICT
 
+//optional loose spatial hash (see sv_areahash). ents are filed under the cell containing their centre, anything wider than a cell stays in the regular structures.
+typedef struct
+{
+	wedict_t **ents;
+	unsigned int numents;
+	unsigned int maxents;
+	size_t sequence;	//last walk that visited this cell, so hash collisions don't get walked twice.
+} areahashcell_t;
+typedef struct areahash_s
+{
+	float cellsize;
+	float scale;		//1/cellsize
+	unsigned int mask;	//numcells-1
+	size_t sequence;
+	areahashcell_t *cells;
+} areahash_t;
+
 typedef struct
 {
 	qboolean present;
@@ -224,6 +241,14 @@ struct world_s
 	unsigned int	spawncount;	//number of times it got restarted, so we can stop events from happening after vm restarts
 	qboolean		remasterlogic;	//workarounds needed
 
+	areahash_t		*areahash;	//null when disabled.
+	struct
+	{
+		unsigned int traces;
+		unsigned int cells;	//areas/nodes/cells visited
+		unsigned int tests;	//ents considered
+	} areastats;
+
 #ifdef USEAREAGRID
 	vec2_t			gridbias;
 	vec2_t			gridscale;
@@ -235,6 +260,22 @@ struct world_s
 
 	double		physicstime;		// the last time global physics were run
 	unsigned int    framenum;
+
+	struct
+	{	//idle ents that the physics walk skips. see WPhys_TrySleep.
+		unsigned int	*awake;		//bit per ent. ents past maxents are always awake.
+		float			*thinktime;	//[maxents] nextthink a sleeper is waiting on, or 0.
+		unsigned int	maxents;
+		struct
+		{
+			float time;
+			unsigned int entnum;
+		}				*heap;		//min-heap of pending thinks. entries not matching thinktime[entnum] are stale.
+		unsigned int	numheap;
+		unsigned int	maxheap;
+		unsigned int	walkpos;	//the physics walk has already been past every ent before this one this frame.
+		double			runtime[2];	//physicstime of this frame and the last, for bringing woken ents up to date.
+	} sleep;
 	int			lastcheck;			// used by PF_checkclient
 	double		lastchecktime;		// for monster ai
 	qbyte		*lastcheckpvs;		// for monster ai
@@ -336,12 +377,16 @@ void QDECL World_LinkEdict (world_t *w, wedict_t *ent, qboolean touch_triggers);
 extern int World_AreaEdicts (world_t *w, vec3_t mins, vec3_t maxs, wedict_t **list, int maxcount, int areatype);
 
 #ifdef USEAREAGRID
-void World_TouchAllLinks (world_t *w, wedict_t *ent);
 extern size_t areagridsequence;
 #else
 void World_TouchLinks (world_t *w, wedict_t *ent, areanode_t *node);
-#define World_TouchAllLinks(w,e) World_TouchLinks(w,e,(w)->areanodes)
 #endif
+void World_TouchAllLinks (world_t *w, wedict_t *ent);
+
+//calls func for each ent in the world's areahash that might be within the box. does no bounds checks itself.
+//func must not relink anything, and returns false to stop early. returns the number of cells visited.
+unsigned int World_AreaHash_Walk (world_t *w, const vec3_t mins, const vec3_t maxs, qboolean (*func)(world_t *w, wedict_t *ent, void *ctx), void *ctx);
+void World_PrintAreaStats (world_t *w);
 
 int World_PointContentsWorldOnly (world_t *w, vec3_t p);
 int World_PointContentsAllBSPs (world_t *w, vec3_t p);
@@ -393,6 +438,8 @@ qboolean World_GetEntGravityAxis(wedict_t *ent, vec3_t axis[3]);
 //
 void WPhys_Init(void);
 void World_Physics_Frame(world_t *w);
+void WPhys_WakeEdict(world_t *w, wedict_t *ent);
+void WPhys_WakeAll(world_t *w);
 void SV_SetMoveVars(void);
 void WPhys_RunNewmis (world_t *w);
 qboolean SV_Physics (void);
@@ -58,116 +58,212 @@ qbyte sentinelkey;
 size_t zmemtotal;
 size_t zmemdelta;
 
-typedef struct memheader_s {
-	size_t size;
+//tagged allocations are tracked per-tag so that Z_FreeTags can drop a whole list without walking every other tag.
+//blocks are rounded up to a power-of-two size class, and freed blocks are kept in a small per-thread cache so that qc/lua string churn doesn't hit malloc each time.
+#define ZONE_MINCLASSSHIFT	4	//16 bytes
+#define ZONE_NUMCLASSES		9	//16...4096 bytes. bigger allocations always go through malloc.
+#define ZONE_NOCLASS		0xff
+#define ZONE_CACHELIMIT		64	//max blocks per size class per thread (so at most ~512kb sitting idle per thread).
+#define ZONE_TAGBUCKETS		64
+
+typedef struct zonetag_s
+{
+	struct zonetag_s *hashnext;	//never unlinked once created.
+	struct zone_s *first;
 	int tag;
-} memheader_t;
+#ifdef MULTITHREAD
+	void *lock;
+#endif
+	//stats, for hunkprint.
+	size_t blocks;
+	size_t bytes;
+	size_t peakbytes;
+	size_t totalallocs;
+} zonetag_t;
 
 typedef struct zone_s {
-	struct zone_s *next;
-	struct zone_s *pvdn; // down if first, previous if not
-	memheader_t mh;
+	union
+	{
+		struct
+		{
+			struct zone_s *next;
+			struct zone_s *prev;
+			zonetag_t *owner;
+			size_t size;
+			size_t sizeclass;	//ZONE_NOCLASS if it came straight from malloc.
+		};
+		qbyte align16[(sizeof(void*)*3+sizeof(size_t)*2+15)&~15];	//callers expect malloc-grade alignment (lua, q2 gamecode, qvm edicts), so keep the header a multiple of 16.
+	};
 } zone_t;
-zone_t *zone_head;
+typedef int zone_t_align16_check[(sizeof(zone_t)%16)?-1:1];
+static zonetag_t *zone_tags[ZONE_TAGBUCKETS];
 #ifdef MULTITHREAD
 void *zonelock;
 #endif
 
-#if 0
-static void Z_DumpTree(void)
+#if !defined(MULTITHREAD)
+	#define ZONE_TLS
+#elif defined(__GNUC__)
+	#define ZONE_TLS __thread
+#elif defined(_MSC_VER)
+	#define ZONE_TLS __declspec(thread)
+#else
+	#define ZONE_NOCACHE	//no idea how to do thread-local storage here, just use malloc.
+#endif
+#ifndef ZONE_NOCACHE
+typedef struct
 {
-	zone_t *zone;
-	zone_t *nextlist;
-	zone_t *t;
-	zone_t *prev;
-
-	zone = zone_head;
-	while(zone)
-	{
-		nextlist = zone->pvdn;
-
-		fprintf(stderr, " +-+ %016x (tag: %08x)\n", zone, zone->mh.tag);
-
-		prev = zone;
-		t = zone->next;
-		while(t)
-		{
-			if (t->pvdn != prev)
-				fprintf(stderr, "Previous link failure\n");
-
-			prev = t;
-			t = t->next;
-		}
-
-		while(zone)
-		{
-			fprintf(stderr, "   +-- %016x\n", zone);
-
-			zone = zone->next;
-		}
+	zone_t *free[ZONE_NUMCLASSES];
+	unsigned int count[ZONE_NUMCLASSES];
+	size_t hits;
+	size_t misses;
+} zonecache_t;
+static ZONE_TLS zonecache_t zone_cache;
+#endif
 
-		zone = nextlist;
-	}
+static size_t Z_SizeClass(size_t size)
+{
+	size_t c;
+	for (c = 0; c < ZONE_NUMCLASSES; c++)
+		if (size <= ((size_t)1<<(c+ZONE_MINCLASSSHIFT)))
+			return c;
+	return ZONE_NOCLASS;
 }
-#endif
 
-void *Z_TagMalloc(size_t size, int tag)
+static zonetag_t *Z_FindTag(int tag, qboolean create)
 {
-	zone_t *zone;
+	unsigned int bucket = (unsigned int)tag % ZONE_TAGBUCKETS;
+	zonetag_t *t;
 
-	zone = (zone_t *)malloc(size + sizeof(zone_t));
-	if (!zone)
-		Sys_Error("Z_Malloc: Failed on allocation of %"PRIuSIZE" bytes", size);
-	Q_memset(zone, 0, size + sizeof(zone_t));
-	zone->mh.tag = tag;
-	zone->mh.size = size;
+#if defined(MULTITHREAD) && defined(FTE_AtomicPtr_Load)
+	//records are only ever prepended (with a release store) and never removed, so we can walk it without locking.
+	for (t = FTE_AtomicPtr_Load(&zone_tags[bucket]); t; t = t->hashnext)
+		if (t->tag == tag)
+			return t;
+	if (!create)
+		return NULL;
+#endif
 
 #ifdef MULTITHREAD
-	if (zonelock)
+	if (zonelock)	//tags can be created before Memory_Init, while we're still single-threaded.
 		Sys_LockMutex(zonelock);
 #endif
-
-#if 0
-	fprintf(stderr, "Before alloc:\n");
-	Z_DumpTree();
-	fprintf(stderr, "\n");
+	//someone else may have created it while we were waiting.
+	for (t = zone_tags[bucket]; t; t = t->hashnext)
+		if (t->tag == tag)
+			break;
+	if (!t && create)
+	{
+		t = calloc(1, sizeof(*t));
+		if (!t)
+			Sys_Error("Z_TagMalloc: Failed to allocate tag %i", tag);
+		t->tag = tag;
+#ifdef MULTITHREAD
+		t->lock = Sys_CreateMutex();
+#endif
+		t->hashnext = zone_tags[bucket];
+#if defined(MULTITHREAD) && defined(FTE_AtomicPtr_Store)
+		FTE_AtomicPtr_Store(&zone_tags[bucket], t);
+#else
+		zone_tags[bucket] = t;
+#endif
+	}
+#ifdef MULTITHREAD
+	if (zonelock)
+		Sys_UnlockMutex(zonelock);
 #endif
+	return t;
+}
 
-	if (zone_head == NULL)
-		zone_head = zone;
+static zone_t *Z_BlockAlloc(size_t size)
+{
+	size_t sc = Z_SizeClass(size);
+	zone_t *zone;
+	if (sc == ZONE_NOCLASS)
+		zone = calloc(1, sizeof(zone_t) + size);
 	else
 	{
-		zone_t *s = zone_head;
-
-		while (s && s->mh.tag != tag)
-			s = s->pvdn;
-
-		if (s)
-		{ // tag match
-			zone->next = s->next;
-			if (s->next)
-				s->next->pvdn = zone;
-			zone->pvdn = s;
-			s->next = zone;
+#ifndef ZONE_NOCACHE
+		zone = zone_cache.free[sc];
+		if (zone)
+		{
+			zone_cache.free[sc] = zone->next;
+			zone_cache.count[sc]--;
+			zone_cache.hits++;
+			memset(zone, 0, sizeof(zone_t) + size);
 		}
 		else
 		{
-			zone->pvdn = zone_head;
-		//	if (s->next)
-		//		s->next->pvdn = zone;
-			zone_head = zone;
+			zone_cache.misses++;
+			zone = calloc(1, sizeof(zone_t) + ((size_t)1<<(sc+ZONE_MINCLASSSHIFT)));
 		}
+#else
+		zone = calloc(1, sizeof(zone_t) + ((size_t)1<<(sc+ZONE_MINCLASSSHIFT)));
+#endif
+	}
+	if (!zone)
+		Sys_Error("Z_Malloc: Failed on allocation of %"PRIuSIZE" bytes", size);
+	zone->size = size;
+	zone->sizeclass = sc;
+	return zone;
+}
+static void Z_BlockFree(zone_t *zone)
+{
+#ifndef ZONE_NOCACHE
+	size_t sc = zone->sizeclass;
+	if (sc != ZONE_NOCLASS && zone_cache.count[sc] < ZONE_CACHELIMIT)
+	{
+		zone->next = zone_cache.free[sc];
+		zone_cache.free[sc] = zone;
+		zone_cache.count[sc]++;
+		return;
 	}
-
-#if 0
-	fprintf(stderr, "After alloc:\n");
-	Z_DumpTree();
-	fprintf(stderr, "\n");
 #endif
+	free(zone);
+}
+//releases the calling thread's cached blocks back to the system. threads must call this before they exit, or their cache leaks.
+void Z_FlushThreadCache(void)
+{
+#ifndef ZONE_NOCACHE
+	size_t sc;
+	zone_t *zone;
+	for (sc = 0; sc < ZONE_NUMCLASSES; sc++)
+	{
+		while ((zone = zone_cache.free[sc]))
+		{
+			zone_cache.free[sc] = zone->next;
+			free(zone);
+		}
+		zone_cache.count[sc] = 0;
+	}
+#endif
+}
+
+void *Z_TagMalloc(size_t size, int tag)
+{
+	zonetag_t *t = Z_FindTag(tag, true);
+	zone_t *zone = Z_BlockAlloc(size);
+
+	zone->owner = t;
 
 #ifdef MULTITHREAD
-	if (zonelock)
-		Sys_UnlockMutex(zonelock);
+	if (t->lock)
+		Sys_LockMutex(t->lock);
+#endif
+	zone->prev = NULL;
+	zone->next = t->first;
+	if (t->first)
+		t->first->prev = zone;
+	t->first = zone;
+
+	t->blocks++;
+	t->bytes += size;
+	t->totalallocs++;
+	if (t->peakbytes < t->bytes)
+		t->peakbytes = t->bytes;
+#ifdef MULTITHREAD
+	if (t->lock)
+		Sys_UnlockMutex(t->lock);
 #endif
 
 	return (void *)(zone + 1);
@@ -279,58 +375,26 @@ void Z_StrCat(char **ptr, const char *append)
 void VARGS Z_TagFree(void *mem)
 {
 	zone_t *zone = ((zone_t *)mem) - 1;
-
-#if 0
-	fprintf(stderr, "Before free:\n");
-	Z_DumpTree();
-	fprintf(stderr, "\n");
-#endif
+	zonetag_t *t = zone->owner;
 
 #ifdef MULTITHREAD
-	if (zonelock)
-		Sys_LockMutex(zonelock);
+	if (t->lock)
+		Sys_LockMutex(t->lock);
 #endif
 	if (zone->next)
-		zone->next->pvdn = zone->pvdn;
-
-	if (zone->pvdn && zone->pvdn->mh.tag == zone->mh.tag)
-		zone->pvdn->next = zone->next;
+		zone->next->prev = zone->prev;
+	if (zone->prev)
+		zone->prev->next = zone->next;
 	else
-	{ // zone is first entry in a tag list 
-		zone_t *s = zone_head;
-
-		if (zone != s)
-		{ // traverse and update down list
-			while (s->pvdn != zone) 
-				s = s->pvdn;
-
-			if (zone->next)
-				s->pvdn = zone->next;
-			else
-				s->pvdn = zone->pvdn;
-		}
-	}
-
-	if (zone == zone_head)
-	{ // freeing head node so update head pointer
-		if (zone->next) // move to next, pvdn should be maintained properly
-			zone_head = zone->next;
-		else // no more entries with this tag so move head down
-			zone_head = zone->pvdn;
-	}
-
-#if 0
-	fprintf(stderr, "After free:\n");
-	Z_DumpTree();
-	fprintf(stderr, "\n");
-#endif
-
+		t->first = zone->next;
+	t->blocks--;
+	t->bytes -= zone->size;
 #ifdef MULTITHREAD
-	if (zonelock)
-		Sys_UnlockMutex(zonelock);
+	if (t->lock)
+		Sys_UnlockMutex(t->lock);
 #endif
 
-	free(zone);
+	Z_BlockFree(zone);
 }
 
 void VARGS Z_Free(void *mem)
@@ -340,48 +404,32 @@ void VARGS Z_Free(void *mem)
 
 void VARGS Z_FreeTags(int tag)
 {
+	zonetag_t *tl = Z_FindTag(tag, false);
 	zone_t *taglist;
 	zone_t *t;
 
+	if (!tl)
+		return;	//nothing was ever allocated with it.
+
 #ifdef MULTITHREAD
-	if (zonelock)
-		Sys_LockMutex(zonelock);
-#endif
-	if (zone_head)
-	{
-		if (zone_head->mh.tag == tag)
-		{ // just pull off the head
-			taglist = zone_head;
-			zone_head = zone_head->pvdn;
-		}
-		else
-		{ // search for tag list and isolate it
-			zone_t *z;
-			z = zone_head;
-			while (z->pvdn != NULL && z->pvdn->mh.tag != tag)
-				z = z->pvdn;
-
-			if (z->pvdn == NULL)
-				taglist = NULL;
-			else
-			{
-				taglist = z->pvdn;
-				z->pvdn = z->pvdn->pvdn;
-			}
-		}
-	}
-	else
-		taglist = NULL;
+	if (tl->lock)
+		Sys_LockMutex(tl->lock);
+#endif
+	//isolate the list, so we can free it without holding the lock
+	taglist = tl->first;
+	tl->first = NULL;
+	tl->blocks = 0;
+	tl->bytes = 0;
 #ifdef MULTITHREAD
-	if (zonelock)
-		Sys_UnlockMutex(zonelock);
+	if (tl->lock)
+		Sys_UnlockMutex(tl->lock);
 #endif
 
 	// actually free list
 	while (taglist != NULL)
 	{
 		t = taglist->next;
-		free(taglist);
+		Z_BlockFree(taglist);
 		taglist = t;
 	}
 }
@@ -741,6 +789,7 @@ void Cache_Flush(void)
 	Image_Purge();
 #endif
 
+	Z_FlushThreadCache();
 #ifdef __GLIBC__
 	malloc_trim(0);
 #endif
@@ -753,18 +802,31 @@ static void Hunk_Print_f (void)
 	//note: Zone memory isn't tracked reliably. we don't track the mem that is freed, so it'll just climb and climb
 	//we don't track reallocs either.
 
-#if 0
 	{
-		zone_t *zone;
-		int zoneused = 0;
-		int zoneblocks = 0;
-
-		for(zone = zone_head; zone; zone=zone->next)
+		zonetag_t *t;
+		unsigned int bucket;
+		for (bucket = 0; bucket < ZONE_TAGBUCKETS; bucket++)
 		{
-			zoneused += zone->size + sizeof(zone_t);
-			zoneblocks++;
+			for (t = zone_tags[bucket]; t; t = t->hashnext)
+			{
+#ifdef MULTITHREAD
+				if (t->lock)
+					Sys_LockMutex(t->lock);
+#endif
+				Con_Printf("Tag %i: %"PRIuSIZE" blocks, %"PRIuSIZE"KB (peak %"PRIuSIZE"KB, %"PRIuSIZE" allocs)\n", t->tag, t->blocks, t->bytes/1024, t->peakbytes/1024, t->totalallocs);
+#ifdef MULTITHREAD
+				if (t->lock)
+					Sys_UnlockMutex(t->lock);
+#endif
+			}
 		}
-		Con_Printf("Zone: %i containing %iKB\n", zoneblocks, zoneused/1024);
+	}
+#ifndef ZONE_NOCACHE
+	{
+		size_t sc, cached = 0;
+		for (sc = 0; sc < ZONE_NUMCLASSES; sc++)
+			cached += zone_cache.count[sc] * ((size_t)1<<(sc+ZONE_MINCLASSSHIFT));
+		Con_Printf("Tag cache: %"PRIuSIZE"KB idle, %"PRIuSIZE" hits, %"PRIuSIZE" misses\n", cached/1024, zone_cache.hits, zone_cache.misses);
 	}
 #endif
 
@@ -109,6 +109,7 @@ void *ZF_MallocNamed (size_t size, char *file, int line); // allowed to fail
 void *Z_TagMalloc (size_t size, int tag);
 void VARGS Z_TagFree(void *ptr);
 void VARGS Z_FreeTags(int tag);
+void Z_FlushThreadCache(void);	//releases the calling thread's tag cache. called by Sys_CreateThread's wrappers as the thread exits.
 qboolean ZF_ReallocElements(void **ptr, size_t *elements, size_t newelements, size_t elementsize);	//returns false on error
 qboolean ZF_ReallocElementsNamed(void **ptr, size_t *elements, size_t newelements, size_t elementsize, const char *file, int line);	//returns false on error
 #define Z_ReallocElements(ptr,elements,newelements,elementsize) do{if (!ZF_ReallocElements(ptr,elements,newelements,elementsize))Sys_Error("Z_ReallocElements failed (%s %i)\n", __FILE__, __LINE__);}while(0)	//returns false on error
@@ -658,6 +658,9 @@ void Mod_Init (qboolean initial)
 #endif
 
 		Cmd_AddCommand("mod_memlist", Mod_MemList_f);
+#ifdef SKELETALMODELS
+		Cmd_AddCommandD("mod_tracebench", Mod_TraceBench_f, "Times random traces against a posed skeletal model, comparing the per-bone bounds against testing every triangle. Args: model, traces, frame, time.");
+#endif
 #ifndef SERVERONLY
 		Cmd_AddCommand("mod_batchlist", Mod_BatchList_f);
 		Cmd_AddCommand("mod_texturelist", Mod_TextureList_f);
@@ -1082,11 +1085,19 @@ Mod_LoadModel
 Loads a model into the cache
 ==================
 */
+static void Mod_UnmapModelFile(unsigned *buf, void *view)
+{
+	if (view)
+		FS_UnmapFile(view);
+	else
+		BZ_Free(buf);	//dummy maps etc.
+}
 static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 {
 	model_t *mod = ctx;
 	enum mlverbosity_e verbose = a;
 	unsigned *buf = NULL;
+	void *view = NULL;
 	char mdlbase[MAX_QPATH];
 	char *replstr;
 #ifdef DSPMODELS
@@ -1221,7 +1232,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 				continue;
 
 			TRACE(("Mod_LoadModel: Trying to load (replacement) model \"%s\"\n", altname));
-			buf = (unsigned *)FS_LoadMallocGroupFile(NULL, altname, &filesize, true);
+			buf = (unsigned *)FS_MapPrivateFile(altname, &filesize, true, &view);	//loaders may patch the buffer, but most only touch headers so copy-on-write saves copying the rest.
 
 			if (buf)
 				Q_strncpyz(mod->name, altname, sizeof(mod->name));
@@ -1229,7 +1240,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 		else
 		{
 			TRACE(("Mod_LoadModel: Trying to load model \"%s\"\n", mod->publicname));
-			buf = (unsigned *)FS_LoadMallocGroupFile(NULL, mod->publicname, &filesize, true);
+			buf = (unsigned *)FS_MapPrivateFile(mod->publicname, &filesize, true, &view);
 			if (buf)
 				Q_strncpyz(mod->name, mod->publicname, sizeof(mod->name));
 			else if (!buf)
@@ -1239,7 +1250,6 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 				{
 					TRACE(("Mod_LoadModel: doomsprite: \"%s\"\n", mod->name));
 					Mod_LoadDoomSprite(mod);
-					BZ_Free(buf);
 					COM_AddWork(WG_MAIN, Mod_ModelLoaded, mod, NULL, MLS_LOADED, 0);
 					return;
 				}
@@ -1270,6 +1280,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 							"origin \"0 0 64\"\n"
 						"}\n";
 					buf = (unsigned*)Z_StrDup(dummymap);
+					view = NULL;
 					filesize = strlen(dummymap);
 				}
 				else
@@ -1281,7 +1292,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 			continue;
 		if (filesize < 4)
 		{
-			BZ_Free(buf);
+			Mod_UnmapModelFile(buf, view);
 			continue;
 		}
 
@@ -1290,7 +1301,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 //
 		if (!Mod_DoCRC(mod, (char*)buf, filesize))
 		{
-			BZ_Free(buf);
+			Mod_UnmapModelFile(buf, view);
 			continue;
 		}
 
@@ -1315,7 +1326,7 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 		{
 			if (!modelloaders[i].load(mod, buf, filesize))
 			{
-				BZ_Free(buf);
+				Mod_UnmapModelFile(buf, view);
 				continue;
 			}
 		}
@@ -1331,21 +1342,21 @@ static void Mod_LoadModelWorker (void *ctx, void *data, size_t a, size_t b)
 			{
 				if (!modelloaders[i].load(mod, buf, filesize))
 				{
-					BZ_Free(buf);
+					Mod_UnmapModelFile(buf, view);
 					continue;
 				}
 			}
 			else
 			{
 				Con_Printf(CON_WARNING "Unrecognised model format %c%c%c%c\n", ((char*)buf)[0], ((char*)buf)[1], ((char*)buf)[2], ((char*)buf)[3]);
-				BZ_Free(buf);
+				Mod_UnmapModelFile(buf, view);
 				continue;
 			}
 		}
 
 		TRACE(("Mod_LoadModel: Loaded\n"));
 
-		BZ_Free(buf);
+		Mod_UnmapModelFile(buf, view);
 
 		COM_AddWork(WG_MAIN, Mod_ModelLoaded, mod, NULL, MLS_LOADED, 0);
 		return;
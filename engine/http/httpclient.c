@@ -1645,6 +1645,10 @@ vfsfile_t *VFS_OpenPipeInternal(int refs, qboolean seekable, void (*callback)(vo
 	newf->funcs.GetLen = VFSPIPE_GetLen;
 	newf->funcs.ReadBytes = VFSPIPE_ReadBytes;
 	newf->funcs.WriteBytes = VFSPIPE_WriteBytes;
+	newf->funcs.ReadBytesAt = NULL;
+	newf->funcs.GetMapping = NULL;
+	newf->funcs.MapPrivate = NULL;
+	newf->funcs.UnmapPrivate = NULL;
 
 	newf->ctx = ctx;
 	newf->callback = callback;
@@ -33,6 +33,7 @@
 #define QCPOINTER(p) (eval_t *)(p->_int+progfuncs->funcs.stringtable)
 #define QCPOINTERM(p) (eval_t *)((p)+progfuncs->funcs.stringtable)
 #define QCPOINTERWRITEFAIL(p,sz) ((unsigned int)(p)-1 >= prinst.addressableused-1-(sz))	//disallows null writes
+#define QCPOINTERWAKE(p,sz) errorif (progfuncs->funcs.numasleep && (p) != progfuncs->funcs.lastaddress) PR_WakePointer(&progfuncs->funcs, p, sz)	//the field that was just addressed is awake, anything else might be in a sleeping entity.
 #define QCPOINTERREADFAIL(p,sz) ((unsigned int)(p) >= prinst.addressableused-(sz))		//permits null reads
 
 
@@ -368,6 +369,7 @@ reeval:
 	//store a value to a pointer
 	case OP_STOREP_IF:
 		i = OPB->_int + OPC->_int*sizeof(ptr->_float);
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(ptr->_float), sizeof(ptr->_float))))
@@ -383,6 +385,7 @@ reeval:
 		break;
 	case OP_STOREP_FI:
 		i = OPB->_int + OPC->_int*sizeof(ptr->_int);
+		QCPOINTERWAKE(i, sizeof(int));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(int)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(ptr->_int), sizeof(ptr->_int))))
@@ -403,6 +406,7 @@ reeval:
 	case OP_STOREP_S:
 	case OP_STOREP_FNC:		// pointers
 		i = OPB->_int + OPC->_int*sizeof(ptr->_int);
+		QCPOINTERWAKE(i, sizeof(ptr->_int));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(ptr->_int)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(ptr->_int), sizeof(ptr->_int))))
@@ -421,6 +425,7 @@ reeval:
 		break;
 	case OP_STOREP_I64:		// 64bit
 		i = OPB->_int + OPC->_int*sizeof(ptr->_int);
+		QCPOINTERWAKE(i, sizeof(ptr->i64));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(ptr->i64)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(ptr->_int), sizeof(ptr->i64))))
@@ -439,6 +444,7 @@ reeval:
 		break;
 	case OP_STOREP_V:
 		i = OPB->_int + (OPC->_int*sizeof(ptr->_int));
+		QCPOINTERWAKE(i, sizeof(pvec3_t));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(pvec3_t)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(ptr->_int), sizeof(pvec3_t))))
@@ -457,6 +463,7 @@ reeval:
 
 	case OP_STOREP_C:	//store (float) character in a string
 		i = OPB->_int + (OPC->_int)*sizeof(char);
+		QCPOINTERWAKE(i, sizeof(char));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(char)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(char), sizeof(char))))
@@ -472,6 +479,7 @@ reeval:
 		break;
 	case OP_STOREP_I8:	//store (byte) character in a string
 		i = OPB->_int + (OPC->_int)*sizeof(pbyte);
+		QCPOINTERWAKE(i, sizeof(pbyte));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(pbyte)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(pbyte), sizeof(pbyte))))
@@ -487,6 +495,7 @@ reeval:
 		break;
 	case OP_STOREP_I16:	//store short to a pointer
 		i = OPB->_int + (OPC->_int)*sizeof(short);
+		QCPOINTERWAKE(i, sizeof(short));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(short)))
 		{
 			if (!(ptr=PR_GetWriteTempStringPtr(progfuncs, OPB->_int, OPC->_int*sizeof(short), sizeof(short))))
@@ -511,17 +520,22 @@ reeval:
 			break;
 		}
 		ed = PROG_TO_EDICT_PB(progfuncs, OPA->edict);
-		errorif (!ed || ed->readonly)
-		{	//boot it over to the debugger
-#if INTSIZE == 16
-			ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
+		errorif (!ed || ed->readonly || ed->asleep)
+		{
+			if (ed && !ed->readonly)
+				externs->entwake(&progfuncs->funcs, (struct edict_s *)ed);	//only asleep, not protected. wake it and let the write through.
+			else
+			{	//boot it over to the debugger
+	#if INTSIZE == 16
+				ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
 #else
-			ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
+				ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
 #endif
-			fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
-			if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
-				return prinst.pr_xstatement;
-			break;
+				fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
+				if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
+					return prinst.pr_xstatement;
+				break;
+			}
 		}
 
 //Whilst the next block would technically be correct, we don't use it as it breaks too many quake mods.
@@ -553,17 +567,22 @@ reeval:
 			break;
 		}
 		ed = PROG_TO_EDICT_PB(progfuncs, OPA->edict);
-		errorif (!ed || ed->readonly)
-		{	//boot it over to the debugger
-#if INTSIZE == 16
-			ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
+		errorif (!ed || ed->readonly || ed->asleep)
+		{
+			if (ed && !ed->readonly)
+				externs->entwake(&progfuncs->funcs, (struct edict_s *)ed);	//only asleep, not protected. wake it and let the write through.
+			else
+			{	//boot it over to the debugger
+	#if INTSIZE == 16
+				ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
 #else
-			ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
+				ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
 #endif
-			fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
-			if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
-				return prinst.pr_xstatement;
-			break;
+				fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
+				if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
+					return prinst.pr_xstatement;
+				break;
+			}
 		}
 
 //Whilst the next block would technically be correct, we don't use it as it breaks too many quake mods.
@@ -595,17 +614,22 @@ reeval:
 			break;
 		}
 		ed = PROG_TO_EDICT_PB(progfuncs, OPA->edict);
-		errorif (!ed || ed->readonly)
-		{	//boot it over to the debugger
-#if INTSIZE == 16
-			ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
+		errorif (!ed || ed->readonly || ed->asleep)
+		{
+			if (ed && !ed->readonly)
+				externs->entwake(&progfuncs->funcs, (struct edict_s *)ed);	//only asleep, not protected. wake it and let the write through.
+			else
+			{	//boot it over to the debugger
+	#if INTSIZE == 16
+				ddef16_t *d = ED_GlobalAtOfs16(progfuncs, st->a);
 #else
-			ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
+				ddef32_t *d = ED_GlobalAtOfs32(progfuncs, st->a);
 #endif
-			fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
-			if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
-				return prinst.pr_xstatement;
-			break;
+				fdef_t *f = ED_FieldAtOfs(progfuncs, OPB->_int + progfuncs->funcs.fieldadjust);
+				if (PR_ExecRunWarning(&progfuncs->funcs, st-pr_statements, "assignment to read-only entity %i in %s (%s.%s)\n", OPA->edict, PR_StringToNative(&progfuncs->funcs, prinst.pr_xfunction->s_name), d?PR_StringToNative(&progfuncs->funcs, d->s_name):"??", f?f->name:"??"))
+					return prinst.pr_xstatement;
+				break;
+			}
 		}
 
 //Whilst the next block would technically be correct, we don't use it as it breaks too many quake mods.
@@ -645,9 +669,11 @@ reeval:
 #ifdef PARANOID
 		NUM_FOR_EDICT(ed);		// make sure it's in range
 #endif
-		errorif (!ed || ed->readonly)
+		errorif (!ed || ed->readonly || ed->asleep)
 		{
-
+			if (ed && !ed->readonly)
+				externs->entwake(&progfuncs->funcs, (struct edict_s *)ed);	//only asleep, not protected. wake it and let the write through.
+			else
 			//boot it over to the debugger
 			{
 #if INTSIZE == 16
@@ -685,6 +711,7 @@ reeval:
 #endif
 
 		OPC->_int = ENGINEPOINTER((((int *)edvars(ed)) + i));
+		progfuncs->funcs.lastaddress = OPC->_int;
 		break;
 
 	//load a field to a value
@@ -850,6 +877,10 @@ reeval:
 	case OP_GOTO:
 		RUNAWAYCHECK();
 		st += (sofs)st->a - 1;	// offset the s++
+#if defined(QCJIT_AMD64) && !defined(DEBUGABLE)
+		if (current_progstate->jit)
+			return st-pr_statements;	//let the jit take over again
+#endif
 		break;
 
 	case OP_CALL8H:
@@ -930,6 +961,11 @@ reeval:
 				{
 #ifndef QCGC
 					prinst.numtempstringsstack = prinst.numtempstrings;
+#endif
+#ifdef DEBUGABLE
+					if (prinst.cgactive)
+						PR_CallGraphBuiltin(progfuncs, newf, externs->globalbuiltins[i]);
+					else
 #endif
 					(*externs->globalbuiltins[i]) (&progfuncs->funcs, (struct globalvars_s *)current_progstate->globals);
 
@@ -1325,6 +1361,7 @@ reeval:
 		break;
 	case OP_MULSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1335,6 +1372,7 @@ reeval:
 		break;
 	case OP_MULSTOREP_VF:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(pvec3_t));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(pvec3_t)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1351,6 +1389,7 @@ reeval:
 		break;
 	case OP_DIVSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1369,6 +1408,7 @@ reeval:
 		break;
 	case OP_ADDSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1379,6 +1419,7 @@ reeval:
 		break;
 	case OP_ADDSTOREP_V:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(pvec3_t));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(pvec3_t)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1399,6 +1440,7 @@ reeval:
 		break;
 	case OP_SUBSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1409,6 +1451,7 @@ reeval:
 		break;
 	case OP_SUBSTOREP_V:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(pvec3_t));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(pvec3_t)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1424,6 +1467,7 @@ reeval:
 		break;
 	case OP_BITSETSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1437,6 +1481,7 @@ reeval:
 		break;
 	case OP_BITCLRSTOREP_F:
 		i = OPB->_int;
+		QCPOINTERWAKE(i, sizeof(float));
 		errorif (QCPOINTERWRITEFAIL(i, sizeof(float)))
 		{
 			prinst.pr_xstatement = st-pr_statements;
@@ -1784,4 +1829,5 @@ reeval:
 #undef ENGINEPOINTER
 #undef QCPOINTER
 #undef QCPOINTERM
+#undef QCPOINTERWAKE
 
@@ -152,189 +152,241 @@ void *PRAddressableExtend(progfuncs_t *progfuncs, void *src, size_t srcsize, int
 }
 
 
+//the qc heap lives in arenas within the addressable hunk, each terminated with a sentinel header.
+//every block has a header with its size, free blocks additionally have their size at the end (boundary tags) so neighbours can be merged in constant time.
+//free blocks are kept in size-segregated bins, exact 16-byte classes for small sizes and power-of-two classes after that.
 #define MARKER_USED 0xC2A4F5A6u
 #define MARKER_FREE 0xF1E3E3E7u
+#define MARKER_END	0xE4D0E4D0u
+#define QCMEM_PREVFREE	1u	//the block physically before this one is free, and has its size stored in its last 4 bytes.
+#define QCMEM_SIZEMASK	(~3u)
+#define QCMEM_MINBLOCK	32	//must fit a free header and the trailing size
 typedef struct
 {
-#ifdef _DEBUG
 	unsigned int marker;
-#endif
-	unsigned int next;
-	unsigned int prev;
-	unsigned int size;	//includes header size
-} qcmemfreeblock_t;
+	unsigned int size;	//includes header size. low bits are flags.
+} qcmemusedblock_t;
 typedef struct
 {
 	unsigned int marker;
-#ifdef _DEBUG
+	unsigned int size;	//includes header size. flags are always clear (there's never a free block before a free block).
 	unsigned int next;
 	unsigned int prev;
-#endif
-	unsigned int size;	//includes header size
-} qcmemusedblock_t;
-static void PF_fmem_unlink(progfuncs_t *progfuncs, qcmemfreeblock_t *p)
+} qcmemfreeblock_t;
+#define QCMEM_BLOCK(ofs) ((qcmemfreeblock_t*)(progfuncs->funcs.stringtable + (ofs)))
+#define QCMEM_TAG(ofs) (*(unsigned int*)(progfuncs->funcs.stringtable + (ofs)))
+
+static unsigned int PR_membin(unsigned int size)
 {
-	qcmemfreeblock_t *np;
-#ifdef _DEBUG
-	if (p->marker != MARKER_FREE)
-	{
-		externs->Printf("PF_fmem_unlink: memory corruption\n");
-		PR_StackTrace(&progfuncs->funcs, false);
-	}
-	p->marker = 0;
-#endif
+	unsigned int bin;
+	if (size < 1024)
+		return size>>4;
+	for (bin = 64, size >>= 11; size; size >>= 1)
+		bin++;
+	return bin;
+}
+static unsigned int PR_membinsize(unsigned int bin)
+{
+	if (bin < 64)
+		return bin<<4;
+	return 1024u<<(bin-64);
+}
+
+static void PR_memunlink(progfuncs_t *progfuncs, unsigned int b)
+{
+	qcmemfreeblock_t *p = QCMEM_BLOCK(b);
+	unsigned int bin = PR_membin(p->size);
 	if (p->prev)
+		QCMEM_BLOCK(p->prev)->next = p->next;
+	else
 	{
-		np = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + p->prev);
-		np->next = p->next;
+		prinst.mbin[bin] = p->next;
+		if (!p->next)
+			prinst.mbinused[bin>>5] &= ~(1u<<(bin&31));
 	}
-	else
-		progfuncs->inst.mfreelist = p->next;
 	if (p->next)
+		QCMEM_BLOCK(p->next)->prev = p->prev;
+	p->marker = 0;
+}
+//turns the region into a free block, and tells the following block about it.
+static void PR_memlink(progfuncs_t *progfuncs, unsigned int b, unsigned int size)
+{
+	qcmemfreeblock_t *p = QCMEM_BLOCK(b);
+	unsigned int bin = PR_membin(size);
+	p->marker = MARKER_FREE;
+	p->size = size;
+	p->prev = 0;
+	p->next = prinst.mbin[bin];
+	if (p->next)
+		QCMEM_BLOCK(p->next)->prev = b;
+	prinst.mbin[bin] = b;
+	prinst.mbinused[bin>>5] |= 1u<<(bin&31);
+	QCMEM_TAG(b+size-4) = size;
+	QCMEM_BLOCK(b+size)->size |= QCMEM_PREVFREE;
+}
+
+//finds and unlinks a free block that's at least size bytes
+static unsigned int PR_memfindfree(progfuncs_t *progfuncs, unsigned int size)
+{
+	unsigned int bin = PR_membin(size), b, w, bits;
+	if (bin >= 64)
+	{	//large bins have a range of sizes, so we need to check that its actually big enough.
+		for (b = prinst.mbin[bin]; b; b = QCMEM_BLOCK(b)->next)
+		{
+			if (QCMEM_BLOCK(b)->size >= size)
+			{
+				PR_memunlink(progfuncs, b);
+				return b;
+			}
+		}
+		bin++;
+	}
+	//anything in a higher bin is guarenteed to fit, take the first.
+	for (w = bin>>5; w < QCMEM_BINWORDS; w++)
 	{
-		np = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + p->next);
-		np->prev = p->prev;
+		bits = prinst.mbinused[w];
+		if (w == bin>>5)
+			bits &= ~0u<<(bin&31);
+		if (bits)
+		{
+			for (bin = w<<5; !(bits&1); bits >>= 1)
+				bin++;
+			b = prinst.mbin[bin];
+			PR_memunlink(progfuncs, b);
+			return b;
+		}
 	}
+	return 0;
 }
 
-void PR_memvalidate (progfuncs_t *progfuncs)
+//gets more memory from the addressable hunk. returns an unlinked free block of at least size bytes.
+static unsigned int PR_memgrow(progfuncs_t *progfuncs, unsigned int size)
+{
+	unsigned int b, avail, end;
+	size_t before = prinst.addressableused;
+	qcmemusedblock_t *s;
+	if (prinst.mtail && prinst.mtail + sizeof(qcmemusedblock_t) == prinst.addressableused)
+	{	//nothing else has been allocated since, so we can just push our sentinel along (merging with any free block at the end).
+		b = prinst.mtail;
+		if (QCMEM_BLOCK(b)->size & QCMEM_PREVFREE)
+		{
+			b -= QCMEM_TAG(b-4);
+			PR_memunlink(progfuncs, b);
+		}
+		avail = prinst.mtail + sizeof(qcmemusedblock_t) - b;
+		if (avail < size + sizeof(qcmemusedblock_t))
+		{
+			if (!PRAddressableExtend(progfuncs, NULL, size + sizeof(qcmemusedblock_t) - avail, 0))
+				return 0;
+		}
+	}
+	else
+	{	//start a new arena
+		s = PRAddressableExtend(progfuncs, NULL, size + sizeof(qcmemusedblock_t), 0);
+		if (!s)
+			return 0;
+		b = (char*)s - progfuncs->funcs.stringtable;
+	}
+	//extending may have padded it slightly, so use it all.
+	end = prinst.addressableused - sizeof(qcmemusedblock_t);
+	prinst.mheapsize += prinst.addressableused - before;
+	prinst.mtail = end;
+	s = (qcmemusedblock_t*)QCMEM_BLOCK(end);
+	s->marker = MARKER_END;
+	s->size = 0;
+	QCMEM_BLOCK(b)->size = end - b;
+	return b;
+}
+
+#ifdef _DEBUG
+static void PR_memvalidate (progfuncs_t *progfuncs)
 {
 	qcmemfreeblock_t *p;
-	unsigned int b,l;
+	unsigned int bin, b, l;
 
-	b = prinst.mfreelist;
-	l = 0;
-	while (b)
+	for (bin = 0; bin < QCMEM_BINS; bin++)
 	{
-		if ((size_t)b >= (size_t)prinst.addressableused)
+		for (b = prinst.mbin[bin], l = 0; b; l = b, b = p->next)
 		{
-			externs->Printf("PF_memalloc: memory corruption\n");
-			PR_StackTrace(&progfuncs->funcs, false);
-			return;
+			if (b + QCMEM_MINBLOCK > prinst.addressableused)
+				break;
+			p = QCMEM_BLOCK(b);
+			if (p->marker != MARKER_FREE ||
+				p->prev != l ||
+				PR_membin(p->size) != bin ||
+				b + p->size + sizeof(qcmemusedblock_t) > prinst.addressableused ||
+				QCMEM_TAG(b+p->size-4) != p->size ||
+				!(QCMEM_BLOCK(b+p->size)->size & QCMEM_PREVFREE))
+				break;
 		}
-		p = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + b);
-
-		if (
-#ifdef _DEBUG
-			p->marker != MARKER_FREE ||
-#endif
-			p->prev != l ||
-			(p->next && p->next < b + p->size) ||
-			p->next >= prinst.addressableused ||
-			b + p->size >= prinst.addressableused ||
-			p->prev >= b)
+		if (b)
 		{
 			externs->Printf("PF_memalloc: memory corruption\n");
 			PR_StackTrace(&progfuncs->funcs, false);
 			return;
 		}
-		l = b;
-		b = p->next;
 	}
 }
+#else
+#define PR_memvalidate(pf)
+#endif
 
 static void *PDECL PR_memalloc (pubprogfuncs_t *ppf, unsigned int size)
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
-	qcmemfreeblock_t *p, *np;
-	qcmemusedblock_t *ub = NULL;
-	unsigned int b,n;
+	qcmemusedblock_t *ub;
+	unsigned int b, bsize;
 	/*round size up*/
-	size = (size+sizeof(qcmemusedblock_t) + 63) & ~63;
+	if (size > 0x7fffffff)
+	{
+		externs->Printf("PF_memalloc: memory exausted\n");
+		PR_StackTrace(&progfuncs->funcs, false);
+		return NULL;
+	}
+	size = (size+sizeof(qcmemusedblock_t) + 15) & ~15;
+	if (size < QCMEM_MINBLOCK)
+		size = QCMEM_MINBLOCK;
 
 	PR_memvalidate(progfuncs);
 
-	b = prinst.mfreelist;
-	while (b)
-	{
-		if (/*b < 0 || */b+sizeof(qcmemfreeblock_t) >= prinst.addressableused)
+	b = PR_memfindfree(progfuncs, size);
+	if (!b)
+	{	/*assign more space*/
+		b = PR_memgrow(progfuncs, size);
+		if (!b)
 		{
-			externs->Printf("PF_memalloc: memory corruption\n");
+			externs->Printf("PF_memalloc: memory exausted\n");
 			PR_StackTrace(&progfuncs->funcs, false);
 			return NULL;
 		}
-		p = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + b);
-		if (p->size >= size)
-		{
-			if ((p->next && p->next < b + p->size) ||
-				p->next >= prinst.addressableused ||
-				b + p->size >= prinst.addressableused ||
-				p->prev >= b)
-			{
-				externs->Printf("PF_memalloc: memory corruption\n");
-				PR_StackTrace(&progfuncs->funcs, false);
-				return NULL;
-			}
-
-			ub = (qcmemusedblock_t*)p;
-			if (p->size > size + 63)
-			{
-				/*make a new header just after it, with basically the same properties, and shift the important fields over*/
-				n = b + size;
-				np = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + b + size);
-#ifdef _DEBUG
-				np->marker = MARKER_FREE;
-#endif
-				np->prev = p->prev;
-				np->next = p->next;
-				np->size = p->size - size;
-				if (np->prev)
-				{
-					p = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + np->prev);
-					p->next = n;
-				}
-				else
-					prinst.mfreelist = n;
-				if (p->next)
-				{
-					p = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + np->next);
-					p->prev = n;
-				}
-			}
-			else
-			{
-				size = p->size; /*alloc the entire block*/
-				/*unlink this entry*/
-				PF_fmem_unlink(progfuncs, p);
-			}
-			break;
-		}
-		b = p->next;
 	}
 
-	/*assign more space*/
-	if (!ub)
-	{
-		ub = PRAddressableExtend(progfuncs, NULL, size, 0);
-		if (!ub)
-		{
-			externs->Printf("PF_memalloc: memory exausted\n");
-			PR_StackTrace(&progfuncs->funcs, false);
-			return NULL;
-		}
-		//FIXME: merge with previous block
+	bsize = QCMEM_BLOCK(b)->size & QCMEM_SIZEMASK;
+	if (bsize >= size + QCMEM_MINBLOCK)
+	{	//split off the excess
+		PR_memlink(progfuncs, b+size, bsize-size);
+		bsize = size;
 	}
-	memset(ub, 0, size);
+	else
+		QCMEM_BLOCK(b+bsize)->size &= ~QCMEM_PREVFREE;
+
+	ub = (qcmemusedblock_t*)QCMEM_BLOCK(b);
 	ub->marker = MARKER_USED;
-	ub->size = size;
+	ub->size = bsize;
+	memset(ub+1, 0, bsize-sizeof(*ub));
+	prinst.mheapused += bsize;
+	prinst.mallocs[PR_membin(bsize)]++;
 
 	PR_memvalidate(progfuncs);
 
 	return ub+1;
 }
-static void PDECL PR_memfree (pubprogfuncs_t *ppf, void *memptr)
+
+//validates a pointer from the qc, returning the block's offset or 0.
+static unsigned int PR_memusedblock (progfuncs_t *progfuncs, void *memptr, const char *func)
 {
-	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
 	qcmemusedblock_t *ub;
-	qcmemfreeblock_t *b, *nb, *pb; 
-	unsigned int pa, na;	//prev addr, next addr
-	unsigned int size;
-	unsigned int ptr = memptr?((char*)memptr - progfuncs->funcs.stringtable):0;
-
-	/*freeing NULL is ignored*/
-	if (!ptr)
-		return;
-	PR_memvalidate(progfuncs);
+	unsigned int ptr = (char*)memptr - progfuncs->funcs.stringtable;
 	ptr -= sizeof(qcmemusedblock_t);
 	if (/*ptr < 0 ||*/ ptr >= prinst.addressableused)
 	{
@@ -343,105 +395,73 @@ static void PDECL PR_memfree (pubprogfuncs_t *ppf, void *memptr)
 		{
 			//the empty string is a point of contention. while we can detect it from fteqcc, its best to not give any special favours (other than nicer debugging, where possible)
 			//we might not actually spot it from other qccs, so warning about it where possible is probably a very good thing.
-			externs->Printf("PF_memfree: unable to free the non-null empty string constant at %x\n", ptr);
+			externs->Printf("%s: unable to free the non-null empty string constant at %x\n", func, ptr);
 		}
 		else
-			externs->Printf("PF_memfree: pointer invalid - out of range (%x >= %x)\n", ptr, (unsigned int)prinst.addressableused);
+			externs->Printf("%s: pointer invalid - out of range (%x >= %x)\n", func, ptr, (unsigned int)prinst.addressableused);
 		PR_StackTrace(&progfuncs->funcs, false);
-		return;
+		return 0;
 	}
 
 	//this is the used block that we're trying to free
-	ub = (qcmemusedblock_t*)(progfuncs->funcs.stringtable + ptr);
-	if (ub->marker != MARKER_USED || ub->size <= sizeof(*ub) || ptr + ub->size > (unsigned int)prinst.addressableused)
+	ub = (qcmemusedblock_t*)QCMEM_BLOCK(ptr);
+	if (ub->marker != MARKER_USED || (ub->size&QCMEM_SIZEMASK) < QCMEM_MINBLOCK || ptr + (ub->size&QCMEM_SIZEMASK) + sizeof(*ub) > (unsigned int)prinst.addressableused)
 	{
-		externs->Printf("PR_memfree: pointer lacks marker - double-freed?\n");
+		externs->Printf("%s: pointer lacks marker - double-freed?\n", func);
 		PR_StackTrace(&progfuncs->funcs, false);
-		return;
+		return 0;
 	}
+	return ptr;
+}
+
+//frees a used block, merging it with any free neighbours.
+static void PR_memrelease (progfuncs_t *progfuncs, unsigned int b)
+{
+	qcmemusedblock_t *ub = (qcmemusedblock_t*)QCMEM_BLOCK(b);
+	qcmemfreeblock_t *nb;
+	unsigned int size = ub->size & QCMEM_SIZEMASK, psize;
+
+	prinst.mheapused -= size;
+	prinst.mallocs[PR_membin(size)]--;
 	ub->marker = 0;	//invalidate it
-	size = ub->size;
-	ub = NULL;
 
-	//we have an (ordered) list of free blocks.
-	//in order to free our memory, we need to find the free block before+after the 'new' block
-	for (na = prinst.mfreelist, pa = 0; ;)
+	nb = QCMEM_BLOCK(b+size);
+	if (nb->marker == MARKER_FREE)
 	{
-		if (/*na < 0 ||*/ na >= prinst.addressableused)
+		PR_memunlink(progfuncs, b+size);
+		size += nb->size;
+	}
+	if (ub->size & QCMEM_PREVFREE)
+	{
+		psize = QCMEM_TAG(b-4);
+		if (psize > b || QCMEM_BLOCK(b-psize)->marker != MARKER_FREE || QCMEM_BLOCK(b-psize)->size != psize)
 		{
 			externs->Printf("PF_memfree: memory corruption\n");
 			PR_StackTrace(&progfuncs->funcs, false);
-			return;
 		}
-		if (!na || na >= ptr)
+		else
 		{
-			pb = pa?(qcmemfreeblock_t*)(progfuncs->funcs.stringtable + pa):NULL;
-			if (pb && pa+pb->size>ptr)
-			{	//previous free block extends into the block that we're trying to free.
-				externs->Printf("PF_memfree: double free\n");
-				PR_StackTrace(&progfuncs->funcs, false);
-				return;
-			}
-#ifdef _DEBUG
-			if (pb && pb->marker != MARKER_FREE)
-			{
-				externs->Printf("PF_memfree: use-after-free?\n");
-				PR_StackTrace(&progfuncs->funcs, false);
-				return;
-			}
-#endif
-
-			nb = na?(qcmemfreeblock_t*)(progfuncs->funcs.stringtable + na):NULL;
-			if (nb && ptr+size > na)
-			{
-				externs->Printf("PF_memfree: block extends into neighbour\n");
-				PR_StackTrace(&progfuncs->funcs, false);
-				return;
-			}
-#ifdef _DEBUG
-			if (nb && nb->marker != MARKER_FREE)
-			{
-				externs->Printf("PF_memfree: use-after-free?\n");
-				PR_StackTrace(&progfuncs->funcs, false);
-				return;
-			}
-#endif
-
-			/*generate the free block, now we know its proper values*/
-			b = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + ptr);
-#ifdef _DEBUG
-			b->marker = MARKER_FREE;
-#endif
-			b->prev = pa;
-			b->next = na;
-			b->size = size;
-			if (na)
-				nb->prev = ptr;
-			if (!pa)
-				prinst.mfreelist = ptr;
-			else
-				pb->next = ptr;
-
-			/*extend this block and kill the next if they are adjacent*/
-			if (na && b->next == ptr + size)
-			{
-				b->size += nb->size; 
-				PF_fmem_unlink(progfuncs, nb);
-			}
-			/*we're adjacent to the previous block, so merge them by killing the newly freed region*/
-			if (pa && pa + pb->size == ptr)
-			{
-				pb->size += size;
-				PF_fmem_unlink(progfuncs, b);
-			}
-			break;
+			b -= psize;
+			PR_memunlink(progfuncs, b);
+			size += psize;
 		}
-
-		pa = na;
-		b = (qcmemfreeblock_t*)(progfuncs->funcs.stringtable + pa);
-		na = b->next;
 	}
+	PR_memlink(progfuncs, b, size);
+}
 
+static void PDECL PR_memfree (pubprogfuncs_t *ppf, void *memptr)
+{
+	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
+	unsigned int b;
+
+	/*freeing NULL is ignored*/
+	if (!memptr || memptr == progfuncs->funcs.stringtable)
+		return;
+	PR_memvalidate(progfuncs);
+	b = PR_memusedblock(progfuncs, memptr, "PF_memfree");
+	if (!b)
+		return;
+	PR_memrelease(progfuncs, b);
 	PR_memvalidate(progfuncs);
 }
 
@@ -449,56 +469,116 @@ static void *PDECL PR_memrealloc (pubprogfuncs_t *ppf, void *memptr, unsigned in
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
 	qcmemusedblock_t *ub;
-	unsigned int ptr = memptr?((char*)memptr - progfuncs->funcs.stringtable):0;
+	qcmemfreeblock_t *nb;
+	unsigned int b, size, need;
 	void *newptr;
 	unsigned int oldsize;
 
 	/*freeing NULL is ignored*/
-	if (!ptr)	//realloc instead of malloc is accepted.
+	if (!memptr || memptr == progfuncs->funcs.stringtable || newsize > 0x7fffffff)	//realloc instead of malloc is accepted.
 		return PR_memalloc(ppf, newsize);
 	PR_memvalidate(progfuncs);
-	ptr -= sizeof(qcmemusedblock_t);
-	if (/*ptr < 0 ||*/ ptr >= prinst.addressableused)
-	{
-		ptr += sizeof(qcmemusedblock_t);
-		if (ptr < prinst.addressableused && !*(char*)memptr)
+	b = PR_memusedblock(progfuncs, memptr, "PR_memrealloc");
+	if (!b)
+		return NULL;
+	ub = (qcmemusedblock_t*)QCMEM_BLOCK(b);
+	size = ub->size & QCMEM_SIZEMASK;
+	need = (newsize+sizeof(qcmemusedblock_t) + 15) & ~15;
+	if (need < QCMEM_MINBLOCK)
+		need = QCMEM_MINBLOCK;
+
+	if (need > size)
+	{	//try to grow into a free block after it, to avoid copying.
+		nb = QCMEM_BLOCK(b+size);
+		if (nb->marker == MARKER_FREE && size + nb->size >= need)
 		{
-			//the empty string is a point of contention. while we can detect it from fteqcc, its best to not give any special favours (other than nicer debugging, where possible)
-			//we might not actually spot it from other qccs, so warning about it where possible is probably a very good thing.
-			externs->Printf("PR_memrealloc: unable to free the non-null empty string constant at %x\n", ptr);
+			unsigned int extra = nb->size;
+			PR_memunlink(progfuncs, b+size);
+			memset(nb, 0, extra);	//clear out the extended part.
+			prinst.mheapused -= size;
+			prinst.mallocs[PR_membin(size)]--;
+			size += extra;
+			QCMEM_BLOCK(b+size)->size &= ~QCMEM_PREVFREE;
+			//may be too big now, let the shrinking below deal with it.
+			ub->size = size | (ub->size & QCMEM_PREVFREE);
+			prinst.mheapused += size;
+			prinst.mallocs[PR_membin(size)]++;
 		}
-		else
-			externs->Printf("PR_memrealloc: pointer invalid - out of range (%x >= %x)\n", ptr, (unsigned int)prinst.addressableused);
-		PR_StackTrace(&progfuncs->funcs, false);
-		return NULL;
 	}
-
-	//this is the used block that we're trying to free
-	ub = (qcmemusedblock_t*)(progfuncs->funcs.stringtable + ptr);
-	if (ub->marker != MARKER_USED || ub->size <= sizeof(*ub) || ptr + ub->size > (unsigned int)prinst.addressableused)
-	{
-		externs->Printf("PR_memrealloc: pointer lacks marker - double-freed?\n");
-		PR_StackTrace(&progfuncs->funcs, false);
-		return NULL;
+	if (need <= size)
+	{	//fits in place. give back any excess by turning it into its own block and freeing that.
+		if (size >= need + QCMEM_MINBLOCK)
+		{
+			qcmemusedblock_t *tail = (qcmemusedblock_t*)QCMEM_BLOCK(b+need);
+			prinst.mallocs[PR_membin(size)]--;
+			prinst.mallocs[PR_membin(need)]++;
+			prinst.mallocs[PR_membin(size-need)]++;
+			ub->size = need | (ub->size & QCMEM_PREVFREE);
+			tail->marker = MARKER_USED;
+			tail->size = size-need;
+			PR_memrelease(progfuncs, b+need);
+		}
+		//anything after the new size must read as 0 if it later grows again
+		memset((char*)memptr+newsize, 0, (ub->size&QCMEM_SIZEMASK)-sizeof(*ub)-newsize);
+		PR_memvalidate(progfuncs);
+		return memptr;
 	}
-	oldsize = ub->size;
-	oldsize -= sizeof(qcmemusedblock_t);	//ignore the header.
 
+	oldsize = size - sizeof(qcmemusedblock_t);	//ignore the header.
 	newptr = PR_memalloc(ppf, newsize);
-	if (oldsize > newsize)
-		oldsize = newsize;		//don't copy it all.
-	memcpy(newptr, memptr, oldsize);
-	newsize -= oldsize;
-	memset((char*)newptr+oldsize, 0, newsize);	//clear out any extended part.
-	PR_memfree(ppf, memptr);	//free the old.
+	if (!newptr)
+		return NULL;
+	memptr = progfuncs->funcs.stringtable + b + sizeof(qcmemusedblock_t);	//the hunk may have moved
+	memcpy(newptr, memptr, oldsize);	//the new block is already cleared.
+	PR_memrelease(progfuncs, b);	//free the old.
 
 	return newptr;
 }
 
+static void PDECL PR_memstats (pubprogfuncs_t *ppf)
+{
+	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
+	unsigned int bin, b, freeblocks = 0, freebytes = 0, largest = 0, liveallocs = 0;
+	unsigned int binfree[QCMEM_BINS];
+
+	for (bin = 0; bin < QCMEM_BINS; bin++)
+	{
+		binfree[bin] = 0;
+		for (b = prinst.mbin[bin]; b; b = QCMEM_BLOCK(b)->next)
+		{
+			binfree[bin]++;
+			freebytes += QCMEM_BLOCK(b)->size;
+			if (largest < QCMEM_BLOCK(b)->size)
+				largest = QCMEM_BLOCK(b)->size;
+		}
+		freeblocks += binfree[bin];
+		liveallocs += prinst.mallocs[bin];
+	}
+
+	externs->Printf("addressable: %u of %u bytes\n", (unsigned int)prinst.addressableused, (unsigned int)prinst.addressablesize);
+	externs->Printf("heap       : %u bytes, %u in use by %u allocations\n", (unsigned int)prinst.mheapsize, (unsigned int)prinst.mheapused, liveallocs);
+	externs->Printf("free       : %u bytes in %u blocks, largest %u (%.1f%% fragmented)\n", freebytes, freeblocks, largest, freebytes?100.0*(freebytes-largest)/freebytes:0.0);
+#ifdef QCGC
+	externs->Printf("tempstrings: %u live of %u, %u collections, last freed %u (%u total)\n", prinst.livetemps, prinst.maxtempstrings, prinst.gcstats.collections, prinst.gcstats.lastswept, (unsigned int)prinst.gcstats.totalswept);
+#ifdef THREADEDGC
+	externs->Printf("gc pauses  : last %gms, max %gms, last collection took %gms%s\n", prinst.gcstats.lastpause/1000.0, prinst.gcstats.maxpause/1000.0, prinst.gcstats.lasttotal/1000.0, prinst.gccontext?" (one in progress)":"");
+#endif
+#endif
+	for (bin = 0; bin < QCMEM_BINS; bin++)
+	{
+		if (prinst.mallocs[bin] || binfree[bin])
+			externs->Printf("%10u-%-10u: %u used, %u free\n", PR_membinsize(bin), PR_membinsize(bin+1)-1, prinst.mallocs[bin], binfree[bin]);
+	}
+}
+
 void PRAddressableFlush(progfuncs_t *progfuncs, size_t totalammount)
 {
 	prinst.addressableused = 0;
-	prinst.mfreelist = 0;
+	memset(prinst.mbin, 0, sizeof(prinst.mbin));
+	memset(prinst.mbinused, 0, sizeof(prinst.mbinused));
+	memset(prinst.mallocs, 0, sizeof(prinst.mallocs));
+	prinst.mtail = 0;
+	prinst.mheapsize = prinst.mheapused = 0;
 
 	if (totalammount <= 0)	//flush
 	{
@@ -552,6 +632,7 @@ int PDECL PR_InitEnts(pubprogfuncs_t *ppf, int max_ents)
 
 	prinst.edicttable = (struct edictrun_s**)(progfuncs->funcs.edicttable = PRHunkAlloc(progfuncs, prinst.maxedicts*sizeof(struct edicts_s *), "edicttable"));
 	progfuncs->funcs.edicttable_length = prinst.maxedicts;
+	ED_ResetFreeQueue(progfuncs);
 	e = PRHunkAlloc(progfuncs, externs->edictsize, "edict0");
 	e->fieldsize = prinst.fields_size;
 	e->entnum = 0;
@@ -620,12 +701,17 @@ static void PDECL PR_Configure (pubprogfuncs_t *ppf, size_t addressable_size, in
 
 	PR_FreeAllTemps(progfuncs);
 
+	if (prinst.cgactive)
+		externs->Printf("qc call graph discarded\n");	//its full of pointers to the old progs' functions
+	PR_CallGraphFree(progfuncs);
+
 	prinst.reorganisefields = false;
 
 	prinst.profiling = profiling;
 	prinst.profilingalert = Sys_GetClockRate();
 	progfuncs->funcs.edicttable_length = prinst.maxedicts = 0;
 	prinst.edicttable = (edictrun_t**)(progfuncs->funcs.edicttable = &sv_edicts);
+	ED_ResetFreeQueue(progfuncs);
 	sv_num_edicts = 0;	//set up a safty buffer so things won't go horribly wrong too often
 	sv_edicts=(struct edict_s *)&tempedict;
 	tempedict.readonly = true;
@@ -1195,10 +1281,27 @@ void *PR_PointerToNative_Resize(pubprogfuncs_t *inst, pint_t ptr, size_t offset,
 		offset += ptr;
 		if (datasize > inst->stringtablesize || offset >= inst->stringtablesize-datasize || !offset)
 			return NULL;	//can't autoresize these. just fail.
+		PR_WakePointer(inst, ptr, datasize);
 		return inst->stringtable + ptr;
 	}
 	return NULL;
 }
+//writes through pointers don't go through the field write trap, so wake any sleeping entity that they land in.
+void PR_WakePointer(pubprogfuncs_t *inst, pint_t ptr, size_t datasize)
+{
+	progfuncs_t *progfuncs = (progfuncs_t*)inst;
+	char *start = inst->stringtable + ptr;
+	edictrun_t *ed;
+	unsigned int i;
+	if (!inst->numasleep || (size_t)ptr >= inst->stringtablesize)
+		return;
+	for (i = 0; i < sv_num_edicts; i++)
+	{
+		ed = (edictrun_t*)prinst.edicttable[i];
+		if (ed && ed->asleep && start < (char*)ed->fields + ed->fieldsize && start + datasize > (char*)ed->fields)
+			externs->entwake(inst, (struct edict_s *)ed);
+	}
+}
 void *PR_PointerToNative_MoInvalidate(pubprogfuncs_t *inst, pint_t ptr, size_t offset, size_t datasize)
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)inst;
@@ -1266,130 +1369,254 @@ void QCBUILTIN PF_memsetval (pubprogfuncs_t *inst, struct globalvars_s *globals)
 	*(int*)(inst->stringtable + dst) = val;
 }
 
-//#define GCTIMINGS
 
 #ifdef QCGC
 #define smallbool char
-static smallbool *PR_QCGC_Mark(void *mem, size_t memsize, size_t numtemps)
+#ifdef THREADEDGC
+#include "quakedef.h"
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//tempstring states during a collection
+#define QCGC_CANDIDATE	0	//existed when the collection started, and no reference has been seen (yet).
+#define QCGC_LIVE		1	//something that looks like a reference to it was found.
+#define QCGC_NEW		2	//didn't exist when the collection started, so its not ours to free.
+#define QCGC_CHUNKWORDS	(256*1024)	//words to mark per job
+#define QCGC_SWEEPSTEP	8192		//min slots to sweep per PR_RunGC, so a big collection is spread over several calls.
+#define QCGC_SWEEPSPLIT	4			//...but don't take more calls than this, or we'll fall behind the allocations.
+
+static void PR_ExpandTempStrings(progfuncs_t *progfuncs, size_t newmax)
+{
+	tempstr_t **ntable = progfuncs->funcs.parms->memalloc(sizeof(*ntable) * newmax);
+	memcpy(ntable, prinst.tempstrings, sizeof(*ntable) * prinst.maxtempstrings);
+	memset(ntable+prinst.maxtempstrings, 0, sizeof(*ntable) * (newmax-prinst.maxtempstrings));
+	prinst.maxtempstrings = newmax;
+	if (prinst.tempstrings)
+		progfuncs->funcs.parms->memfree(prinst.tempstrings);
+	prinst.tempstrings = ntable;
+}
+struct qcgccontext_s
+{
+	int done;	//marking has finished, sweeping can begin.
+	progfuncs_t *progfuncs;	//careful!
+
+	size_t maxtemps;		//so it doesn't go stale
+	smallbool *marked;
+	size_t sweeppos;
+	unsigned int candidates;
+	unsigned int swept;
+
+	const unsigned int *mem;	//what we're marking from (either the live addressable memory, or our own copy of it)
+	size_t memwords;
+#ifdef THREADEDGC
+	qatomic32_t nextchunk;
+	qatomic32_t pending;	//chunks not yet marked
+	qatomic32_t refs;
+	double starttime;
+#endif
+	unsigned int amem[1];	//snapshot for threaded marking (followed by marked)
+};
+
+static void PR_QCGC_MarkWords(const unsigned int *str, size_t words, smallbool *marked, size_t numtemps)
 {
-	unsigned int *str;	//the reference we're considering
 	size_t p;
-	smallbool *marked;	//just booleans. could compact.
-	marked = malloc(sizeof(*marked) * numtemps);
-	memset(marked, 0, sizeof(*marked) * numtemps);
-
-	//mark everything the qc has access to, even if it isn't even a string!
-	//note that I did try specifically checking only data explicitly marked as a string type, but that was:
-	//a) a smidge slower (lots of extra loops and conditions I guess)
-	//b) doesn't work with pointers/structs (yes, we assume it'll all be aligned).
-	//c) both methods got the same number of false positives in my test (2, probably dead strunzoned references)
-	for (str = mem, p = 0; p < memsize; p+=sizeof(*str), str++)
-	{
-		if ((*str & STRING_SPECMASK) == STRING_TEMP)
+	unsigned int idx;
+	for (p = 0; p < words; p++)
+	{
+		if ((str[p] & STRING_SPECMASK) == STRING_TEMP)
 		{
-			unsigned int idx = *str &~ STRING_SPECMASK;
-			if (idx < numtemps)
-				marked[idx] = true;
+			idx = str[p] &~ STRING_SPECMASK;
+			if (idx < numtemps && marked[idx] == QCGC_CANDIDATE)
+				marked[idx] = QCGC_LIVE;	//other threads only ever write the same value here
 		}
 	}
-	return marked;
 }
-static size_t PR_QCGC_Sweep(progfuncs_t *progfuncs, smallbool *marked, tempstr_t **tempstrings, unsigned int numtemps)
+//mark everything the qc has access to, even if it isn't even a string!
+//note that I did try specifically checking only data explicitly marked as a string type, but that was:
+//a) a smidge slower (lots of extra loops and conditions I guess)
+//b) doesn't work with pointers/structs (yes, we assume it'll all be aligned).
+//c) both methods got the same number of false positives in my test (2, probably dead strunzoned references)
+static void PR_QCGC_Mark(const unsigned int *str, size_t words, smallbool *marked, size_t numtemps)
 {
-	unsigned int p;
-	unsigned int swept = 0;
-#ifdef GCTIMINGS
-	unsigned int unswept = 0;
-	unsigned int errors = 0;
+	size_t p = 0;
+#ifdef __SSE2__
+	//hardly anything is a tempstring reference, so test 8 words at a time and only look closer at those with a hit.
+	const __m128i mask = _mm_set1_epi32((int)STRING_SPECMASK), temp = _mm_set1_epi32((int)STRING_TEMP);
+	__m128i a, b;
+	for (; p+8 <= words; p += 8)
+	{
+		a = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)(str+p)), mask), temp);
+		b = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)(str+p+4)), mask), temp);
+		if (_mm_movemask_epi8(_mm_or_si128(a, b)))
+			PR_QCGC_MarkWords(str+p, 8, marked, numtemps);
+	}
 #endif
-	for (p = 0; p < numtemps; p++)
-	{
-		if (marked[p])
-		{	//still live...
-#ifdef GCTIMINGS
-			unswept++;
+	PR_QCGC_MarkWords(str+p, words-p, marked, numtemps);
+}
 
-			if (!tempstrings[p])
-				errors++;
+#ifdef THREADEDGC
+static void PR_QCGC_Done(void *ctx, void *data, size_t a, size_t b)
+{
+	struct qcgccontext_s *gc = ctx;
+	gc->done = true;
+}
+static void PR_QCGC_Release(struct qcgccontext_s *gc)
+{
+	if (!FTE_Atomic32_Dec(&gc->refs))
+		free(gc);
+}
+//marks chunks until there are none left. returns true if it marked the last one.
+static pbool PR_QCGC_MarkChunks(struct qcgccontext_s *gc)
+{
+	size_t start;
+	pbool last = false;
+	for(;;)
+	{
+		start = (size_t)(FTE_Atomic32_Inc(&gc->nextchunk)-1) * QCGC_CHUNKWORDS;
+		if (start >= gc->memwords)
+			break;
+		PR_QCGC_Mark(gc->mem+start, min(QCGC_CHUNKWORDS, gc->memwords-start), gc->marked, gc->maxtemps);
+		if (!FTE_Atomic32_Dec(&gc->pending))
+			last = true;
+	}
+	return last;
+}
+static void PR_QCGC_Thread(void *ctx, void *data, size_t a, size_t b)
+{
+	struct qcgccontext_s *gc = ctx;
+	if (PR_QCGC_MarkChunks(gc))	//let the main thread know that it can start sweeping.
+		COM_InsertWork(WG_MAIN, PR_QCGC_Done, gc, NULL, 0, 0);
+	PR_QCGC_Release(gc);
+}
+static void PR_QCGC_MarkRange(void *ctx, size_t first, size_t last)
+{
+	struct qcgccontext_s *gc = ctx;
+	PR_QCGC_Mark(gc->mem+first, last-first, gc->marked, gc->maxtemps);
+}
 #endif
-		}
-		else if (tempstrings[p])
-		{	//not marked, but was valid at the time our snapshot was taken
 
-#ifdef _DEBUG
-			if (tempstrings[p] != prinst.tempstrings[p])
-			{	//something weird happened. tempstrings are supposed to be immutable (at least in length).
-				externs->Sys_Error("tempstring was reallocated while gc was running");
-				continue;
-			}
+static void PR_QCGC_Begin(progfuncs_t *progfuncs)
+{
+	struct qcgccontext_s *gc;
+	size_t p;
+	pbool snapshot = false;
+#ifdef THREADEDGC
+	size_t chunks = (prinst.addressableused/sizeof(int) + QCGC_CHUNKWORDS-1) / QCGC_CHUNKWORDS;
+	unsigned int workers = COM_HasWorkers(WG_LOADER);
+	double starttime = Sys_DoubleTime();
+	snapshot = externs->usethreadedgc;
 #endif
 
-			swept++;
-
-			//FIXME: Security Race: its possible for a mod to do weird manipulations to access the tempstring while we're still freeing it, allowing it to read something outside of its sandbox.
-			//one option would be to have the main thread bounce it back to the worker after its complete, so we can actually free the memory only after main thread has acknowledged that its tempstrings are nulled.
-			prinst.tempstrings[p] = NULL;
-
-			externs->memfree(tempstrings[p]);
+	gc = prinst.gccontext = malloc(sizeof(*gc) - sizeof(gc->amem) + (snapshot?prinst.addressableused:0) + sizeof(*gc->marked)*prinst.maxtempstrings);
+	gc->done = false;
+	gc->progfuncs = progfuncs;
+	gc->sweeppos = 0;
+	gc->swept = 0;
+	gc->memwords = prinst.addressableused/sizeof(int);
+	gc->maxtemps = prinst.maxtempstrings;
+	if (snapshot)
+	{	//the qc will keep running while we're marking, so give the workers their own copy.
+		memcpy(gc->amem, prinst.addressablehunk, prinst.addressableused);
+		gc->mem = gc->amem;
+		gc->marked = (smallbool*)gc->amem + prinst.addressableused;
+	}
+	else
+	{
+		gc->mem = (const unsigned int*)prinst.addressablehunk;
+		gc->marked = (smallbool*)gc->amem;
+	}
+	//strings allocated after this point are exempt from this collection
+	gc->candidates = 0;
+	for (p = 0; p < gc->maxtemps; p++)
+	{
+		if (prinst.tempstrings[p])
+		{
+			gc->marked[p] = QCGC_CANDIDATE;
+			gc->candidates++;
 		}
+		else
+			gc->marked[p] = QCGC_NEW;
 	}
 
-	free(marked);
-
-	return swept;
-}
-
 #ifdef THREADEDGC
-#include "quakedef.h"
-struct qcgccontext_s
-{
-	int done;
-	unsigned int clearedtemps;	//number of temps that were swept away
-	progfuncs_t *progfuncs;	//careful!
-
-	size_t maxtemps;		//so it doesn't go stale
-	tempstr_t **tempstrings;//so we don't get confused over temps added while marking
-
-	size_t memsize;
-	unsigned int amem[1];
-};
-void PR_QCGC_Done(void *ctx, void *data, size_t a, size_t b)
-{
-	struct qcgccontext_s *gc = ctx;
+	gc->starttime = starttime;
+	gc->nextchunk = 0;
+	gc->pending = chunks;
+	gc->refs = 1;
+	if (snapshot)
+	{	//let the workers get on with it. we'll sweep once they're done.
+		for (p = 0; p < chunks && p < max(1, workers); p++)
+		{
+			FTE_Atomic32_Inc(&gc->refs);
+			COM_InsertWork(WG_LOADER, PR_QCGC_Thread, gc, NULL, 0, 0);
+		}
+	}
+	else
+	{	//stop the world, but get any idle compute workers to help out. this blocks until its all marked.
+		COM_ParallelFor(gc->memwords, QCGC_CHUNKWORDS, PR_QCGC_MarkRange, gc);
+		gc->done = true;
+	}
+	p = (Sys_DoubleTime() - starttime)*1000000;
+	prinst.gcstats.lastpause = p;
+	if (prinst.gcstats.maxpause < p)
+		prinst.gcstats.maxpause = p;
+#else
+	PR_QCGC_Mark(gc->mem, gc->memwords, gc->marked, gc->maxtemps);
 	gc->done = true;
+#endif
 }
-void PR_QCGC_Thread(void *ctx, void *data, size_t a, size_t b)
+
+//frees some of the strings that weren't marked. returns true once its all done.
+static pbool PR_QCGC_Sweep(progfuncs_t *progfuncs, struct qcgccontext_s *gc, size_t budget)
 {
-	struct qcgccontext_s *gc = ctx;
-	progfuncs_t *progfuncs = gc->progfuncs;
-	smallbool *marked;
+	size_t p, end = gc->sweeppos + min(budget, gc->maxtemps-gc->sweeppos);
+	unsigned int survivors;
+	for (p = gc->sweeppos; p < end; p++)
+	{
+		if (gc->marked[p] == QCGC_CANDIDATE)
+		{	//nothing referenced it when marking, and nothing can have gained a reference since (they'd need to have found it first).
+			externs->memfree(prinst.tempstrings[p]);
+			prinst.tempstrings[p] = NULL;
+			prinst.livetemps--;
+			gc->swept++;
+		}
+	}
+	gc->sweeppos = end;
+	if (end < gc->maxtemps)
+		return false;
 
-#ifdef GCTIMINGS
-	double starttime, markedtime, endtime;
-	starttime = Sys_DoubleTime();
-#endif
-	marked = PR_QCGC_Mark(gc->amem, gc->memsize, gc->maxtemps);
-#ifdef GCTIMINGS
-	markedtime = Sys_DoubleTime();
+	prinst.gcstats.collections++;
+	prinst.gcstats.lastswept = gc->swept;
+	prinst.gcstats.totalswept += gc->swept;
+	survivors = gc->candidates - gc->swept;
+#ifdef THREADEDGC
+	prinst.gcstats.lasttotal = (Sys_DoubleTime() - gc->starttime)*1000000;
 #endif
-	gc->clearedtemps = PR_QCGC_Sweep(progfuncs, marked, gc->tempstrings, gc->maxtemps);
-#ifdef GCTIMINGS
-	endtime = Sys_DoubleTime();
-	gc->externs->Printf("live: %u, dead: %u, threadtime: mark=%f, sweep=%f, total=%f\n", prinst.livetemps-gc->clearedtemps, gc->clearedtemps, (markedtime - starttime), (endtime - markedtime), endtime-starttime);
+	prinst.gccontext = NULL;
+#ifdef THREADEDGC
+	PR_QCGC_Release(gc);
+#else
+	free(gc);
 #endif
 
-	COM_InsertWork(WG_MAIN, PR_QCGC_Done, gc, NULL, 0, 0);
+	//if over half the (max)strings survived, just increase the max so we are not spamming collections (ones created since don't count, they've not had a chance to die yet)
+	if (survivors >= prinst.maxtempstrings/2)
+		PR_ExpandTempStrings(progfuncs, prinst.maxtempstrings * 2);
+	return true;
 }
-#endif
-static void PR_ExpandTempStrings(progfuncs_t *progfuncs, size_t newmax)
+//completes any collection that's in progress.
+static void PR_QCGC_Finish(progfuncs_t *progfuncs)
 {
-	tempstr_t **ntable = progfuncs->funcs.parms->memalloc(sizeof(*ntable) * newmax);
-	memcpy(ntable, prinst.tempstrings, sizeof(*ntable) * prinst.maxtempstrings);
-	memset(ntable+prinst.maxtempstrings, 0, sizeof(*ntable) * (newmax-prinst.maxtempstrings));
-	prinst.maxtempstrings = newmax;
-	if (prinst.tempstrings)
-		progfuncs->funcs.parms->memfree(prinst.tempstrings);
-	prinst.tempstrings = ntable;
+	while (prinst.gccontext)
+	{
+#ifdef THREADEDGC
+		if (!prinst.gccontext->done)
+			COM_WorkerPartialSync(prinst.gccontext, &prinst.gccontext->done, false);
+#endif
+		PR_QCGC_Sweep(progfuncs, prinst.gccontext, ~(size_t)0);
+	}
 }
 static string_t PDECL PR_AllocTempStringLen			(pubprogfuncs_t *ppf, char **str, unsigned int len)
 {
@@ -1401,16 +1628,11 @@ static string_t PDECL PR_AllocTempStringLen			(pubprogfuncs_t *ppf, char **str,
 
 	if (prinst.livetemps == prinst.maxtempstrings)
 	{
-#ifdef THREADEDGC
 		//need to wait for the gc to finish, otherwise it might be wiping freed strings that we're still using.
-		while (prinst.gccontext)
-		{
-			COM_WorkerPartialSync(prinst.gccontext, &prinst.gccontext->done, false);
-			PR_RunGC(progfuncs);
-		}
-#endif
+		PR_QCGC_Finish(progfuncs);
 
-		PR_ExpandTempStrings(progfuncs, prinst.maxtempstrings*2 + 1024);
+		if (prinst.livetemps == prinst.maxtempstrings)
+			PR_ExpandTempStrings(progfuncs, prinst.maxtempstrings*2 + 1024);
 	}
 
 	for (i = prinst.nexttempstring; i < prinst.maxtempstrings && prinst.tempstrings[i]; i++)
@@ -1435,75 +1657,22 @@ static string_t PDECL PR_AllocTempStringLen			(pubprogfuncs_t *ppf, char **str,
 }
 void PR_RunGC (progfuncs_t *progfuncs)
 {
-#ifdef THREADEDGC
 	if (!prinst.gccontext)
-#endif
 	{
 		if (prinst.livetemps < prinst.maxtempstrings/2 || prinst.nexttempstring < prinst.maxtempstrings/2)
 		{	//don't bother yet
 			return;
 		}
-#ifdef THREADEDGC
-		if (externs->usethreadedgc)
-		{
-#ifdef GCTIMINGS
-			double starttime = Sys_DoubleTime(), endtime;
-#endif
-			struct qcgccontext_s *gc = prinst.gccontext = malloc(sizeof(*gc) - sizeof(gc->amem) + prinst.addressableused + sizeof(*gc->tempstrings)*prinst.maxtempstrings);
-			gc->done = false;
-			gc->clearedtemps = 0;
-			gc->progfuncs = progfuncs;
-
-			gc->memsize = prinst.addressableused;
-			memcpy(gc->amem, prinst.addressablehunk, prinst.addressableused);
-
-			gc->maxtemps = prinst.maxtempstrings;
-			gc->tempstrings = (void*)((char*)gc->amem+prinst.addressableused);
-			memcpy(gc->tempstrings, prinst.tempstrings, sizeof(*gc->tempstrings)*gc->maxtemps);
-
-			COM_InsertWork(WG_LOADER, PR_QCGC_Thread, gc, NULL, 0, 0);
-
-#ifdef GCTIMINGS
-			endtime = Sys_DoubleTime();
-			gc->externs->Printf("preparetime=%f\n", (endtime - starttime));
-#endif
-			return;
-		}
-#endif
-		{	//same-thread gc.
-			smallbool *marked = PR_QCGC_Mark(prinst.addressablehunk, prinst.addressableused, prinst.maxtempstrings);
-			size_t swept = PR_QCGC_Sweep(progfuncs, marked, prinst.tempstrings, prinst.maxtempstrings);
-			prinst.livetemps -= swept;
-
-			//if over half the (max)strings are still live, just increase the max so we are not spamming collections
-			if (prinst.livetemps >= prinst.maxtempstrings/2)
-				PR_ExpandTempStrings(progfuncs, prinst.maxtempstrings * 2);
-		}
-	}
-#ifdef THREADEDGC
-	else if (prinst.gccontext->done)
-	{
-		prinst.livetemps -= prinst.gccontext->clearedtemps;
-		free(prinst.gccontext);
-		prinst.gccontext = NULL;
-
-		//if over half the (max)strings are still live, just increase the max so we are not spamming collections
-		if (prinst.livetemps >= prinst.maxtempstrings/2)
-			PR_ExpandTempStrings(progfuncs, prinst.maxtempstrings * 2);
+		PR_QCGC_Begin(progfuncs);
 	}
-#endif
+	if (prinst.gccontext->done)
+		PR_QCGC_Sweep(progfuncs, prinst.gccontext, max(QCGC_SWEEPSTEP, prinst.gccontext->maxtemps/QCGC_SWEEPSPLIT));
 }
 
 static void PR_FreeAllTemps			(progfuncs_t *progfuncs)
 {
 	unsigned int i;
-#ifdef THREADEDGC
-	while (prinst.gccontext)
-	{
-		COM_WorkerPartialSync(prinst.gccontext, &prinst.gccontext->done, false);
-		PR_RunGC(progfuncs);
-	}
-#endif
+	PR_QCGC_Finish(progfuncs);
 	for (i = 0; i < prinst.maxtempstrings; i++)
 	{
 		externs->memfree(prinst.tempstrings[i]);
@@ -1762,6 +1931,12 @@ static pubprogfuncs_t deffuncs = {
 	PR_DumpProfiles,
 
 	0, NULL,
+	{NULL, 0},	//user
+
+	ED_Count,
+	PR_memstats,
+	PR_StartCallGraph,
+	PR_StopCallGraph,
 };
 static int PDECL qclib_null_printf(const char *s, ...)
 {
@@ -1828,6 +2003,7 @@ static void PDECL PR_Shutdown(pubprogfuncs_t *ppf)
 	inst->inst.tempstrings = NULL;
 
 	free(inst->inst.watch_name);
+	PR_CallGraphFree(inst);
 
 	if (inst->inst.field)
 		f(inst->inst.field);
@@ -32,6 +32,126 @@ void PDECL QC_ClearEdict (pubprogfuncs_t *ppf, struct edict_s *ed)
 	e->entnum = num;
 }
 
+#define ED_NOLINK (~0u)
+struct edfreelink_s
+{
+	unsigned int next;
+	unsigned int prev;
+	pbool queued;
+	pbool object;
+};
+
+void ED_ResetFreeQueue (progfuncs_t *progfuncs)
+{
+	int q;
+	for (q = 0; q < 2; q++)
+	{
+		prinst.edfree[q].head = prinst.edfree[q].tail = ED_NOLINK;
+		prinst.edfree[q].count = 0;
+	}
+	prinst.objectfloor = prinst.maxedicts;
+	prinst.edstats_reused = prinst.edstats_fresh = prinst.edstats_early = prinst.edstats_scanned = 0;
+	if (prinst.maxedicts)
+		prinst.edfreelink = PRHunkAlloc(progfuncs, sizeof(*prinst.edfreelink)*prinst.maxedicts, "edfreelink");
+	else
+		prinst.edfreelink = NULL;
+}
+
+static void ED_Unqueue (progfuncs_t *progfuncs, unsigned int num)
+{
+	struct edfreelink_s *l = &prinst.edfreelink[num];
+	int q = l->object;
+	if (l->prev != ED_NOLINK)
+		prinst.edfreelink[l->prev].next = l->next;
+	else
+		prinst.edfree[q].head = l->next;
+	if (l->next != ED_NOLINK)
+		prinst.edfreelink[l->next].prev = l->prev;
+	else
+		prinst.edfree[q].tail = l->prev;
+	prinst.edfree[q].count--;
+	l->queued = false;
+}
+
+//adds a free edict to the reuse queue. the queue stays sorted by freetime so long as gametime doesn't go backwards.
+static void ED_Enqueue (progfuncs_t *progfuncs, edictrun_t *e, pbool object)
+{
+	unsigned int num = e->entnum;
+	struct edfreelink_s *l;
+	int q = !!object;
+	if (!prinst.edfreelink || num >= prinst.maxedicts || prinst.edicttable[num] != e)
+		return;
+	l = &prinst.edfreelink[num];
+	if (l->queued)
+		ED_Unqueue(progfuncs, num);
+	l->object = q;
+	l->queued = true;
+	if (e->freetime < 2 || prinst.edfree[q].head == ED_NOLINK)
+	{	//instantly reusable, so it can skip to the front.
+		l->prev = ED_NOLINK;
+		l->next = prinst.edfree[q].head;
+		if (l->next != ED_NOLINK)
+			prinst.edfreelink[l->next].prev = num;
+		else
+			prinst.edfree[q].tail = num;
+		prinst.edfree[q].head = num;
+	}
+	else
+	{
+		l->next = ED_NOLINK;
+		l->prev = prinst.edfree[q].tail;
+		prinst.edfreelink[l->prev].next = num;
+		prinst.edfree[q].tail = num;
+	}
+	prinst.edfree[q].count++;
+}
+
+// the first couple seconds of server time can involve a lot of
+// freeing and allocating, so relax the replacement policy
+static pbool ED_CanReuse (progfuncs_t *progfuncs, edictrun_t *e)
+{
+	float now = *externs->gametime;
+	return e->freetime < 2 || e->freetime > now || now - e->freetime > 0.5;	//(freetime > now means the clock was reset, so its old)
+}
+
+//takes the oldest edict from the queue, if it has been free for long enough (or regardless, if force is set).
+static unsigned int ED_PopFree (progfuncs_t *progfuncs, int q, pbool force)
+{
+	unsigned int num;
+	edictrun_t *e;
+	while ((num = prinst.edfree[q].head) != ED_NOLINK)
+	{
+		e = prinst.edicttable[num];
+		if (e && e->ereftype != ER_FREE)
+		{	//something brought it back to life without going through ED_AllocIndex
+			ED_Unqueue(progfuncs, num);
+			continue;
+		}
+		if (e && !force && !ED_CanReuse(progfuncs, e))
+			return ED_NOLINK;	//everything after this was freed more recently, so don't bother looking further
+		ED_Unqueue(progfuncs, num);
+		return num;
+	}
+	return ED_NOLINK;
+}
+
+//last resort, for edicts that were marked free without going through ED_Free.
+static unsigned int ED_ScanFree (progfuncs_t *progfuncs, unsigned int end, pbool force)
+{
+	unsigned int i;
+	edictrun_t *e;
+	for (i = 1; i < end; i++)
+	{
+		e = prinst.edicttable[i];
+		if (!e || (e->ereftype == ER_FREE && (force || ED_CanReuse(progfuncs, e))))
+		{
+			prinst.edstats_scanned++;
+			return i;
+		}
+	}
+	return ED_NOLINK;
+}
+
 struct edict_s *PDECL ED_AllocIndex (pubprogfuncs_t *ppf, unsigned int num, pbool object, size_t extrasize)
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
@@ -44,17 +164,21 @@ struct edict_s *PDECL ED_AllocIndex (pubprogfuncs_t *ppf, unsigned int num, pboo
 		externs->Sys_Error ("ED_AllocIndex: index %u exceeds limit of %u", num, prinst.maxedicts);
 		return NULL;
 	}
+	if (prinst.edfreelink && prinst.edfreelink[num].queued)
+		ED_Unqueue(progfuncs, num);
 	if (!object)
 	{
 		while(sv_num_edicts < num)
 		{	//fill in any holes
 			e = (edictrun_t*)EDICT_NUM(progfuncs, sv_num_edicts);
 			if (!e)
-			{
+			{	//bumps sv_num_edicts itself
 				e = (edictrun_t*)ED_AllocIndex(&progfuncs->funcs, sv_num_edicts, object, extrasize);
 				e->ereftype=ER_FREE;
+				ED_Enqueue(progfuncs, e, false);
 			}
-			sv_num_edicts++;
+			else
+				sv_num_edicts++;
 		}
 		if (num >= sv_num_edicts)
 			sv_num_edicts=num+1;
@@ -100,60 +224,61 @@ Try to avoid reusing an entity that was recently freed, because it
 can cause the client to think the entity morphed into something else
 instead of being removed and recreated, which can cause interpolated
 angles and bad trails.
+Freed edicts are reused in the order they were freed.
 =================
 */
 struct edict_s *PDECL ED_Alloc (pubprogfuncs_t *ppf, pbool object, size_t extrasize)
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
 	unsigned int			i;
-	edictrun_t		*e;
 
 	if (object)
 	{
 		//objects are allocated at the end (won't be networked, so this reduces issues with users on old protocols).
 		//also they're potentially higher than num_edicts, which is handy.
-		for ( i=prinst.maxedicts-1 ; i>0 ; i--)
+		i = ED_PopFree(progfuncs, 1, false);
+		if (i == ED_NOLINK)
 		{
-			e = (edictrun_t*)EDICT_NUM(progfuncs, i);
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if (!e || (e->ereftype==ER_FREE && ( e->freetime < 2 || *externs->gametime - e->freetime > 0.5 ) ))
-				return ED_AllocIndex(&progfuncs->funcs, i, object, extrasize);
+			while (prinst.objectfloor > 1 && prinst.edicttable[prinst.objectfloor-1])
+				prinst.objectfloor--;
+			if (prinst.objectfloor > 1)
+			{
+				i = --prinst.objectfloor;
+				prinst.edstats_fresh++;
+			}
+			else if ((i = ED_PopFree(progfuncs, 0, false)) == ED_NOLINK)
+				i = ED_ScanFree(progfuncs, prinst.maxedicts, false);
+			else
+				prinst.edstats_reused++;
 		}
-		externs->Sys_Error ("ED_Alloc: no free edicts (max is %i)", prinst.maxedicts);
+		else
+			prinst.edstats_reused++;
+		if (i == ED_NOLINK)
+			externs->Sys_Error ("ED_Alloc: no free edicts (max is %i)", prinst.maxedicts);
+		return ED_AllocIndex(&progfuncs->funcs, i, object, extrasize);
 	}
 
-	//define this to wastefully allocate extra ents, to test network capabilities.
-#define STEP 1//((i <= 32)?1:8)
-
-	for ( i=0 ; i<sv_num_edicts ; i+=STEP)
+	i = ED_PopFree(progfuncs, 0, false);
+	if (i != ED_NOLINK)
+		prinst.edstats_reused++;
+	else if (sv_num_edicts < prinst.maxedicts-1)
 	{
-		e = (edictrun_t*)EDICT_NUM(progfuncs, i);
-		// the first couple seconds of server time can involve a lot of
-		// freeing and allocating, so relax the replacement policy
-		if (!e || (e->ereftype==ER_FREE && ( e->freetime < 2 || *externs->gametime - e->freetime > 0.5 ) ))
-			return ED_AllocIndex(&progfuncs->funcs, i, object, extrasize);
+		i = sv_num_edicts;
+		prinst.edstats_fresh++;
 	}
+	else
+	{	//try again, but use timed out ents.
+		i = ED_PopFree(progfuncs, 0, true);
+		if (i != ED_NOLINK)
+			prinst.edstats_early++;
+		else
+			i = ED_ScanFree(progfuncs, sv_num_edicts, true);
 
-	if (i >= prinst.maxedicts-1)	//try again, but use timed out ents.
-	{
-		for ( i=0 ; i<sv_num_edicts ; i+=STEP)
-		{
-			e = (edictrun_t*)EDICT_NUM(progfuncs, i);
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if (!e || (e->ereftype==ER_FREE))
-				return ED_AllocIndex(&progfuncs->funcs, i, object, extrasize);
-		}
-
-		if (i >= prinst.maxedicts-2)
-		{
-			PR_RunWarning(&progfuncs->funcs, "Running out of edicts\n");
-		}
-		if (i >= prinst.maxedicts-1)
+		if (i == ED_NOLINK)
 		{
 			size_t size;
 			char *buf;
+			PR_RunWarning(&progfuncs->funcs, "Running out of edicts\n");
 			buf = PR_SaveEnts(&progfuncs->funcs, NULL, &size, 0, 0);
 			progfuncs->funcs.parms->WriteFile("edalloc.dump", buf, size);
 			externs->Sys_Error ("ED_Alloc: no free edicts (max is %i)", prinst.maxedicts);
@@ -175,6 +300,7 @@ void PDECL ED_Free (pubprogfuncs_t *ppf, struct edict_s *ed, pbool instant)
 {
 	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
 	edictrun_t *e = (edictrun_t *)ed;
+	pbool object;
 //	SV_UnlinkEdict (ed);		// unlink from world bsp
 
 	if (e->ereftype == ER_FREE)	//this happens on start.bsp where an onlyregistered trigger killtargets itself (when all of this sort die after 1 trigger anyway).
@@ -192,8 +318,10 @@ void PDECL ED_Free (pubprogfuncs_t *ppf, struct edict_s *ed, pbool instant)
 		if (!externs->entcanfree(ed))	//can stop an ent from being freed.
 			return;
 
+	object = e->ereftype == ER_OBJECT;
 	e->ereftype = ER_FREE;
 	e->freetime = instant?0:(float)*externs->gametime;
+	ED_Enqueue(progfuncs, e, object);
 
 /*
 	ed->v.model = 0;
@@ -1127,6 +1255,8 @@ void ED_PrintEdicts (progfuncs_t *progfuncs)
 		ED_PrintNum (progfuncs, i);
 }
 
+#endif
+
 /*
 =============
 ED_Count
@@ -1134,35 +1264,31 @@ ED_Count
 For debugging
 =============
 */
-void ED_Count (progfuncs_t *progfuncs)
+void PDECL ED_Count (pubprogfuncs_t *ppf)
 {
+	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
 	unsigned int		i;
 	edictrun_t	*ent;
-	unsigned int		active, models, solid, step;
+	unsigned int		active, objects;
 
-	active = models = solid = step = 0;
-	for (i=0 ; i<sv_num_edicts ; i++)
+	active = objects = 0;
+	for (i=0 ; i<prinst.maxedicts ; i++)
 	{
-		ent = (edictrun_t *)EDICT_NUM(progfuncs, i);
-		if (ent->isfree)
+		ent = prinst.edicttable[i];
+		if (!ent || ent->ereftype == ER_FREE)
 			continue;
-		active++;
-//		if (ent->v.solid)
-//			solid++;
-//		if (ent->v.model)
-//			models++;
-//		if (ent->v.movetype == MOVETYPE_STEP)
-//			step++;
+		if (ent->ereftype == ER_OBJECT)
+			objects++;
+		else
+			active++;
 	}
 
 	externs->Printf ("num_edicts:%3i\n", sv_num_edicts);
 	externs->Printf ("active    :%3i\n", active);
-//	Con_Printf ("view      :%3i\n", models);
-//	Con_Printf ("touch     :%3i\n", solid);
-//	Con_Printf ("step      :%3i\n", step);
-
+	externs->Printf ("objects   :%3i\n", objects);
+	externs->Printf ("queued    :%3i entities, %i objects\n", prinst.edfree[0].count, prinst.edfree[1].count);
+	externs->Printf ("allocs    :%3i reused, %i new, %i reused early, %i found by scanning\n", prinst.edstats_reused, prinst.edstats_fresh, prinst.edstats_early, prinst.edstats_scanned);
 }
-#endif
 
 
 //============================================================================
@@ -1580,7 +1706,10 @@ cont:
 	}
 
 	if (!init)
+	{
 		ent->ereftype = ER_FREE;
+		ED_Enqueue(progfuncs, ent, false);
+	}
 
 	return data;
 }
@@ -2141,6 +2270,7 @@ int PDECL PR_LoadEnts(pubprogfuncs_t *ppf, const char *file, void *ctx, void (PD
 					{
 						ed = (edictrun_t *)ED_AllocIndex(&progfuncs->funcs, num, false, 0);
 						ed->ereftype = ER_FREE;
+						ED_Enqueue(progfuncs, ed, false);
 						if (externs->entspawn)
 							externs->entspawn((struct edict_s *) ed, true);
 					}
@@ -2231,6 +2361,7 @@ int PDECL PR_LoadEnts(pubprogfuncs_t *ppf, const char *file, void *ctx, void (PD
 					{
 						ed = (edictrun_t *)ED_AllocIndex(&progfuncs->funcs, num, false, 0);
 						ed->ereftype = ER_FREE;
+						ED_Enqueue(progfuncs, ed, false);
 					}
 
 					if (externs->entspawn)
@@ -2431,6 +2562,7 @@ int PDECL PR_LoadEnts(pubprogfuncs_t *ppf, const char *file, void *ctx, void (PD
 					{
 						ed = (edictrun_t *)ED_AllocIndex(&progfuncs->funcs, num, false, 0);
 						ed->ereftype = ER_FREE;
+						ED_Enqueue(progfuncs, ed, false);
 					}
 				}
 			}
@@ -82,6 +82,19 @@
 
 #if !defined(Sys_GetClock) && defined(__unix__)
 	#include <time.h>
+	#ifdef CLOCK_MONOTONIC
+		//clock() only ticks in microseconds (at best), which is too coarse for timing individual calls. this is usually a vdso call so its cheap too.
+		static prclocks_t Sys_GetClock(void)
+		{
+			struct timespec c;
+			clock_gettime(CLOCK_MONOTONIC, &c);
+			return (c.tv_sec*1000000000ull) + c.tv_nsec;
+		}
+		#define Sys_GetClock Sys_GetClock
+		prclocks_t Sys_GetClockRate(void) { return 1000000000ull; }
+	#endif
+#endif
+#if !defined(Sys_GetClock) && defined(__unix__)
 	#define Sys_GetClock() clock()
 	prclocks_t Sys_GetClockRate(void) { return CLOCKS_PER_SEC; }
 #endif
@@ -499,6 +512,278 @@ The interpretation main loop
 ============================================================================
 */
 
+/*
+====================
+PR_CallGraphEnter
+
+Moves the call graph into f, returning the node to restore on exit
+====================
+*/
+unsigned int PR_CallGraphEnter (progfuncs_t *progfuncs, mfunction_t *f)
+{
+	unsigned int caller = prinst.cgnode, i, *link;
+	prcallnode_t *n;
+
+	//find the existing path, and move it to the front, as the same callee tends to be called repeatedly
+	for (link = &prinst.cgnodes[caller].child; (i = *link); link = &prinst.cgnodes[i].sibling)
+	{
+		if (prinst.cgnodes[i].f == f)
+		{
+			*link = prinst.cgnodes[i].sibling;
+			break;
+		}
+	}
+	if (!i)
+	{
+		if (prinst.cgnumnodes == prinst.cgmaxnodes)
+		{
+			n = realloc(prinst.cgnodes, sizeof(*prinst.cgnodes) * prinst.cgmaxnodes * 2);
+			if (!n)
+			{	//stop recording, but keep what we have so it can still be written out.
+				externs->Printf("qc call graph: out of memory, recording stopped\n");
+				prinst.cgactive = false;
+				return caller;
+			}
+			prinst.cgnodes = n;
+			prinst.cgmaxnodes *= 2;
+		}
+		i = prinst.cgnumnodes++;
+		n = &prinst.cgnodes[i];
+		memset(n, 0, sizeof(*n));
+		n->f = f;
+		n->parent = caller;
+	}
+	n = &prinst.cgnodes[i];
+	n->sibling = prinst.cgnodes[caller].child;
+	prinst.cgnodes[caller].child = i;
+	n->calls++;
+
+	prinst.cgnode = i;
+	return caller;
+}
+
+/*
+====================
+PR_CallGraphLeave
+====================
+*/
+void PR_CallGraphLeave (progfuncs_t *progfuncs, unsigned int caller, prclocks_t start, prclocks_t duration)
+{
+	prcallevent_t *ev;
+	if (prinst.cgnode >= prinst.cgnumnodes || caller >= prinst.cgnumnodes)
+	{	//recording was restarted underneath us.
+		prinst.cgnode = 0;
+		return;
+	}
+	prinst.cgnodes[prinst.cgnode].total += duration;
+	prinst.cgnodes[caller].childtime += duration;
+
+	if (prinst.cgnumevents < prinst.cgmaxevents)
+	{
+		ev = &prinst.cgevents[prinst.cgnumevents++];
+		ev->node = prinst.cgnode;
+		ev->start = start;
+		ev->duration = duration;
+	}
+	else
+		prinst.cgdroppedevents++;
+
+	prinst.cgnode = caller;
+}
+
+//so builtins show up in the call graph, instead of being lumped in with whatever called them.
+static void PR_CallGraphBuiltin (progfuncs_t *progfuncs, mfunction_t *f, builtin_t builtin)
+{
+	prclocks_t start = Sys_GetClock();
+	unsigned int caller = PR_CallGraphEnter(progfuncs, f);
+	(*builtin) (&progfuncs->funcs, (struct globalvars_s *)current_progstate->globals);
+	if (prinst.cgactive)
+		PR_CallGraphLeave(progfuncs, caller, start, Sys_GetClock() - start);
+}
+
+void PR_CallGraphFree (progfuncs_t *progfuncs)
+{
+	if (prinst.cgnodes)
+		prinst.profiling = prinst.cgwasprofiling;
+	prinst.cgactive = false;
+	free(prinst.cgnodes);
+	prinst.cgnodes = NULL;
+	prinst.cgnumnodes = prinst.cgmaxnodes = 0;
+	prinst.cgnode = 0;
+	free(prinst.cgevents);
+	prinst.cgevents = NULL;
+	prinst.cgnumevents = prinst.cgmaxevents = prinst.cgdroppedevents = 0;
+}
+
+//starts (or restarts) recording every call path, along with a timeline of the first maxevents calls.
+pbool PDECL PR_StartCallGraph (pubprogfuncs_t *ppf, size_t maxevents)
+{
+	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
+	pbool wasprofiling;
+	if (prinst.pr_depth)
+		return false;	//we'd not know where to return to.
+
+	wasprofiling = prinst.cgnodes?prinst.cgwasprofiling:prinst.profiling;
+	PR_CallGraphFree(progfuncs);
+
+	prinst.cgmaxnodes = 1024;
+	prinst.cgnodes = malloc(sizeof(*prinst.cgnodes) * prinst.cgmaxnodes);
+	if (!prinst.cgnodes)
+	{
+		prinst.cgmaxnodes = 0;
+		return false;
+	}
+	memset(prinst.cgnodes, 0, sizeof(*prinst.cgnodes));	//the engine
+	prinst.cgnumnodes = 1;
+	prinst.cgnode = 0;
+	prinst.cgevents = maxevents?malloc(sizeof(*prinst.cgevents) * maxevents):NULL;
+	prinst.cgmaxevents = prinst.cgevents?maxevents:0;
+
+	prinst.cgwasprofiling = wasprofiling;
+	prinst.profiling = true;	//we need the timestamps, and the interpreter
+	prinst.cgstarttime = Sys_GetClock();
+	prinst.cgactive = true;
+	return true;
+}
+
+typedef struct
+{
+	char *data;
+	size_t len;
+	size_t max;
+	pbool failed;	//ran out of memory, don't write anything.
+} cgtext_t;
+static void PR_CallGraphText (cgtext_t *t, const char *str)
+{
+	size_t len = strlen(str);
+	char *n;
+	if (t->failed)
+		return;
+	if (t->len + len > t->max)
+	{
+		n = realloc(t->data, (t->len + len)*2 + 65536);
+		if (!n)
+		{
+			t->failed = true;
+			return;
+		}
+		t->data = n;
+		t->max = (t->len + len)*2 + 65536;
+	}
+	memcpy(t->data + t->len, str, len);
+	t->len += len;
+}
+//json strings need a few chars escaped. qc function names shouldn't have any, but they're not our names.
+static void PR_CallGraphJSONString (cgtext_t *t, const char *str)
+{
+	char tmp[8] = {0, 0};
+	PR_CallGraphText(t, "\"");
+	for (; *str; str++)
+	{
+		if ((unsigned char)*str < ' ')
+		{
+			snprintf(tmp, sizeof(tmp), "\\u%04x", (unsigned char)*str);
+			PR_CallGraphText(t, tmp);
+			tmp[1] = 0;
+			continue;
+		}
+		if (*str == '\"' || *str == '\\')
+			PR_CallGraphText(t, "\\");
+		tmp[0] = *str;
+		PR_CallGraphText(t, tmp);
+	}
+	PR_CallGraphText(t, "\"");
+}
+static const char *PR_CallGraphName (progfuncs_t *progfuncs, unsigned int node)
+{
+	mfunction_t *f = prinst.cgnodes[node].f;
+	return f?PR_StringToNative(&progfuncs->funcs, f->s_name):"engine";
+}
+
+//stops recording. the call paths are written to foldedname as folded stacks (one 'a;b;c selftime' line per path, in microseconds, for flamegraph tools).
+//the timeline is written to tracename as chrome trace-event json (for chrome://tracing, perfetto, speedscope, etc).
+pbool PDECL PR_StopCallGraph (pubprogfuncs_t *ppf, const char *foldedname, const char *tracename)
+{
+	progfuncs_t *progfuncs = (progfuncs_t*)ppf;
+	double usecs = 1000000.0 / ull2dbl(Sys_GetClockRate());
+	cgtext_t t = {NULL};
+	char tmp[256];
+	unsigned int n, i, depth, *path;
+	prcallnode_t *node;
+	prcallevent_t *ev;
+	size_t e;
+	double self;
+
+	if (!prinst.cgnodes)
+		return false;
+	prinst.cgactive = false;
+
+	if (foldedname)
+	{
+		path = malloc(sizeof(*path) * prinst.cgnumnodes);
+		for (n = 1; path && n < prinst.cgnumnodes; n++)
+		{
+			node = &prinst.cgnodes[n];
+			self = ull2dbl(node->total - node->childtime) * usecs;
+			if (self < 0.5)
+				continue;	//not worth listing.
+			for (depth = 0, i = n; i; i = prinst.cgnodes[i].parent)
+				path[depth++] = i;
+			while (depth --> 0)
+			{
+				PR_CallGraphText(&t, PR_CallGraphName(progfuncs, path[depth]));
+				PR_CallGraphText(&t, depth?";":"");
+			}
+			snprintf(tmp, sizeof(tmp), " %.0f\n", self);
+			PR_CallGraphText(&t, tmp);
+		}
+		if (!path || t.failed)
+			externs->Printf("Unable to write %s: out of memory\n", foldedname);
+		else
+		{
+			if (t.len)
+				externs->WriteFile(foldedname, t.data, t.len);
+			externs->Printf("Wrote %u call paths to %s\n", prinst.cgnumnodes-1, foldedname);
+		}
+		free(path);
+		t.len = 0;
+		t.failed = false;
+	}
+
+	if (tracename)
+	{
+		PR_CallGraphText(&t, "{\"traceEvents\":[\n");
+		for (e = 0; e < prinst.cgnumevents; e++)
+		{
+			ev = &prinst.cgevents[e];
+			node = &prinst.cgnodes[ev->node];
+			PR_CallGraphText(&t, "{\"name\":");
+			PR_CallGraphJSONString(&t, PR_CallGraphName(progfuncs, ev->node));
+			snprintf(tmp, sizeof(tmp), ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+				(node->f && node->f->first_statement <= 0)?"builtin":"qc",
+				ull2dbl(ev->start - prinst.cgstarttime) * usecs, ull2dbl(ev->duration) * usecs,
+				(e+1 < prinst.cgnumevents)?",":"");
+			PR_CallGraphText(&t, tmp);
+		}
+		snprintf(tmp, sizeof(tmp), "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%u}}\n", (unsigned int)prinst.cgdroppedevents);
+		PR_CallGraphText(&t, tmp);
+		if (t.failed)
+			externs->Printf("Unable to write %s: out of memory\n", tracename);
+		else
+		{
+			externs->WriteFile(tracename, t.data, t.len);
+			if (prinst.cgdroppedevents)
+				externs->Printf("Wrote %u calls to %s (%u more did not fit)\n", (unsigned int)prinst.cgnumevents, tracename, (unsigned int)prinst.cgdroppedevents);
+			else
+				externs->Printf("Wrote %u calls to %s\n", (unsigned int)prinst.cgnumevents, tracename);
+		}
+	}
+	free(t.data);
+
+	PR_CallGraphFree(progfuncs);
+	return true;
+}
+
 /*
 ====================
 PR_EnterFunction
@@ -533,6 +818,12 @@ static int ASMCALL PR_EnterFunction (progfuncs_t *progfuncs, mfunction_t *f, int
 	if (prinst.profiling)
 	{
 		st->timestamp = Sys_GetClock();
+		if (prinst.cgactive)
+		{
+			if (st == prinst.pr_stack)
+				prinst.cgnode = 0;	//the engine is calling in. forget about anything left over from an aborted call.
+			st->cgcaller = PR_CallGraphEnter(progfuncs, f);
+		}
 	}
 
 	prinst.localstack_used += prinst.spushed;	//make sure the call doesn't hurt pushed pointers
@@ -604,6 +895,8 @@ static int ASMCALL PR_LeaveFunction (progfuncs_t *progfuncs)
 		if (cycles > prinst.profilingalert)
 			externs->Printf("QC call to %s took over a second\n", PR_StringToNative(&progfuncs->funcs,prinst.pr_xfunction->s_name));
 		prinst.pr_xfunction->profiletime += cycles;
+		if (prinst.cgactive)
+			PR_CallGraphLeave(progfuncs, st->cgcaller, st->timestamp, cycles);
 		prinst.pr_xfunction = st->f;
 		if (prinst.pr_depth)
 			prinst.pr_xfunction->profilechildtime += cycles;
@@ -1187,6 +1480,14 @@ int PDECL PR_ToggleBreakpoint(pubprogfuncs_t *ppf, const char *filename, int lin
 		if (!cp->progs)
 			continue;
 
+#ifdef QCJIT_AMD64
+		if (cp->jit && flag != 3)
+		{	//compiled code doesn't know about breakpoints, so stick to the interpreter from now on.
+			PR_CloseJit(cp->jit);
+			cp->jit = NULL;
+		}
+#endif
+
 		if (linenum)	//linenum is set means to set the breakpoint on a file and line
 		{
 			struct sortedfunc_s *sortedstatements;
@@ -1806,7 +2107,7 @@ static void PR_ExecuteCode (progfuncs_t *progfuncs, int s)
 //		prinst->watch_ptr = NULL;
 	}
 
-#ifdef QCJIT
+#if defined(QCJIT) && !defined(QCJIT_AMD64)
 	if (current_progstate->jit)
 	{
 		PR_EnterJIT(progfuncs, current_progstate->jit, s);
@@ -1818,6 +2119,11 @@ static void PR_ExecuteCode (progfuncs_t *progfuncs, int s)
 
 	for(;;)
 	{
+#ifdef QCJIT_AMD64
+		//run as much as we can natively, the interpreter gets whatever the jit couldn't handle (and anything while debugging).
+		if (current_progstate->jit && !progfuncs->funcs.debug_trace && !prinst.watch_ptr && !prinst.profiling)
+			s = PR_EnterJIT(progfuncs, current_progstate->jit, s, &runaway);
+#endif
 		switch (current_progstate->structtype)
 		{
 		case PST_DEFAULT:
@@ -111,7 +111,8 @@ progsnum_t PDECL PR_LoadProgs(pubprogfuncs_t *ppf, const char *s)
 					progfuncs->funcs.numprogs = a+1;
 
 #ifdef QCJIT
-				current_progstate->jit = PR_GenerateJit(progfuncs);
+				if (!externs->nojit)
+					current_progstate->jit = PR_GenerateJit(progfuncs);
 #endif
 				if (oldtype != -1)
 					PR_SwitchProgs(progfuncs, oldtype);
@@ -141,6 +142,7 @@ void PR_Clear(progfuncs_t *progfuncs)
 #ifdef QCJIT
 		if (pr_progstate[a].jit)
 			PR_CloseJit(pr_progstate[a].jit);
+		pr_progstate[a].jit = NULL;
 #endif
 		pr_progstate[a].progs = NULL;
 	}
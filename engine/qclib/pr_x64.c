@@ -0,0 +1,776 @@
+/*
+amd64 (sysv abi) load-time compiler for qc statements.
+
+unlike pr_x86.c, this doesn't try to take over the whole vm.
+every statement gets some native code, but only the common opcodes actually get compiled.
+anything else (calls, returns, strings, state, switches, breakpoints, etc) just exits back to the interpreter, which executes it and then keeps interpreting.
+the interpreter only hands control back to us at its next OP_GOTO (see execloop.h), so code after a call runs interpreted until the next loop back-edge or else-branch.
+slow paths (bad entity numbers, bad pointers, fields out of range) also exit to the interpreter so that it can generate the proper warnings.
+
+registers while running:
+	rbx - globals
+	r12 - progfuncs
+	r14 - runaway counter
+	eax, ecx, edx, xmm0, xmm1 - temps
+entry takes (globals, progfuncs, runaway, target) and returns the statement before the one that the interpreter should resume at, just like PR_ExecuteCode16 does.
+*/
+
+#define PROGSUSED
+#include "progsint.h"
+
+#ifdef QCJIT_AMD64
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define JIT_MAXSTATEMENTSIZE 192	//largest amount of code any single statement can generate (load_v is the big one)
+
+typedef int (*jitentry_t)(float *glob, progfuncs_t *progfuncs, int *runaway, void *target);
+
+struct jitstate
+{
+	unsigned int *statementjumps;	//pairs of [codeofs, statement]
+	unsigned char **statementoffsets;
+	unsigned int numjumps;
+	unsigned int numstatements;
+	unsigned char *code;
+	size_t codesize;
+	size_t codemax;
+	unsigned int epilogue;
+	jitentry_t entry;
+};
+
+typedef struct
+{
+	unsigned int op;
+	unsigned int a, b, c;
+} jitop_t;
+
+enum
+{
+	REG_EAX,
+	REG_ECX,
+	REG_EDX,
+	REG_EBX
+};
+
+static void Jit_EmitByte(struct jitstate *jit, unsigned char byte)
+{
+	jit->code[jit->codesize++] = byte;
+}
+static void Jit_Emit4Byte(struct jitstate *jit, unsigned int value)
+{
+	jit->code[jit->codesize++] = (value>> 0)&0xff;
+	jit->code[jit->codesize++] = (value>> 8)&0xff;
+	jit->code[jit->codesize++] = (value>>16)&0xff;
+	jit->code[jit->codesize++] = (value>>24)&0xff;
+}
+static void Jit_Emit8Byte(struct jitstate *jit, unsigned long long value)
+{
+	Jit_Emit4Byte(jit, (unsigned int)value);
+	Jit_Emit4Byte(jit, (unsigned int)(value>>32));
+}
+static void Jit_EmitRel32(struct jitstate *jit, size_t target)
+{
+	Jit_Emit4Byte(jit, (unsigned int)(target - (jit->codesize+4)));
+}
+//rel32 to the start of some statement, filled in once everything is generated.
+static void Jit_EmitStatementJump(struct jitstate *jit, unsigned int statement)
+{
+	jit->statementjumps[jit->numjumps++] = jit->codesize;
+	jit->statementjumps[jit->numjumps++] = statement;
+	jit->codesize += 4;
+}
+
+#define EmitByte(v) Jit_EmitByte(jit, v)
+#define Emit4Byte(v) Jit_Emit4Byte(jit, v)
+
+//modrm for [rbx+glob*4]
+#define GLOB(reg,ofs) EmitByte(0x80 | ((reg)<<3) | REG_EBX);Emit4Byte((ofs)*4);
+//modrm for [r12+ofs], which needs an sib byte.
+#define PROGFUNCS(reg,ofs) EmitByte(0x84 | ((reg)<<3));EmitByte(0x24);Emit4Byte(ofs);
+//modrm for [rcx+ofs]
+#define RCXOFS(reg,ofs) EmitByte(0x81 | ((reg)<<3));Emit4Byte(ofs);
+
+#define LOADREG(ofs,reg)		EmitByte(0x8b);GLOB(reg,ofs)					//mov glob[ofs],%reg
+#define STOREREG(reg,ofs)		EmitByte(0x89);GLOB(reg,ofs)					//mov %reg,glob[ofs]
+#define LOADPTR(ofs,reg)		EmitByte(0x49);EmitByte(0x8b);PROGFUNCS(reg,ofs)	//mov ofs(%r12),%reg64
+#define INTOP(opc,ofs)			EmitByte(opc);GLOB(REG_EAX,ofs)				//op glob[ofs],%eax
+#define SSEOP(opc,xmm,ofs)		EmitByte(0xf3);EmitByte(0x0f);EmitByte(opc);GLOB(xmm,ofs)	//op glob[ofs],%xmm
+#define SSEREG(opc,xd,xs)		EmitByte(0xf3);EmitByte(0x0f);EmitByte(opc);EmitByte(0xc0|((xd)<<3)|(xs))
+#define LOADF(ofs,xmm)			SSEOP(0x10,xmm,ofs)							//movss glob[ofs],%xmm
+#define STOREF(xmm,ofs)			SSEOP(0x11,xmm,ofs)							//movss %xmm,glob[ofs]
+#define CVTSI2SS(ofs,xmm)		SSEOP(0x2a,xmm,ofs)							//cvtsi2ssl glob[ofs],%xmm
+#define CVTTSS2SI(ofs,reg)		SSEOP(0x2c,reg,ofs)							//cvttss2si glob[ofs],%reg
+#define UCOMISS(xmm,ofs)		EmitByte(0x0f);EmitByte(0x2e);GLOB(xmm,ofs)	//ucomiss glob[ofs],%xmm
+#define TESTGLOB(ofs,mask)		EmitByte(0xf7);GLOB(0,ofs);Emit4Byte(mask)	//testl $mask,glob[ofs]
+#define CMPGLOB0(ofs)			EmitByte(0x83);GLOB(7,ofs);EmitByte(0)		//cmpl $0,glob[ofs]
+#define SETCC(cc,reg)			EmitByte(0x0f);EmitByte(0x90|(cc));EmitByte(0xc0|(reg))	//setcc %reg8
+
+//condition codes
+#define CC_B	0x2
+#define CC_AE	0x3
+#define CC_E	0x4
+#define CC_NE	0x5
+#define CC_BE	0x6
+#define CC_A	0x7
+#define CC_P	0xa
+#define CC_NP	0xb
+#define CC_L	0xc
+#define CC_GE	0xd
+#define CC_LE	0xe
+#define CC_G	0xf
+
+//convert the bool in %al into an int or a float and store it in glob[ofs]
+static void Jit_StoreBool(struct jitstate *jit, unsigned int ofs, pbool asfloat)
+{
+	//movzbl %al,%eax
+	EmitByte(0x0f);EmitByte(0xb6);EmitByte(0xc0);
+	if (asfloat)
+	{	//imul $1.0f,%eax,%eax
+		EmitByte(0x69);EmitByte(0xc0);Emit4Byte(0x3f800000);
+	}
+	STOREREG(REG_EAX, ofs);
+}
+
+//mov $(statement-1),%eax; jmp epilogue
+static void Jit_EmitExit(struct jitstate *jit, unsigned int statement)
+{
+	EmitByte(0xb8);Emit4Byte(statement-1);
+	EmitByte(0xe9);Jit_EmitRel32(jit, jit->epilogue);
+}
+
+//jcc to a later exit stub. returns the location to pass to Jit_EmitFailStub.
+static size_t Jit_EmitFailJump(struct jitstate *jit, int cc)
+{
+	EmitByte(0x0f);EmitByte(0x80|cc);
+	jit->codesize += 4;
+	return jit->codesize;
+}
+//emits 'jmp done; fail: exit; done:', and points the given jumps at the fail stub.
+static void Jit_EmitFailStub(struct jitstate *jit, unsigned int statement, size_t *fails, int numfails)
+{
+	size_t skip, here;
+	EmitByte(0xeb);EmitByte(0);
+	skip = jit->codesize;
+	here = jit->codesize;
+	while (numfails-->0)
+	{
+		size_t f = fails[numfails];
+		unsigned int rel = (unsigned int)(here - f);
+		jit->code[f-4] = (rel>> 0)&0xff;
+		jit->code[f-3] = (rel>> 8)&0xff;
+		jit->code[f-2] = (rel>>16)&0xff;
+		jit->code[f-1] = (rel>>24)&0xff;
+	}
+	Jit_EmitExit(jit, statement);
+	jit->code[skip-1] = (unsigned char)(jit->codesize - skip);
+}
+
+//the interpreter counts every branch, so we need to too or infinite loops will hang the server instead of erroring.
+//when it runs out we let the interpreter do the branch so that it can generate the error.
+static void Jit_EmitRunawayCheck(struct jitstate *jit, unsigned int statement)
+{
+	size_t skip;
+	//subl $1,(%r14)
+	EmitByte(0x41);EmitByte(0x83);EmitByte(0x2e);EmitByte(0x01);
+	//jnz ok
+	EmitByte(0x75);EmitByte(0);
+	skip = jit->codesize;
+	//movl $1,(%r14)
+	EmitByte(0x41);EmitByte(0xc7);EmitByte(0x06);Emit4Byte(1);
+	Jit_EmitExit(jit, statement);
+	jit->code[skip-1] = (unsigned char)(jit->codesize - skip);
+}
+
+//validates glob[ent] and leaves the edictrun_t in rcx and the ent number in eax.
+static void Jit_EmitEdict(struct jitstate *jit, progfuncs_t *progfuncs, unsigned int ent, size_t *fails, int *numfails)
+{
+	LOADREG(ent, REG_EAX);
+	//movabs $num_edicts,%rcx
+	EmitByte(0x48);EmitByte(0xb9);Jit_Emit8Byte(jit, (size_t)externs->num_edicts);
+	//cmp (%rcx),%eax
+	EmitByte(0x3b);EmitByte(0x01);
+	fails[(*numfails)++] = Jit_EmitFailJump(jit, CC_AE);
+	//mov edicttable(%r12),%rcx
+	LOADPTR(offsetof(progfuncs_t, inst.edicttable), REG_ECX);
+	//mov (%rcx,%rax,8),%rcx
+	EmitByte(0x48);EmitByte(0x8b);EmitByte(0x0c);EmitByte(0xc1);
+}
+
+//leaves the sign-extended field index in rax
+static void Jit_EmitFieldIndex(struct jitstate *jit, unsigned int fld)
+{
+	LOADREG(fld, REG_EAX);
+	//add fieldadjust(%r12),%eax
+	EmitByte(0x41);EmitByte(0x03);PROGFUNCS(REG_EAX, offsetof(progfuncs_t, funcs.fieldadjust));
+	//movslq %eax,%rax
+	EmitByte(0x48);EmitByte(0x63);EmitByte(0xc0);
+}
+
+//validates a qc pointer write of the given size at glob[b]+glob[c]*4, leaving the native address as (%rdx,%rax)
+static void Jit_EmitPointer(struct jitstate *jit, unsigned int b, unsigned int c, unsigned int size, size_t *fails, int *numfails)
+{
+	LOADREG(b, REG_EAX);
+	LOADREG(c, REG_EDX);
+	//shl $2,%edx
+	EmitByte(0xc1);EmitByte(0xe2);EmitByte(0x02);
+	//add %edx,%eax
+	EmitByte(0x01);EmitByte(0xd0);
+	//lea -1(%rax),%ecx
+	EmitByte(0x8d);EmitByte(0x48);EmitByte(0xff);
+	//mov addressableused(%r12),%rdx
+	LOADPTR(offsetof(progfuncs_t, inst.addressableused), REG_EDX);
+	//sub $(1+size),%rdx
+	EmitByte(0x48);EmitByte(0x83);EmitByte(0xea);EmitByte(1+size);
+	//cmp %rdx,%rcx
+	EmitByte(0x48);EmitByte(0x39);EmitByte(0xd1);
+	fails[(*numfails)++] = Jit_EmitFailJump(jit, CC_AE);
+	//cmpl $0,numasleep(%r12)
+	EmitByte(0x41);EmitByte(0x83);PROGFUNCS(7, offsetof(progfuncs_t, funcs.numasleep));EmitByte(0);
+	//je over the next two
+	EmitByte(0x74);EmitByte(8+6);
+	//cmp lastaddress(%r12),%eax	(anything else might be a sleeping entity, which the interpreter wakes)
+	EmitByte(0x41);EmitByte(0x3b);PROGFUNCS(REG_EAX, offsetof(progfuncs_t, funcs.lastaddress));
+	fails[(*numfails)++] = Jit_EmitFailJump(jit, CC_NE);
+	//mov stringtable(%r12),%rdx
+	LOADPTR(offsetof(progfuncs_t, funcs.stringtable), REG_EDX);
+}
+
+static pbool Jit_EmitStatement(struct jitstate *jit, progfuncs_t *progfuncs, jitop_t *op, unsigned int i)
+{
+	size_t fails[8];
+	int numfails = 0;
+	int k;
+	unsigned int target;
+
+	switch(op->op)
+	{
+	//float maths
+	case OP_ADD_F:
+	case OP_SUB_F:
+	case OP_MUL_F:
+	case OP_DIV_F:
+		LOADF(op->a, 0);
+		SSEOP((op->op==OP_ADD_F)?0x58:(op->op==OP_SUB_F)?0x5c:(op->op==OP_MUL_F)?0x59:0x5e, 0, op->b);
+		STOREF(0, op->c);
+		break;
+	case OP_ADD_V:
+	case OP_SUB_V:
+		for (k = 0; k < 3; k++)
+		{
+			LOADF(op->a+k, 0);
+			SSEOP((op->op==OP_ADD_V)?0x58:0x5c, 0, op->b+k);
+			STOREF(0, op->c+k);
+		}
+		break;
+	case OP_MUL_V:
+		LOADF(op->a+0, 0);
+		SSEOP(0x59, 0, op->b+0);
+		for (k = 1; k < 3; k++)
+		{
+			LOADF(op->a+k, 1);
+			SSEOP(0x59, 1, op->b+k);
+			SSEREG(0x58, 0, 1);	//addss %xmm1,%xmm0
+		}
+		STOREF(0, op->c);
+		break;
+	case OP_MUL_FV:
+	case OP_MUL_VF:
+	case OP_DIV_VF:
+		LOADF((op->op==OP_MUL_FV)?op->a:op->b, 1);
+		for (k = 0; k < 3; k++)
+		{
+			LOADF(((op->op==OP_MUL_FV)?op->b:op->a)+k, 0);
+			SSEREG((op->op==OP_DIV_VF)?0x5e:0x59, 0, 1);
+			STOREF(0, op->c+k);
+		}
+		break;
+	case OP_ADD_FI:
+	case OP_SUB_FI:
+		LOADF(op->a, 0);
+		CVTSI2SS(op->b, 1);
+		SSEREG((op->op==OP_ADD_FI)?0x58:0x5c, 0, 1);
+		STOREF(0, op->c);
+		break;
+	case OP_ADD_IF:
+	case OP_SUB_IF:
+		CVTSI2SS(op->a, 0);
+		SSEOP((op->op==OP_ADD_IF)?0x58:0x5c, 0, op->b);
+		STOREF(0, op->c);
+		break;
+	case OP_BITAND_F:
+	case OP_BITOR_F:
+		CVTTSS2SI(op->a, REG_EAX);
+		CVTTSS2SI(op->b, REG_ECX);
+		//and/or %ecx,%eax
+		EmitByte((op->op==OP_BITAND_F)?0x21:0x09);EmitByte(0xc8);
+		//cvtsi2ss %eax,%xmm0
+		SSEREG(0x2a, 0, REG_EAX);
+		STOREF(0, op->c);
+		break;
+
+	//float comparisons. ucomiss sets CF+ZF+PF for nans, which conveniently makes them all false (except ne).
+	case OP_EQ_F:
+	case OP_NE_F:
+		LOADF(op->a, 0);
+		UCOMISS(0, op->b);
+		SETCC((op->op==OP_EQ_F)?CC_E:CC_NE, REG_EAX);
+		SETCC((op->op==OP_EQ_F)?CC_NP:CC_P, REG_ECX);
+		//and/or %cl,%al
+		EmitByte((op->op==OP_EQ_F)?0x20:0x08);EmitByte(0xc8);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_LT_F:
+	case OP_LE_F:
+		LOADF(op->b, 0);
+		UCOMISS(0, op->a);
+		SETCC((op->op==OP_LT_F)?CC_A:CC_AE, REG_EAX);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_GT_F:
+	case OP_GE_F:
+		LOADF(op->a, 0);
+		UCOMISS(0, op->b);
+		SETCC((op->op==OP_GT_F)?CC_A:CC_AE, REG_EAX);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+
+	//integer comparisons
+	case OP_EQ_E:
+	case OP_NE_E:
+	case OP_EQ_FNC:
+	case OP_NE_FNC:
+	case OP_EQ_I:
+	case OP_NE_I:
+	case OP_LT_I:
+	case OP_LE_I:
+	case OP_GT_I:
+	case OP_GE_I:
+		LOADREG(op->a, REG_EAX);
+		INTOP(0x3b, op->b);	//cmp glob[b],%eax
+		switch(op->op)
+		{
+		case OP_EQ_E:
+		case OP_EQ_FNC:
+		case OP_EQ_I:	SETCC(CC_E, REG_EAX);	break;
+		case OP_NE_E:
+		case OP_NE_FNC:
+		case OP_NE_I:	SETCC(CC_NE, REG_EAX);	break;
+		case OP_LT_I:	SETCC(CC_L, REG_EAX);	break;
+		case OP_LE_I:	SETCC(CC_LE, REG_EAX);	break;
+		case OP_GT_I:	SETCC(CC_G, REG_EAX);	break;
+		default:		SETCC(CC_GE, REG_EAX);	break;
+		}
+		Jit_StoreBool(jit, op->c, op->op==OP_EQ_E||op->op==OP_NE_E||op->op==OP_EQ_FNC||op->op==OP_NE_FNC);
+		break;
+
+	//logic
+	case OP_NOT_F:
+		TESTGLOB(op->a, 0x7fffffff);
+		SETCC(CC_E, REG_EAX);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_NOT_FNC:
+		TESTGLOB(op->a, 0x00ffffff);
+		SETCC(CC_E, REG_EAX);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_NOT_ENT:
+	case OP_NOT_I:
+		CMPGLOB0(op->a);
+		SETCC(CC_E, REG_EAX);
+		Jit_StoreBool(jit, op->c, op->op==OP_NOT_ENT);
+		break;
+	case OP_NOT_V:
+		//xorps %xmm1,%xmm1
+		EmitByte(0x0f);EmitByte(0x57);EmitByte(0xc9);
+		//the result is true only if all three compare equal (and ordered) with 0.
+		//movb $1,%al
+		EmitByte(0xb0);EmitByte(0x01);
+		for (k = 0; k < 3; k++)
+		{
+			UCOMISS(1, op->a+k);
+			SETCC(CC_E, REG_ECX);
+			//and %cl,%al
+			EmitByte(0x20);EmitByte(0xc8);
+			SETCC(CC_NP, REG_ECX);
+			EmitByte(0x20);EmitByte(0xc8);
+		}
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_EQ_V:
+	case OP_NE_V:
+		//movb $(eq),%al
+		EmitByte(0xb0);EmitByte(op->op==OP_EQ_V);
+		for (k = 0; k < 3; k++)
+		{
+			LOADF(op->a+k, 0);
+			UCOMISS(0, op->b+k);
+			SETCC((op->op==OP_EQ_V)?CC_E:CC_NE, REG_ECX);
+			//and/or %cl,%al
+			EmitByte((op->op==OP_EQ_V)?0x20:0x08);EmitByte(0xc8);
+			SETCC((op->op==OP_EQ_V)?CC_NP:CC_P, REG_ECX);
+			EmitByte((op->op==OP_EQ_V)?0x20:0x08);EmitByte(0xc8);
+		}
+		Jit_StoreBool(jit, op->c, true);
+		break;
+	case OP_AND_F:
+	case OP_OR_F:
+		TESTGLOB(op->a, 0x7fffffff);
+		SETCC(CC_NE, REG_EAX);
+		TESTGLOB(op->b, 0x7fffffff);
+		SETCC(CC_NE, REG_ECX);
+		EmitByte((op->op==OP_AND_F)?0x20:0x08);EmitByte(0xc8);
+		Jit_StoreBool(jit, op->c, true);
+		break;
+
+	//integer maths
+	case OP_ADD_I:
+	case OP_SUB_I:
+	case OP_BITAND_I:
+	case OP_BITOR_I:
+	case OP_BITXOR_I:
+		LOADREG(op->a, REG_EAX);
+		INTOP((op->op==OP_ADD_I)?0x03:(op->op==OP_SUB_I)?0x2b:(op->op==OP_BITAND_I)?0x23:(op->op==OP_BITOR_I)?0x0b:0x33, op->b);
+		STOREREG(REG_EAX, op->c);
+		break;
+	case OP_MUL_I:
+		LOADREG(op->a, REG_EAX);
+		//imul glob[b],%eax
+		EmitByte(0x0f);INTOP(0xaf, op->b);
+		STOREREG(REG_EAX, op->c);
+		break;
+	case OP_LSHIFT_I:
+	case OP_RSHIFT_I:
+	case OP_RSHIFT_U:
+		LOADREG(op->a, REG_EAX);
+		LOADREG(op->b, REG_ECX);
+		//shl/sar/shr %cl,%eax
+		EmitByte(0xd3);EmitByte((op->op==OP_LSHIFT_I)?0xe0:(op->op==OP_RSHIFT_I)?0xf8:0xe8);
+		STOREREG(REG_EAX, op->c);
+		break;
+	case OP_CONV_ITOF:
+		CVTSI2SS(op->a, 0);
+		STOREF(0, op->c);
+		break;
+	case OP_CONV_FTOI:
+		CVTTSS2SI(op->a, REG_EAX);
+		STOREREG(REG_EAX, op->c);
+		break;
+
+	//stores
+	case OP_STORE_F:
+	case OP_STORE_ENT:
+	case OP_STORE_FLD:
+	case OP_STORE_S:
+	case OP_STORE_I:
+	case OP_STORE_FNC:
+	case OP_STORE_P:
+		LOADREG(op->a, REG_EAX);
+		STOREREG(REG_EAX, op->b);
+		break;
+	case OP_STORE_V:
+		for (k = 0; k < 3; k++)
+		{
+			LOADREG(op->a+k, REG_EAX);
+			STOREREG(REG_EAX, op->b+k);
+		}
+		break;
+	case OP_STORE_IF:
+		CVTSI2SS(op->a, 0);
+		STOREF(0, op->b);
+		break;
+	case OP_STORE_FI:
+		CVTTSS2SI(op->a, REG_EAX);
+		STOREREG(REG_EAX, op->b);
+		break;
+
+	case OP_STOREP_F:
+	case OP_STOREP_ENT:
+	case OP_STOREP_FLD:
+	case OP_STOREP_S:
+	case OP_STOREP_I:
+	case OP_STOREP_FNC:
+	case OP_STOREP_V:
+		Jit_EmitPointer(jit, op->b, op->c, (op->op==OP_STOREP_V)?12:4, fails, &numfails);
+		for (k = 0; k < ((op->op==OP_STOREP_V)?3:1); k++)
+		{
+			LOADREG(op->a+k, REG_ECX);
+			//mov %ecx,k*4(%rdx,%rax)
+			EmitByte(0x89);EmitByte(0x4c);EmitByte(0x02);EmitByte(k*4);
+		}
+		Jit_EmitFailStub(jit, i, fails, numfails);
+		break;
+
+	//entity fields
+	case OP_LOAD_F:
+	case OP_LOAD_ENT:
+	case OP_LOAD_FLD:
+	case OP_LOAD_S:
+	case OP_LOAD_I:
+	case OP_LOAD_FNC:
+	case OP_LOAD_P:
+	case OP_LOAD_V:
+		Jit_EmitEdict(jit, progfuncs, op->a, fails, &numfails);
+#ifdef NOLEGACY	//the interpreter warns about reading from free ents then, so let it.
+		//cmpl $ER_FREE,ereftype(%rcx)
+		EmitByte(0x83);RCXOFS(7, offsetof(edictrun_t, ereftype));EmitByte(ER_FREE);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_E);
+#endif
+		Jit_EmitFieldIndex(jit, op->b);
+		//lea (count*4)(,%rax,4),%edx
+		EmitByte(0x8d);EmitByte(0x14);EmitByte(0x85);Emit4Byte(((op->op==OP_LOAD_V)?3:1)*4);
+		//cmp fieldsize(%rcx),%edx
+		EmitByte(0x3b);RCXOFS(REG_EDX, offsetof(edictrun_t, fieldsize));
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_A);
+		//mov fields(%rcx),%rcx
+		EmitByte(0x48);EmitByte(0x8b);RCXOFS(REG_ECX, offsetof(edictrun_t, fields));
+		for (k = 0; k < ((op->op==OP_LOAD_V)?3:1); k++)
+		{
+			//mov k*4(%rcx,%rax,4),%edx
+			EmitByte(0x8b);EmitByte(0x54);EmitByte(0x81);EmitByte(k*4);
+			STOREREG(REG_EDX, op->c+k);
+		}
+		Jit_EmitFailStub(jit, i, fails, numfails);
+		break;
+	case OP_ADDRESS:
+		Jit_EmitEdict(jit, progfuncs, op->a, fails, &numfails);
+		//test %rcx,%rcx
+		EmitByte(0x48);EmitByte(0x85);EmitByte(0xc9);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_E);
+		//cmpl $0,readonly(%rcx)
+		EmitByte(0x83);RCXOFS(7, offsetof(edictrun_t, readonly));EmitByte(0);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_NE);
+		//cmpl $0,asleep(%rcx)	(the interpreter wakes it)
+		EmitByte(0x83);RCXOFS(7, offsetof(edictrun_t, asleep));EmitByte(0);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_NE);
+		Jit_EmitFieldIndex(jit, op->b);
+		//mov fields(%rcx),%rcx
+		EmitByte(0x48);EmitByte(0x8b);RCXOFS(REG_ECX, offsetof(edictrun_t, fields));
+		//lea (%rcx,%rax,4),%rax
+		EmitByte(0x48);EmitByte(0x8d);EmitByte(0x04);EmitByte(0x81);
+		//sub stringtable(%r12),%rax
+		EmitByte(0x49);EmitByte(0x2b);PROGFUNCS(REG_EAX, offsetof(progfuncs_t, funcs.stringtable));
+		STOREREG(REG_EAX, op->c);
+		//mov %eax,lastaddress(%r12)
+		EmitByte(0x41);EmitByte(0x89);PROGFUNCS(REG_EAX, offsetof(progfuncs_t, funcs.lastaddress));
+		Jit_EmitFailStub(jit, i, fails, numfails);
+		break;
+
+#ifndef NOLEGACY	//the interpreter also rejects free ents then, leave that to it.
+	case OP_STOREF_F:
+	case OP_STOREF_S:
+	case OP_STOREF_I:
+	case OP_STOREF_V:
+		Jit_EmitEdict(jit, progfuncs, op->a, fails, &numfails);
+		//test %rcx,%rcx
+		EmitByte(0x48);EmitByte(0x85);EmitByte(0xc9);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_E);
+		//cmpl $0,readonly(%rcx)
+		EmitByte(0x83);RCXOFS(7, offsetof(edictrun_t, readonly));EmitByte(0);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_NE);
+		//cmpl $0,asleep(%rcx)	(the interpreter wakes it)
+		EmitByte(0x83);RCXOFS(7, offsetof(edictrun_t, asleep));EmitByte(0);
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_NE);
+		Jit_EmitFieldIndex(jit, op->b);
+		//lea (count*4)(,%rax,4),%edx
+		EmitByte(0x8d);EmitByte(0x14);EmitByte(0x85);Emit4Byte(((op->op==OP_STOREF_V)?3:1)*4);
+		//cmp fieldsize(%rcx),%edx
+		EmitByte(0x3b);RCXOFS(REG_EDX, offsetof(edictrun_t, fieldsize));
+		fails[numfails++] = Jit_EmitFailJump(jit, CC_A);
+		//mov fields(%rcx),%rcx
+		EmitByte(0x48);EmitByte(0x8b);RCXOFS(REG_ECX, offsetof(edictrun_t, fields));
+		for (k = 0; k < ((op->op==OP_STOREF_V)?3:1); k++)
+		{
+			LOADREG(op->c+k, REG_EDX);
+			//mov %edx,k*4(%rcx,%rax,4)
+			EmitByte(0x89);EmitByte(0x54);EmitByte(0x81);EmitByte(k*4);
+		}
+		Jit_EmitFailStub(jit, i, fails, numfails);
+		break;
+#endif
+
+	//control flow
+	case OP_GOTO:
+		target = i + (int)op->a;
+		if (target >= jit->numstatements)
+			return false;
+		if (target <= i)
+			Jit_EmitRunawayCheck(jit, i);
+		EmitByte(0xe9);Jit_EmitStatementJump(jit, target);
+		break;
+	case OP_IF_I:
+	case OP_IFNOT_I:
+	case OP_IF_F:
+	case OP_IFNOT_F:
+		target = i + (int)op->b;
+		if (target >= jit->numstatements)
+			return false;
+		if (target <= i)
+			Jit_EmitRunawayCheck(jit, i);
+		if (op->op == OP_IF_F || op->op == OP_IFNOT_F)
+		{
+			TESTGLOB(op->a, 0x7fffffff);	//ignore the sign bit, so -0 is false
+		}
+		else
+		{
+			CMPGLOB0(op->a);
+		}
+		EmitByte(0x0f);EmitByte(0x80|((op->op==OP_IF_I||op->op==OP_IF_F)?CC_NE:CC_E));
+		Jit_EmitStatementJump(jit, target);
+		break;
+
+	default:
+		//calls, returns, strings, switches, state, breakpoints, and anything else that's rare or complex enough to want the interpreter.
+		return false;
+	}
+	return true;
+}
+
+void PR_CloseJit(struct jitstate *jit)
+{
+	if (jit)
+	{
+		free(jit->statementjumps);
+		free(jit->statementoffsets);
+		if (jit->code)
+			munmap(jit->code, jit->codemax);
+		free(jit);
+	}
+}
+
+struct jitstate *PR_GenerateJit(progfuncs_t *progfuncs)
+{
+	struct jitstate *jit;
+	unsigned int i, j, compiled = 0;
+	unsigned int numstatements = current_progstate->progs->numstatements;
+	jitop_t op;
+
+	if (!numstatements)
+		return NULL;
+	switch(current_progstate->structtype)
+	{
+	case PST_DEFAULT:
+	case PST_QTEST:
+	case PST_KKQWSV:
+	case PST_FTE32:
+	case PST_UHEXEN2:
+		break;
+	default:
+		return NULL;
+	}
+
+	jit = calloc(1, sizeof(*jit));
+	jit->numstatements = numstatements;
+	jit->statementjumps = malloc(numstatements*2*sizeof(*jit->statementjumps));
+	jit->statementoffsets = malloc(numstatements*sizeof(*jit->statementoffsets));
+	jit->codemax = 64 + (size_t)(numstatements+1)*JIT_MAXSTATEMENTSIZE;
+	jit->code = mmap(NULL, jit->codemax, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+	if (jit->code == MAP_FAILED || !jit->statementjumps || !jit->statementoffsets)
+	{
+		if (jit->code == MAP_FAILED)
+			jit->code = NULL;
+		PR_CloseJit(jit);
+		return NULL;
+	}
+
+	//prologue
+	//push %rbx; push %r12; push %r14
+	EmitByte(0x53);
+	EmitByte(0x41);EmitByte(0x54);
+	EmitByte(0x41);EmitByte(0x56);
+	//mov %rdi,%rbx
+	EmitByte(0x48);EmitByte(0x89);EmitByte(0xfb);
+	//mov %rsi,%r12
+	EmitByte(0x49);EmitByte(0x89);EmitByte(0xf4);
+	//mov %rdx,%r14
+	EmitByte(0x49);EmitByte(0x89);EmitByte(0xd6);
+	//jmp *%rcx
+	EmitByte(0xff);EmitByte(0xe1);
+
+	//epilogue, everything jumps back here with the return value in eax.
+	jit->epilogue = jit->codesize;
+	//pop %r14; pop %r12; pop %rbx
+	EmitByte(0x41);EmitByte(0x5e);
+	EmitByte(0x41);EmitByte(0x5c);
+	EmitByte(0x5b);
+	//ret
+	EmitByte(0xc3);
+
+	for (i = 0; i < numstatements; i++)
+	{
+		if (current_progstate->structtype == PST_DEFAULT || current_progstate->structtype == PST_QTEST)
+		{
+			dstatement16_t *st = (dstatement16_t*)current_progstate->statements + i;
+			op.op = st->op;
+			op.a = st->a;
+			op.b = st->b;
+			op.c = st->c;
+			//branch offsets are signed, everything else is an unsigned global index.
+			switch(op.op)
+			{
+			case OP_GOTO:
+				op.a = (unsigned int)(signed short)st->a;
+				break;
+			case OP_IF_I:
+			case OP_IFNOT_I:
+			case OP_IF_F:
+			case OP_IFNOT_F:
+				op.b = (unsigned int)(signed short)st->b;
+				break;
+			}
+		}
+		else
+		{
+			dstatement32_t *st = (dstatement32_t*)current_progstate->statements + i;
+			op.op = st->op;
+			op.a = st->a;
+			op.b = st->b;
+			op.c = st->c;
+		}
+
+		jit->statementoffsets[i] = jit->code + jit->codesize;
+		j = jit->codesize;
+		if (Jit_EmitStatement(jit, progfuncs, &op, i))
+			compiled++;
+		else
+		{	//undo anything it might have started, and leave it to the interpreter.
+			jit->codesize = j;
+			while (jit->numjumps && jit->statementjumps[jit->numjumps-2] >= j)
+				jit->numjumps -= 2;
+			Jit_EmitExit(jit, i);
+		}
+	}
+	//shouldn't be reachable, as the last statement is always a done. just in case.
+	Jit_EmitExit(jit, numstatements);
+
+	for (j = 0; j < jit->numjumps; j += 2)
+	{
+		unsigned char *src = jit->code + jit->statementjumps[j];
+		unsigned int rel = (unsigned int)(jit->statementoffsets[jit->statementjumps[j+1]] - (src+4));
+		src[0] = (rel>> 0)&0xff;
+		src[1] = (rel>> 8)&0xff;
+		src[2] = (rel>>16)&0xff;
+		src[3] = (rel>>24)&0xff;
+	}
+
+	if (mprotect(jit->code, jit->codemax, PROT_READ|PROT_EXEC))
+	{
+		PR_CloseJit(jit);
+		return NULL;
+	}
+	jit->entry = (jitentry_t)(void*)jit->code;
+
+	externs->DPrintf("QCJIT: compiled %u of %u statements (%u bytes)\n", compiled, numstatements, (unsigned int)jit->codesize);
+	return jit;
+}
+
+//runs native code from the statement after 'statement', and returns the statement before the one that the interpreter needs to handle.
+int PR_EnterJIT(progfuncs_t *progfuncs, struct jitstate *jit, int statement, int *runaway)
+{
+	if ((unsigned int)(statement+1) >= jit->numstatements)
+		return statement;
+	return jit->entry(current_progstate->globals, progfuncs, runaway, jit->statementoffsets[statement+1]);
+}
+#endif
@@ -40,7 +40,7 @@ optimisations:
 #define PROGSUSED
 #include "progsint.h"
 
-#ifdef QCJIT
+#if defined(QCJIT) && !defined(QCJIT_AMD64)	//see pr_x64.c for that
 
 #ifndef _WIN32
 #include <sys/mman.h>
@@ -101,8 +101,27 @@ typedef struct
 	int				s;
 	int				pushed;
 	prclocks_t		timestamp;
+	unsigned int	cgcaller;	//call graph node to return to
 } prstack_t;
 
+//call graph profiling. each node is one unique call path, so the same function called from two places gets two nodes.
+typedef struct prcallnode_s
+{
+	mfunction_t		*f;			//qc function or builtin. NULL for the engine (node 0).
+	unsigned int	parent;
+	unsigned int	child;		//first callee
+	unsigned int	sibling;	//next callee of our parent
+	unsigned int	calls;
+	prclocks_t		total;		//time inside, including callees
+	prclocks_t		childtime;	//time inside callees
+} prcallnode_t;
+typedef struct
+{
+	unsigned int	node;
+	prclocks_t		start;
+	prclocks_t		duration;
+} prcallevent_t;
+
 #if defined(QCGC) && defined(MULTITHREAD)
 	#define THREADEDGC
 #endif
@@ -122,9 +141,15 @@ typedef struct prinst_s
 #if defined(QCGC)
 	unsigned int nexttempstring;
 	unsigned int livetemps;	//increased on alloc, decremented after sweep
-	#ifdef THREADEDGC
-		struct qcgccontext_s *gccontext;
-	#endif
+	struct qcgccontext_s *gccontext;	//collection in progress
+	struct
+	{
+		unsigned int collections;
+		unsigned int lastswept;
+		size_t totalswept;
+		unsigned int lastpause, maxpause;	//main-thread stall while starting a collection, in microseconds
+		unsigned int lasttotal;	//from start to end of sweep, in microseconds
+	} gcstats;
 #else
 	unsigned int numtempstrings;
 	unsigned int numtempstringsstack;
@@ -180,6 +205,19 @@ typedef struct prinst_s
 
 	pbool profiling;
 	prclocks_t profilingalert;	//one second, in cpu clocks
+
+	//call graph recording (see PR_CallGraph*)
+	pbool cgactive;
+	pbool cgwasprofiling;		//to restore when the recording stops
+	prclocks_t cgstarttime;
+	prcallnode_t *cgnodes;
+	unsigned int cgnumnodes;
+	unsigned int cgmaxnodes;
+	unsigned int cgnode;		//currently executing path
+	prcallevent_t *cgevents;	//for timelines, in the order that the calls returned
+	size_t cgnumevents;
+	size_t cgmaxevents;
+	size_t cgdroppedevents;
 	mfunction_t	*pr_xfunction;	//active function
 	int pr_xstatement;			//active statement
 
@@ -188,9 +226,25 @@ typedef struct prinst_s
 	unsigned int fields_size;	// in bytes
 	unsigned int max_fields_size;
 
+	//freed edicts are queued oldest-first, so allocating only needs to look at the head of the queue.
+	struct edfreelink_s *edfreelink;	//indexed by entnum
+	struct
+	{
+		unsigned int head, tail, count;
+	} edfree[2];	//[0]=entities, [1]=objects
+	unsigned int objectfloor;	//objects are allocated downwards from maxedicts. slots below this have not been given out to objects yet.
+	unsigned int edstats_reused, edstats_fresh, edstats_early, edstats_scanned;
+
 
 //initlib.c
-	int mfreelist;
+	//qc heap, see PR_memalloc
+#define QCMEM_BINS		86
+#define QCMEM_BINWORDS	((QCMEM_BINS+31)/32)
+	unsigned int mbin[QCMEM_BINS];			//free lists, by size class
+	unsigned int mbinused[QCMEM_BINWORDS];	//bitmask of non-empty free lists
+	unsigned int mallocs[QCMEM_BINS];		//live allocations, by size class
+	unsigned int mtail;						//sentinel of the most recent arena
+	size_t mheapsize, mheapused;
 	char * addressablehunk;
 	size_t addressableused;
 	size_t addressablesize;
@@ -319,6 +373,7 @@ typedef struct edictrun_s
 	unsigned int	entnum;
 	unsigned int	fieldsize;
 	pbool			readonly;	//causes error when QC tries writing to it. (quake's world entity)
+	pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 	void			*fields;
 
 // other fields from progs come immediately after
@@ -338,6 +393,7 @@ void PDECL PR_StackTrace (pubprogfuncs_t *progfuncs, int showlocals);
 
 eval_t *PR_GetReadTempStringPtr(progfuncs_t *progfuncs, string_t str, size_t offset, size_t datasize);
 eval_t *PR_GetWriteTempStringPtr(progfuncs_t *progfuncs, string_t str, size_t offset, size_t datasize);
+void PR_WakePointer(pubprogfuncs_t *inst, pint_t ptr, size_t datasize);
 
 extern int noextensions;
 
@@ -422,10 +478,17 @@ pbool PR_ReallyLoadProgs (progfuncs_t *progfuncs, const char *filename, progstat
 void *PRHunkAlloc(progfuncs_t *progfuncs, int ammount, const char *name);
 
 void PR_Profile_f (void);
+unsigned int PR_CallGraphEnter (progfuncs_t *progfuncs, mfunction_t *f);
+void PR_CallGraphLeave (progfuncs_t *progfuncs, unsigned int caller, prclocks_t start, prclocks_t duration);
+void PR_CallGraphFree (progfuncs_t *progfuncs);
+pbool PDECL PR_StartCallGraph (pubprogfuncs_t *ppf, size_t maxevents);
+pbool PDECL PR_StopCallGraph (pubprogfuncs_t *ppf, const char *foldedname, const char *tracename);
 
 struct edict_s *PDECL ED_Alloc (pubprogfuncs_t *progfuncs, pbool object, size_t extrasize);
 struct edict_s *PDECL ED_AllocIndex (pubprogfuncs_t *progfuncs, unsigned int num, pbool object, size_t extrasize);
 void PDECL ED_Free (pubprogfuncs_t *progfuncs, struct edict_s *ed, pbool instant);
+void ED_ResetFreeQueue (progfuncs_t *progfuncs);
+void PDECL ED_Count (pubprogfuncs_t *ppf);
 
 #ifdef QCGC
 void PR_RunGC			(progfuncs_t *progfuncs);
@@ -563,7 +626,11 @@ pbool CompileFile(progfuncs_t *progfuncs, const char *filename);
 
 struct jitstate;
 struct jitstate *PR_GenerateJit(progfuncs_t *progfuncs);
+#ifdef QCJIT_AMD64
+int PR_EnterJIT(progfuncs_t *progfuncs, struct jitstate *jitstate, int statement, int *runaway);
+#else
 void PR_EnterJIT(progfuncs_t *progfuncs, struct jitstate *jitstate, int statement);
+#endif
 void PR_CloseJit(struct jitstate *jit);
 
 char *QCC_COM_Parse (const char *data);
@@ -40,6 +40,9 @@
 	#if defined(__GNUC__) || defined(_MSC_VER)	//supported compilers (yay for inline asm)
 	//#define QCJIT
 	#endif
+#elif (defined(__x86_64__) || defined(__amd64__)) && defined(__GNUC__) && !defined(_WIN32)	//sysv abi only, win64 passes args differently.
+	#define QCJIT
+	#define QCJIT_AMD64	//hybrid jit, falls back on the interpreter for anything it doesn't know.
 #endif
 
 #define QCBUILTIN ASMCALL
@@ -50,7 +53,7 @@
 #define PDECL
 #endif
 
-#ifdef QCJIT
+#if defined(QCJIT) && !defined(QCJIT_AMD64)
 #define ASMCALL VARGS
 #else
 #define ASMCALL PDECL
@@ -246,6 +249,15 @@ struct pubprogfuncs_s
 		char	*tempstringbase;					//for engine's use. Store your base tempstring pointer here.
 		int		tempstringnum;						//for engine's use.
 	} user;
+
+	void (PDECL *EntCount)						(pubprogfuncs_t *progfuncs);	//prints edict allocation stats
+	void (PDECL *MemStats)						(pubprogfuncs_t *progfuncs);	//prints qc heap usage
+	pbool (PDECL *StartCallGraph)				(pubprogfuncs_t *progfuncs, size_t maxevents);	//records every call path (including builtins), and a timeline of up to maxevents calls. fails if qc is running.
+	pbool (PDECL *StopCallGraph)				(pubprogfuncs_t *progfuncs, const char *foldedname, const char *tracename);	//writes folded stacks and/or chrome trace json (either may be NULL to skip). returns false if not recording.
+
+	//edicts flagged as asleep. writes through pointers skip the field write trap, so while there are any the vm has to look for them itself.
+	unsigned int numasleep;		//the engine counts them as it sets and clears the flag.
+	int lastaddress;			//the field the vm last took the address of (waking it). the engine clears this whenever something falls asleep.
 };
 
 typedef struct progexterns_s {
@@ -293,6 +305,9 @@ typedef struct progexterns_s {
 	int edictsize;	//size of edict_t
 
 	void *user;	/*contains the owner's world reference in FTE*/
+
+	void (PDECL *entwake)				(pubprogfuncs_t *prinst, struct edict_s *ent);	//qc is writing to an entity flagged as asleep. must clear asleep.
+	pbool nojit;	//always use the interpreter, even where there's a jit for this cpu. read each time a progs is loaded.
 } progparms_t, progexterns_t;
 
 #if defined(QCLIBDLL_EXPORTS)
@@ -322,7 +337,7 @@ typedef union eval_s
 #define PR_CURRENT	-1
 #define PR_ANY	-2	//not always valid. Use for finding funcs
 #define PR_ANYBACK -3
-#define PROGSTRUCT_VERSION 4
+#define PROGSTRUCT_VERSION 6
 
 
 #ifndef DLL_PROG
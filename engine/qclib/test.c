@@ -486,6 +486,7 @@ struct edict_s
 	unsigned int	entnum;
 	unsigned int	fieldsize;
 	pbool			readonly;	//causes error when QC tries writing to it. (quake's world entity)
+	pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 	void			*fields;
 };
 void PF_spawn (pubprogfuncs_t *prinst, struct globalvars_s *pr_globals)
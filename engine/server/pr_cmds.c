@@ -236,6 +236,7 @@ void PDECL ED_Spawned (struct edict_s *ent, int loading)
 	if (!ent->xv)
 		ent->xv = (extentvars_t *)(ent->v+1);
 #endif
+	WPhys_WakeEdict(&sv.world, (wedict_t*)ent);
 
 	if (!loading || !ent->xv->uniquespawnid)
 	{
@@ -277,6 +278,7 @@ pbool PDECL ED_CanFree (edict_t *ed)
 		return false;
 	}
 	World_UnlinkEdict ((wedict_t*)ed);		// unlink from world bsp
+	WPhys_WakeEdict(&sv.world, (wedict_t*)ed);
 
 	ed->v->model = 0;
 	ed->v->takedamage = 0;
@@ -327,7 +329,9 @@ pbool PDECL ED_CanFree (edict_t *ed)
 
 static void ASMCALL StateOp (pubprogfuncs_t *prinst, float var, func_t func)
 {
-	stdentvars_t *vars = PROG_TO_EDICT(prinst, pr_global_struct->self)->v;
+	edict_t *e = PROG_TO_EDICT(prinst, pr_global_struct->self);
+	stdentvars_t *vars = e->v;
+	WPhys_WakeEdict(&sv.world, (wedict_t*)e);
 #ifdef HEXEN2
 	if (progstype == PROG_H2)
 		vars->nextthink = pr_global_struct->time+0.05;
@@ -344,6 +348,7 @@ static void ASMCALL CStateOp (pubprogfuncs_t *prinst, float first, float last, f
 	float step;
 	wedict_t *e = PROG_TO_WEDICT(prinst, pr_global_struct->self);
 	float frame = e->v->frame;
+	WPhys_WakeEdict(&sv.world, e);
 
 	if (progstype == PROG_H2)
 		e->v->nextthink = pr_global_struct->time+0.05;
@@ -386,6 +391,7 @@ static void ASMCALL CWStateOp (pubprogfuncs_t *prinst, float first, float last,
 	float step;
 	wedict_t *e = PROG_TO_WEDICT(prinst, pr_global_struct->self);
 	float frame = e->v->weaponframe;
+	WPhys_WakeEdict(&sv.world, e);
 
 	if (progstype == PROG_H2)
 		e->v->nextthink = pr_global_struct->time+0.05;
@@ -426,10 +432,16 @@ static void ASMCALL CWStateOp (pubprogfuncs_t *prinst, float first, float last,
 static void ASMCALL ThinkTimeOp (pubprogfuncs_t *prinst, edict_t *ed, float var)
 {
 	stdentvars_t *vars = ed->v;
+	WPhys_WakeEdict(&sv.world, (wedict_t*)ed);
 	vars->nextthink = pr_global_struct->time+var;
 }
 #endif
 
+static void PDECL SV_EntWake(pubprogfuncs_t *prinst, edict_t *ed)
+{	//qc wrote to a sleeping entity
+	WPhys_WakeEdict(&sv.world, (wedict_t*)ed);
+}
+
 static int SV_ParticlePrecache_Add(const char *pname);
 static pbool PDECL SV_BadField(pubprogfuncs_t *inst, edict_t *foo, const char *keyname, const char *value)
 {
@@ -721,6 +733,7 @@ void Q_SetProgsParms(qboolean forcompiler)
 	svprogparms.cwstateop = CWStateOp;
 	svprogparms.thinktimeop = ThinkTimeOp;
 #endif
+	svprogparms.entwake = SV_EntWake;
 
 	svprogparms.MapNamedBuiltin = PR_SSQC_MapNamedBuiltin;
 	svprogparms.loadcompleate = NULL;//void (*loadcompleate) (int edictsize);	//notification to reset any pointers.
@@ -739,6 +752,7 @@ void Q_SetProgsParms(qboolean forcompiler)
 #ifdef MULTITHREAD
 	svprogparms.usethreadedgc = pr_gc_threaded.ival;
 #endif
+	svprogparms.nojit = !pr_jit.ival;
 
 	svprogparms.edicts = (edict_t**)&sv.world.edicts;
 	svprogparms.num_edicts = &sv.world.num_edicts;
@@ -1499,6 +1513,44 @@ static void PR_SSProfile_f(void)
 			Con_Printf("Enabled ssqc profiling. Re-execute %s to see the results.\n", Cmd_Argv(0));
 }
 
+static void PR_SSCallGraph_f(void)
+{
+	const char *cmd = Cmd_Argv(1);
+	char folded[MAX_QPATH], trace[MAX_QPATH];
+	if (!svprogfuncs || !svprogfuncs->StartCallGraph)
+		Con_Printf("ssqc call graphs are not available\n");
+	else if (!strcmp(cmd, "start"))
+	{
+		if (svprogfuncs->StartCallGraph(svprogfuncs, (Cmd_Argc() > 2)?strtoul(Cmd_Argv(2), NULL, 0):262144))
+			Con_Printf("Recording ssqc call graph. Use '%s stop' to save it.\n", Cmd_Argv(0));
+		else
+			Con_Printf("Unable to start recording from inside qc.\n");
+	}
+	else if (!strcmp(cmd, "stop"))
+	{
+		Q_snprintfz(folded, sizeof(folded), "%s.folded", (Cmd_Argc() > 2)?Cmd_Argv(2):"ssqcprofile");
+		Q_snprintfz(trace, sizeof(trace), "%s.json", (Cmd_Argc() > 2)?Cmd_Argv(2):"ssqcprofile");
+		if (!svprogfuncs->StopCallGraph(svprogfuncs, folded, trace))
+			Con_Printf("Not recording an ssqc call graph.\n");
+	}
+	else if (!strcmp(cmd, "abort"))
+		svprogfuncs->StopCallGraph(svprogfuncs, NULL, NULL);
+	else
+		Con_Printf("%s start [maxevents]: begins recording\n%s stop [name]: writes name.folded and name.json\n%s abort: stops without writing anything\n", Cmd_Argv(0), Cmd_Argv(0), Cmd_Argv(0));
+}
+
+static void PR_SSEdictCount_f(void)
+{
+	if (svprogfuncs && svprogfuncs->EntCount)
+		svprogfuncs->EntCount(svprogfuncs);
+}
+
+static void PR_SSMemStats_f(void)
+{
+	if (svprogfuncs && svprogfuncs->MemStats)
+		svprogfuncs->MemStats(svprogfuncs);
+}
+
 static void PR_SSPoke_f(void)
 {
 	if (MSV_ForwardToAutoServer())
@@ -1560,6 +1612,10 @@ void PR_Init(void)
 	Cmd_AddCommand ("poke_ssqc", PR_SSPoke_f);
 	Cmd_AddCommandD ("profile_ssqc", PR_SSProfile_f, "Displays how much time has been spent in various QC functions since this command was last used.\nIf pr_enable_profiling is set, profiling will be enabled automatically, and can be used to list spawn functions.\nAdd an arg with value 1 if you wish to avoid purging timing information.");
 
+	Cmd_AddCommandD ("profile_ssqc_callgraph", PR_SSCallGraph_f, "Records which QC functions and builtins call which, and how long each call path takes.\nThe results are written as folded stacks (for flamegraph tools) and as a Chrome trace-event timeline of the first maxevents calls.");
+
+	Cmd_AddCommandD ("edictcount", PR_SSEdictCount_f, "Displays how many ssqc edicts are in use, and how they have been allocated.");
+	Cmd_AddCommandD ("pr_memstats", PR_SSMemStats_f, "Displays how the ssqc's heap is being used, including fragmentation and allocations by size.");
 	Cmd_AddCommand ("extensionlist_ssqc", PR_SVExtensionList_f);
 	Cmd_AddCommand ("pr_dumpplatform", PR_DumpPlatform_f);
 
@@ -10179,6 +10235,7 @@ static void QCBUILTIN PF_runclientphys(pubprogfuncs_t *prinst, struct globalvars
 		Con_Printf("runplayerphysics called on read-only entity\n");
 		return;
 	}
+	WPhys_WakeEdict(&sv.world, (wedict_t*)ent);
 
 	VALGRIND_MAKE_MEM_UNDEFINED(&pmove, sizeof(pmove));
 
@@ -67,6 +67,7 @@ typedef struct edict_s
 	int				entnum;
 	unsigned int	fieldsize;
 	pbool			readonly;	//world
+	pbool			asleep;		//physics is skipping it. qc writes call externs->entwake first.
 #ifdef VM_Q1
 	stdentvars_t	*v;
 	extentvars_t	*xv;
@@ -85,6 +86,7 @@ typedef struct edict_s
 #else
 	link_t	area;
 #endif
+	areahashlink_t	areahash;
 	pvscache_t pvsinfo;
 	int lastruntime;
 	int solidsize;
@@ -743,6 +743,12 @@ typedef struct client_s
 	size_t lastseen_count;
 	float *lastseen_time;	//timer for cullentities_trace, so we can get away with fewer traces per test
 
+	size_t snapvis_count;
+	qbyte *snapvis;			//per-entity SNAPVIS_* results from sv_threadedsnapshots, consumed by the next snapshot.
+	qboolean snapvis_valid;
+	unsigned int snapvis_qcgen;	//if qc ran after this, each entity's result needs to be checked against snapshot_precullhash.
+	unsigned int snapvis_camhash;	//the cameras it was culled against, in case qc moved them.
+
 #ifdef VM_Q1
 	int hideentity;
 	qboolean hideplayers;
@@ -1426,6 +1432,7 @@ qboolean PR_ShouldTogglePause(client_t *initiator, qboolean pausedornot);
 // sv_ents.c
 //
 void SV_WriteEntitiesToClient (client_t *client, sizebuf_t *msg, qboolean ignorepvs);
+void SV_Snapshot_PrecullClients(client_t **clients, int count);
 void SVFTE_EmitBaseline(entity_state_t *to, qboolean numberisimportant, sizebuf_t *msg, unsigned int pext2, unsigned int ezext);
 void SVQ3Q1_BuildEntityPacket(client_t *client, packet_entities_t *pack);
 void SV_Snapshot_BuildStateQ1(entity_state_t *state, edict_t *ent, client_t *client, packet_entities_t *pack);
@@ -1693,12 +1700,10 @@ void SV_CheckTimer(void);
 void SV_LogPlayer(client_t *cl, char *msg);
 
 extern vec3_t pmove_mins, pmove_maxs;	//abs min/max extents
-#ifdef USEAREAGRID
 void AddAllLinksToPmove (world_t *w, wedict_t *player);
-#else
+#ifndef USEAREAGRID
 void AddLinksToPmove (world_t *w, wedict_t *player, areanode_t *node);
 void AddLinksToPmove_Force (world_t *w, wedict_t *player, areanode_t *node);
-#define AddAllLinksToPmove(w,p) do{AddLinksToPmove(w,p,(w)->areanodes);AddLinksToPmove_Force(w,p,&(w)->portallist);}while(0)
 #endif
 
 
@@ -38,6 +38,63 @@ typedef struct
 	pvsbuffer_t pvs;
 } pvscamera_t;
 
+//results of SV_Snapshot_PrecullClients, one per entity
+#define SNAPVIS_UNKNOWN	0	//not tested, do it all the slow way.
+#define SNAPVIS_CULLED	1	//definitely not visible to this client.
+#define SNAPVIS_PVS		2	//passed the pvs test, still needs tracelines (if enabled)
+#define SNAPVIS_VISIBLE	3	//passed both pvs and traceline tests.
+static unsigned int snapshot_qcgen;	//bumped whenever qc runs mid-send, as it might move/change any ent and invalidate the preculled results.
+static unsigned int *snapshot_precullhash;	//per entity, what the precull saw. if qc ran since, only ents whose hash changed need redoing.
+static size_t snapshot_precullhashes;
+
+static unsigned int SV_Snapshot_HashBytes(unsigned int h, const void *data, size_t len)
+{
+	const qbyte *b = data;
+	while (len--)
+		h = (h ^ *b++) * 16777619;
+	return h;
+}
+#define SNAPHASH(x) h = SV_Snapshot_HashBytes(h, &(x), sizeof(x))
+//covers everything that SV_Snapshot_Precull looks at for an entity.
+static unsigned int SV_Snapshot_PrecullHash(edict_t *ent)
+{
+	unsigned int h = 2166136261u;
+	edict_t *t = ent;
+	int c = 10;
+	SNAPHASH(ent->v->modelindex);
+	SNAPHASH(ent->v->model);
+	SNAPHASH(ent->v->effects);
+	SNAPHASH(ent->v->skin);
+	SNAPHASH(ent->xv->SendEntity);
+	SNAPHASH(ent->xv->customizeentityforclient);
+	SNAPHASH(ent->xv->pflags);
+	SNAPHASH(ent->xv->pvsflags);
+	while (t->xv->tag_entity && c-->0)
+		t = EDICT_NUM_UB(svprogfuncs, t->xv->tag_entity);
+	SNAPHASH(t);	//the ent whose position is actually tested
+	SNAPHASH(t->v->origin);
+	SNAPHASH(t->v->mins);
+	SNAPHASH(t->v->maxs);
+	SNAPHASH(t->v->modelindex);
+	SNAPHASH(t->v->solid);
+	SNAPHASH(t->xv->viewmodelforclient);
+	SNAPHASH(((wedict_t*)t)->pvsinfo);
+	return h;
+}
+static unsigned int SV_Snapshot_CameraHash(pvscamera_t *cameras)
+{
+	unsigned int h = 2166136261u;
+	int c;
+	SNAPHASH(cameras->numents);
+	for (c = 0; c < cameras->numents; c++)
+	{
+		SNAPHASH(cameras->ent[c]);
+		SNAPHASH(cameras->org[c]);
+	}
+	return h;
+}
+#undef SNAPHASH
+
 static void *AllocateBoneSpace(packet_entities_t *pack, unsigned char bonecount, unsigned int *allocationpos)
 {
 	size_t space = bonecount * sizeof(short)*7;
@@ -411,6 +468,7 @@ void SV_EmitCSQCUpdate(client_t *client, sizebuf_t *msg, qbyte svcnumber)
 			G_FLOAT(OFS_PARM1+0) = (int)((bits>>(SENDFLAGS_SHIFT+ 0)) & 0xffffff);	//each float can only hold 24 bits before it forgets its lower bits.
 			G_FLOAT(OFS_PARM1+1) = (int)((bits>>(SENDFLAGS_SHIFT+24)) & 0xffffff);
 			G_FLOAT(OFS_PARM1+2) = (int)((bits>>(SENDFLAGS_SHIFT+48)) & 0xffffff);
+			snapshot_qcgen++;
 			PR_ExecuteProgram(svprogfuncs, ent->xv->SendEntity);
 			mod_result = G_INT(OFS_RETURN);
 		}
@@ -2895,6 +2953,7 @@ void SV_WritePlayersToClient (client_t *client, client_frame_t *frame, edict_t *
 			globalvars_t *pr_globals = PR_globals(svprogfuncs, PR_CURRENT);
 			pr_global_struct->self = EDICT_TO_PROG(svprogfuncs, vent);
 			pr_global_struct->other = (clent?EDICT_TO_PROG(svprogfuncs, clent):0);
+			snapshot_qcgen++;
 			PR_ExecuteProgram(svprogfuncs, vent->xv->customizeentityforclient);
 			if(!G_FLOAT(OFS_RETURN))
 				continue;
@@ -3828,6 +3887,7 @@ void SV_Snapshot_BuildQ1(client_t *client, packet_entities_t *pack, pvscamera_t
 	int limit;
 	int c, maxc = cameras?cameras->numents:0;
 	client_t *seat;
+	qbyte *snapvis = NULL, vis;
 
 	limit = sv.world.num_edicts;
 	if (client->max_net_ents < limit)
@@ -3908,16 +3968,34 @@ void SV_Snapshot_BuildQ1(client_t *client, packet_entities_t *pack, pvscamera_t
 	if (sv_cullentities_trace.ival && client->lastseen_count < limit)
 		Z_ReallocElements((void**)&client->lastseen_time, &client->lastseen_count, limit, sizeof(client->lastseen_time));
 
+	if (client->snapvis_valid && cameras)
+	{
+		snapvis = client->snapvis;	//worker threads already did the pvs/trace tests for us.
+		if (client->snapvis_qcgen != snapshot_qcgen && client->snapvis_camhash != SV_Snapshot_CameraHash(cameras))
+			snapvis = NULL;	//qc moved the view since the precull, so none of it can be trusted.
+	}
+	client->snapvis_valid = false;
+
 	for ( ; e<limit ; e++)
 	{
 		ent = EDICT_NUM_PB(svprogfuncs, e);
 		if (ED_ISFREE(ent))
 			continue;
 
+		vis = (snapvis && e < client->snapvis_count)?snapvis[e]:SNAPVIS_UNKNOWN;
+		if (vis != SNAPVIS_UNKNOWN && client->snapvis_qcgen != snapshot_qcgen)
+		{	//qc ran since the precull. if it changed this ent then do it the slow way.
+			if (e >= snapshot_precullhashes || snapshot_precullhash[e] != SV_Snapshot_PrecullHash(ent))
+				vis = SNAPVIS_UNKNOWN;
+		}
+		if (vis == SNAPVIS_CULLED)
+			continue;
+
 		if (ent->xv->customizeentityforclient)
 		{
 			pr_global_struct->self = EDICT_TO_PROG(svprogfuncs, ent);
 			pr_global_struct->other = (clent?EDICT_TO_PROG(svprogfuncs, clent):0);
+			snapshot_qcgen++;
 			PR_ExecuteProgram(svprogfuncs, ent->xv->customizeentityforclient);
 			if(!G_FLOAT(OFS_RETURN))
 				continue;
@@ -3986,13 +4064,13 @@ void SV_Snapshot_BuildQ1(client_t *client, packet_entities_t *pack, pvscamera_t
 						}
 						else
 						{
-							if (!sv.world.worldmodel->funcs.EdictInFatPVS(sv.world.worldmodel, &((wedict_t*)tracecullent)->pvsinfo, cameras->pvs.buffer, cameras->area))
+							if (vis < SNAPVIS_PVS && !sv.world.worldmodel->funcs.EdictInFatPVS(sv.world.worldmodel, &((wedict_t*)tracecullent)->pvsinfo, cameras->pvs.buffer, cameras->area))
 								continue;
 						}
 					}
 					else
 					{
-						if (!sv.world.worldmodel->funcs.EdictInFatPVS(sv.world.worldmodel, &((wedict_t*)ent)->pvsinfo, cameras->pvs.buffer, cameras->area))
+						if (vis < SNAPVIS_PVS && !sv.world.worldmodel->funcs.EdictInFatPVS(sv.world.worldmodel, &((wedict_t*)ent)->pvsinfo, cameras->pvs.buffer, cameras->area))
 							continue;
 						tracecullent = ent;
 					}
@@ -4065,7 +4143,7 @@ void SV_Snapshot_BuildQ1(client_t *client, packet_entities_t *pack, pvscamera_t
 					continue;
 
 
-		if (cameras && tracecullent && !((unsigned int)ent->v->effects & (EF_DIMLIGHT|EF_BLUE|EF_RED|EF_BRIGHTLIGHT|EF_BRIGHTFIELD|EF_NODEPTHTEST)))
+		if (cameras && tracecullent && vis != SNAPVIS_VISIBLE && !((unsigned int)ent->v->effects & (EF_DIMLIGHT|EF_BLUE|EF_RED|EF_BRIGHTLIGHT|EF_BRIGHTFIELD|EF_NODEPTHTEST)))
 		{	//more expensive culling
 			if (!(pvsflags & PVSF_MODE_MASK))
 				if ((e <= sv.allocated_client_slots && sv_cullplayers_trace.value) || sv_cullentities_trace.value)
@@ -4220,6 +4298,146 @@ void SV_Snapshot_SetupPVS(client_t *client, pvscamera_t *camera)
 		SV_AddCameraEntity(camera, NULL, sv.skyroom_pos);
 }
 
+//does the read-only parts of SV_Snapshot_BuildQ1's visibility tests. this runs on worker threads, so no qc and no globals.
+//anything that might need qc or has side effects is left as SNAPVIS_UNKNOWN for the main thread to figure out.
+static void SV_Snapshot_Precull(client_t *client, pvscamera_t *cameras)
+{
+	model_t *wm = sv.world.worldmodel;
+	qboolean cantrace = wm->fromgame == fg_quake || wm->fromgame == fg_halflife;	//q2+q3 bsp traces use static state, so leave those traces for the main thread.
+	edict_t *clent = client->edict, *ent, *tracecullent;
+	qbyte *vis = client->snapvis;
+	int e, c, pvsflags;
+
+	for (e = 1; e < client->snapvis_count; e++)
+	{
+		vis[e] = SNAPVIS_UNKNOWN;
+		ent = EDICT_NUM_PB(svprogfuncs, e);
+		if (ED_ISFREE(ent))
+			continue;
+		if (ent->xv->customizeentityforclient || ent->xv->viewmodelforclient)
+			continue;	//qc gets to decide on these.
+#ifdef NQPROT
+		if (progstype != PROG_QW && ((int)ent->v->effects & EF_MUZZLEFLASH))
+			continue;	//gets cleared by the first client to look at it, so don't skip that.
+#endif
+		for (c = 0; c < cameras->numents; c++)
+			if (ent == cameras->ent[c])
+				break;
+		if (c < cameras->numents)
+			continue;
+
+		if (!(ent->xv->SendEntity && client->csqcactive) &&
+			(!ent->v->modelindex || !*PR_GetString(svprogfuncs, ent->v->model)) &&
+			!((int)ent->xv->pflags & PFLAGS_FULLDYNAMIC) &&
+			ent->v->skin >= 0)
+		{
+			vis[e] = SNAPVIS_CULLED;	//not networked.
+			continue;
+		}
+
+		pvsflags = ent->xv->pvsflags;
+		if (((int)ent->v->effects & EF_NODEPTHTEST) || (pvsflags & PVSF_MODE_MASK) >= PVSF_USEPHS)
+			continue;
+
+		tracecullent = ent;
+		if (ent->xv->tag_entity)
+		{
+			c = 10;
+			while(tracecullent->xv->tag_entity&&c-->0)
+				tracecullent = EDICT_NUM_UB(svprogfuncs, tracecullent->xv->tag_entity);
+			if (tracecullent == clent || tracecullent->xv->viewmodelforclient)
+				continue;
+		}
+		if (!wm->funcs.EdictInFatPVS(wm, &((wedict_t*)tracecullent)->pvsinfo, cameras->pvs.buffer, cameras->area))
+		{
+			vis[e] = SNAPVIS_CULLED;
+			continue;
+		}
+		vis[e] = SNAPVIS_PVS;
+
+		if (cantrace && !(pvsflags & PVSF_MODE_MASK) && !((unsigned int)ent->v->effects & (EF_DIMLIGHT|EF_BLUE|EF_RED|EF_BRIGHTLIGHT|EF_BRIGHTFIELD|EF_NODEPTHTEST)))
+		{
+			c = tracecullent->v->modelindex;
+			if ((unsigned int)c >= MAX_PRECACHE_MODELS || (sv.models[c]?sv.models[c]->loadstate != MLS_LOADED:!!sv.strings.model_precache[c]))
+				continue;	//Cull_Traceline would need to load the model, which is main-thread only.
+			if ((e <= sv.allocated_client_slots && sv_cullplayers_trace.value) || sv_cullentities_trace.value)
+				vis[e] = Cull_Traceline(e < client->lastseen_count?&client->lastseen_time[e]:NULL, cameras, tracecullent)?SNAPVIS_CULLED:SNAPVIS_VISIBLE;
+			else
+				vis[e] = SNAPVIS_VISIBLE;
+		}
+	}
+}
+
+struct snapshotprecull_s
+{
+	client_t **clients;
+	pvscamera_t *cameras;
+};
+static void SV_Snapshot_PrecullRange(void *ctx, size_t first, size_t last)
+{
+	struct snapshotprecull_s *job = ctx;
+	for (; first < last; first++)
+		SV_Snapshot_Precull(job->clients[first], &job->cameras[first]);
+}
+
+//spreads the pvs+traceline tests for the listed clients' next snapshots over the compute workers.
+//must be called after physics and before the clients' datagrams are built, the results are consumed by SV_Snapshot_BuildQ1.
+void SV_Snapshot_PrecullClients(client_t **clients, int count)
+{
+	struct snapshotprecull_s job;
+	qbyte *pvsbuf;
+	size_t pvsbytes;
+	int i, limit, queued = 0;
+	client_t *cl;
+
+	if (!count || sv_nopvs.ival || svs.gametype == GT_HALFLIFE || !sv.world.worldmodel || !COM_HasWorkers(WG_COMPUTE))
+		return;
+#ifdef SERVER_DEMO_PLAYBACK
+	if (sv.demostatevalid)
+		return;
+#endif
+
+	//remember what each ent looked like, so that if qc changes some of them mid-send only those need redoing.
+	if (snapshot_precullhashes < sv.world.num_edicts)
+		Z_ReallocElements((void**)&snapshot_precullhash, &snapshot_precullhashes, sv.world.num_edicts, sizeof(*snapshot_precullhash));
+	for (i = 1; i < sv.world.num_edicts; i++)
+	{
+		edict_t *ent = EDICT_NUM_PB(svprogfuncs, i);
+		snapshot_precullhash[i] = ED_ISFREE(ent)?0:SV_Snapshot_PrecullHash(ent);
+	}
+
+	pvsbytes = sv.world.worldmodel->pvsbytes;
+	job.clients = BZ_Malloc(count * (sizeof(*job.clients) + sizeof(*job.cameras) + pvsbytes));
+	job.cameras = (pvscamera_t*)(job.clients+count);
+	pvsbuf = (qbyte*)(job.cameras+count);
+	for (i = 0; i < count; i++)
+	{
+		cl = clients[i];
+		cl->snapvis_valid = false;
+		if (cl->state != cs_spawned || !cl->edict || (cl->penalties & BAN_BLIND))
+			continue;
+
+		limit = min(sv.world.num_edicts, cl->max_net_ents);
+		if (cl->snapvis_count < limit)
+			Z_ReallocElements((void**)&cl->snapvis, &cl->snapvis_count, limit, sizeof(*cl->snapvis));
+		if (sv_cullentities_trace.ival && cl->lastseen_count < limit)
+			Z_ReallocElements((void**)&cl->lastseen_time, &cl->lastseen_count, limit, sizeof(cl->lastseen_time));
+
+		job.cameras[queued].pvs.buffer = pvsbuf + queued*pvsbytes;
+		job.cameras[queued].pvs.buffersize = pvsbytes;
+		SV_Snapshot_SetupPVS(cl, &job.cameras[queued]);
+
+		cl->snapvis_valid = true;
+		cl->snapvis_qcgen = snapshot_qcgen;
+		cl->snapvis_camhash = SV_Snapshot_CameraHash(&job.cameras[queued]);
+		job.clients[queued++] = cl;
+	}
+
+	//blocks only on our own chunks, with the main thread taking its share.
+	COM_ParallelFor(queued, 1, SV_Snapshot_PrecullRange, &job);
+	BZ_Free(job.clients);
+}
+
 void SV_Snapshot_Clear(packet_entities_t *pack)
 {
 	pack->num_entities = 0;
@@ -26,6 +26,9 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifdef __GLIBC__
 #include <malloc.h>	//for malloc_trim
 #endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #ifndef CLIENTONLY
 extern int			total_loading_size, current_loading_size, loading_stage;
@@ -447,24 +450,100 @@ void SV_GetNewSpawnParms(client_t *cl)
 	}
 }
 
+#define PHS_CACHEVERSION	2
+#define PHS_ROWSPERJOB		64
+struct phsbuild_s
+{
+	const qbyte *pvs;
+	qbyte *phs;
+	int numclusters;
+	int rowbytes;
+};
+//or src into dest, rowbytes is always a multiple of 4.
+static void SV_PHSOrRow(qbyte *dest, const qbyte *src, int rowbytes)
+{
+	int l = 0;
+#ifdef __SSE2__
+	for (; l+16 <= rowbytes; l += 16)
+		_mm_storeu_si128((__m128i*)(dest+l), _mm_or_si128(_mm_loadu_si128((const __m128i*)(dest+l)), _mm_loadu_si128((const __m128i*)(src+l))));
+#else
+	for (; l+sizeof(size_t) <= rowbytes; l += sizeof(size_t))
+		*(size_t*)(dest+l) |= *(const size_t*)(src+l);
+#endif
+	for (; l < rowbytes; l += 4)
+		*(unsigned*)(dest+l) |= *(const unsigned*)(src+l);
+}
+//expands rows [first,last) of the phs. each row is independent, so this can safely run on any thread.
+static void SV_PHSExpandRows(void *ctx, size_t first, size_t last)
+{
+	const struct phsbuild_s *build = ctx;
+	int i, j, k, index, rowbytes = build->rowbytes, num = build->numclusters;
+	const qbyte *scan;
+	qbyte *dest;
+	for (i = first; i < last; i++)
+	{
+		scan = build->pvs + i*rowbytes;
+		dest = build->phs + i*rowbytes;
+		memcpy (dest, scan, rowbytes);
+		for (j=0 ; j<rowbytes ; j+=4)
+		{
+			if (!*(const unsigned*)(scan+j))
+				continue;	//most pvs rows are sparse, skip empty words quickly
+			for (k=0 ; k<32 ; k++)
+			{
+				if (! (scan[j+(k>>3)] & (1<<(k&7))) )
+					continue;
+				// or this pvs row into the phs
+				// +1 because pvs is 1 based
+				//except we now use clusters internally, which are 0-based (ie: leaf 0 is invalid and maps to cluster -1)
+				index = (j<<3)+k;
+				if (index >= num)
+					break;
+				SV_PHSOrRow(dest, build->pvs + index*rowbytes, rowbytes);
+			}
+		}
+	}
+}
+//counts the bits set in each row (ignoring cluster 0), just for developer stats.
+static int SV_PHSCountBits(const qbyte *rows, int rowbytes, int num)
+{
+	int i, j, count = 0;
+	const qbyte *scan;
+	for (i=1 ; i<num ; i++)
+	{
+		scan = rows + i*rowbytes;
+		for (j=0 ; j<num ; j++)
+			if ( scan[j>>3] & (1<<(j&7)) )
+				count++;
+	}
+	return count;
+}
+#define PHS_CACHEHEADER 5
+static void SV_PHSCacheHeader(int *hdr, model_t *model)
+{
+	memcpy(hdr, "QPHS", 4);
+	hdr[1] = LittleLong(PHS_CACHEVERSION);
+	hdr[2] = LittleLong(model->checksum);	//so edited maps don't pick up stale data
+	hdr[3] = LittleLong(model->numclusters);
+	hdr[4] = LittleLong(model->pvsbytes);
+}
 /*
 ================
 SV_CalcPHS
 
-Expands the PVS and calculates the PHS
+Expand the PVS and calculate the PHS
 (Potentially Hearable Set)
 ================
 */
 void SV_CalcPHS (void)
 {
-	int		rowbytes, rowwords;
-	int		i, j, k, l, index, num;
-	int		bitbyte;
-	unsigned	*dest, *src;
+	int		rowbytes;
+	int		i, num;
 	qbyte	*scan, *pvs;
-	int		count, vcount;
 	model_t *model = sv.world.worldmodel;
 	pvsbuffer_t buf;
+	struct phsbuild_s build;
+	qboolean cache;
 
 	if (model->pvs || model->fromgame == fg_quake2 || model->fromgame == fg_quake3)
 	{
@@ -472,44 +551,24 @@ void SV_CalcPHS (void)
 		return;
 	}
 
-	//FIXME: this can take a significant time on some maps, and should ideally be pushed to a worker thread.
 	num = model->numclusters;
 	rowbytes = model->pvsbytes;
-	rowwords = rowbytes/sizeof(*dest);
 	buf.buffersize = model->pvsbytes;
 
-	if (!sv_calcphs.ival || (sv_calcphs.ival == 2 && (rowbytes*num >= 0x100000 || (!deathmatch.ival && !coop.ival))))
+	if (!sv_calcphs.ival || (sv_calcphs.ival == 2 && !deathmatch.ival && !coop.ival))
 	{
-		pvs = NULL;/*ZG_Malloc(&model->memgroup, rowbytes*num);
-		scan = pvs;
-		for (i=0 ; i<num ; i++, scan+=rowbytes)
-		{
-			buf.buffer = scan;
-			model->funcs.ClusterPVS(model, i, &buf, PVM_REPLACE);
-		}*/
-
 		Con_DPrintf("Skipping PHS\n");
-		model->pvs = pvs;
+		model->pvs = NULL;
 		model->phs = NULL;
 		return;
 	}
 
 	pvs = ZG_Malloc(&model->memgroup, rowbytes*num);
 	scan = pvs;
-	vcount = 0;
 	for (i=0 ; i<num ; i++, scan+=rowbytes)
 	{
 		buf.buffer = scan;
 		model->funcs.ClusterPVS(model, i, &buf, PVM_REPLACE);
-		if (i == 0)
-			continue;
-		for (j=0 ; j<num ; j++)
-		{
-			if ( scan[j>>3] & (1<<(j&7)) )
-			{
-				vcount++;
-			}
-		}
 	}
 	if (developer.value)
 		Con_TPrintf ("Building PHS...\n");
@@ -518,88 +577,79 @@ void SV_CalcPHS (void)
 	model->phs = ZG_Malloc (&model->memgroup, rowbytes*num);
 
 	/*this routine takes an exponential amount of time, so cache it if its too big*/
-	if (rowbytes*num >= 0x100000)
+	cache = rowbytes*num >= 0x100000;
+	if (cache)
 	{
-		char hdr[8];
-		vfsfile_t *f = FS_OpenVFS(va("maps/%s.phs", svs.name), "rb", FS_GAME);
-		if (f)
+		int hdr[PHS_CACHEHEADER];
+		size_t fsize;
+		void *view;
+		const qbyte *data = FS_MapFile(va("maps/%s.phs", svs.name), 0, &fsize, &view);
+		if (data)
 		{
-			VFS_READ(f, hdr, sizeof(hdr));
-			if (!memcmp(hdr, "QPHS\1\0\0\0", 8) && VFS_GETLEN(f) == rowbytes*num + 8)
+			SV_PHSCacheHeader(hdr, model);
+			if (fsize == sizeof(hdr) + rowbytes*num && !memcmp(data, hdr, sizeof(hdr)))
 			{
-				VFS_READ(f, model->phs, rowbytes*num);
-				VFS_CLOSE(f);
+				memcpy(model->phs, data+sizeof(hdr), rowbytes*num);
+				FS_UnmapFile(view);
 				Con_DPrintf("Loaded cached PHS\n");
 				return;
 			}
-			else
-				Con_DPrintf("Stale cached PHS\n");
-			VFS_CLOSE(f);
-		}
-	}
-
-	count = 0;
-	scan = pvs;
-	dest = (unsigned *)model->phs;
-	for (i=0 ; i<num ; i++, dest += rowwords, scan += rowbytes)
-	{
-		memcpy (dest, scan, rowbytes);
-		for (j=0 ; j<rowbytes ; j++)
-		{
-			bitbyte = scan[j];
-			if (!bitbyte)
-				continue;
-			for (k=0 ; k<8 ; k++)
-			{
-				if (! (bitbyte & (1<<k)) )
-					continue;
-				// or this pvs row into the phs
-				// +1 because pvs is 1 based
-				//except we now use clusters internally, which are 0-based (ie: leaf 0 is invalid and maps to cluster -1)
-				index = ((j<<3)+k);
-				if (index >= num)
-					continue;
-				src = (unsigned *)pvs + index*rowwords;
-				for (l=0 ; l<rowwords ; l++)
-					dest[l] |= src[l];
-			}
+			Con_DPrintf("Stale cached PHS\n");
+			FS_UnmapFile(view);
 		}
-
-		if (i == 0)
-			continue;
-		for (j=0 ; j<num ; j++)
-			if ( ((qbyte *)dest)[j>>3] & (1<<(j&7)) )
-				count++;
 	}
 
-	if (rowbytes*num >= 0x100000)
-	{
-		vfsfile_t *f = FS_OpenVFS(va("maps/%s.phs", svs.name), "wb", FS_GAMEONLY);
+	//each row only depends upon the pvs, so spread them over whatever workers we have.
+	build.pvs = pvs;
+	build.phs = model->phs;
+	build.numclusters = num;
+	build.rowbytes = rowbytes;
+	COM_ParallelFor(num, PHS_ROWSPERJOB, SV_PHSExpandRows, &build);
+
+	if (cache)
+	{	//write it to a temp name first so a partial write can never be mistaken for a valid cache.
+		int hdr[PHS_CACHEHEADER];
+		char *name = va("maps/%s.phs", svs.name);
+		char tmpname[MAX_QPATH];
+		vfsfile_t *f;
+		Q_snprintfz(tmpname, sizeof(tmpname), "%s.tmp", name);
+		f = FS_OpenVFS(tmpname, "wb", FS_GAMEONLY);
 		if (f)
 		{
-			VFS_WRITE(f, "QPHS\1\0\0\0", 8);
-			VFS_WRITE(f, model->phs, rowbytes*num);
+			qboolean ok;
+			SV_PHSCacheHeader(hdr, model);
+			ok = VFS_WRITE(f, hdr, sizeof(hdr)) == sizeof(hdr);
+			ok &= VFS_WRITE(f, model->phs, rowbytes*num) == rowbytes*num;
 			VFS_CLOSE(f);
-			Con_Printf("Written PHS cache (%u bytes)\n", rowbytes*num);
+			if (ok && !FS_Rename(tmpname, name, FS_GAMEONLY))
+			{	//some systems refuse to rename over an existing file
+				FS_Remove(name, FS_GAMEONLY);
+				ok = FS_Rename(tmpname, name, FS_GAMEONLY);
+			}
+			if (ok)
+				Con_Printf("Written PHS cache (%u bytes)\n", rowbytes*num);
+			else
+				FS_Remove(tmpname, FS_GAMEONLY);
 		}
 	}
 
 	if (num)
 		if (developer.value)
-			Con_TPrintf ("Average leafs visible / hearable / total: %i / %i / %i\n", vcount/num, count/num, num);
+			Con_TPrintf ("Average leafs visible / hearable / total: %i / %i / %i\n", SV_PHSCountBits(pvs, rowbytes, num)/num, SV_PHSCountBits(model->phs, rowbytes, num)/num, num);
 }
 
 unsigned SV_CheckModel(char *mdl)
 {
 	size_t fsize;
-	qbyte *buf;
+	const qbyte *buf;
+	void *view;
 	unsigned short crc;
 
-	buf = (qbyte *)FS_LoadMallocFile (mdl, &fsize);
+	buf = FS_MapFile (mdl, 0, &fsize, &view);
 	if (!buf)
 		return 0;
 	crc = CalcHashInt(&hash_crc16, buf, fsize);
-	BZ_Free(buf);
+	FS_UnmapFile(view);
 	return crc;
 }
 
@@ -145,11 +145,12 @@ cvar_t sv_maxdrate			= CVARAFCD("sv_maxdrate", "500000",
 cvar_t sv_minping			= CVARFD("sv_minping", "", CVAR_SERVERINFO, "Simulate fake lag for any players with a ping under the value specified here. Value is in milliseconds.");
 
 cvar_t sv_bigcoords			= CVARFD("sv_bigcoords", "1", 0, "Uses floats for coordinates instead of 16bit values.\nAlso boosts angle precision, so can be useful even on small maps.\nAffects clients thusly:\nQW: enforces a mandatory protocol extension\nDP: enables DPP7 protocol support\nNQ: uses RMQ protocol (protocol 999).");
-cvar_t sv_calcphs			= CVARFD("sv_calcphs", "2", CVAR_MAPLATCH, "Enables culling of sound effects. 0=always skip phs. Sounds are globally broadcast. 1=always generate phs. Sounds are always culled. On large maps the phs will be dumped to disk. 2=On large single-player maps, generation of phs is skipped. Otherwise like option 1.");
+cvar_t sv_calcphs			= CVARFD("sv_calcphs", "2", CVAR_MAPLATCH, "Enables culling of sound effects. 0=always skip phs. Sounds are globally broadcast. 1=always generate phs. Sounds are always culled. On large maps the phs will be cached to disk. 2=On single-player maps, generation of phs is skipped. Otherwise like option 1.");
 
 cvar_t sv_showconnectionlessmessages	= CVARD("sv_showconnectionlessmessages", "0", "Display a line describing each connectionless message that arrives on the server. Primarily a debugging feature, but also potentially useful to admins.");
 cvar_t sv_cullplayers_trace		= CVARFD("sv_cullplayers_trace", "", CVAR_SERVERINFO, "Attempt to cull player entities using tracelines as an anti-wallhack.");
 cvar_t sv_cullentities_trace	= CVARFD("sv_cullentities_trace", "", CVAR_SERVERINFO, "Attempt to cull non-player entities using tracelines as an extreeme anti-wallhack.");
+cvar_t sv_threadedsnapshots	= CVARD("sv_threadedsnapshots", "0", "Perform the pvs and traceline culling for each client's entity updates on worker threads, before the packets are built. Worthwhile on servers with many players and entities.");
 cvar_t sv_phs					= CVARD("sv_phs", "1", "If 1, do not use the phs. It is generally better to use sv_calcphs instead, and leave this as 1.");
 cvar_t sv_resetparms			= CVAR("sv_resetparms", "0");
 cvar_t sv_pupglow				= CVARFD("sv_pupglow", "", CVAR_SERVERINFO, "Instructs clients to enable hexen2-style powerup pulsing.");
@@ -692,6 +693,10 @@ void SV_DropClient (client_t *drop)
 		Z_Free(drop->sentents.entities);
 		memset(&drop->sentents.entities, 0, sizeof(drop->sentents.entities));
 	}
+	Z_Free(drop->snapvis);
+	drop->snapvis = NULL;
+	drop->snapvis_count = 0;
+	drop->snapvis_valid = false;
 
 	for (i = 0; i < MAX_CL_STATS; i++)
 	{
@@ -3112,6 +3117,7 @@ void SV_DoDirectConnect(svconnectinfo_t *fte_restrict info)
 		Con_Printf("Client frame info was set\n");
 		Z_Free(newcl->frameunion.frames);
 	}
+	Z_Free(newcl->snapvis);	//temp doesn't have one, don't leak the old slot's.
 
 	temp.name = newcl->name;
 	temp.team = newcl->team;
@@ -5409,6 +5415,11 @@ void SVQ2_ClearEvents(void)
 #endif
 
 
+static void SV_AreaStats_f (void)
+{
+	World_PrintAreaStats(&sv.world);
+}
+
 /*
 ==================
 SV_Impulse_f
@@ -5765,11 +5776,13 @@ float SV_Frame (void)
 		SV_CheckVars ();
 
 // send messages back to the clients that had packets read this frame
+		NET_BatchSends(svs.sockets, true);
 		SV_SendClientMessages ();
 
 #ifdef MVD_RECORDING
 		SV_SendMVDMessage();
 #endif
+		NET_BatchSends(svs.sockets, false);	//flush them all out now
 
 // send a heartbeat to the master if needed
 		SV_Master_Heartbeat ();
@@ -6015,6 +6028,7 @@ void SV_InitLocal (void)
 	Cvar_Register (&sv_phs,	cvargroup_servercontrol);
 	Cvar_Register (&sv_cullplayers_trace, cvargroup_servercontrol);
 	Cvar_Register (&sv_cullentities_trace, cvargroup_servercontrol);
+	Cvar_Register (&sv_threadedsnapshots, cvargroup_servercontrol);
 
 	Cvar_Register (&sv_csqc_progname,	cvargroup_servercontrol);
 	Cvar_Register (&sv_csqcdebug, cvargroup_servercontrol);
@@ -6037,6 +6051,7 @@ void SV_InitLocal (void)
 	Cvar_Register (&sv_nopvs, cvargroup_servercontrol);
 
 	Cmd_AddCommand ("sv_impulse", SV_Impulse_f);
+	Cmd_AddCommandD ("sv_areastats", SV_AreaStats_f, "Shows how many collision cells and entities each trace has been checking since the last call (see sv_areahash).");
 
 	Cmd_AddCommand ("openroute", SV_OpenRoute_f);
 
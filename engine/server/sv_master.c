@@ -63,14 +63,32 @@ typedef struct svm_server_s {
 	bucket_t bucket;	//for faster address lookups.
 	struct svm_game_s *game;
 	struct svm_server_s *next;
+	struct svm_server_s **link;	//whatever points to us, for unlinking without walking the list.
+	struct svm_server_s *wheelnext, **wheelprev;	//expiry timer wheel. NULL prev when not scheduled (brokered).
 	char rules[1024];
 } svm_server_t;
 
+//a fully formed response (udp packet or http body) for a specific query, valid until the game's servers change.
+typedef struct svm_listcache_s {
+	struct svm_listcache_s *next;
+	unsigned int generation;	//game->generation when it was built
+	unsigned int refs;			//1 while its in the cache, +1 for each open http response
+	char key[256];				//the query+filters it was built for
+	const char *mimetype;		//for http responses
+	size_t size;
+	qbyte data[1];
+} svm_listcache_t;
+#define SVM_MAXCACHEDLISTS 16	//per game, to stop junk filter combinations from eating memory
+
 typedef struct svm_game_s {
 	struct svm_game_s *next;
 
 	svm_server_t *firstserver;
 	size_t numservers;
+	unsigned int generation;	//bumped whenever something that might show up in a listing changes.
+	unsigned int sortedgeneration;	//generation when last sorted
+	int sortedby;				//sv_sortlist value it was last sorted with
+	svm_listcache_t *cache;
 	qboolean persistent;
 	char *levelshotsurl;	//eg "https://somewhere/somegame/levelshots/" mapname.jpg will be appended.
 	char *aliases;	//list of terminated names, terminated with a double-null
@@ -100,6 +118,10 @@ typedef struct {
 	} total, stamps[60];
 	size_t stampring;
 	double nextstamp;
+
+#define SVM_WHEELSLOTS 512	//one second each. servers that expire further out just get skipped until their lap comes around.
+	svm_server_t *wheel[SVM_WHEELSLOTS];
+	unsigned int wheeltick;	//next second to be processed
 } masterserver_t;
 
 static masterserver_t svm;
@@ -287,6 +309,229 @@ static svm_game_t *SVM_FindGame(const char *game, int create)
 	return g;
 }
 
+static void SVM_LinkServer(svm_game_t *game, svm_server_t *server)
+{
+	server->game = game;
+	server->next = game->firstserver;
+	if (server->next)
+		server->next->link = &server->next;
+	server->link = &game->firstserver;
+	game->firstserver = server;
+	game->numservers++;
+	game->generation++;
+	svm.numservers++;
+}
+
+//(re)files the server into the expiry wheel slot for its current expiretime.
+static void SVM_ScheduleExpiry(svm_server_t *server)
+{
+	unsigned int tick = (server->expiretime > svm.wheeltick)?(unsigned int)server->expiretime:svm.wheeltick;
+	svm_server_t **slot = &svm.wheel[tick % SVM_WHEELSLOTS];
+	if (server->wheelprev)
+	{
+		if (server->wheelnext)
+			server->wheelnext->wheelprev = server->wheelprev;
+		*server->wheelprev = server->wheelnext;
+	}
+	server->wheelnext = *slot;
+	if (server->wheelnext)
+		server->wheelnext->wheelprev = &server->wheelnext;
+	server->wheelprev = slot;
+	*slot = server;
+}
+
+static void SVM_RemoveServer(svm_server_t *server)
+{
+	svm_game_t *game = server->game;
+	if (server->wheelprev)
+	{
+		if (server->wheelnext)
+			server->wheelnext->wheelprev = server->wheelprev;
+		*server->wheelprev = server->wheelnext;
+	}
+	if (server->next)
+		server->next->link = server->link;
+	*server->link = server->next;
+
+	if (server->brokerid)
+		Hash_RemoveDataKey(&svm.serverhash, SVM_GenerateBrokerKey(server->brokerid), server);
+	else
+		Hash_RemoveDataKey(&svm.serverhash, SVM_GenerateAddressKey(&server->adr), server);
+	Z_Free(server);
+	game->numservers--;
+	game->generation++;
+	svm.numservers--;
+}
+
+//bumps the game's generation if an info/status response changed anything that the cached listings depend upon.
+static void SVM_ServerUpdated(svm_server_t *server, const svm_server_t *old)
+{
+	if (memcmp(&server->protover, &old->protover, (qbyte*)&server->expiretime - (qbyte*)&server->protover) ||
+		strcmp(Info_ValueForKey(server->rules, "protocol"), Info_ValueForKey(old->rules, "protocol")) ||
+		strcmp(Info_ValueForKey(server->rules, "*fp"), Info_ValueForKey(old->rules, "*fp")))
+		server->game->generation++;
+}
+
+static void SVM_ReleaseCachedList(svm_listcache_t *list)
+{
+	if (!--list->refs)
+		Z_Free(list);
+}
+static void SVM_FlushCachedLists(svm_game_t *game)
+{
+	svm_listcache_t *list;
+	while ((list = game->cache))
+	{
+		game->cache = list->next;
+		SVM_ReleaseCachedList(list);
+	}
+}
+//returns a previously generated response for the exact same query, if nothing changed since.
+static svm_listcache_t *SVM_GetCachedList(svm_game_t *game, const char *key)
+{
+	svm_listcache_t **link, *list;
+	for (link = &game->cache; (list = *link); )
+	{
+		if (list->generation != game->generation)
+		{	//stale, something changed since.
+			*link = list->next;
+			SVM_ReleaseCachedList(list);
+		}
+		else if (!strcmp(list->key, key))
+		{	//move it to the front, so the busy ones are found quickly and the rare ones are what get pushed out.
+			*link = list->next;
+			list->next = game->cache;
+			game->cache = list;
+			return list;
+		}
+		else
+			link = &list->next;
+	}
+	return NULL;
+}
+static svm_listcache_t *SVM_AddCachedList(svm_game_t *game, const char *key, const void *data, size_t size)
+{
+	svm_listcache_t *list, **link;
+	size_t count;
+	if (strlen(key) >= sizeof(list->key)-1)
+		return NULL;	//callers may have truncated it. don't cache it to avoid false matches.
+	list = Z_Malloc(sizeof(*list) + size);
+	list->generation = game->generation;
+	list->refs = 1;
+	strcpy(list->key, key);
+	list->size = size;
+	memcpy(list->data, data, size);
+	list->next = game->cache;
+	game->cache = list;
+
+	for (count = 0, link = &game->cache; *link; link = &(*link)->next)
+	{
+		if (++count == SVM_MAXCACHEDLISTS)
+		{
+			while ((list = (*link)->next))
+			{
+				(*link)->next = list->next;
+				SVM_ReleaseCachedList(list);
+			}
+			break;
+		}
+	}
+	return game->cache;
+}
+
+//read-only file handle for http clients, so they can read a cached list without copying it all first.
+typedef struct {
+	vfsfile_t funcs;
+	svm_listcache_t *list;
+	size_t ofs;
+} svm_listfile_t;
+static int QDECL SVM_ListFile_ReadBytes(vfsfile_t *file, void *buffer, int bytestoread)
+{
+	svm_listfile_t *f = (svm_listfile_t*)file;
+	if (bytestoread > f->list->size - f->ofs)
+		bytestoread = f->list->size - f->ofs;
+	memcpy(buffer, f->list->data + f->ofs, bytestoread);
+	f->ofs += bytestoread;
+	return bytestoread;
+}
+static qboolean QDECL SVM_ListFile_Seek(vfsfile_t *file, qofs_t pos)
+{
+	svm_listfile_t *f = (svm_listfile_t*)file;
+	if (pos > f->list->size)
+		return false;
+	f->ofs = pos;
+	return true;
+}
+static qofs_t QDECL SVM_ListFile_Tell(vfsfile_t *file)
+{
+	return ((svm_listfile_t*)file)->ofs;
+}
+static qofs_t QDECL SVM_ListFile_GetLen(vfsfile_t *file)
+{
+	return ((svm_listfile_t*)file)->list->size;
+}
+static const void *QDECL SVM_ListFile_GetMapping(vfsfile_t *file, qofs_t *len)
+{
+	svm_listfile_t *f = (svm_listfile_t*)file;
+	*len = f->list->size;
+	return f->list->data;
+}
+static qboolean QDECL SVM_ListFile_Close(vfsfile_t *file)
+{
+	svm_listfile_t *f = (svm_listfile_t*)file;
+	SVM_ReleaseCachedList(f->list);
+	Z_Free(f);
+	return true;
+}
+static vfsfile_t *SVM_OpenCachedList(svm_listcache_t *list)
+{
+	svm_listfile_t *f = Z_Malloc(sizeof(*f));
+	f->funcs.ReadBytes = SVM_ListFile_ReadBytes;
+	f->funcs.Seek = SVM_ListFile_Seek;
+	f->funcs.Tell = SVM_ListFile_Tell;
+	f->funcs.GetLen = SVM_ListFile_GetLen;
+	f->funcs.GetMapping = SVM_ListFile_GetMapping;
+	f->funcs.Close = SVM_ListFile_Close;
+	f->funcs.seekstyle = SS_SEEKABLE;
+	f->list = list;
+	list->refs++;
+	return &f->funcs;
+}
+//generates the http page via the given generator, or reuses the one from last time if nothing changed.
+static vfsfile_t *SVM_CachedPage(svm_game_t *game, const char *key, vfsfile_t *(*generate)(const char **mimetype, const char *masteraddr, const char *gamename, const char *query), const char **mimetype, const char *masteraddr, const char *gamename, const char *query)
+{
+	svm_listcache_t *list;
+	vfsfile_t *f;
+	qofs_t len;
+	void *data;
+
+	if (!game)
+		return generate(mimetype, masteraddr, gamename, query);	//no point caching unknown games.
+	list = SVM_GetCachedList(game, key);
+	if (!list)
+	{
+		f = generate(mimetype, masteraddr, gamename, query);
+		if (!f)
+			return NULL;
+		len = VFS_GETLEN(f);
+		data = BZ_Malloc(len);
+		VFS_READ(f, data, len);
+		VFS_CLOSE(f);
+		list = SVM_AddCachedList(game, key, data, len);
+		if (!list)
+		{	//couldn't cache it (silly key), so just give them a fresh copy.
+			f = VFSPIPE_Open(1, false);
+			VFS_WRITE(f, data, len);
+			BZ_Free(data);
+			return f;
+		}
+		BZ_Free(data);
+		list->mimetype = *mimetype;
+	}
+	*mimetype = list->mimetype;
+	return SVM_OpenCachedList(list);
+}
+
 static int QDECL SVM_SortOrder(const void *v1, const void *v2)
 {
 	svm_server_t const*const s1 = *(svm_server_t const*const*const)v1;
@@ -343,57 +588,71 @@ static int QDECL SVM_SortOrder(const void *v1, const void *v2)
 
 static void SVM_SortServers(svm_game_t *game)
 {
-	svm_server_t **serverlink, *s;
-	svm_server_t **sv = malloc(sizeof(*sv)*game->numservers);
-	int i;
+	svm_server_t **serverlink, *s, **sv;
+	size_t i;
+	qboolean changed = false;
 	if (!sv_sortlist.ival)
 		return;
+	if (game->sortedgeneration == game->generation && game->sortedby == sv_sortlist.ival && !(sv_sortlist.ival&8))
+		return;	//nothing changed since last time (sorting by expiry time always needs a resort though)
 
+	sv = BZ_Malloc(sizeof(*sv)*game->numservers);
 	for (i=0, s = game->firstserver; s; s = s->next)
 		sv[i++] = s;
 	qsort(sv, i, sizeof(*sv), SVM_SortOrder);
 
 	for (i = 0, serverlink = &game->firstserver; i < game->numservers; i++)
 	{
+		if (*serverlink != sv[i])
+			changed = true;
 		*serverlink = sv[i];
+		sv[i]->link = serverlink;
 		serverlink = &sv[i]->next;
 	}
 	*serverlink = NULL;
+	BZ_Free(sv);
+
+	if (changed)
+		game->generation++;	//the order matters to anything we cached.
+	game->sortedgeneration = game->generation;
+	game->sortedby = sv_sortlist.ival;
 }
 
 static void SVM_RemoveOldServers(void)
 {
 	svm_game_t **gamelink, *g;
-	svm_server_t **serverlink, *s;
-	for (gamelink = &svm.firstgame; (g=*gamelink); )
+	svm_server_t *s, *next;
+	unsigned int now = svm.time;
+
+	//only look at the servers that were due to expire since last time, instead of every single one.
+	if (now - svm.wheeltick > SVM_WHEELSLOTS)
+		svm.wheeltick = now - SVM_WHEELSLOTS;	//we stalled for ages, don't walk the same slots multiple times.
+	for (; svm.wheeltick < now; svm.wheeltick++)
 	{
-		for (serverlink = &g->firstserver; (s=*serverlink); )
+		for (s = svm.wheel[svm.wheeltick % SVM_WHEELSLOTS]; s; s = next)
 		{
-			//brokered servers don't time out (they drop when their tcp connection dies)
-			if (!s->brokerid && s->expiretime < svm.time)
-			{
-				if (developer.ival)
-				{
-					char buf[256];
-					Con_Printf("timeout: %s\n", NET_AdrToString(buf, sizeof(buf), &s->adr));
-				}
+			next = s->wheelnext;
+			if (s->expiretime >= svm.time)
+				continue;	//got refreshed, or isn't due until a later lap.
 
-				Hash_RemoveDataKey(&svm.serverhash, SVM_GenerateAddressKey(&s->adr), s);
-
-				svm.total.drops++;
-				*serverlink = s->next;
-				BZ_Free(s);
-				g->numservers--;
-				svm.numservers--;
+			if (developer.ival)
+			{
+				char buf[256];
+				Con_Printf("timeout: %s\n", NET_AdrToString(buf, sizeof(buf), &s->adr));
 			}
-			else
-				serverlink = &s->next;
+
+			svm.total.drops++;
+			SVM_RemoveServer(s);
 		}
+	}
 
+	for (gamelink = &svm.firstgame; (g=*gamelink); )
+	{
 		if (!g->firstserver && !g->persistent)
 		{
 			Con_DPrintf("game \"%s\" has no active servers\n", g->name);
 			*gamelink = g->next;
+			SVM_FlushCachedLists(g);
 			Z_Free(g);
 			svm.numgames--;
 		}
@@ -402,63 +661,90 @@ static void SVM_RemoveOldServers(void)
 	}
 }
 
-int SVM_AddIPAddresses(sizebuf_t *sb, int first, int ver, const char *gamename, int v4, int v6, qboolean empty, qboolean full, qboolean prefixes, int gametype)
+//writes as many matching addresses as will fit.
+static int SVM_AddIPAddresses(sizebuf_t *sb, svm_game_t *game, int ver, int v4, int v6, qboolean empty, qboolean full, qboolean prefixes, int gametype)
 {
 	int number = 0;
 	svm_server_t *server;
 	int prefix;
 	int len;
-	svm_game_t *game = SVM_FindGame(gamename, false);
-	if (game)
-	{
-		for (server = game->firstserver; server; server = server->next)
-		{
-			if (number == first)
-				break;
 
-			first--;
-		}
-
-		for (; server; server = server->next)
+	for (server = game->firstserver; server; server = server->next)
+	{
+		if (server->protover != ver)
+			continue;
+		if (server->clients == 0 && !empty)
+			continue;
+		if (server->clients+server->bots >= server->maxclients && !full)
+			continue;
+		if (gametype != -1 && server->gametype != gametype)
+			continue;
+		switch(server->adr.type)
 		{
-			if (server->protover != ver)
-				continue;
-			if (server->clients == 0 && !empty)
+		case NA_IP:
+			if (!v4)
 				continue;
-			if (server->clients+server->bots >= server->maxclients && !full)
-				continue;
-			if (gametype != -1 && server->gametype != gametype)
-				continue;
-			switch(server->adr.type)
-			{
-			case NA_IP:
-				if (!v4)
-					continue;
-				prefix = '\\';
-				len = 4;
-				break;
-			case NA_IPV6:
-				if (!v6)
-					continue;
-				prefix = '/';
-				len = 16;
-				break;
-			default:
+			prefix = '\\';
+			len = 4;
+			break;
+		case NA_IPV6:
+			if (!v6)
 				continue;
-			}
+			prefix = '/';
+			len = 16;
+			break;
+		default:
+			continue;
+		}
 
-			if (prefixes)
-				MSG_WriteByte(sb, prefix);
+		if (sb->cursize + (prefixes?1:0) + len + 2 > sb->maxsize)
+			break;	//full. don't overflow.
 
-			SZ_Write(sb, server->adr.address.ip, len);
-			MSG_WriteShort(sb, server->adr.port);
+		if (prefixes)
+			MSG_WriteByte(sb, prefix);
 
-			number++;
-		}
+		SZ_Write(sb, server->adr.address.ip, len);
+		MSG_WriteShort(sb, server->adr.port);
+
+		number++;
 	}
 	return number;
 }
 
+//sends a server list packet to net_from. these get hammered, so the whole packet is cached until the game's servers change.
+static void SVM_SendAddressList(const char *gamename, const char *header, const char *trailer, int ver, int v4, int v6, qboolean empty, qboolean full, qboolean prefixes, int gametype)
+{
+	svm_game_t *game = SVM_FindGame(gamename, false);
+	svm_listcache_t *list = NULL;
+	char key[sizeof(list->key)];
+	size_t trailerlen = strlen(trailer);
+	sizebuf_t sb;
+
+	if (game)
+	{
+		Q_snprintfz(key, sizeof(key), "%s %i %i %i %i %i %i %i", header+4, ver, v4, v6, empty, full, prefixes, gametype);
+		list = SVM_GetCachedList(game, key);
+		if (list)
+		{
+			NET_SendPacket(svm_sockets, list->size, list->data, &net_from);
+			return;
+		}
+	}
+
+	memset(&sb, 0, sizeof(sb));
+	sb.maxsize = sizeof(net_message_buffer)-trailerlen;
+	sb.data = net_message_buffer;
+	SZ_Write(&sb, header, strlen(header));
+	if (game)
+		SVM_AddIPAddresses(&sb, game, ver, v4, v6, empty, full, prefixes, gametype);
+	sb.maxsize += trailerlen;
+	SZ_Write(&sb, trailer, trailerlen);
+
+	if (game)
+		SVM_AddCachedList(game, key, sb.data, sb.cursize);
+	NET_SendPacket(svm_sockets, sb.cursize, sb.data, &net_from);
+}
+
 static char *QuakeCharsToHTML(char *outhtml, size_t outsize, const char *quake, qboolean deunderscore)
 {
 	char *ret = outhtml;
@@ -997,6 +1283,8 @@ vfsfile_t *SVM_Generate_Rawlist(const char **mimetype, const char *masteraddr, c
 vfsfile_t *SVM_GenerateIndex(const char *requesthost, const char *fname, const char **mimetype, const char *query)
 {
 	vfsfile_t *f = NULL;
+	svm_game_t *game;
+	char key[sizeof(((svm_listcache_t*)NULL)->key)];
 	if (!master_css)
 		SVM_Init();
 	if (!strcmp(fname, "index.html"))
@@ -1006,9 +1294,20 @@ vfsfile_t *SVM_GenerateIndex(const char *requesthost, const char *fname, const c
 	else if (!strncmp(fname, "room/", 5))
 		f = SVM_Generate_RoomServerinfo(mimetype, requesthost, fname+5, query);
 	else if (!strncmp(fname, "game/", 5))
-		f = SVM_Generate_Serverlist(mimetype, requesthost, fname+5, query);
+	{
+		game = SVM_FindGame(fname+5, false);
+		if (game)
+			SVM_SortServers(game);	//before checking the cache, so it can't be stale.
+		Q_snprintfz(key, sizeof(key), "html %s %s %i %i", fname+5, requesthost, query && !!strstr(query, "ver=1"), sv_sortlist.ival);
+		f = SVM_CachedPage(game, key, SVM_Generate_Serverlist, mimetype, requesthost, fname+5, query);
+	}
 	else if (!strncmp(fname, "raw/", 4))
-		f = SVM_Generate_Rawlist(mimetype, requesthost, fname+4, query);
+	{
+		COM_StripExtension(fname+4, key, sizeof(key));
+		game = SVM_FindGame(key, false);
+		Q_snprintfz(key, sizeof(key), "raw %s", fname+4);
+		f = SVM_CachedPage(game, key, SVM_Generate_Rawlist, mimetype, requesthost, fname+4, query);
+	}
 	return f;
 }
 
@@ -1047,7 +1346,7 @@ static svm_server_t *SVM_FindBrokerHost(const char *brokerid)
 }
 void SVM_RemoveBrokerGame(const char *brokerid)
 {
-	svm_server_t *s, **link;
+	svm_server_t *s;
 	svm_game_t *game = SVM_GameFromBrokerID(&brokerid, false);
 	if (!game)
 	{
@@ -1055,19 +1354,13 @@ void SVM_RemoveBrokerGame(const char *brokerid)
 		return;
 	}
 
-	for (link = &game->firstserver; (s=*link); )
+	for (s = game->firstserver; s; s = s->next)
 	{
 		if (s->brokerid == brokerid)
 		{
-			*link = s->next;
-			Hash_RemoveDataKey(&svm.serverhash, SVM_GenerateBrokerKey(brokerid), s);
-			Z_Free(s);
-			game->numservers--;
-			svm.numservers--;
+			SVM_RemoveServer(s);
 			return;
 		}
-		else
-			link = &s->next;
 	}
 
 	Con_Printf("SVM_RemoveBrokerGame: failed to remove brokered server: %s\n", brokerid);
@@ -1089,20 +1382,18 @@ void SVM_AddBrokerGame(const char *brokerid, const char *info)
 		Con_DPrintf("heartbeat(new - %s): /%s\n", game->name, brokerid);
 
 		server = Z_Malloc(sizeof(svm_server_t));
-		server->game = game;
 		server->brokerid = brokerid;
-
-		server->next = game->firstserver;
-		game->firstserver = server;
-		game->numservers++;
-		svm.numservers++;
+		SVM_LinkServer(game, server);
 
 		svm.total.adds++;
 
 		Hash_AddKey(&svm.serverhash, SVM_GenerateBrokerKey(brokerid), server, &server->bucket);
 	}
 	else
+	{
 		Con_DPrintf("heartbeat(update - %s): /%s\n", game->name, brokerid);
+		server->game->generation++;
+	}
 
 	s = Info_ValueForKey(info, "sv_maxclients");
 	if (!*s)
@@ -1196,6 +1487,7 @@ static svm_server_t *SVM_Heartbeat(const char *gamename, netadr_t *adr, int numc
 		if (server)
 		{	//it still exists, renew it, but don't otherwise care too much.
 			server->expiretime = max(validuntil, server->expiretime);
+			SVM_ScheduleExpiry(server);
 			return server;
 		}
 		game = SVM_FindGame("UNKNOWN", true);
@@ -1210,6 +1502,7 @@ static svm_server_t *SVM_Heartbeat(const char *gamename, netadr_t *adr, int numc
 	if (server && server->game != game)
 	{
 		server->expiretime = realtime - 1;
+		SVM_ScheduleExpiry(server);
 		server = NULL;
 	}
 
@@ -1227,12 +1520,9 @@ static svm_server_t *SVM_Heartbeat(const char *gamename, netadr_t *adr, int numc
 		}
 
 		server = Z_Malloc(sizeof(svm_server_t));
-		server->game = game;
-		server->next = game->firstserver;
-		game->firstserver = server;
-		game->numservers++;
-		svm.numservers++;
+		SVM_LinkServer(game, server);
 		server->expiretime = validuntil;
+		SVM_ScheduleExpiry(server);
 
 		server->adr = *adr;
 
@@ -1248,8 +1538,11 @@ static svm_server_t *SVM_Heartbeat(const char *gamename, netadr_t *adr, int numc
 			Con_Printf("heartbeat(refresh): %s\n", NET_AdrToString(buf, sizeof(buf), &server->adr));
 		}
 		server->expiretime = max(server->expiretime, validuntil);
+		SVM_ScheduleExpiry(server);
 	}
 
+	if (server->clients != numclients || server->bots != numbots || server->spectators != numspecs)
+		game->generation++;
 	server->clients = numclients;
 	server->bots = numbots;
 	server->spectators = numspecs;
@@ -1400,12 +1693,11 @@ static void SVM_ProcessUDPPacket(void)
 	s = COM_Parse(line);
 	if (!strcmp(com_token, "getservers") || !strcmp(com_token, "getserversExt"))
 	{	//q3/dpmaster
-		sizebuf_t sb;
 		int ver;
 		char *eos;
 		char game[64];
 		qboolean ext = !strcmp(com_token, "getserversExt");
-		const char *resp=ext?"getserversExtResponse":"getserversResponse";
+		const char *resp=ext?"\xff\xff\xff\xffgetserversExtResponse":"\xff\xff\xff\xffgetserversResponse";
 		qboolean empty = false;
 		qboolean full = false;
 		qboolean ipv4 = !ext;
@@ -1454,18 +1746,7 @@ static void SVM_ProcessUDPPacket(void)
 
 
 		svm.total.queries++;
-		memset(&sb, 0, sizeof(sb));
-		sb.maxsize = sizeof(net_message_buffer)-2;
-		sb.data = net_message_buffer;
-		MSG_WriteLong(&sb, -1);
-		SZ_Write(&sb, resp, strlen(resp));	//WriteString, but without the null.
-		SVM_AddIPAddresses(&sb, 0, ver, game, ipv4, ipv6, empty, full, true, gametype);
-		sb.maxsize+=2;
-		MSG_WriteByte(&sb, '\\');	//otherwise the last may be considered invalid and ignored.
-		MSG_WriteByte(&sb, 'E');
-		MSG_WriteByte(&sb, 'O');
-		MSG_WriteByte(&sb, 'T');
-		NET_SendPacket(svm_sockets, sb.cursize, sb.data, &net_from);
+		SVM_SendAddressList(game, resp, "\\EOT"/*otherwise the last may be considered invalid and ignored*/, ver, ipv4, ipv6, empty, full, true, gametype);
 	}
 	else if (!strcmp(com_token, "heartbeat"))
 	{	//quake2 heartbeat. Serverinfo and players should follow.
@@ -1555,6 +1836,7 @@ static void SVM_ProcessUDPPacket(void)
 			srv = SVM_Heartbeat(game, &net_from, clients,bots,specs, svm.time + sv_heartbeattimeout.ival);
 			if (srv)
 			{
+				svm_server_t old = *srv;
 				if (unknownresp)
 				{	//retain _ keys that won't be included in unchallenged responses.
 					char *turnkey = Info_ValueForKey(srv->rules, "_turnkey");
@@ -1599,21 +1881,14 @@ static void SVM_ProcessUDPPacket(void)
 					srv->stype |= STYPE_TURN;
 				if (atoi(Info_ValueForKey(srv->rules, "nomouse")))
 					srv->stype |= STYPE_NOMOUSE;
+				SVM_ServerUpdated(srv, &old);
 			}
 		}
 	}
 	else if (!strcmp(com_token, "query"))
 	{	//quake2 server listing request
-		sizebuf_t sb;
 		svm.total.queries++;
-		memset(&sb, 0, sizeof(sb));
-		sb.maxsize = sizeof(net_message_buffer);
-		sb.data = net_message_buffer;
-		MSG_WriteLong(&sb, -1);
-		MSG_WriteString(&sb, "servers\n");
-		sb.cursize--;
-		SVM_AddIPAddresses(&sb, 0, 0, QUAKE2PROTOCOLNAME, true, false, true, true, false, -1);
-		NET_SendPacket(svm_sockets, sb.cursize, sb.data, &net_from);
+		SVM_SendAddressList(QUAKE2PROTOCOLNAME, "\xff\xff\xff\xffservers\n", "", 0, true, false, true, true, false, -1);
 	}
 	else if (*com_token == S2M_HEARTBEAT)	//sequence, players
 	{	//quakeworld heartbeat
@@ -1752,6 +2027,7 @@ static void SVM_ProcessUDPPacket(void)
 		srv = SVM_Heartbeat(game, &net_from, clients,bots,specs, svm.time + sv_heartbeattimeout.ival);
 		if (srv)
 		{
+			svm_server_t old = *srv;
 			Q_strncpyz(srv->rules, s, sizeof(srv->rules));
 			Info_RemoveKey(srv->rules, "*fp");	//we have no challenge and thus no way to protect against spoofing. don't allow it to report a dodgy fingerprint.
 			if (developer.ival)
@@ -1784,20 +2060,14 @@ static void SVM_ProcessUDPPacket(void)
 			}
 			if (!*srv->version)
 				Q_strncpyz(srv->version, Info_ValueForKey(s, "ver"), sizeof(srv->version));
+			SVM_ServerUpdated(srv, &old);
 		}
 	}
 	else if (*com_token == C2M_MASTER_REQUEST)
 	{	//quakeworld server listing request
-		sizebuf_t sb;
+		static const char header[] = {'\xff','\xff','\xff','\xff',M2C_MASTER_REPLY,'\n',0};
 		svm.total.queries++;
-		memset(&sb, 0, sizeof(sb));
-		sb.maxsize = sizeof(net_message_buffer);
-		sb.data = net_message_buffer;
-		MSG_WriteLong(&sb, -1);
-		MSG_WriteByte(&sb, M2C_MASTER_REPLY);
-		MSG_WriteByte(&sb, '\n');
-		SVM_AddIPAddresses(&sb, 0, 0, QUAKEWORLDPROTOCOLNAME, true, false, true, true, false, -1);
-		NET_SendPacket(svm_sockets, sb.cursize, sb.data, &net_from);
+		SVM_SendAddressList(QUAKEWORLDPROTOCOLNAME, header, "", 0, true, false, true, true, false, -1);
 	}
 	else if (*com_token == A2A_PING)
 	{	//quakeworld server ping request... because we can.
@@ -152,6 +152,8 @@ qboolean World_movestep (world_t *world, wedict_t *ent, vec3_t move, vec3_t axis
 	int eflags = ent->v->flags;
 	vec3_t		eaxis[3];
 
+	WPhys_WakeEdict(world, ent);
+
 	if (!axis)
 	{
 		//fixme?
@@ -602,6 +604,7 @@ qboolean World_MoveToGoal (world_t *world, wedict_t *ent, float dist)
 
 	ent = (wedict_t*)PROG_TO_EDICT(world->progs, *world->g.self);	
 	goal = (wedict_t*)PROG_TO_EDICT(world->progs, ent->v->goalentity);
+	WPhys_WakeEdict(world, ent);
 
 	if ( !( (int)ent->v->flags & (FL_ONGROUND|FL_FLY|FL_SWIM) ) )
 	{
@@ -66,6 +66,7 @@ cvar_t	sv_gameplayfix_spawnbeforethinks	= CVARD( "sv_gameplayfix_spawnbeforethin
 cvar_t	dpcompat_noretouchground	= CVARD( "dpcompat_noretouchground", "0", "Prevents entities that are already standing on an entity from touching the same entity again.");
 cvar_t	sv_sound_watersplash = CVAR( "sv_sound_watersplash", "misc/h2ohit1.wav");
 cvar_t	sv_sound_land		 = CVAR( "sv_sound_land", "demon/dland2.wav");
+cvar_t	sv_physics_sleep	 = CVARD( "sv_physics_sleep", "0", "Stops running physics on idle entities (stationary, with no think due within a second) until qc or the engine changes them. Only applies to qc progs, as other gamecode apis cannot be trapped when they write to entities.\n2: Runs them anyway, and reports any field that running them changed, to check that sleeping doesn't change the game.");
 cvar_t	sv_stepheight		 = CVARAFD("pm_stepheight", "",	/*dp*/"sv_stepheight", CVAR_SERVERINFO, "If empty, the value "STRINGIFY(PM_DEFAULTSTEPHEIGHT)" will be used instead. This is the size of the step you can step up or down.");
 extern cvar_t sv_nqplayerphysics;
 
@@ -100,6 +101,7 @@ void WPhys_Init(void)
 	Cvar_Register (&sv_sound_watersplash,				cvargroup_serverphysics);
 	Cvar_Register (&sv_sound_land,						cvargroup_serverphysics);
 	Cvar_Register (&sv_stepheight,						cvargroup_serverphysics);
+	Cvar_Register (&sv_physics_sleep,					cvargroup_serverphysics);
 
 	Cvar_Register (&sv_gameplayfix_noairborncorpse,		cvargroup_serverphysics);
 	Cvar_Register (&sv_gameplayfix_multiplethinks,		cvargroup_serverphysics);
@@ -792,6 +794,7 @@ static qboolean WPhys_PushAngles (world_t *w, wedict_t *pusher, vec3_t move, vec
 			VectorCopy (check->v->origin, pushed_p->origin);
 			VectorCopy (check->v->angles, pushed_p->angles);
 			pushed_p++;
+			WPhys_WakeEdict(w, check);
 
 			// try moving the contacted entity
 			VectorAdd (check->v->origin, move, check->v->origin);
@@ -998,6 +1001,7 @@ qboolean WPhys_Push (world_t *w, wedict_t *pusher, vec3_t move, vec3_t amove)
 		VectorCopy (check->v->origin, moved_from[num_moved]);
 		moved_edict[num_moved] = check;
 		num_moved++;
+		WPhys_WakeEdict(w, check);
 
 		if (check->v->groundentity != pusher->entnum)
 			check->v->flags = (int)check->v->flags & ~FL_ONGROUND;
@@ -2448,16 +2452,271 @@ trace_t WPhys_Trace_Toss (world_t *w, wedict_t *tossent, wedict_t *ignore)
 	return trace;
 }
 
+/*
+Entity sleeping.
+Entities whose physics frame would be a no-op (movetype_none, or resting on the world with no velocity) are left out
+of the physics walk until something changes them. Their asleep flag is set, so any qc write to them
+gets trapped by the vm and wakes them via WPhys_WakeEdict. Writes through pointers are found by address while
+numasleep says there's anything to find. Engine code that pokes physics fields directly must wake
+them itself. Pending nextthinks are kept in a min-heap and woken on the frame they become due.
+Waking stamps lastruntime as though the walk had been running them all along, but qc that reads it from an ent that
+is still asleep will see when it fell asleep.
+*/
+#define PHYS_SLEEPMARGIN 1.0	//don't bother sleeping ents that will think within this many seconds.
+
+static void WPhys_SleepReserve(world_t *w, unsigned int entnum)
+{
+	unsigned int newmax = max(entnum+1, w->max_edicts);
+	newmax = (newmax+31)&~31;
+	w->sleep.awake = BZ_Realloc(w->sleep.awake, sizeof(*w->sleep.awake)*(newmax>>5));
+	memset(w->sleep.awake+(w->sleep.maxents>>5), 0xff, sizeof(*w->sleep.awake)*((newmax-w->sleep.maxents)>>5));	//anything new is awake
+	w->sleep.thinktime = BZ_Realloc(w->sleep.thinktime, sizeof(*w->sleep.thinktime)*newmax);
+	memset(w->sleep.thinktime+w->sleep.maxents, 0, sizeof(*w->sleep.thinktime)*(newmax-w->sleep.maxents));
+	w->sleep.maxents = newmax;
+}
+
+static void WPhys_SleepHeapPush(world_t *w, float time, unsigned int entnum)
+{
+	unsigned int i, p;
+	if (w->sleep.numheap == w->sleep.maxheap)
+	{
+		w->sleep.maxheap = max(64, w->sleep.maxheap*2);
+		w->sleep.heap = BZ_Realloc(w->sleep.heap, sizeof(*w->sleep.heap)*w->sleep.maxheap);
+	}
+	for (i = w->sleep.numheap++; i > 0; i = p)
+	{
+		p = (i-1)>>1;
+		if (w->sleep.heap[p].time <= time)
+			break;
+		w->sleep.heap[i] = w->sleep.heap[p];
+	}
+	w->sleep.heap[i].time = time;
+	w->sleep.heap[i].entnum = entnum;
+}
+
+static void WPhys_SleepHeapPop(world_t *w)
+{
+	unsigned int i, c, n = --w->sleep.numheap;
+	float time = w->sleep.heap[n].time;
+	for (i = 0; (c = i*2+1) < n; i = c)
+	{
+		if (c+1 < n && w->sleep.heap[c+1].time < w->sleep.heap[c].time)
+			c++;
+		if (time <= w->sleep.heap[c].time)
+			break;
+		w->sleep.heap[i] = w->sleep.heap[c];
+	}
+	w->sleep.heap[i] = w->sleep.heap[n];
+}
+
+//the physics walk stamps these on everything it runs, so a sleeper needs them bringing up to date as though it never stopped.
+static void WPhys_SleepCatchUp(world_t *w, wedict_t *ent, qboolean ranthisframe)
+{
+	ent->lastruntime = ranthisframe?w->framenum:w->framenum-1;
+#ifndef CLIENTONLY
+	if (progstype == PROG_QW && w == &sv.world)
+		ent->v->lastruntime = w->sleep.runtime[ranthisframe?0:1];
+#endif
+}
+
+void WPhys_WakeEdict(world_t *w, wedict_t *ent)
+{
+	unsigned int n = ent->entnum;
+	if (!ent->asleep)
+		return;
+	ent->asleep = false;
+	w->progs->numasleep--;
+	WPhys_SleepCatchUp(w, ent, n < w->sleep.walkpos);	//if the walk is yet to reach it then it'll be stamped again there.
+	if (n < w->sleep.maxents)
+	{
+		w->sleep.awake[n>>5] |= 1u<<(n&31);
+		w->sleep.thinktime[n] = 0;	//any heap entry for it is now stale
+	}
+}
+
+//wakes everything and forgets about sleeping entirely (for when the world is cleared or sleeping gets disabled).
+void WPhys_WakeAll(world_t *w)
+{
+	unsigned int i, n = min(w->sleep.maxents, w->num_edicts);
+	wedict_t *ent;
+	for (i = 0; i < n; i++)
+	{
+		if (w->sleep.awake[i>>5] & (1u<<(i&31)))
+			continue;
+		ent = WEDICT_NUM_PB(w->progs, i);
+		if (ent->asleep)
+		{
+			ent->asleep = false;
+			WPhys_SleepCatchUp(w, ent, i < w->sleep.walkpos);
+		}
+	}
+	if (w->progs)
+		w->progs->numasleep = 0;
+	BZ_Free(w->sleep.awake);
+	BZ_Free(w->sleep.thinktime);
+	BZ_Free(w->sleep.heap);
+	w->sleep.awake = NULL;
+	w->sleep.thinktime = NULL;
+	w->sleep.heap = NULL;
+	w->sleep.maxents = 0;
+	w->sleep.numheap = w->sleep.maxheap = 0;
+}
+
+//wakes any sleepers whose nextthink is due this frame.
+static void WPhys_WakeThinkers(world_t *w)
+{
+	double limit = w->physicstime + host_frametime;	//must match WPhys_RunThink
+	unsigned int n;
+	float time;
+
+	while (w->sleep.numheap && !(w->sleep.heap[0].time > limit))
+	{
+		time = w->sleep.heap[0].time;
+		n = w->sleep.heap[0].entnum;
+		WPhys_SleepHeapPop(w);
+		if (n < w->num_edicts && w->sleep.thinktime[n] == time)
+			WPhys_WakeEdict(w, WEDICT_NUM_PB(w->progs, n));
+	}
+}
+
+//returns the first awake entity at or after i.
+static unsigned int WPhys_NextAwake(world_t *w, unsigned int i)
+{
+	unsigned int bits;
+	while (i < w->num_edicts && i < w->sleep.maxents)
+	{
+		bits = w->sleep.awake[i>>5] >> (i&31);
+		if (bits)
+		{
+			while (!(bits&1))
+			{
+				bits >>= 1;
+				i++;
+			}
+			return i;
+		}
+		i = (i|31)+1;
+	}
+	return i;
+}
+
+//puts the entity to sleep if running its physics would do nothing for a while.
+static void WPhys_TrySleep(world_t *w, wedict_t *ent)
+{
+	unsigned int n = ent->entnum;
+	float thinktime;
+	wedict_t *sleeper;
+
+	if (ED_ISFREE(ent) || ent->readonly || ent->xv->customphysics)
+		return;
+#ifdef HEXEN2
+	if (ent->xv->movechain)
+		return;
+#endif
+	switch((int)ent->v->movetype)
+	{
+	case MOVETYPE_NONE:
+		break;
+	case MOVETYPE_FLY:
+	case MOVETYPE_FLY_WORLDONLY:
+	case MOVETYPE_H2SWIM:
+	case MOVETYPE_TOSS:
+	case MOVETYPE_BOUNCE:
+	case MOVETYPE_BOUNCEMISSILE:
+	case MOVETYPE_FLYMISSILE:
+		//WPhys_Physics_Toss returns early for these. anything else (like a plat) might move under them.
+		if (!((int)ent->v->flags & FL_ONGROUND) || ent->v->groundentity)
+			return;
+		if (ent->v->velocity[0] || ent->v->velocity[1] || ent->v->velocity[2])
+			return;
+		break;
+	default:
+		return;
+	}
+
+	thinktime = ent->v->nextthink;
+	if (thinktime > 0)
+	{
+		if (thinktime <= w->physicstime + host_frametime + PHYS_SLEEPMARGIN)
+			return;
+	}
+	else
+		thinktime = 0;
+
+	if (n >= w->sleep.maxents)
+		WPhys_SleepReserve(w, n);
+	if (thinktime)
+	{
+		if (w->sleep.numheap >= w->sleep.maxents)
+		{	//too many stale entries from ents that keep getting woken. rebuild it from scratch.
+			unsigned int i;
+			w->sleep.numheap = 0;
+			for (i = 0; i < w->sleep.maxents && i < w->num_edicts; i++)
+			{
+				if (!(w->sleep.awake[i>>5] & (1u<<(i&31))) && w->sleep.thinktime[i])
+				{
+					sleeper = WEDICT_NUM_PB(w->progs, i);
+					if (sleeper->asleep)
+						WPhys_SleepHeapPush(w, w->sleep.thinktime[i], i);
+				}
+			}
+		}
+		WPhys_SleepHeapPush(w, thinktime, n);
+	}
+	w->sleep.thinktime[n] = thinktime;
+	w->sleep.awake[n>>5] &= ~(1u<<(n&31));
+	ent->asleep = true;
+	w->progs->numasleep++;
+	w->progs->lastaddress = 0;	//qc might still be holding that, and it isn't awake any more.
+}
+
+//sv_physics_sleep 2 runs sleepers anyway, as they would be with sleeping off, and complains about anything that changed.
+static void WPhys_SleepCheck(world_t *w, wedict_t *ent)
+{
+	static int *before;
+	static unsigned int beforesize;
+	const int *after = (const int*)ent->v;
+	unsigned int count, f, i, size;
+	fdef_t *fdef;
+
+	if (beforesize < ent->fieldsize)
+	{
+		beforesize = ent->fieldsize;
+		before = BZ_Realloc(before, beforesize);
+	}
+	WPhys_SleepCatchUp(w, ent, true);	//what waking it now would give.
+	memcpy(before, ent->v, ent->fieldsize);
+	ent->lastruntime = w->framenum-1;	//so WPhys_RunEntity doesn't think it already ran.
+
+	WPhys_RunEntity (w, ent);
+	WPhys_RunNewmis (w);
+
+	if (!memcmp(before, ent->v, ent->fieldsize))
+		return;	//running it didn't do anything, so sleeping through it didn't either.
+	fdef = w->progs->FieldInfo(w->progs, &count);
+	for (f = 0; f < count; f++)
+	{
+		size = (fdef[f].type == ev_vector)?3:1;
+		i = fdef[f].ofs + w->progs->fieldadjust;
+		if ((i+size)*sizeof(int) <= ent->fieldsize && memcmp(before+i, after+i, size*sizeof(int)))
+			Con_Printf("sleeping entity %i (%s) would have changed .%s\n", ent->entnum, PR_GetString(w->progs, ent->v->classname), fdef[f].name);
+	}
+	WPhys_WakeEdict(w, ent);	//it's not idle after all.
+}
+
 /*
 Run an individual physics frame. This might be run multiple times in one frame if we're running slow, or not at all.
 */
 void World_Physics_Frame(world_t *w)
 {
 	int i;
-	qboolean retouch;
+	qboolean retouch, sleep, sleepcheck;
 	wedict_t *ent;
 
 	w->framenum++;
+	w->sleep.runtime[1] = w->sleep.runtime[0];
+	w->sleep.runtime[0] = w->physicstime;
+	w->sleep.walkpos = 0;
 
 	i = *w->g.physics_mode;
 	if (i == 0)
@@ -2482,18 +2741,48 @@ void World_Physics_Frame(world_t *w)
 
 	retouch = (w->g.force_retouch && (*w->g.force_retouch >= 1));
 
+#ifdef HAVE_SERVER
+	sleep = w == &sv.world && svs.gametype == GT_PROGS && sv_physics_sleep.ival;
+	sleepcheck = sleep && sv_physics_sleep.ival == 2;
+#else
+	sleep = sleepcheck = false;
+#endif
+	if (sleep)
+		WPhys_WakeThinkers(w);
+	else if (w->sleep.maxents)
+		WPhys_WakeAll(w);
+
 	//
 	// treat each object in turn
 	// even the world gets a chance to think
 	//
 	for (i=0 ; i<w->num_edicts ; i++)
 	{
+		if (sleep && !retouch && !sleepcheck)
+		{
+			i = WPhys_NextAwake(w, i);
+			if (i >= w->num_edicts)
+				break;
+		}
+		w->sleep.walkpos = i;
 		ent = (wedict_t*)EDICT_NUM_PB(w->progs, i);
 		if (ED_ISFREE(ent))
 			continue;
 
 		if (retouch)
+		{
 			World_LinkEdict (w, ent, true);	// force retouch even for stationary
+			if (ent->asleep && !sleepcheck)
+				continue;	//still asleep, nothing to run.
+		}
+		if (ent->asleep)
+		{
+			w->sleep.walkpos = i+1;	//this is its turn.
+			WPhys_SleepCheck(w, ent);
+			if (!ent->asleep)
+				WPhys_TrySleep(w, ent);
+			continue;
+		}
 
 #ifdef HAVE_SERVER
 		if (i > 0 && i <= sv.allocated_client_slots && w == &sv.world)
@@ -2538,7 +2827,10 @@ void World_Physics_Frame(world_t *w)
 
 		WPhys_RunEntity (w, ent);
 		WPhys_RunNewmis (w);
+		if (sleep)
+			WPhys_TrySleep(w, ent);
 	}
+	w->sleep.walkpos = ~0u;
 
 	if (retouch)
 		*w->g.force_retouch-=1;
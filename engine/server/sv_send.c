@@ -3397,6 +3397,32 @@ void SV_BroadcastUserinfoChange(client_t *about, qboolean isbasic, const char *k
 #endif
 }
 
+//the bit of SV_SendClientMessages that actually builds+sends the client's packet, once its decided that it should.
+static void SV_SendClientPacket(client_t *c)
+{
+	int sentbytes, fnum;
+
+	SV_ReplaceEntityFrame(c, c->netchan.outgoing_sequence);
+	SV_SendClientPrespawnInfo(c);
+	if (c->state == cs_spawned)
+		SV_SendClientDatagram (c);
+	else
+	{
+#ifdef NQPROT
+		SV_DarkPlacesDownloadChunk(c, &c->datagram);
+#endif
+		fnum = c->netchan.outgoing_sequence;
+		sentbytes = Netchan_Transmit (&c->netchan, c->datagram.cursize, c->datagram.data, SV_RateForClient(c));	// just update reliable
+		if (ISQWCLIENT(c) || ISNQCLIENT(c))
+			c->frameunion.frames[fnum & UPDATE_MASK].packetsizeout += sentbytes;
+		c->datagram.cursize = 0;
+	}
+	c->lastoutgoingphysicstime = sv.world.physicstime;
+
+	if (c->netchan.fatal_error)
+		c->drop = true;
+}
+
 /*
 =======================
 SV_SendClientMessages
@@ -3406,7 +3432,9 @@ void SV_SendClientMessages (void)
 {
 	int			i, j;
 	client_t	*c;
-	int sentbytes, fnum;
+	client_t	**sendlist = NULL;	//sv_threadedsnapshots defers the sends until the workers have culled everything.
+	int			numsend = 0;
+	extern cvar_t sv_threadedsnapshots;
 #ifdef NQPROT
 	float pt = sv.paused?realtime:sv.world.physicstime;
 #endif
@@ -3453,6 +3481,9 @@ void SV_SendClientMessages (void)
 // update frags, names, etc
 	SV_UpdateToReliableMessages ();
 
+	if (sv_threadedsnapshots.ival && COM_HasWorkers(WG_COMPUTE))
+		sendlist = alloca(sizeof(*sendlist) * svs.allocated_client_slots);
+
 // build individual updates
 	for (i=0, c = svs.clients ; i<svs.allocated_client_slots ; i++, c++)
 	{
@@ -3667,25 +3698,20 @@ void SV_SendClientMessages (void)
 			c->ratetime = sv.time;
 		}
 
-		SV_ReplaceEntityFrame(c, c->netchan.outgoing_sequence);
-		SV_SendClientPrespawnInfo(c);
-		if (c->state == cs_spawned)
-			SV_SendClientDatagram (c);
+		if (sendlist)
+			sendlist[numsend++] = c;
 		else
+			SV_SendClientPacket(c);
+	}
+
+	if (numsend)
+	{
+		SV_Snapshot_PrecullClients(sendlist, numsend);
+		for (i = 0; i < numsend; i++)
 		{
-#ifdef NQPROT
-			SV_DarkPlacesDownloadChunk(c, &c->datagram);
-#endif
-			fnum = c->netchan.outgoing_sequence;
-			sentbytes = Netchan_Transmit (&c->netchan, c->datagram.cursize, c->datagram.data, SV_RateForClient(c));	// just update reliable
-			if (ISQWCLIENT(c) || ISNQCLIENT(c))
-				c->frameunion.frames[fnum & UPDATE_MASK].packetsizeout += sentbytes;
-			c->datagram.cursize = 0;
+			SV_SendClientPacket(sendlist[i]);
+			sendlist[i]->snapvis_valid = false;	//don't let it go stale if nothing used it
 		}
-		c->lastoutgoingphysicstime = sv.world.physicstime;
-
-		if (c->netchan.fatal_error)
-			c->drop = true;
 	}
 #ifdef MVD_RECORDING
 	if (sv.mvdrecording)
@@ -7025,18 +7025,46 @@ static qboolean AddEntityToPmove(world_t *w, wedict_t *player, wedict_t *check)
 }
 
 #if 1
+//ctx is the player
+static qboolean AddLinkToPmove (world_t *w, wedict_t *check, void *ctx)
+{
+	wedict_t	*player = ctx;
+	int			i;
+	int			solid;
+
+	if (check->v->owner == EDICT_TO_PROG(w->progs, player))
+		return true;		// player's own missile
+	if (check == player)
+		return true;
+	solid = check->v->solid;
+	if (
+		(solid == SOLID_TRIGGER && check->v->skin < 0)
+		|| solid == SOLID_BSP
+		|| solid == SOLID_PORTAL
+		|| solid == SOLID_BBOX
+		|| solid == SOLID_SLIDEBOX
+		|| solid == SOLID_LADDER
+		//|| (solid == SOLID_PHASEH2 && progstype == PROG_H2) //logically matches hexen2, but I hate it
+		)
+	{
+
+		for (i=0 ; i<3 ; i++)
+			if (check->v->absmin[i] > pmove_maxs[i]
+			|| check->v->absmax[i] < pmove_mins[i])
+				break;
+		if (i != 3)
+			return true;
+
+		return AddEntityToPmove(w, player, check);
+	}
+	return true;
+}
 #ifdef USEAREAGRID
 extern size_t areagridsequence;
 static void AddLinksToPmove (world_t *w, wedict_t *player, areagridlink_t *node)
 {
-	int Q1_HullPointContents (hull_t *hull, int num, vec3_t p);
 	link_t		*l, *next;
 	wedict_t		*check;
-	int			pl;
-	int			i;
-	int			solid;
-
-	pl = EDICT_TO_PROG(w->progs, player);
 
 	// touch linked edicts
 	for (l = node->l.next ; l != &node->l ; l = next)
@@ -7048,32 +7076,8 @@ static void AddLinksToPmove (world_t *w, wedict_t *player, areagridlink_t *node)
 			continue;
 		check->gridareasequence = areagridsequence;
 
-		if (check->v->owner == pl)
-			continue;		// player's own missile
-		if (check == player)
-			continue;
-		solid = check->v->solid;
-		if (
-			(solid == SOLID_TRIGGER && check->v->skin < 0)
-			|| solid == SOLID_BSP
-			|| solid == SOLID_PORTAL
-			|| solid == SOLID_BBOX
-			|| solid == SOLID_SLIDEBOX
-			|| solid == SOLID_LADDER
-			//|| (solid == SOLID_PHASEH2 && progstype == PROG_H2) //logically matches hexen2, but I hate it
-			)
-		{
-
-			for (i=0 ; i<3 ; i++)
-				if (check->v->absmin[i] > pmove_maxs[i]
-				|| check->v->absmax[i] < pmove_mins[i])
-					break;
-			if (i != 3)
-				continue;
-
-			if (!AddEntityToPmove(w, player, check))
-				break;
-		}
+		if (!AddLinkToPmove(w, check, player))
+			break;
 	}
 }
 
@@ -7130,6 +7134,7 @@ void AddAllLinksToPmove (world_t *w, wedict_t *player)
 	for (g[0] = ming[0]; g[0] < maxg[0]; g[0]++)
 		for (g[1] = ming[1]; g[1] < maxg[1]; g[1]++)
 			AddLinksToPmove(w, player, &w->gridareas[g[0] + g[1]*w->gridsize[0]]);
+	World_AreaHash_Walk(w, pmove_mins, pmove_maxs, AddLinkToPmove, player);
 
 	AddPortalsToPmove(w, player, &w->portallist);
 }
@@ -7142,47 +7147,14 @@ AddLinksToPmove
 */
 void AddLinksToPmove (world_t *w, wedict_t *player, areanode_t *node)
 {
-	int Q1_HullPointContents (hull_t *hull, int num, vec3_t p);
 	link_t		*l, *next;
-	wedict_t		*check;
-	int			pl;
-	int			i;
-	int			solid;
-
-	pl = EDICT_TO_PROG(w->progs, player);
 
 	// touch linked edicts
 	for (l = node->edicts.next ; l != &node->edicts ; l = next)
 	{
 		next = l->next;
-		check = (wedict_t*)EDICT_FROM_AREA(l);
-
-		if (check->v->owner == pl)
-			continue;		// player's own missile
-		if (check == player)
-			continue;
-		solid = check->v->solid;
-		if (
-			(solid == SOLID_TRIGGER && check->v->skin < 0)
-			|| solid == SOLID_BSP
-			|| solid == SOLID_PORTAL
-			|| solid == SOLID_BBOX
-			|| solid == SOLID_SLIDEBOX
-			|| solid == SOLID_LADDER
-			//|| (solid == SOLID_PHASEH2 && progstype == PROG_H2) //logically matches hexen2, but I hate it
-			)
-		{
-
-			for (i=0 ; i<3 ; i++)
-				if (check->v->absmin[i] > pmove_maxs[i]
-				|| check->v->absmax[i] < pmove_mins[i])
-					break;
-			if (i != 3)
-				continue;
-
-			if (!AddEntityToPmove(w, player, check))
-				break;
-		}
+		if (!AddLinkToPmove(w, (wedict_t*)EDICT_FROM_AREA(l), player))
+			break;
 	}
 
 // recurse down both sides
@@ -7242,6 +7214,12 @@ void AddLinksToPmove_Force (world_t *w, wedict_t *player, areanode_t *node)
 	if (pmove_mins[node->axis] < node->dist)
 		AddLinksToPmove_Force (w, player, node->children[1]);
 }
+void AddAllLinksToPmove (world_t *w, wedict_t *player)
+{
+	AddLinksToPmove(w, player, w->areanodes);
+	World_AreaHash_Walk(w, pmove_mins, pmove_maxs, AddLinkToPmove, player);
+	AddLinksToPmove_Force(w, player, &w->portallist);
+}
 #endif
 
 #else
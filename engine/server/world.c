@@ -37,6 +37,7 @@ size_t areagridsequence;	//used to avoid poking the same ent twice.
 
 extern cvar_t sv_compatiblehulls;
 extern cvar_t sv_gameplayfix_linknonsolid;
+extern cvar_t sv_areahash;
 
 typedef struct
 {
@@ -214,6 +215,210 @@ ENTITY AREA CHECKING
 ===============================================================================
 */
 
+/*
+===============
+World_AreaHash_*
+
+Optional loose spatial hash, for maps that are too big for the areanodes/grid to divide sensibly.
+Each ent is filed under the single cell containing the centre of its bounds, which means queries need to be padded by half a cell.
+Anything wider than a cell is left to the regular structures, as are portals.
+The cells are hashed rather than indexed, so the world's size doesn't matter.
+===============
+*/
+#define AREAHASH_MINCELLS 1024
+#define AREAHASH_KEY(h,x,y) ((((unsigned int)(x)*73856093u) ^ ((unsigned int)(y)*19349663u)) & (h)->mask)
+
+static void World_AreaHash_Unlink (wedict_t *ent)
+{
+	areahash_t *h = ent->areahash.hash;
+	areahashcell_t *cell;
+	wedict_t *last;
+	if (!h)
+		return;	//not in the hash
+	ent->areahash.hash = NULL;
+
+	cell = &h->cells[ent->areahash.cell];
+	if (ent->areahash.slot < cell->numents && cell->ents[ent->areahash.slot] == ent)
+	{	//move the last one into our slot
+		last = cell->ents[--cell->numents];
+		cell->ents[ent->areahash.slot] = last;
+		last->areahash.slot = ent->areahash.slot;
+	}
+}
+
+//returns false if the ent is too big for the hash, in which case it needs linking elsewhere.
+static qboolean World_AreaHash_Link (world_t *w, wedict_t *ent)
+{
+	areahash_t *h = w->areahash;
+	areahashcell_t *cell;
+	unsigned int key;
+
+	if (ent->v->absmax[0]-ent->v->absmin[0] > h->cellsize || ent->v->absmax[1]-ent->v->absmin[1] > h->cellsize)
+	{
+		World_AreaHash_Unlink(ent);
+		return false;
+	}
+
+	key = AREAHASH_KEY(h,	(int)floor((ent->v->absmin[0]+ent->v->absmax[0])*0.5*h->scale),
+							(int)floor((ent->v->absmin[1]+ent->v->absmax[1])*0.5*h->scale));
+	if (ent->areahash.hash == h && ent->areahash.cell == key)
+		return true;	//didn't change cell, nothing to do.
+	World_AreaHash_Unlink(ent);
+
+	cell = &h->cells[key];
+	if (cell->numents == cell->maxents)
+	{
+		cell->maxents = cell->maxents?cell->maxents*2:8;
+		cell->ents = BZ_Realloc(cell->ents, sizeof(*cell->ents)*cell->maxents);
+	}
+	ent->areahash.hash = h;
+	ent->areahash.cell = key;
+	ent->areahash.slot = cell->numents;
+	cell->ents[cell->numents++] = ent;
+	return true;
+}
+
+static void World_AreaHash_Free (world_t *w)
+{
+	areahash_t *h = w->areahash;
+	unsigned int i;
+	if (!h)
+		return;
+	for (i = 0; i <= h->mask; i++)
+		BZ_Free(h->cells[i].ents);
+	Z_Free(h);
+	w->areahash = NULL;
+}
+
+//(re)creates an empty hash. ents must be relinked (or known to be unlinked) afterwards.
+static void World_AreaHash_Clear (world_t *w, float cellsize)
+{
+	areahash_t *h;
+	unsigned int numcells, i;
+
+	if (cellsize <= 0)
+	{
+		World_AreaHash_Free(w);
+		return;
+	}
+
+	//aim for about two cells per ent
+	for (numcells = AREAHASH_MINCELLS; numcells < w->max_edicts*2 && numcells < (1u<<20); numcells <<= 1)
+		;
+	if (w->areahash && w->areahash->mask+1 != numcells)
+		World_AreaHash_Free(w);
+	h = w->areahash;
+	if (!h)
+	{
+		h = Z_Malloc(sizeof(*h) + sizeof(*h->cells)*numcells);
+		h->cells = (areahashcell_t*)(h+1);
+		h->mask = numcells-1;
+		w->areahash = h;
+	}
+	else
+	{
+		for (i = 0; i <= h->mask; i++)
+		{
+			h->cells[i].numents = 0;
+			h->cells[i].sequence = 0;
+		}
+	}
+	h->cellsize = max(cellsize, 16);
+	h->scale = 1/h->cellsize;
+	h->sequence = 0;
+}
+
+unsigned int World_AreaHash_Walk (world_t *w, const vec3_t mins, const vec3_t maxs, qboolean (*func)(world_t *w, wedict_t *ent, void *ctx), void *ctx)
+{
+	areahash_t *h = w->areahash;
+	areahashcell_t *cell;
+	double lo[2], hi[2];
+	int x, y;
+	unsigned int i, visited = 0;
+
+	if (!h)
+		return 0;
+
+	//ents can poke out of their cell by up to half a cell.
+	for (i = 0; i < 2; i++)
+	{
+		lo[i] = floor((mins[i] - h->cellsize*0.5) * h->scale);
+		hi[i] = floor((maxs[i] + h->cellsize*0.5) * h->scale);
+	}
+	if (!((hi[0]-lo[0]+1) * (hi[1]-lo[1]+1) < h->mask+1) || lo[0] < -0x40000000 || lo[1] < -0x40000000 || hi[0] > 0x40000000 || hi[1] > 0x40000000)
+	{	//covers more cells than we have, just do them all once.
+		for (cell = h->cells; cell <= h->cells+h->mask; cell++)
+			for (i = 0; i < cell->numents; i++)
+				if (!func(w, cell->ents[i], ctx))
+					return h->mask+1;
+		return h->mask+1;
+	}
+
+	h->sequence++;
+	for (y = lo[1]; y <= (int)hi[1]; y++)
+		for (x = lo[0]; x <= (int)hi[0]; x++)
+		{
+			cell = &h->cells[AREAHASH_KEY(h, x, y)];
+			if (cell->sequence == h->sequence)
+				continue;	//collision, already walked this one.
+			cell->sequence = h->sequence;
+			visited++;
+			for (i = 0; i < cell->numents; i++)
+				if (!func(w, cell->ents[i], ctx))
+					return visited;
+		}
+	return visited;
+}
+
+void World_PrintAreaStats (world_t *w)
+{
+	unsigned int traces = max(1, w->areastats.traces);
+	unsigned int i, hashed = 0, busiest = 0;
+
+	if (w->areahash)
+	{
+		for (i = 0; i <= w->areahash->mask; i++)
+		{
+			hashed += w->areahash->cells[i].numents;
+			busiest = max(busiest, w->areahash->cells[i].numents);
+		}
+		Con_Printf("areahash: %g unit cells, %u ents in %u buckets, busiest has %u\n", w->areahash->cellsize, hashed, w->areahash->mask+1, busiest);
+	}
+	Con_Printf("%u traces, %.1f cells visited and %.1f ents tested per trace\n", w->areastats.traces, w->areastats.cells/(float)traces, w->areastats.tests/(float)traces);
+	memset(&w->areastats, 0, sizeof(w->areastats));
+}
+
+/*
+===============
+SV_UnlinkEdict
+
+===============
+*/
+//unlinks from the grid/areanodes, but not the hash.
+static void World_UnlinkAreas (wedict_t *ent)
+{
+#ifdef USEAREAGRID
+	size_t i;
+	for (i = 0; i < countof(ent->gridareas); i++)
+	{
+		if (!ent->gridareas[i].l.prev)
+			return;		// not linked in anywhere
+		RemoveLink (&ent->gridareas[i].l);
+		ent->gridareas[i].l.prev = ent->gridareas[i].l.next = NULL;
+	}
+#else
+	if (!ent->area.prev)
+		return;		// not linked in anywhere
+	RemoveLink (&ent->area);
+	ent->area.prev = ent->area.next = NULL;
+#endif
+}
+void World_UnlinkEdict (wedict_t *ent)
+{
+	World_AreaHash_Unlink (ent);
+	World_UnlinkAreas (ent);
+}
+
 #if defined(Q2SERVER) || !defined(USEAREAGRID)
 /*
 ===============
@@ -315,6 +520,7 @@ void World_ClearWorld_Nodes (world_t *w, qboolean relink)
 			if (!ent)
 				continue;
 			ent->area.prev = ent->area.next = NULL;
+			ent->areahash.hash = NULL;
 			if (ED_ISFREE(ent))
 				continue;
 			World_LinkEdict (w, ent, false);	// relink ents so touch functions continue to work.
@@ -384,6 +590,7 @@ static void World_ClearWorld_AreaGrid (world_t *w, qboolean relink)
 					break;		// not linked in anywhere
 				ClearLink(&ent->gridareas[j].l);
 			}
+			ent->areahash.hash = NULL;
 			if (ED_ISFREE(ent))
 				continue;
 			World_LinkEdict (w, ent, false);	// relink ents so touch functions continue to work.
@@ -394,12 +601,18 @@ static void World_ClearWorld_AreaGrid (world_t *w, qboolean relink)
 
 void World_ClearWorld (world_t *w, qboolean relink)
 {
+	memset(&w->areastats, 0, sizeof(w->areastats));
+	WPhys_WakeAll(w);
 #ifdef Q2SERVER
 	if (w == &sv.world && svs.gametype == GT_QUAKE2)
+	{
+		World_AreaHash_Clear(w, 0);	//q2 gamecode walks the areanodes itself.
 		World_ClearWorld_Nodes(w, relink);
+	}
 	else
 #endif
 	{
+		World_AreaHash_Clear(w, sv_areahash.value);
 #ifdef USEAREAGRID
 		World_ClearWorld_AreaGrid(w, relink);
 #else
@@ -409,64 +622,53 @@ void World_ClearWorld (world_t *w, qboolean relink)
 }
 
 #if !defined(USEAREAGRID)
-
-/*
-===============
-SV_UnlinkEdict
-
-===============
-*/
-void World_UnlinkEdict (wedict_t *ent)
-{
-	if (!ent->area.prev)
-		return;		// not linked in anywhere
-	RemoveLink (&ent->area);
-	ent->area.prev = ent->area.next = NULL;
-}
-
 /*
 ====================
 SV_TouchLinks
 ====================
 */
-void World_TouchLinks (world_t *w, wedict_t *ent, areanode_t *node)
+typedef struct
 {
-	static wedict_t *nodelinks[256];	//all this means is that any more than this will not touch. probably you won't have that many valid triggers
-	link_t		*l, *next;
-	wedict_t		*touch;
-
-	int linkcount = 0, ln;
+	wedict_t *ent;
+	wedict_t **links;	//static, so touch functions that relink stuff don't chew through the stack
+	int count;
+} touchlinks_t;
+#define MAX_TOUCHLINKS 256	//all this means is that any more than this will not touch. probably you won't have that many valid triggers
+static qboolean World_TouchLinks_Check (world_t *w, wedict_t *touch, void *ctx)
+{
+	touchlinks_t *tl = ctx;
+	wedict_t *ent = tl->ent;
 
-	//work out who they are first.
-	for (l = node->edicts.next ; l != &node->edicts ; l = next)
-	{
-		if (linkcount == countof(nodelinks))
-			break;
-		next = l->next;
-		touch = EDICT_FROM_AREA(l);
-		if (touch == ent)
-			continue;
+	if (tl->count == MAX_TOUCHLINKS)
+		return false;
+	if (touch == ent)
+		return true;
 
-		if (!touch->v->touch || !SOLID_ISTRIGGER(touch->v->solid))
-			continue;
+	if (!touch->v->touch || !SOLID_ISTRIGGER(touch->v->solid))
+		return true;
 
-		if (ent->v->absmin[0] > touch->v->absmax[0]
-		|| ent->v->absmin[1] > touch->v->absmax[1]
-		|| ent->v->absmin[2] > touch->v->absmax[2]
-		|| ent->v->absmax[0] < touch->v->absmin[0]
-		|| ent->v->absmax[1] < touch->v->absmin[1]
-		|| ent->v->absmax[2] < touch->v->absmin[2] )
-			continue;
+	if (ent->v->absmin[0] > touch->v->absmax[0]
+	|| ent->v->absmin[1] > touch->v->absmax[1]
+	|| ent->v->absmin[2] > touch->v->absmax[2]
+	|| ent->v->absmax[0] < touch->v->absmin[0]
+	|| ent->v->absmax[1] < touch->v->absmin[1]
+	|| ent->v->absmax[2] < touch->v->absmin[2] )
+		return true;
 
-		if (!((int)ent->xv->dimension_solid & (int)touch->xv->dimension_hit))
-			continue;
+	if (!((int)ent->xv->dimension_solid & (int)touch->xv->dimension_hit))
+		return true;
 
-		nodelinks[linkcount++] = touch;
-	}
+	tl->links[tl->count++] = touch;
+	return true;
+}
+static void World_TouchLinks_Fire (world_t *w, touchlinks_t *tl)
+{
+	wedict_t *ent = tl->ent, *touch;
+	int ln;
 
-	for (ln = 0; ln < linkcount; ln++)
+	for (ln = 0; ln < tl->count; ln++)
 	{
-		touch = nodelinks[ln];
+		touch = tl->links[ln];
 
 		//make sure nothing moved it away
 		if (ED_ISFREE(touch))
@@ -490,7 +692,21 @@ void World_TouchLinks (world_t *w, wedict_t *ent, areanode_t *node)
 		if (ED_ISFREE(ent))
 			break;
 	}
+}
+void World_TouchLinks (world_t *w, wedict_t *ent, areanode_t *node)
+{
+	static wedict_t *nodelinks[MAX_TOUCHLINKS];
+	touchlinks_t tl = {ent, nodelinks, 0};
+	link_t		*l, *next;
 
+	//work out who they are first.
+	for (l = node->edicts.next ; l != &node->edicts ; l = next)
+	{
+		next = l->next;
+		if (!World_TouchLinks_Check(w, EDICT_FROM_AREA(l), &tl))
+			break;
+	}
+	World_TouchLinks_Fire(w, &tl);
 
 // recurse down both sides
 	if (node->axis == -1 || ED_ISFREE(ent))
@@ -501,6 +717,18 @@ void World_TouchLinks (world_t *w, wedict_t *ent, areanode_t *node)
 	if (ent->v->absmin[node->axis] < node->dist)
 		World_TouchLinks (w, ent, node->children[1]);
 }
+void World_TouchAllLinks (world_t *w, wedict_t *ent)
+{
+	static wedict_t *hashlinks[MAX_TOUCHLINKS];
+	touchlinks_t tl = {ent, hashlinks, 0};
+
+	World_TouchLinks(w, ent, w->areanodes);
+	if (w->areahash && !ED_ISFREE(ent))
+	{
+		World_AreaHash_Walk(w, ent->v->absmin, ent->v->absmax, World_TouchLinks_Check, &tl);
+		World_TouchLinks_Fire(w, &tl);
+	}
+}
 #endif
 
 /*
@@ -515,20 +743,20 @@ void QDECL World_LinkEdict (world_t *w, wedict_t *ent, qboolean touch_triggers)
 	pvec_t *maxs;
 	int solid;
 
-#ifdef USEAREAGRID
-	World_UnlinkEdict (ent);	// unlink from old position
-#else
+#ifndef USEAREAGRID
 	areanode_t	*node;
-	
-	if (ent->area.prev)
-		World_UnlinkEdict (ent);	// unlink from old position
 #endif
+
+	World_UnlinkAreas (ent);	// unlink from old position. the hash is left until we know if it actually changed cell.
 	
 	if (ent == w->edicts)
 		return;		// don't add the world
 
 	if (ED_ISFREE(ent))
+	{
+		World_AreaHash_Unlink (ent);
 		return;
+	}
 
 	mins = ent->v->mins;
 	maxs = ent->v->maxs;
@@ -656,15 +884,21 @@ void QDECL World_LinkEdict (world_t *w, wedict_t *ent, qboolean touch_triggers)
 	}
 
 	if (ent->v->solid == SOLID_NOT && !sv_gameplayfix_linknonsolid.ival)
+	{
+		World_AreaHash_Unlink (ent);
 		return;
+	}
 
 #ifdef USEAREAGRID
 	// find the first node that the ent's box crosses
 	if (ent->v->solid == SOLID_PORTAL)
 	{
+		World_AreaHash_Unlink (ent);
 		ent->gridareas[0].ed = ent;
 		InsertLinkBefore (&ent->gridareas[0].l, &w->portallist.l);
 	}
+	else if (w->areahash && World_AreaHash_Link (w, ent))
+		;	//small enough to go in the hash instead
 	else
 	{
 		int ming[2], maxg[2], g[2], ga;
@@ -690,6 +924,8 @@ void QDECL World_LinkEdict (world_t *w, wedict_t *ent, qboolean touch_triggers)
 // find the first node that the ent's box crosses
 	if (ent->v->solid == SOLID_PORTAL)
 		node = &w->portallist;
+	else if (w->areahash && World_AreaHash_Link (w, ent))
+		node = NULL;	//small enough to go in the hash instead
 	else
 	{
 		node = w->areanodes;
@@ -707,8 +943,11 @@ void QDECL World_LinkEdict (world_t *w, wedict_t *ent, qboolean touch_triggers)
 	}
 	
 // link it in	
-
-	InsertLinkBefore (&ent->area, &node->edicts);
+	if (node)
+	{
+		World_AreaHash_Unlink (ent);
+		InsertLinkBefore (&ent->area, &node->edicts);
+	}
 #endif
 	
 // if touch_triggers, touch all entities at this node and decend for more
@@ -1075,6 +1314,44 @@ static trace_t World_ClipMoveToEntity (world_t *w, wedict_t *ent, vec3_t eorg, v
 
 #ifdef USEAREAGRID
 
+typedef struct
+{
+	float *mins, *maxs;
+	wedict_t **list;
+	int count, maxcount;
+	int areatype;
+} areaedicts_t;
+static qboolean World_AreaEdicts_Check (world_t *w, wedict_t *check, void *ctx)
+{
+	areaedicts_t *a = ctx;
+
+	if (a->areatype != AREA_ALL)
+	{
+		if (check->v->solid == SOLID_NOT)
+			return true;		// deactivated
+
+		if ((check->v->solid == SOLID_TRIGGER||check->v->solid == SOLID_BSPTRIGGER) != (a->areatype == AREA_TRIGGER))
+			return true;
+	}
+
+	if (check->v->absmin[0] > a->maxs[0]
+	|| check->v->absmin[1] > a->maxs[1]
+	|| check->v->absmin[2] > a->maxs[2]
+	|| check->v->absmax[0] < a->mins[0]
+	|| check->v->absmax[1] < a->mins[1]
+	|| check->v->absmax[2] < a->mins[2])
+		return true;		// not touching
+
+	if (a->count == a->maxcount)
+	{
+		Con_Printf ("World_AreaEdicts: MAXCOUNT\n");
+		return false;
+	}
+
+	a->list[a->count++] = check;
+	return true;
+}
+
 /*
 ================
 SV_AreaEdicts
@@ -1084,7 +1361,7 @@ int World_AreaEdicts (world_t *w, vec3_t mins, vec3_t maxs, wedict_t **list, int
 {
 	wedict_t *check;
 	areagridlink_t *start, *l;
-	size_t count = 0;
+	areaedicts_t a = {mins, maxs, list, 0, maxcount, areatype};
 	int ming[2], maxg[2], g[2], ga;
 	CALCAREAGRIDBOUNDS(w, mins, maxs);
 
@@ -1100,31 +1377,8 @@ int World_AreaEdicts (world_t *w, vec3_t mins, vec3_t maxs, wedict_t **list, int
 //			continue;
 		check->gridareasequence = areagridsequence;
 	
-		if (areatype != AREA_ALL)
-		{
-			if (check->v->solid == SOLID_NOT)
-				continue;		// deactivated
-
-			if ((check->v->solid == SOLID_TRIGGER||check->v->solid == SOLID_BSPTRIGGER) != (areatype == AREA_TRIGGER))
-				continue;
-		}
-
-		if (check->v->absmin[0] > maxs[0]
-		|| check->v->absmin[1] > maxs[1]
-		|| check->v->absmin[2] > maxs[2]
-		|| check->v->absmax[0] < mins[0]
-		|| check->v->absmax[1] < mins[1]
-		|| check->v->absmax[2] < mins[2])
-			continue;		// not touching
-
-		if (count == maxcount)
-		{
-			Con_DPrintf ("World_AreaEdicts: MAXCOUNT\n");
-			return count;
-		}
-
-		list[count] = check;
-		count++;
+		if (!World_AreaEdicts_Check(w, check, &a))
+			return a.count;
 	}
 
 	//check the actual grid now.
@@ -1141,35 +1395,15 @@ int World_AreaEdicts (world_t *w, vec3_t mins, vec3_t maxs, wedict_t **list, int
 					continue;
 				check->gridareasequence = areagridsequence;
 			
-				if (areatype != AREA_ALL)
-				{
-					if (check->v->solid == SOLID_NOT)
-						continue;		// deactivated
-
-					if ((check->v->solid == SOLID_TRIGGER||check->v->solid == SOLID_BSPTRIGGER) != (areatype == AREA_TRIGGER))
-						continue;
-				}
-
-				if (check->v->absmin[0] > maxs[0]
-				|| check->v->absmin[1] > maxs[1]
-				|| check->v->absmin[2] > maxs[2]
-				|| check->v->absmax[0] < mins[0]
-				|| check->v->absmax[1] < mins[1]
-				|| check->v->absmax[2] < mins[2])
-					continue;		// not touching
-
-				if (count == maxcount)
-				{
-					Con_Printf ("World_AreaEdicts: MAXCOUNT\n");
-					return count;
-				}
-
-				list[count] = check;
-				count++;
+				if (!World_AreaEdicts_Check(w, check, &a))
+					return a.count;
 			}
 		}
 	}
-	return count;
+
+	//and anything small enough to be in the hash.
+	World_AreaHash_Walk(w, mins, maxs, World_AreaEdicts_Check, &a);
+	return a.count;
 }
 
 #else
@@ -1180,10 +1414,36 @@ static q2edict_t	**area_q2list;
 #endif
 static int		area_count, area_maxcount;
 static int		area_type;
+static qboolean World_AreaEdicts_Check (world_t *w, wedict_t *check, void *ctx)
+{
+	if (check->v->solid == SOLID_NOT)
+		return true;		// deactivated
+
+	/*q2 still has solid/trigger lists, emulate that here*/
+	if ((check->v->solid == SOLID_TRIGGER||check->v->solid == SOLID_BSPTRIGGER) != (area_type == AREA_TRIGGER))
+		return true;
+
+	if (check->v->absmin[0] > area_maxs[0]
+	|| check->v->absmin[1] > area_maxs[1]
+	|| check->v->absmin[2] > area_maxs[2]
+	|| check->v->absmax[0] < area_mins[0]
+	|| check->v->absmax[1] < area_mins[1]
+	|| check->v->absmax[2] < area_mins[2])
+		return true;		// not touching
+
+	if (area_count == area_maxcount)
+	{
+		Con_Printf ("SV_AreaEdicts: MAXCOUNT\n");
+		return false;
+	}
+
+	area_list[area_count] = check;
+	area_count++;
+	return true;
+}
 static void World_AreaEdicts_r (areanode_t *node)
 {
 	link_t		*l, *next, *start;
-	wedict_t		*check;
 
 	// touch linked edicts
 	start = &node->edicts;
@@ -1191,31 +1451,8 @@ static void World_AreaEdicts_r (areanode_t *node)
 	for (l=start->next  ; l != start ; l = next)
 	{
 		next = l->next;
-		check = EDICT_FROM_AREA(l);
-
-		if (check->v->solid == SOLID_NOT)
-			continue;		// deactivated
-
-		/*q2 still has solid/trigger lists, emulate that here*/
-		if ((check->v->solid == SOLID_TRIGGER||check->v->solid == SOLID_BSPTRIGGER) != (area_type == AREA_TRIGGER))
-			continue;
-
-		if (check->v->absmin[0] > area_maxs[0]
-		|| check->v->absmin[1] > area_maxs[1]
-		|| check->v->absmin[2] > area_maxs[2]
-		|| check->v->absmax[0] < area_mins[0]
-		|| check->v->absmax[1] < area_mins[1]
-		|| check->v->absmax[2] < area_mins[2])
-			continue;		// not touching
-
-		if (area_count == area_maxcount)
-		{
-			Con_Printf ("SV_AreaEdicts: MAXCOUNT\n");
+		if (!World_AreaEdicts_Check(NULL, EDICT_FROM_AREA(l), NULL))
 			return;
-		}
-
-		area_list[area_count] = check;
-		area_count++;
 	}
 	
 	if (node->axis == -1)
@@ -1243,6 +1480,7 @@ int World_AreaEdicts (world_t *w, vec3_t mins, vec3_t maxs, wedict_t **list, int
 	area_type = areatype;
 
 	World_AreaEdicts_r (w->areanodes);
+	World_AreaHash_Walk (w, mins, maxs, World_AreaEdicts_Check, NULL);
 
 	return area_count;
 }
@@ -1673,144 +1911,142 @@ void World_TouchAllLinks (world_t *w, wedict_t *ent)
 	}
 }
 
-void World_UnlinkEdict (wedict_t *ent)
+static qboolean World_ClipToEdict (world_t *w, wedict_t *touch, void *ctx)
 {
-	size_t i;
-	for (i = 0; i < countof(ent->gridareas); i++)
+	moveclip_t	*clip = ctx;
+	trace_t		trace;
+
+	w->areastats.tests++;
+	if (touch->v->solid == SOLID_NOT)
+		return true;
+	if (touch == clip->passedict)
+		return true;
+
+	/*if its a trigger, we only clip against it if the flags are aligned*/
+	if (SOLID_ISTRIGGER(touch->v->solid))
 	{
-		if (!ent->gridareas[i].l.prev)
-			return;		// not linked in anywhere
-		RemoveLink (&ent->gridareas[i].l);
-		ent->gridareas[i].l.prev = ent->gridareas[i].l.next = NULL;
+		if (!(clip->type & MOVE_TRIGGERS))
+			return true;
+		if (!((int)touch->v->flags & FL_FINDABLE_NONSOLID))
+			return true;
 	}
-}
-
-static void World_ClipToLinks (world_t *w, areagridlink_t *node, moveclip_t *clip)
-{
-	link_t		*l, *next;
-	wedict_t		*touch;
-	trace_t		trace;
 
-// touch linked edicts
-	for (l = node->l.next ; l != &node->l ; l = next)
+	if (clip->type & MOVE_LAGGED)
 	{
-		next = l->next;
-		touch = ((areagridlink_t*)l)->ed;
+		//can't touch lagged ents - we do an explicit test for them later.
+		if (touch->entnum-1 < w->maxlagents)
+			if (w->lagents[touch->entnum-1].present)
+				return true;
+	}
 
-		if (touch->gridareasequence == areagridsequence)
-			continue;
-		touch->gridareasequence = areagridsequence;
+	if ((clip->type & MOVE_NOMONSTERS) && (touch->v->solid != SOLID_BSP && touch->v->solid != SOLID_PORTAL))
+		return true;
 
-		if (touch->v->solid == SOLID_NOT)
-			continue;
-		if (touch == clip->passedict)
-			continue;
-
-		/*if its a trigger, we only clip against it if the flags are aligned*/
-		if (SOLID_ISTRIGGER(touch->v->solid))
-		{
-			if (!(clip->type & MOVE_TRIGGERS))
-				continue;
-			if (!((int)touch->v->flags & FL_FINDABLE_NONSOLID))
-				continue;
-		}
-
-		if (clip->type & MOVE_LAGGED)
-		{
-			//can't touch lagged ents - we do an explicit test for them later.
-			if (touch->entnum-1 < w->maxlagents)
-				if (w->lagents[touch->entnum-1].present)
-					continue;
-		}
-
-		if ((clip->type & MOVE_NOMONSTERS) && (touch->v->solid != SOLID_BSP && touch->v->solid != SOLID_PORTAL))
-			continue;
-
-		if (clip->passedict)
+	if (clip->passedict)
+	{
+		if (w->usesolidcorpse)
 		{
-			if (w->usesolidcorpse)
-			{
 #if 1
 //				if (!(clip->hitcontentsmask & ((touch->v->solid == SOLID_CORPSE)?FTECONTENTS_CORPSE:FTECONTENTS_BODY)))
-//					continue;
+//					return true;
 #else
-				// don't clip corpse against character
-				if (clip->passedict->v->solid == SOLID_CORPSE && (touch->v->solid == SOLID_SLIDEBOX || touch->v->solid == SOLID_CORPSE))
-					continue;
-				// don't clip character against corpse
-				if (clip->passedict->v->solid == SOLID_SLIDEBOX && touch->v->solid == SOLID_CORPSE)
-					continue;
+			// don't clip corpse against character
+			if (clip->passedict->v->solid == SOLID_CORPSE && (touch->v->solid == SOLID_SLIDEBOX || touch->v->solid == SOLID_CORPSE))
+				return true;
+			// don't clip character against corpse
+			if (clip->passedict->v->solid == SOLID_SLIDEBOX && touch->v->solid == SOLID_CORPSE)
+				return true;
 #endif
-			}
-			if (!((int)clip->passedict->xv->dimension_hit & (int)touch->xv->dimension_solid))
-				continue;
 		}
+		if (!((int)clip->passedict->xv->dimension_hit & (int)touch->xv->dimension_solid))
+			return true;
+	}
 
-		if (clip->boxmins[0] > touch->v->absmax[0]
-		|| clip->boxmins[1] > touch->v->absmax[1]
-		|| clip->boxmins[2] > touch->v->absmax[2]
-		|| clip->boxmaxs[0] < touch->v->absmin[0]
-		|| clip->boxmaxs[1] < touch->v->absmin[1]
-		|| clip->boxmaxs[2] < touch->v->absmin[2] )
-			continue;
+	if (clip->boxmins[0] > touch->v->absmax[0]
+	|| clip->boxmins[1] > touch->v->absmax[1]
+	|| clip->boxmins[2] > touch->v->absmax[2]
+	|| clip->boxmaxs[0] < touch->v->absmin[0]
+	|| clip->boxmaxs[1] < touch->v->absmin[1]
+	|| clip->boxmaxs[2] < touch->v->absmin[2] )
+		return true;
 
-		if (clip->passedict && clip->passedict->v->size[0] && !touch->v->size[0])
-			continue;	// points never interact
+	if (clip->passedict && clip->passedict->v->size[0] && !touch->v->size[0])
+		return true;	// points never interact
 
-	// might intersect, so do an exact clip
+// might intersect, so do an exact clip
 //		if (clip->trace.allsolid)
 //			return;
-		if (clip->passedict)
-		{
-		 	if ((wedict_t*)PROG_TO_EDICT(w->progs, touch->v->owner) == clip->passedict)
-				continue;	// don't clip against own missiles
-			if ((wedict_t*)PROG_TO_EDICT(w->progs, clip->passedict->v->owner) == touch)
-				continue;	// don't clip against owner
-		}
+	if (clip->passedict)
+	{
+	 	if ((wedict_t*)PROG_TO_EDICT(w->progs, touch->v->owner) == clip->passedict)
+			return true;	// don't clip against own missiles
+		if ((wedict_t*)PROG_TO_EDICT(w->progs, clip->passedict->v->owner) == touch)
+			return true;	// don't clip against owner
+	}
 
-		if (touch->v->solid == SOLID_PORTAL)
+	if (touch->v->solid == SOLID_PORTAL)
+	{
+		//make sure we don't hit the world if we're inside the portal
+		World_PortalCSG(touch, clip->mins, clip->maxs, clip->start, clip->end, &clip->trace);
+	}
+
+	if ((int)touch->v->flags & FL_MONSTER)
+		trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins2, clip->maxs2, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
+	else
+		trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins, clip->maxs, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
+
+	if (trace.fraction < clip->trace.fraction)
+	{
+		//trace traveled less, but don't forget if we started in a solid.
+		trace.startsolid |= clip->trace.startsolid;
+		trace.allsolid |= clip->trace.allsolid;
+
+		if (clip->type & MOVE_ENTCHAIN)
 		{
-			//make sure we don't hit the world if we're inside the portal
-			World_PortalCSG(touch, clip->mins, clip->maxs, clip->start, clip->end, &clip->trace);
+			touch->v->chain = EDICT_TO_PROG(w->progs, clip->trace.ent?clip->trace.ent:w->edicts);
+			clip->trace.ent = touch;
 		}
-
-		if ((int)touch->v->flags & FL_MONSTER)
-			trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins2, clip->maxs2, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
 		else
-			trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins, clip->maxs, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
-
-		if (trace.fraction < clip->trace.fraction)
 		{
-			//trace traveled less, but don't forget if we started in a solid.
-			trace.startsolid |= clip->trace.startsolid;
-			trace.allsolid |= clip->trace.allsolid;
-
-			if (clip->type & MOVE_ENTCHAIN)
-			{
-				touch->v->chain = EDICT_TO_PROG(w->progs, clip->trace.ent?clip->trace.ent:w->edicts);
-				clip->trace.ent = touch;
-			}
+			if (clip->trace.startsolid && !trace.startsolid)
+				trace.ent = clip->trace.ent;	//something else hit earlier, that one gets the trace entity, but not the fraction. yeah, combining traces like this was always going to be weird.
 			else
-			{
-				if (clip->trace.startsolid && !trace.startsolid)
-					trace.ent = clip->trace.ent;	//something else hit earlier, that one gets the trace entity, but not the fraction. yeah, combining traces like this was always going to be weird.
-				else
-					trace.ent = touch;
-				clip->trace = trace;
-			}
+				trace.ent = touch;
+			clip->trace = trace;
 		}
-		else if (trace.startsolid || trace.allsolid)
+	}
+	else if (trace.startsolid || trace.allsolid)
+	{
+		//even if the trace traveled less, we still care if it was in a solid.
+		clip->trace.startsolid |= trace.startsolid;
+		clip->trace.allsolid |= trace.allsolid;
+		clip->trace.contents |= trace.contents;
+		if (!clip->trace.ent || trace.fraction == clip->trace.fraction)	//xonotic requires that second test (DP has no check at all, which would end up reporting mismatched fraction/ent results, so yuck).
 		{
-			//even if the trace traveled less, we still care if it was in a solid.
-			clip->trace.startsolid |= trace.startsolid;
-			clip->trace.allsolid |= trace.allsolid;
-			clip->trace.contents |= trace.contents;
-			if (!clip->trace.ent || trace.fraction == clip->trace.fraction)	//xonotic requires that second test (DP has no check at all, which would end up reporting mismatched fraction/ent results, so yuck).
-			{
-				clip->trace.ent = touch;
-			}
+			clip->trace.ent = touch;
 		}
 	}
+	return true;
+}
+static void World_ClipToLinks (world_t *w, areagridlink_t *node, moveclip_t *clip)
+{
+	link_t		*l, *next;
+	wedict_t		*touch;
+
+	w->areastats.cells++;
+
+// touch linked edicts
+	for (l = node->l.next ; l != &node->l ; l = next)
+	{
+		next = l->next;
+		touch = ((areagridlink_t*)l)->ed;
+
+		if (touch->gridareasequence == areagridsequence)
+			continue;
+		touch->gridareasequence = areagridsequence;
+
+		World_ClipToEdict(w, touch, clip);
+	}
 }
 static void World_ClipToAllLinks (world_t *w, moveclip_t *clip)
 {
@@ -1825,17 +2061,90 @@ static void World_ClipToAllLinks (world_t *w, moveclip_t *clip)
 		{
 			World_ClipToLinks(w, &w->gridareas[g[0] + g[1]*w->gridsize[0]], clip);
 		}
+
+	w->areastats.cells += World_AreaHash_Walk(w, clip->boxmins, clip->boxmaxs, World_ClipToEdict, clip);
 }
 
-static unsigned int World_ContentsOfLinks (world_t *w, areagridlink_t *node, vec3_t pos)
+typedef struct
 {
-	link_t		*l, *next;
-	wedict_t		*touch;
-
+	float *pos;
+	unsigned int contents;
+} contentsctx_t;
+static qboolean World_ContentsOfEdict (world_t *w, wedict_t *touch, void *ctx)
+{
+	contentsctx_t *cc = ctx;
 	model_t		*model;
 	int mdlidx;
 	vec3_t pos_l, axis[3];
-	unsigned int ret = 0, c;
+	unsigned int c;
+
+	if (touch->v->solid != SOLID_BSP)
+		return true;
+
+	if (   cc->pos[0] > touch->v->absmax[0]
+		|| cc->pos[1] > touch->v->absmax[1]
+		|| cc->pos[2] > touch->v->absmax[2]
+		|| cc->pos[0] < touch->v->absmin[0]
+		|| cc->pos[1] < touch->v->absmin[1]
+		|| cc->pos[2] < touch->v->absmin[2] )
+		return true;
+
+//		if (touch->v->solid == SOLID_PORTAL)
+//			//FIXME: recurse!
+
+	mdlidx = touch->v->modelindex;
+	if (!mdlidx)
+		return true;
+	model = w->Get_CModel(w, mdlidx);
+	if (!model || (model->type != mod_brush && model->type != mod_heightmap) || model->loadstate != MLS_LOADED)
+		return true;
+
+	VectorSubtract (cc->pos, touch->v->origin, pos_l);
+	if (touch->v->angles[0] || touch->v->angles[1] || touch->v->angles[2])
+	{
+		AngleVectors (touch->v->angles, axis[0], axis[1], axis[2]);
+		VectorNegate(axis[1], axis[1]);
+		c = model->funcs.PointContents(model, axis, pos_l);
+	}
+	else
+		c = model->funcs.PointContents(model, NULL, pos_l);
+
+	if (c && touch->v->skin < 0)
+	{	//if forcedcontents is set, then ALL brushes in this model are forced to the specified contents value.
+		//we achive this by tracing against ALL then forcing it after.
+		unsigned int forcedcontents;
+		safeswitch((enum q1contents_e)(int)touch->v->skin)
+		{
+		case Q1CONTENTS_EMPTY:			forcedcontents = FTECONTENTS_EMPTY;			break;
+		case Q1CONTENTS_SOLID:			forcedcontents = FTECONTENTS_SOLID;			break;
+		case Q1CONTENTS_WATER:			forcedcontents = FTECONTENTS_WATER;			break;
+		case Q1CONTENTS_SLIME:			forcedcontents = FTECONTENTS_SLIME;			break;
+		case Q1CONTENTS_LAVA:			forcedcontents = FTECONTENTS_LAVA;			break;
+		case Q1CONTENTS_SKY:			forcedcontents = FTECONTENTS_SKY;			break;
+		case HLCONTENTS_CLIP:			forcedcontents = FTECONTENTS_PLAYERCLIP|FTECONTENTS_MONSTERCLIP;	break;
+		case HLCONTENTS_CURRENT_0:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_0;			break;
+		case HLCONTENTS_CURRENT_90:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_90;			break;
+		case HLCONTENTS_CURRENT_180:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_180;			break;
+		case HLCONTENTS_CURRENT_270:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_270;			break;
+		case HLCONTENTS_CURRENT_UP:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_UP;			break;
+		case HLCONTENTS_CURRENT_DOWN:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_DOWN;			break;
+		case HLCONTENTS_TRANS:			forcedcontents = FTECONTENTS_EMPTY;			break;
+		case Q1CONTENTS_LADDER:			forcedcontents = FTECONTENTS_LADDER;		break;
+		case Q1CONTENTS_MONSTERCLIP:	forcedcontents = FTECONTENTS_MONSTERCLIP;	break;
+		case Q1CONTENTS_PLAYERCLIP:		forcedcontents = FTECONTENTS_PLAYERCLIP;	break;
+		case Q1CONTENTS_CORPSE:			forcedcontents = FTECONTENTS_CORPSE;		break;
+		safedefault:					forcedcontents = 0;							break;
+		}
+		c = forcedcontents;
+	}
+	cc->contents |= c;
+	return true;
+}
+static unsigned int World_ContentsOfLinks (world_t *w, areagridlink_t *node, vec3_t pos)
+{
+	link_t		*l, *next;
+	wedict_t		*touch;
+	contentsctx_t cc = {pos, 0};
 
 // touch linked edicts
 	for (l = node->l.next ; l != &node->l ; l = next)
@@ -1847,68 +2156,9 @@ static unsigned int World_ContentsOfLinks (world_t *w, areagridlink_t *node, vec
 			continue;
 		touch->gridareasequence = areagridsequence;
 
-		if (touch->v->solid != SOLID_BSP)
-			continue;
-
-		if (   pos[0] > touch->v->absmax[0]
-			|| pos[1] > touch->v->absmax[1]
-			|| pos[2] > touch->v->absmax[2]
-			|| pos[0] < touch->v->absmin[0]
-			|| pos[1] < touch->v->absmin[1]
-			|| pos[2] < touch->v->absmin[2] )
-			continue;
-
-//		if (touch->v->solid == SOLID_PORTAL)
-//			//FIXME: recurse!
-
-		mdlidx = touch->v->modelindex;
-		if (!mdlidx)
-			continue;
-		model = w->Get_CModel(w, mdlidx);
-		if (!model || (model->type != mod_brush && model->type != mod_heightmap) || model->loadstate != MLS_LOADED)
-			continue;
-
-		VectorSubtract (pos, touch->v->origin, pos_l);
-		if (touch->v->angles[0] || touch->v->angles[1] || touch->v->angles[2])
-		{
-			AngleVectors (touch->v->angles, axis[0], axis[1], axis[2]);
-			VectorNegate(axis[1], axis[1]);
-			c = model->funcs.PointContents(model, axis, pos_l);
-		}
-		else
-			c = model->funcs.PointContents(model, NULL, pos_l);
-
-		if (c && touch->v->skin < 0)
-		{	//if forcedcontents is set, then ALL brushes in this model are forced to the specified contents value.
-			//we achive this by tracing against ALL then forcing it after.
-			unsigned int forcedcontents;
-			safeswitch((enum q1contents_e)(int)touch->v->skin)
-			{
-			case Q1CONTENTS_EMPTY:			forcedcontents = FTECONTENTS_EMPTY;			break;
-			case Q1CONTENTS_SOLID:			forcedcontents = FTECONTENTS_SOLID;			break;
-			case Q1CONTENTS_WATER:			forcedcontents = FTECONTENTS_WATER;			break;
-			case Q1CONTENTS_SLIME:			forcedcontents = FTECONTENTS_SLIME;			break;
-			case Q1CONTENTS_LAVA:			forcedcontents = FTECONTENTS_LAVA;			break;
-			case Q1CONTENTS_SKY:			forcedcontents = FTECONTENTS_SKY;			break;
-			case HLCONTENTS_CLIP:			forcedcontents = FTECONTENTS_PLAYERCLIP|FTECONTENTS_MONSTERCLIP;	break;
-			case HLCONTENTS_CURRENT_0:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_0;			break;
-			case HLCONTENTS_CURRENT_90:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_90;			break;
-			case HLCONTENTS_CURRENT_180:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_180;			break;
-			case HLCONTENTS_CURRENT_270:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_270;			break;
-			case HLCONTENTS_CURRENT_UP:		forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_UP;			break;
-			case HLCONTENTS_CURRENT_DOWN:	forcedcontents = FTECONTENTS_WATER|Q2CONTENTS_CURRENT_DOWN;			break;
-			case HLCONTENTS_TRANS:			forcedcontents = FTECONTENTS_EMPTY;			break;
-			case Q1CONTENTS_LADDER:			forcedcontents = FTECONTENTS_LADDER;		break;
-			case Q1CONTENTS_MONSTERCLIP:	forcedcontents = FTECONTENTS_MONSTERCLIP;	break;
-			case Q1CONTENTS_PLAYERCLIP:		forcedcontents = FTECONTENTS_PLAYERCLIP;	break;
-			case Q1CONTENTS_CORPSE:			forcedcontents = FTECONTENTS_CORPSE;		break;
-			safedefault:					forcedcontents = 0;							break;
-			}
-			c = forcedcontents;
-		}
-		ret |= c;
+		World_ContentsOfEdict(w, touch, &cc);
 	}
-	return ret;
+	return cc.contents;
 }
 static unsigned int World_ContentsOfAllLinks (world_t *w, vec3_t pos)
 {
@@ -1924,6 +2174,13 @@ static unsigned int World_ContentsOfAllLinks (world_t *w, vec3_t pos)
 		{
 			ret |= World_ContentsOfLinks(w, &w->gridareas[g[0] + g[1]*w->gridsize[0]], pos);
 		}
+
+	if (w->areahash)
+	{
+		contentsctx_t cc = {pos, 0};
+		World_AreaHash_Walk(w, pos, pos, World_ContentsOfEdict, &cc);
+		ret |= cc.contents;
+	}
 	return ret;
 }
 #else
@@ -1934,127 +2191,135 @@ SV_ClipToLinks
 Mins and maxs enclose the entire area swept by the move
 ====================
 */
-static void World_ClipToLinks (world_t *w, areanode_t *node, moveclip_t *clip)
+static qboolean World_ClipToEdict (world_t *w, wedict_t *touch, void *ctx)
 {
-	link_t		*l, *next;
-	wedict_t		*touch;
+	moveclip_t	*clip = ctx;
 	trace_t		trace;
 
-// touch linked edicts
-	for (l = node->edicts.next ; l != &node->edicts ; l = next)
-	{
-		next = l->next;
-		touch = EDICT_FROM_AREA(l);
-		if (touch->v->solid == SOLID_NOT)
-			continue;
-		if (touch == clip->passedict)
-			continue;
+	w->areastats.tests++;
+	if (touch->v->solid == SOLID_NOT)
+		return true;
+	if (touch == clip->passedict)
+		return true;
 
-		/*if its a trigger, we only clip against it if the flags are aligned*/
-		if (SOLID_ISTRIGGER(touch->v->solid))
-		{
-			if (!(clip->type & MOVE_TRIGGERS))
-				continue;
-			if (!((int)touch->v->flags & FL_FINDABLE_NONSOLID))
-				continue;
-		}
+	/*if its a trigger, we only clip against it if the flags are aligned*/
+	if (SOLID_ISTRIGGER(touch->v->solid))
+	{
+		if (!(clip->type & MOVE_TRIGGERS))
+			return true;
+		if (!((int)touch->v->flags & FL_FINDABLE_NONSOLID))
+			return true;
+	}
 
-		if (clip->type & MOVE_LAGGED)
-		{
-			//can't touch lagged ents - we do an explicit test for them later.
-			if (touch->entnum-1 < w->maxlagents)
-				if (w->lagents[touch->entnum-1].present)
-					continue;
-		}
+	if (clip->type & MOVE_LAGGED)
+	{
+		//can't touch lagged ents - we do an explicit test for them later.
+		if (touch->entnum-1 < w->maxlagents)
+			if (w->lagents[touch->entnum-1].present)
+				return true;
+	}
 
-		if ((clip->type & MOVE_NOMONSTERS) && (touch->v->solid != SOLID_BSP && touch->v->solid != SOLID_PORTAL))
-			continue;
+	if ((clip->type & MOVE_NOMONSTERS) && (touch->v->solid != SOLID_BSP && touch->v->solid != SOLID_PORTAL))
+		return true;
 
-		if (clip->passedict)
+	if (clip->passedict)
+	{
+		if (w->usesolidcorpse)
 		{
-			if (w->usesolidcorpse)
-			{
 #if 1
 //				if (!(clip->hitcontentsmask & ((touch->v->solid == SOLID_CORPSE)?FTECONTENTS_CORPSE:FTECONTENTS_BODY)))
-//					continue;
+//					return true;
 #else
-				// don't clip corpse against character
-				if (clip->passedict->v->solid == SOLID_CORPSE && (touch->v->solid == SOLID_SLIDEBOX || touch->v->solid == SOLID_CORPSE))
-					continue;
-				// don't clip character against corpse
-				if (clip->passedict->v->solid == SOLID_SLIDEBOX && touch->v->solid == SOLID_CORPSE)
-					continue;
+			// don't clip corpse against character
+			if (clip->passedict->v->solid == SOLID_CORPSE && (touch->v->solid == SOLID_SLIDEBOX || touch->v->solid == SOLID_CORPSE))
+				return true;
+			// don't clip character against corpse
+			if (clip->passedict->v->solid == SOLID_SLIDEBOX && touch->v->solid == SOLID_CORPSE)
+				return true;
 #endif
-			}
-			if (!((int)clip->passedict->xv->dimension_hit & (int)touch->xv->dimension_solid))
-				continue;
 		}
+		if (!((int)clip->passedict->xv->dimension_hit & (int)touch->xv->dimension_solid))
+			return true;
+	}
 
-		if (clip->boxmins[0] > touch->v->absmax[0]
-		|| clip->boxmins[1] > touch->v->absmax[1]
-		|| clip->boxmins[2] > touch->v->absmax[2]
-		|| clip->boxmaxs[0] < touch->v->absmin[0]
-		|| clip->boxmaxs[1] < touch->v->absmin[1]
-		|| clip->boxmaxs[2] < touch->v->absmin[2] )
-			continue;
+	if (clip->boxmins[0] > touch->v->absmax[0]
+	|| clip->boxmins[1] > touch->v->absmax[1]
+	|| clip->boxmins[2] > touch->v->absmax[2]
+	|| clip->boxmaxs[0] < touch->v->absmin[0]
+	|| clip->boxmaxs[1] < touch->v->absmin[1]
+	|| clip->boxmaxs[2] < touch->v->absmin[2] )
+		return true;
 
-		if (clip->passedict && clip->passedict->v->size[0] && !touch->v->size[0])
-			continue;	// points never interact
+	if (clip->passedict && clip->passedict->v->size[0] && !touch->v->size[0])
+		return true;	// points never interact
 
-	// might intersect, so do an exact clip
+// might intersect, so do an exact clip
 //		if (clip->trace.allsolid)
 //			return;
-		if (clip->passedict)
-		{
-		 	if ((wedict_t*)PROG_TO_EDICT(w->progs, touch->v->owner) == clip->passedict)
-				continue;	// don't clip against own missiles
-			if ((wedict_t*)PROG_TO_EDICT(w->progs, clip->passedict->v->owner) == touch)
-				continue;	// don't clip against owner
-		}
+	if (clip->passedict)
+	{
+	 	if ((wedict_t*)PROG_TO_EDICT(w->progs, touch->v->owner) == clip->passedict)
+			return true;	// don't clip against own missiles
+		if ((wedict_t*)PROG_TO_EDICT(w->progs, clip->passedict->v->owner) == touch)
+			return true;	// don't clip against owner
+	}
 
-		if (touch->v->solid == SOLID_PORTAL)
+	if (touch->v->solid == SOLID_PORTAL)
+	{
+		//make sure we don't hit the world if we're inside the portal
+		World_PortalCSG(touch, clip->mins, clip->maxs, clip->start, clip->end, &clip->trace);
+	}
+
+	if ((int)touch->v->flags & FL_MONSTER)
+		trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins2, clip->maxs2, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
+	else
+		trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins, clip->maxs, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
+
+	if (trace.fraction < clip->trace.fraction)
+	{
+		//trace traveled less, but don't forget if we started in a solid.
+		trace.startsolid |= clip->trace.startsolid;
+		trace.allsolid |= clip->trace.allsolid;
+
+		if (clip->type & MOVE_ENTCHAIN)
 		{
-			//make sure we don't hit the world if we're inside the portal
-			World_PortalCSG(touch, clip->mins, clip->maxs, clip->start, clip->end, &clip->trace);
+			touch->v->chain = EDICT_TO_PROG(w->progs, clip->trace.ent?clip->trace.ent:w->edicts);
+			clip->trace.ent = touch;
 		}
-
-		if ((int)touch->v->flags & FL_MONSTER)
-			trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins2, clip->maxs2, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
 		else
-			trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, clip->start, clip->mins, clip->maxs, clip->end, clip->hullnum, clip->type & MOVE_HITMODEL, clip->capsule, clip->hitcontentsmask);
-
-		if (trace.fraction < clip->trace.fraction)
 		{
-			//trace traveled less, but don't forget if we started in a solid.
-			trace.startsolid |= clip->trace.startsolid;
-			trace.allsolid |= clip->trace.allsolid;
-
-			if (clip->type & MOVE_ENTCHAIN)
-			{
-				touch->v->chain = EDICT_TO_PROG(w->progs, clip->trace.ent?clip->trace.ent:w->edicts);
-				clip->trace.ent = touch;
-			}
+			if (clip->trace.startsolid && !trace.startsolid)
+				trace.ent = clip->trace.ent;	//something else hit earlier, that one gets the trace entity, but not the fraction. yeah, combining traces like this was always going to be weird.
 			else
-			{
-				if (clip->trace.startsolid && !trace.startsolid)
-					trace.ent = clip->trace.ent;	//something else hit earlier, that one gets the trace entity, but not the fraction. yeah, combining traces like this was always going to be weird.
-				else
-					trace.ent = touch;
-				clip->trace = trace;
-			}
+				trace.ent = touch;
+			clip->trace = trace;
 		}
-		else if (trace.startsolid || trace.allsolid)
+	}
+	else if (trace.startsolid || trace.allsolid)
+	{
+		//even if the trace traveled less, we still care if it was in a solid.
+		clip->trace.startsolid |= trace.startsolid;
+		clip->trace.allsolid |= trace.allsolid;
+		clip->trace.contents |= trace.contents;
+		if (!clip->trace.ent)
 		{
-			//even if the trace traveled less, we still care if it was in a solid.
-			clip->trace.startsolid |= trace.startsolid;
-			clip->trace.allsolid |= trace.allsolid;
-			clip->trace.contents |= trace.contents;
-			if (!clip->trace.ent)
-			{
-				clip->trace.ent = touch;
-			}
+			clip->trace.ent = touch;
 		}
 	}
+	return true;
+}
+static void World_ClipToLinks (world_t *w, areanode_t *node, moveclip_t *clip)
+{
+	link_t		*l, *next;
+
+	w->areastats.cells++;
+
+// touch linked edicts
+	for (l = node->edicts.next ; l != &node->edicts ; l = next)
+	{
+		next = l->next;
+		World_ClipToEdict(w, EDICT_FROM_AREA(l), clip);
+	}
 	
 // recurse down both sides
 	if (node->axis == -1)
@@ -2065,46 +2330,63 @@ static void World_ClipToLinks (world_t *w, areanode_t *node, moveclip_t *clip)
 	if ( clip->boxmins[node->axis] < node->dist )
 		World_ClipToLinks (w, node->children[1], clip );
 }
+static void World_ClipToAllLinks (world_t *w, moveclip_t *clip)
+{
+	World_ClipToLinks(w, w->areanodes, clip);
+	w->areastats.cells += World_AreaHash_Walk(w, clip->boxmins, clip->boxmaxs, World_ClipToEdict, clip);
+}
+
 
 
+typedef struct
+{
+	float *pos;
+	unsigned int contents;
+} contentsctx_t;
+static qboolean World_ContentsOfEdict (world_t *w, wedict_t *touch, void *ctx)
+{
+	contentsctx_t *cc = ctx;
+	trace_t		trace;
+
+	if (touch->v->solid == SOLID_NOT)
+		return true;
 
+	/*if its a trigger, we only clip against it if the flags are aligned*/
+	if (touch->v->solid == SOLID_TRIGGER||touch->v->solid == SOLID_BSPTRIGGER)
+		return true;
+
+	if (cc->pos[0] > touch->v->absmax[0]
+	|| cc->pos[1] > touch->v->absmax[1]
+	|| cc->pos[2] > touch->v->absmax[2]
+	|| cc->pos[0] < touch->v->absmin[0]
+	|| cc->pos[1] < touch->v->absmin[1]
+	|| cc->pos[2] < touch->v->absmin[2] )
+		return true;
+
+	/*if (touch->v->solid == SOLID_PORTAL)
+	{
+		//make sure we don't hit the world if we're inside the portal
+		World_PortalCSG(touch, vec3_origin, vec3_origin, pos, pos, &clip->trace);
+	}*/
+
+	trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, cc->pos, vec3_origin, vec3_origin, cc->pos, 0, false, false, ~0u);
+	if (trace.startsolid)
+		cc->contents |= trace.contents;
+	return true;
+}
 static unsigned int World_ContentsOfLinks (world_t *w, areanode_t *node, vec3_t pos)
 {
-	unsigned int c = 0;
+	unsigned int c;
 	link_t		*l, *next;
-	wedict_t		*touch;
-	trace_t		trace;
+	contentsctx_t cc = {pos, 0};
 
 // touch linked edicts
 	for (l = node->edicts.next ; l != &node->edicts ; l = next)
 	{
 		next = l->next;
-		touch = EDICT_FROM_AREA(l);
-		if (touch->v->solid == SOLID_NOT)
-			continue;
-
-		/*if its a trigger, we only clip against it if the flags are aligned*/
-		if (touch->v->solid == SOLID_TRIGGER||touch->v->solid == SOLID_BSPTRIGGER)
-			continue;
-
-		if (pos[0] > touch->v->absmax[0]
-		|| pos[1] > touch->v->absmax[1]
-		|| pos[2] > touch->v->absmax[2]
-		|| pos[0] < touch->v->absmin[0]
-		|| pos[1] < touch->v->absmin[1]
-		|| pos[2] < touch->v->absmin[2] )
-			continue;
-
-		/*if (touch->v->solid == SOLID_PORTAL)
-		{
-			//make sure we don't hit the world if we're inside the portal
-			World_PortalCSG(touch, vec3_origin, vec3_origin, pos, pos, &clip->trace);
-		}*/
-
-		trace = World_ClipMoveToEntity (w, touch, touch->v->origin, touch->v->angles, pos, vec3_origin, vec3_origin, pos, 0, false, false, ~0u);
-		if (trace.startsolid)
-			c |= trace.contents;
+		World_ContentsOfEdict(w, EDICT_FROM_AREA(l), &cc);
 	}
+	c = cc.contents;
 
 // recurse down both sides
 	if (node->axis == -1)
@@ -2119,7 +2401,9 @@ static unsigned int World_ContentsOfLinks (world_t *w, areanode_t *node, vec3_t
 }
 static unsigned int World_ContentsOfAllLinks (world_t *w, vec3_t pos)
 {
-	return World_ContentsOfLinks(w, w->areanodes, pos);
+	contentsctx_t cc = {pos, 0};
+	World_AreaHash_Walk(w, pos, pos, World_ContentsOfEdict, &cc);
+	return cc.contents | World_ContentsOfLinks(w, w->areanodes, pos);
 }
 #endif
 
@@ -2386,6 +2670,7 @@ trace_t World_Move (world_t *w, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t e
 	int hullnum;
 
 	memset ( &clip, 0, sizeof ( moveclip_t ) );
+	w->areastats.traces++;
 
 	if (passedict->xv->hull && !(type & MOVE_IGNOREHULL))
 		hullnum = passedict->xv->hull;
@@ -2582,11 +2867,7 @@ trace_t World_Move (world_t *w, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t e
 			vec3_t lp, la;
 			int j;
 
-#ifdef USEAREAGRID
 			World_ClipToAllLinks (w, &clip);
-#else
-			World_ClipToLinks (w, w->areanodes, &clip);
-#endif
 
 			for (i = 0; i < w->maxlagents; i++)
 			{
@@ -2687,11 +2968,7 @@ trace_t World_Move (world_t *w, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t e
 		}*/
 		else
 		{
-#ifdef USEAREAGRID
 			World_ClipToAllLinks (w, &clip );
-#else
-			World_ClipToLinks (w, w->areanodes, &clip );
-#endif
 		}
 		World_ClipToLinks(w, &w->portallist, &clip);
 	}
@@ -2809,6 +3086,8 @@ void World_Destroy(world_t *world)
 {
 	World_RBE_Shutdown(world);
 
+	World_AreaHash_Free(world);
+	WPhys_WakeAll(world);
 #ifdef USEAREAGRID
 	Z_Free(world->gridareas);
 #else
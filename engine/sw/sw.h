@@ -32,6 +32,8 @@ typedef struct
 	unsigned int *vpcbuf;
 	unsigned int vpwidth;
 	unsigned int vpheight;
+	unsigned int tilesx, tilesy;
+	int tile[4];	//x0,y0,x1,y1 of the tile currently being drawn. spans are clipped to this.
 	swuniforms_t u;
 	qintptr_t vpcstride;
 	struct workqueue_s *wq;
@@ -48,6 +50,46 @@ typedef struct
 	unsigned int clipflags;	/*1=left,2=right,4=top,8=bottom,16=near*/
 } swvert_t;
 
+#define SW_TILESHIFT 6	//64*64 pixel tiles
+#define SW_TILESIZE (1<<SW_TILESHIFT)
+#define SW_BATCHTRIS 16384	//triangles that get binned before they're handed over to the fragment threads. must fit a short.
+#define SW_BATCHCHUNKS 8192
+#define SW_CHUNKTRIS 26
+
+//a clipped screen-space triangle, waiting for the fragment threads
+typedef struct
+{
+	swimage_t *img;
+	swvert_t v[3];
+} swbintri_t;
+//the triangles that touch a tile, in submission order.
+typedef struct swtilechunk_s
+{
+	struct swtilechunk_s *next;
+	unsigned int count;
+	unsigned short tri[SW_CHUNKTRIS];
+} swtilechunk_t;
+typedef struct
+{
+	volatile qatomic32_t busy;	//fragment threads that still need to draw it
+	void *idle;	//broadcast when busy drops to 0
+	unsigned int numtris;
+	unsigned int numchunks;
+	unsigned int maxtiles;
+	swtilechunk_t **tilehead;
+	swtilechunk_t **tiletail;
+	swbintri_t tris[SW_BATCHTRIS];
+	swtilechunk_t chunks[SW_BATCHCHUNKS];
+} swbatch_t;
+//the vertex thread's binning state. batches are double buffered, so binning and drawing overlap.
+typedef struct
+{
+	swbatch_t *batch[2];
+	unsigned int current;
+	unsigned int tilesx, tilesy;
+} swbinner_t;
+
+union wqcom_u;
 #define WQ_SIZE 1024*1024*8
 #define WQ_MASK (WQ_SIZE-1)
 #define WQ_MAXTHREADS 64
@@ -56,10 +98,16 @@ struct workqueue_s
 	unsigned int numthreads;
 	qbyte queue[WQ_SIZE];
 	volatile unsigned int pos;
+	void *condition;	//broadcast when pos moves, and when a thread catches up with it
+	qboolean (*handler)(swthread_t *t, union wqcom_u *com);
+
+	swbinner_t *bins;	//vertex queues only.
+	struct workqueue_s *spans;	//where binned triangles get sent to be drawn
 
 	swthread_t swthreads[WQ_MAXTHREADS];
 };
 extern struct workqueue_s commandqueue;
+extern struct workqueue_s spanqueue;
 
 
 
@@ -86,7 +134,7 @@ enum
 	CLIP_FAR_FLAG		= 32
 };
 
-typedef union
+typedef union wqcom_u
 {
 	unsigned char align[16];
 
@@ -134,7 +182,8 @@ typedef union
 	} uniforms;
 	struct
 	{
-		int foo;
+		struct wqcom_s com;
+		swbatch_t *batch;
 	} spans;
 } wqcom_t;
 
@@ -143,6 +192,7 @@ typedef union
 void SWRast_EndCommand(struct workqueue_s *wq, wqcom_t *com);
 wqcom_t *SWRast_BeginCommand(struct workqueue_s *wq, int cmdtype, unsigned int size);
 void SWRast_Sync(struct workqueue_s *wq);
+void SWRast_Finish(struct workqueue_s *wq);
 
 
 
@@ -21,8 +21,8 @@ void SW_DestroyTexture(texid_t tex)
 	swimage_t *img = tex->ptr;
 	tex->ptr = NULL;
 
-	/*make sure its not in use by the renderer*/
-	SWRast_Sync(&commandqueue);
+	/*make sure its not in use by the renderer (including anything that's still binned)*/
+	SWRast_Finish(&commandqueue);
 
 	/*okay, it can be killed*/
 	BZ_Free(img);
@@ -23,12 +23,13 @@ main thread builds command:
 	command contains vertex data in the command block
 	main thread runs the vertex programs (much like q3) and performs matrix transforms (much like d3d)
 
-worker threads read each command sequentially:
+vertex thread (or the main thread, if sw_vthread is off) reads each command sequentially:
 	clip to viewport
+	bin the resulting triangles into 64*64 screen tiles, handing off each batch to the fragment threads
 
-division of labour between worker threads works by interlacing.
-each thread gets a different set of scanlines to render.
-we can also trivially implement interlacing with this method
+division of labour between fragment threads works by tiles.
+each thread owns a different set of tiles, and only draws the triangles that touch them.
+scanline interlacing (sw_interlace) is still done within each tile.
 
 */
 
@@ -112,6 +113,7 @@ SPAN_ST - interpolates S+T across the span. access with 'sc' and 'tc'
 	int dx, dy;
 	int recalcside;
 	int interlace;
+	int x, skip;
 
 	float fdx1,fdy1,fdx2,fdy2,fz,d1,d2;
 
@@ -334,44 +336,41 @@ SPAN_ST - interpolates S+T across the span. access with 'sc' and 'tc'
 			xr = (int)vrt->scoord[0]<<16;
 		}
 
-		if (y + numspans > th->vpheight)
-			numspans = th->vpheight - y;
+		if (y + numspans > th->tile[3])
+		{	//the rest of the triangle is below this tile, so stop after these rows
+			numspans = th->tile[3] - y;
+			secondhalf = 1;
+		}
 
 		if (numspans <= 0)
 			continue;
 
-
-		vplout = th->vpcbuf + y * th->vpcstride;	//this is a pointer to the left of the viewport buffer.
-
-		interlace = ((y + th->interlaceline) % th->interlacemod);
-		if (interlace)
+		//skip any rows above this tile, and then any that are not part of this frame's interlace.
+		skip = max(0, th->tile[1] - y);
+		skip += ((y + skip + th->interlaceline) % th->interlacemod);
+		if (skip)
 		{
-			if (interlace > numspans)
-			{
-				interlace = numspans;
-				y+=interlace;
-			}
-			else
-			{
-				y+=interlace;
-				numspans-=interlace;
-			}
-			xl += xld*interlace;
-			xr += xrd*interlace;
-			vplout += th->vpcstride*interlace;
+			if (skip > numspans)
+				skip = numspans;
+			y+=skip;
+			numspans-=skip;
+			xl += xld*skip;
+			xr += xrd*skip;
 
 #ifdef SPAN_ST
-			sl += sld*interlace;
-			tl += tld*interlace;
+			sl += sld*skip;
+			tl += tld*skip;
 #endif
 #ifdef SPAN_ZI
-			zil += zild*interlace;
+			zil += zild*skip;
 #endif
 #ifdef SPAN_Z
-			zl += zld*interlace;
+			zl += zld*skip;
 #endif
 		}
 
+		vplout = th->vpcbuf + y * th->vpcstride;	//this is a pointer to the left of the viewport buffer.
+
 		for (; numspans > 0; 
 			numspans -= th->interlacemod
 			,xl += xld*th->interlacemod
@@ -402,11 +401,34 @@ SPAN_ST - interpolates S+T across the span. access with 'sc' and 'tc'
 #endif
 #ifdef SPAN_Z
 			unsigned int z = zl;
-			unsigned int *restrict zb = th->vpdbuf + y * th->vpwidth + (xl>>16);
+			unsigned int *restrict zb;
 #endif
 
+			x = xl>>16;
 			spanlen = (xr - xl)>>16;
-			outbuf = vplout + (xl>>16);
+			//clip it to the tile
+			skip = th->tile[0] - x;
+			if (skip > 0)
+			{
+				x += skip;
+				spanlen -= skip;
+#ifdef SPAN_ST
+				s += (unsigned int)sd*skip;
+				t += (unsigned int)td*skip;
+#endif
+#ifdef SPAN_ZI
+				zi += (unsigned int)zid*skip;
+#endif
+#ifdef SPAN_Z
+				z += (unsigned int)zd*skip;
+#endif
+			}
+			if (x + spanlen > th->tile[2])
+				spanlen = th->tile[2] - x;
+			outbuf = vplout + x;
+#ifdef SPAN_Z
+			zb = th->vpdbuf + y * th->vpwidth + x;
+#endif
 
 			while(spanlen-->0)
 			{
@@ -578,6 +600,140 @@ static int WT_TransformVertXY(swthread_t *th, swvert_t *v)
 	return result;
 }
 
+static void WT_WaitForBatch(swbatch_t *batch)
+{
+#ifdef MULTITHREAD
+	if (batch->busy)
+	{	//the fragment threads are still drawing it
+		Sys_LockConditional(batch->idle);
+		while (batch->busy)
+			Sys_ConditionWait(batch->idle);
+		Sys_UnlockConditional(batch->idle);
+	}
+#endif
+}
+static void WT_ResetBatch(swbinner_t *bins, swbatch_t *batch)
+{
+	WT_WaitForBatch(batch);
+	batch->numtris = 0;
+	batch->numchunks = 0;
+	memset(batch->tilehead, 0, sizeof(*batch->tilehead)*bins->tilesx*bins->tilesy);
+}
+//hands the current batch over to the fragment threads, and starts filling the other one.
+static void WT_FlushBins(struct workqueue_s *wq)
+{
+	swbinner_t *bins = wq->bins;
+	swbatch_t *batch = bins->batch[bins->current];
+	wqcom_t *com;
+
+	if (!batch->numtris)
+		return;
+
+	batch->busy = max(1, wq->spans->numthreads);
+	com = SWRast_BeginCommand(wq->spans, WTC_SPANS, sizeof(com->spans));
+	com->spans.batch = batch;
+	SWRast_EndCommand(wq->spans, com);
+
+	bins->current ^= 1;
+	WT_ResetBatch(bins, bins->batch[bins->current]);
+}
+static void WT_SetupBins(struct workqueue_s *wq, unsigned int width, unsigned int height)
+{
+	swbinner_t *bins = wq->bins;
+	swbatch_t *batch;
+	unsigned int tiles, i;
+
+	bins->tilesx = (width+SW_TILESIZE-1)>>SW_TILESHIFT;
+	bins->tilesy = (height+SW_TILESIZE-1)>>SW_TILESHIFT;
+	tiles = bins->tilesx*bins->tilesy;
+	for (i = 0; i < 2; i++)
+	{
+		batch = bins->batch[i];
+		if (tiles > batch->maxtiles)
+		{
+			WT_WaitForBatch(batch);
+			BZ_Free(batch->tilehead);
+			BZ_Free(batch->tiletail);
+			batch->maxtiles = tiles;
+			batch->tilehead = BZ_Malloc(sizeof(*batch->tilehead)*tiles);
+			batch->tiletail = BZ_Malloc(sizeof(*batch->tiletail)*tiles);
+		}
+	}
+	WT_ResetBatch(bins, bins->batch[bins->current]);
+}
+//adds a (clipped) triangle to each tile that it might touch.
+static void WT_BinTriangle(swthread_t *th, swimage_t *img, swvert_t *v1, swvert_t *v2, swvert_t *v3)
+{
+	struct workqueue_s *wq = th->wq;
+	swbinner_t *bins = wq->bins;
+	swbatch_t *batch = bins->batch[bins->current];
+	swtilechunk_t *chunk;
+	swbintri_t *tri;
+	int minx, maxx, miny, maxy, tx, ty;
+	unsigned int idx, tile;
+
+	if (!img)
+		return;
+
+	minx = min(v1->scoord[0], min(v2->scoord[0], v3->scoord[0]));
+	maxx = max(v1->scoord[0], max(v2->scoord[0], v3->scoord[0]));
+	miny = min(v1->scoord[1], min(v2->scoord[1], v3->scoord[1]));
+	maxy = max(v1->scoord[1], max(v2->scoord[1], v3->scoord[1]));
+	if (minx == maxx || miny == maxy)
+		return;	//no area, so nothing would be drawn anyway.
+	minx = max(minx, 0)>>SW_TILESHIFT;
+	miny = max(miny, 0)>>SW_TILESHIFT;
+	maxx = min(maxx>>SW_TILESHIFT, (int)bins->tilesx-1);
+	maxy = min(maxy>>SW_TILESHIFT, (int)bins->tilesy-1);
+	if (minx > maxx || miny > maxy)
+		return;
+
+	if (batch->numtris == SW_BATCHTRIS || batch->numchunks + (maxx-minx+1)*(maxy-miny+1) > SW_BATCHCHUNKS)
+	{
+		WT_FlushBins(wq);
+		batch = bins->batch[bins->current];
+	}
+
+	tri = NULL;
+	idx = 0;
+	for (ty = miny; ty <= maxy; ty++)
+	{
+		for (tx = minx; tx <= maxx; tx++)
+		{
+			if (batch->numchunks == SW_BATCHCHUNKS)
+			{	//it covers more tiles than a batch can hold (huge screens). the tiles we already did get drawn now, the rest go in the next batch.
+				WT_FlushBins(wq);
+				batch = bins->batch[bins->current];
+				tri = NULL;
+			}
+			if (!tri)
+			{
+				idx = batch->numtris++;
+				tri = &batch->tris[idx];
+				tri->img = img;
+				tri->v[0] = *v1;
+				tri->v[1] = *v2;
+				tri->v[2] = *v3;
+			}
+
+			tile = tx + ty*bins->tilesx;
+			chunk = batch->tilehead[tile]?batch->tiletail[tile]:NULL;
+			if (!chunk || chunk->count == SW_CHUNKTRIS)
+			{
+				swtilechunk_t *n = &batch->chunks[batch->numchunks++];
+				n->next = NULL;
+				n->count = 0;
+				if (chunk)
+					chunk->next = n;
+				else
+					batch->tilehead[tile] = n;
+				batch->tiletail[tile] = chunk = n;
+			}
+			chunk->tri[chunk->count++] = idx;
+		}
+	}
+}
+
 static void WT_ClipTriangle(swthread_t *th, swimage_t *img, swvert_t *v1, swvert_t *v2, swvert_t *v3)
 {
 	unsigned int cflags;
@@ -654,23 +810,25 @@ static void WT_ClipTriangle(swthread_t *th, swimage_t *img, swvert_t *v1, swvert
 		list ^= 1;
 	}
 
-	//draw the damn thing. FIXME: generate spans and push to a fragment thread.
+	//the fragment threads will draw it once the batch is full.
 	for (i = 2; i < count; i++)
 	{
-		WT_Triangle(th, img, &final[list][0], &final[list][i-1], &final[list][i]);
+		WT_BinTriangle(th, img, &final[list][0], &final[list][i-1], &final[list][i]);
 	}
 }
 
+//clears the current tile
 void WQ_ClearBuffer(swthread_t *t, unsigned int *mbuf, qintptr_t stride, unsigned int clearval)
 {
 	int y;
 	int x;
 	unsigned int *buf;
+	int x1 = t->tile[2];
 
-	for (y = t->interlaceline; y < t->vpheight; y += t->interlacemod)
+	for (y = t->tile[1] + (t->interlaceline + t->interlacemod - t->tile[1]%t->interlacemod)%t->interlacemod; y < t->tile[3]; y += t->interlacemod)
 	{
 		buf = mbuf + stride*y;
-		for (x = 0; x < (t->vpwidth & ~15);)
+		for (x = t->tile[0]; x+16 <= x1;)
 		{
 			buf[x++] = clearval;
 			buf[x++] = clearval;
@@ -689,13 +847,102 @@ void WQ_ClearBuffer(swthread_t *t, unsigned int *mbuf, qintptr_t stride, unsigne
 			buf[x++] = clearval;
 			buf[x++] = clearval;
 		}
-		for (; x < t->vpwidth; )
+		for (; x < x1; )
 			buf[x++] = clearval;
 	}
 }
 
-qboolean WT_HandleCommand(swthread_t *t, wqcom_t *com)
+//returns true if this fragment thread is responsible for the given tile (and sets it up for drawing).
+static qboolean WT_SelectTile(swthread_t *t, unsigned int tx, unsigned int ty)
+{
+	if (t->wq->numthreads && (tx+ty)%t->wq->numthreads != t->threadnum)
+		return false;	//someone else's. a diagonal pattern keeps busy areas of the screen spread over all the threads.
+	t->tile[0] = tx<<SW_TILESHIFT;
+	t->tile[1] = ty<<SW_TILESHIFT;
+	t->tile[2] = min(t->tile[0]+SW_TILESIZE, t->vpwidth);
+	t->tile[3] = min(t->tile[1]+SW_TILESIZE, t->vpheight);
+	return true;
+}
+
+//the fragment threads
+static qboolean WT_HandleSpans(swthread_t *t, wqcom_t *com)
+{
+	unsigned int tx, ty;
+	swbatch_t *batch;
+	swtilechunk_t *chunk;
+	swbintri_t *tri;
+	unsigned int i;
+	switch(com->com.command)
+	{
+	case WTC_DIE:
+		t->readpoint += com->com.cmdsize;
+		return 1;
+	case WTC_NOOP:
+		break;
+	case WTC_VIEWPORT:
+		t->vpcbuf = com->viewport.cbuf;
+		t->vpdbuf = com->viewport.dbuf;
+		t->vpwidth = com->viewport.width;
+		t->vpheight = com->viewport.height;
+		t->vpcstride = com->viewport.stride;
+		t->tilesx = (t->vpwidth+SW_TILESIZE-1)>>SW_TILESHIFT;
+		t->tilesy = (t->vpheight+SW_TILESIZE-1)>>SW_TILESHIFT;
+		t->interlacemod = com->viewport.interlace;	//draw every Nth line
+		t->interlaceline = com->viewport.framenum%com->viewport.interlace;	//starting with this one
+
+		if (com->viewport.clearcolour || com->viewport.cleardepth)
+		{
+			for (ty = 0; ty < t->tilesy; ty++)
+				for (tx = 0; tx < t->tilesx; tx++)
+				{
+					if (!WT_SelectTile(t, tx, ty))
+						continue;
+					if (com->viewport.clearcolour)
+						WQ_ClearBuffer(t, t->vpcbuf, t->vpcstride, 0);
+					if (com->viewport.cleardepth)
+						WQ_ClearBuffer(t, t->vpdbuf, t->vpwidth, ~0u);
+				}
+		}
+		break;
+	case WTC_SPANS:
+		batch = com->spans.batch;
+		for (ty = 0; ty < t->tilesy; ty++)
+			for (tx = 0; tx < t->tilesx; tx++)
+			{
+				chunk = batch->tilehead[tx + ty*t->tilesx];
+				if (!chunk || !WT_SelectTile(t, tx, ty))
+					continue;
+				for (; chunk; chunk = chunk->next)
+				{
+					for (i = 0; i < chunk->count; i++)
+					{
+						tri = &batch->tris[chunk->tri[i]];
+						WT_Triangle(t, tri->img, &tri->v[0], &tri->v[1], &tri->v[2]);
+					}
+				}
+			}
+		if (!FTE_Atomic32_Dec(&batch->busy))
+		{	//the vertex thread can reuse it now. the lock is needed so that it can't miss the wakeup.
+#ifdef MULTITHREAD
+			Sys_LockConditional(batch->idle);
+			Sys_ConditionBroadcast(batch->idle);
+			Sys_UnlockConditional(batch->idle);
+#endif
+		}
+		break;
+	default:
+		Sys_Printf("Unknown render command!\n");
+		break;
+	}
+	t->readpoint += com->com.cmdsize;
+	return false;
+}
+
+//the vertex thread
+static qboolean WT_HandleCommand(swthread_t *t, wqcom_t *com)
 {
+	wqcom_t *fwd;
+	struct wqcom_s hdr;
 	index_t *idx;
 	int i;
 	switch(com->com.command)
@@ -707,34 +954,29 @@ qboolean WT_HandleCommand(swthread_t *t, wqcom_t *com)
 		break;
 	case WTC_NEWFRAME:
 		break;
+	case WTC_SYNC:
+		WT_FlushBins(t->wq);
+		break;
 	case WTC_UNIFORMS:
 		memcpy(&t->u, &com->uniforms.u, sizeof(t->u));
 		break;
 	case WTC_VIEWPORT:
+		//anything already binned is for the old viewport
+		WT_FlushBins(t->wq);
+
 		t->vpcbuf = com->viewport.cbuf;
 		t->vpdbuf = com->viewport.dbuf;
 		t->vpwidth = com->viewport.width;
 		t->vpheight = com->viewport.height;
 		t->vpcstride = com->viewport.stride;
-		if (!t->wq->numthreads)
-		{
-			t->interlacemod = com->viewport.interlace;	//this many vthreads
-			t->interlaceline = com->viewport.framenum%com->viewport.interlace;	//this vthread
-		}
-		else
-		{
-			t->interlacemod = t->wq->numthreads*com->viewport.interlace;	//this many vthreads
-			t->interlaceline = (t->threadnum*com->viewport.interlace) + (com->viewport.framenum%com->viewport.interlace);	//this vthread
-		}
-
-		if (com->viewport.clearcolour)
-		{
-			WQ_ClearBuffer(t, t->vpcbuf, t->vpcstride, 0);
-		}
-		if (com->viewport.cleardepth)
-		{
-			WQ_ClearBuffer(t, t->vpdbuf, t->vpwidth, ~0u);
-		}
+		WT_SetupBins(t->wq, t->vpwidth, t->vpheight);
+
+		//the fragment threads need to know about it too (and do the clearing).
+		fwd = SWRast_BeginCommand(t->wq->spans, WTC_VIEWPORT, sizeof(fwd->viewport));
+		hdr = fwd->com;
+		fwd->viewport = com->viewport;
+		fwd->com = hdr;
+		SWRast_EndCommand(t->wq->spans, fwd);
 		break;
 	case WTC_TRIFAN:
 		for (i = 2; i < com->trifan.numverts; i++)
@@ -759,23 +1001,30 @@ qboolean WT_HandleCommand(swthread_t *t, wqcom_t *com)
 	return false;
 }
 
+#ifdef MULTITHREAD
 int WT_Main(void *ptr)
 {
 	wqcom_t *com;
 	swthread_t *t = ptr;
+	struct workqueue_s *wq = t->wq;
 	for(;;)
 	{
-		if (t->readpoint == t->wq->pos)
-		{
-			Sys_Sleep(0);
+		if (t->readpoint == wq->pos)
+		{	//caught up. let SWRast_Sync know, then sleep until there's more.
+			Sys_LockConditional(wq->condition);
+			Sys_ConditionBroadcast(wq->condition);
+			while (t->readpoint == wq->pos)
+				Sys_ConditionWait(wq->condition);
+			Sys_UnlockConditional(wq->condition);
 			continue;
 		}
-		com = (wqcom_t*)&t->wq->queue[t->readpoint & WQ_MASK];
-		if (WT_HandleCommand(t, com))
+		com = (wqcom_t*)&wq->queue[t->readpoint & WQ_MASK];
+		if (wq->handler(t, com))
 			break;
 	}
 	return 0;
 }
+#endif
 void SWRast_EndCommand(struct workqueue_s *wq, wqcom_t *com)
 {
 	wq->pos += com->com.cmdsize;
@@ -783,8 +1032,16 @@ void SWRast_EndCommand(struct workqueue_s *wq, wqcom_t *com)
 	if (!wq->numthreads)
 	{
 		//immediate mode
-		WT_HandleCommand(wq->swthreads, com);
+		wq->handler(wq->swthreads, com);
 	}
+#ifdef MULTITHREAD
+	else
+	{
+		Sys_LockConditional(wq->condition);
+		Sys_ConditionBroadcast(wq->condition);
+		Sys_UnlockConditional(wq->condition);
+	}
+#endif
 }
 wqcom_t *SWRast_BeginCommand(struct workqueue_s *wq, int cmdtype, unsigned int size)
 {
@@ -813,44 +1070,58 @@ void SWRast_Sync(struct workqueue_s *wq)
 	int i;
 	swthread_t *t;
 
+#ifdef MULTITHREAD
 	for (i = 0; i < wq->numthreads; i++)
 	{
 		t = &wq->swthreads[i];
-		while (t->readpoint != wq->pos)
-			;
+		if (t->readpoint != wq->pos)
+		{
+			Sys_LockConditional(wq->condition);
+			while (t->readpoint != wq->pos)
+				Sys_ConditionWait(wq->condition);
+			Sys_UnlockConditional(wq->condition);
+		}
 	}
+#endif
 
 	//all worker threads are up to speed
 }
-void SWRast_CreateThreadPool(struct workqueue_s *wq, int numthreads)
+//flushes any binned triangles, and waits for them to be drawn
+void SWRast_Finish(struct workqueue_s *wq)
+{
+	wqcom_t *com = SWRast_BeginCommand(wq, WTC_SYNC, sizeof(com->com));
+	SWRast_EndCommand(wq, com);
+	SWRast_Sync(wq);
+	if (wq->spans)
+		SWRast_Sync(wq->spans);
+}
+void SWRast_CreateThreadPool(struct workqueue_s *wq, int numthreads, qboolean (*handler)(swthread_t *t, wqcom_t *com))
 {
 	int i = 0;
 	swthread_t *t;
 	wq->pos = 0;
+	wq->handler = handler;
 	numthreads = ((numthreads > WQ_MAXTHREADS)?WQ_MAXTHREADS:numthreads);
+
+	//set them up before they start running, they'll need it straight away.
+	for (i = 0; i < max(1, numthreads); i++)
+	{
+		wq->swthreads[i].readpoint = wq->pos;
+		wq->swthreads[i].wq = wq;
+		wq->swthreads[i].threadnum = i;
+	}
+	i = 0;
 #ifdef MULTITHREAD
-	for (i = 0; i < numthreads; i++)
+	wq->condition = Sys_CreateConditional();
+	for (i = 0; wq->condition && i < numthreads; i++)
 	{
 		t = &wq->swthreads[i];
-		t->threadnum = i;
 		t->thread = Sys_CreateThread("swrast", WT_Main, t, THREADP_NORMAL, 0);
 		if (!t->thread)
 			break;
 	}
-#else
-	numthreads = 0;
 #endif
 	wq->numthreads = i;
-
-	if (i == 0)
-		numthreads = 1;
-	else
-		numthreads = i;
-	for (i = 0; i < numthreads; i++)
-	{
-		wq->swthreads[i].readpoint = wq->pos;
-		wq->swthreads[i].wq = wq;
-	}
 }
 void SWRast_TerminateThreadPool(struct workqueue_s *wq)
 {
@@ -862,21 +1133,154 @@ void SWRast_TerminateThreadPool(struct workqueue_s *wq)
 	{
 		Sys_WaitOnThread(wq->swthreads[i].thread);
 	}
+	if (wq->condition)
+		Sys_DestroyConditional(wq->condition);
+	wq->condition = NULL;
 #endif
 	wq->numthreads = 0;
 }
+//triangles submitted to the vertex queue get binned and passed on to the fragment queue
+static void SWRast_CreateBinner(struct workqueue_s *wq, struct workqueue_s *spans)
+{
+	int i;
+	wq->spans = spans;
+	wq->bins = Z_Malloc(sizeof(*wq->bins));
+	for (i = 0; i < 2; i++)
+	{
+		wq->bins->batch[i] = Z_Malloc(sizeof(*wq->bins->batch[i]));
+#ifdef MULTITHREAD
+		wq->bins->batch[i]->idle = Sys_CreateConditional();
+#endif
+	}
+}
+static void SWRast_DestroyBinner(struct workqueue_s *wq)
+{
+	int i;
+	if (!wq->bins)
+		return;
+	for (i = 0; i < 2; i++)
+	{
+		BZ_Free(wq->bins->batch[i]->tilehead);
+		BZ_Free(wq->bins->batch[i]->tiletail);
+#ifdef MULTITHREAD
+		Sys_DestroyConditional(wq->bins->batch[i]->idle);
+#endif
+		Z_Free(wq->bins->batch[i]);
+	}
+	Z_Free(wq->bins);
+	wq->bins = NULL;
+	wq->spans = NULL;
+}
 
-
-
-
-
-
-
-
-
-
-
-
+static float SW_BenchRand(unsigned int *seed)
+{
+	*seed = *seed*1103515245 + 12345;
+	return ((*seed>>8)&0xffff) / 65535.0f;
+}
+//renders a fixed scene into memory, so the rasterizer can be timed without any video output.
+void SW_Bench_f(void)
+{
+	int frames = (Cmd_Argc()>1)?atoi(Cmd_Argv(1)):100;
+	int threads = (Cmd_Argc()>2)?atoi(Cmd_Argv(2)):sw_fthreads.ival;
+	int width = (Cmd_Argc()>3)?atoi(Cmd_Argv(3)):1280;
+	int height = (Cmd_Argc()>4)?atoi(Cmd_Argv(4)):720;
+	const int quads = 4096, batchquads = 256;
+	struct workqueue_s *front, *spans;
+	unsigned int *cbuf, *dbuf, seed, sum;
+	swimage_t *img;
+	wqcom_t *com;
+	swvert_t *v;
+	index_t *idx;
+	float x, y, z, sz;
+	double start, elapsed;
+	int f, q, i, j;
+
+	frames = max(1, frames);
+	threads = bound(0, threads, WQ_MAXTHREADS);
+	width = bound(SW_TILESIZE, width, 8192);
+	height = bound(SW_TILESIZE, height, 8192);
+
+	cbuf = BZ_Malloc(sizeof(*cbuf)*width*height);
+	dbuf = BZ_Malloc(sizeof(*dbuf)*width*height);
+	img = BZ_Malloc(sizeof(*img) + sizeof(img->data[0])*64*64);
+	img->pwidth = img->pheight = img->pitch = 64;
+	img->pwidthmask = img->pheightmask = 63;
+	for (i = 0; i < 64*64; i++)
+		img->data[i] = (((i>>3)^(i>>9))&1)?0xffc0c0c0:0xff404040;	//8*8 checkers
+
+	front = Z_Malloc(sizeof(*front));
+	spans = Z_Malloc(sizeof(*spans));
+	SWRast_CreateBinner(front, spans);
+	SWRast_CreateThreadPool(spans, threads, WT_HandleSpans);
+	SWRast_CreateThreadPool(front, 0, WT_HandleCommand);
+
+	com = SWRast_BeginCommand(front, WTC_UNIFORMS, sizeof(com->uniforms));
+	Matrix4x4_Identity(com->uniforms.u.matrix);	//verts are already in screen space
+	Vector4Set(com->uniforms.u.viewplane, 0, 0, 30000, 0);
+	SWRast_EndCommand(front, com);
+
+	start = Sys_DoubleTime();
+	for (f = 0; f < frames; f++)
+	{
+		com = SWRast_BeginCommand(front, WTC_VIEWPORT, sizeof(com->viewport));
+		com->viewport.cbuf = cbuf;
+		com->viewport.dbuf = dbuf;
+		com->viewport.width = width;
+		com->viewport.height = height;
+		com->viewport.stride = width;
+		com->viewport.interlace = 1;
+		com->viewport.framenum = f;
+		com->viewport.clearcolour = true;
+		com->viewport.cleardepth = true;
+		SWRast_EndCommand(front, com);
+
+		seed = 1;	//same scene every frame
+		for (q = 0; q < quads; q += batchquads)
+		{
+			com = SWRast_BeginCommand(front, WTC_TRISOUP, (batchquads*4*sizeof(swvert_t)) + sizeof(com->trisoup) - sizeof(com->trisoup.verts) + (sizeof(index_t)*batchquads*6));
+			com->trisoup.texture = img;
+			com->trisoup.numverts = batchquads*4;
+			com->trisoup.numidx = batchquads*6;
+			v = com->trisoup.verts;
+			idx = (index_t*)(v + com->trisoup.numverts);
+			for (i = 0; i < batchquads; i++, v += 4, idx += 6)
+			{
+				//overlapping quads of various sizes and depths, some of which hang off the edges.
+				x = SW_BenchRand(&seed)*2.4 - 1.2;
+				y = SW_BenchRand(&seed)*2.4 - 1.2;
+				z = SW_BenchRand(&seed);
+				sz = 0.02 + SW_BenchRand(&seed)*SW_BenchRand(&seed)*0.5;
+				for (j = 0; j < 4; j++)
+				{
+					Vector4Set(v[j].vcoord, x+((j&1)?sz:-sz), y+((j&2)?sz:-sz), z, 1);
+					Vector2Set(v[j].tccoord, (j&1)*4, (j>>1)*4);
+				}
+				idx[0] = i*4+0;
+				idx[1] = i*4+1;
+				idx[2] = i*4+2;
+				idx[3] = i*4+2;
+				idx[4] = i*4+1;
+				idx[5] = i*4+3;
+			}
+			SWRast_EndCommand(front, com);
+		}
+	}
+	SWRast_Finish(front);
+	elapsed = Sys_DoubleTime() - start;
+
+	for (i = 0, sum = 0; i < width*height; i++)
+		sum = sum*31 + cbuf[i];
+	Con_Printf("sw_bench: %i*%i, %i triangles, %i fragment threads: %.2fms/frame (checksum %08x)\n", width, height, quads*2, spans->numthreads, elapsed*1000/frames, sum);
+
+	SWRast_TerminateThreadPool(front);
+	SWRast_TerminateThreadPool(spans);
+	SWRast_DestroyBinner(front);
+	Z_Free(front);
+	Z_Free(spans);
+	BZ_Free(img);
+	BZ_Free(cbuf);
+	BZ_Free(dbuf);
+}
 
 void SW_Draw_Init(void)
 {
@@ -890,12 +1294,17 @@ void SW_Draw_Shutdown(void)
 }
 void SW_R_Init(void)
 {
-	SWRast_CreateThreadPool(&commandqueue, sw_vthread.ival?1:0);
+	SWRast_CreateBinner(&commandqueue, &spanqueue);
+	SWRast_CreateThreadPool(&spanqueue, sw_fthreads.ival, WT_HandleSpans);
+	SWRast_CreateThreadPool(&commandqueue, sw_vthread.ival?1:0, WT_HandleCommand);
 	sw_vthread.modified = true;
+	sw_fthreads.modified = false;
 }
 void SW_R_DeInit(void)
 {
 	SWRast_TerminateThreadPool(&commandqueue);
+	SWRast_TerminateThreadPool(&spanqueue);
+	SWRast_DestroyBinner(&commandqueue);
 }
 void SW_R_RenderView(void)
 {
@@ -966,19 +1375,18 @@ qboolean SW_SCR_UpdateScreen(void)
 
 	SWBE_Set2D();
 
-	SWRast_Sync(&commandqueue);
-	SWRast_Sync(&spanqueue);
+	SWRast_Finish(&commandqueue);
 	SW_VID_SwapBuffers();
 	if (sw_vthread.modified)
 	{
 		SWRast_TerminateThreadPool(&commandqueue);
-		SWRast_CreateThreadPool(&commandqueue, sw_vthread.ival?1:0);
+		SWRast_CreateThreadPool(&commandqueue, sw_vthread.ival?1:0, WT_HandleCommand);
 		sw_vthread.modified = false;
 	}
 	if (sw_fthreads.modified)
 	{
 		SWRast_TerminateThreadPool(&spanqueue);
-		SWRast_CreateThreadPool(&spanqueue, sw_fthreads.ival);
+		SWRast_CreateThreadPool(&spanqueue, sw_fthreads.ival, WT_HandleSpans);
 		sw_fthreads.modified = false;
 	}
 
@@ -27,6 +27,11 @@ Password checks and stuff are implemented here. This i server side stuff.
 #include "qtv.h"
 #include "time.h"
 
+#if !defined(_WIN32) && !(defined(__MORPHOS__) && !defined(ixemul))
+	#include <sys/uio.h>	//for writev
+	#define FWD_WRITEV
+#endif
+
 
 #undef IN
 #define IN(x) buffer[(x)&(MAX_PROXY_BUFFER-1)]
@@ -175,38 +180,199 @@ void Fwd_ParseCommands(cluster_t *cluster, oproxy_t *prox)
 	}
 }
 
+//stops a proxy from reading out of its stream's shared ring, moving anything still pending into its own buffer.
+static void Fwd_Detach(oproxy_t *prox)
+{
+	fwdring_t *ring = prox->sharedring;
+	unsigned int pending, ofs, chunk;
+
+	if (!ring)
+		return;
+
+	//the ring is never allowed to get more than MAX_PROXY_BUFFER ahead of us, and our own buffer is empty, so this always fits.
+	pending = ring->head - prox->sharedpos;
+	ofs = prox->sharedpos&(MAX_PROXY_BUFFER-1);
+	chunk = MAX_PROXY_BUFFER-ofs;
+	if (chunk > pending)
+		chunk = pending;
+	memcpy(prox->buffer, ring->data+ofs, chunk);
+	memcpy(prox->buffer+chunk, ring->data, pending-chunk);
+	prox->bufferpos = 0;
+	prox->buffersize = pending;
+	prox->sharedring = NULL;
+}
+
+static void Fwd_RingWrite(fwdring_t *ring, const void *data, unsigned int length)
+{
+	unsigned int ofs = ring->head&(MAX_PROXY_BUFFER-1);
+	unsigned int chunk = MAX_PROXY_BUFFER-ofs;
+	if (chunk > length)
+		chunk = length;
+	memcpy(ring->data+ofs, data, chunk);
+	memcpy(ring->data, (const char*)data+chunk, length-chunk);
+	ring->head += length;
+}
+
+//binary websocket frame header, same as Net_ProxySend writes.
+static unsigned int Fwd_WSFrameHeader(unsigned char *out, unsigned int length)
+{
+	out[0] = 0x80|2;
+	if (length >= 126)
+	{
+		out[1] = 126;
+		out[2] = length>>8;
+		out[3] = length;
+		return 4;
+	}
+	out[1] = length;
+	return 2;
+}
+
+//writes the data into the stream's shared rings once, for every proxy that's reading from them.
+//proxies that are too far behind get detached and start flushing, just like they would if their own buffer overflowed.
+//returns false if the data can't be shared, in which case nothing is reading from the rings any more.
+static qboolean Fwd_ShareData(sv_t *qtv, const void *header, unsigned int headerlen, const void *data, unsigned int length)
+{
+	unsigned char frame[4];
+	unsigned int framelen = Fwd_WSFrameHeader(frame, headerlen+length);
+	qboolean fits = headerlen+length+framelen <= MAX_PROXY_BUFFER;
+	qboolean raw = false, ws = false;
+	unsigned int need;
+	oproxy_t *prox;
+
+	if (!headerlen && !length)
+		return true;	//nothing to send, don't push empty websocket frames.
+
+	for (prox = qtv->proxies; prox; prox = prox->next)
+	{
+		if (!prox->sharedring)
+			continue;
+		if (!fits || prox->drop)
+		{
+			Fwd_Detach(prox);
+			continue;
+		}
+
+		need = headerlen+length;
+		if (prox->sharedring == &qtv->fwdws)
+			need += framelen;
+		if (prox->sharedring->head - prox->sharedpos + need > MAX_PROXY_BUFFER)
+		{
+			Net_TryFlushProxyBuffer(qtv->cluster, prox);	//try flushing
+			if (prox->sharedring->head - prox->sharedpos + need > MAX_PROXY_BUFFER)	//damn, still too big.
+			{	//they're too slow. hopefully it was just momentary lag
+				Fwd_Detach(prox);
+				if (!prox->flushing)
+				{
+					printf("QTV client is too lagged\n");
+					prox->flushing = true;
+				}
+				continue;
+			}
+		}
+
+		if (prox->sharedring == &qtv->fwdws)
+			ws = true;
+		else
+			raw = true;
+	}
+	if (!fits)
+		return false;
+
+	if (raw)
+	{
+		Fwd_RingWrite(&qtv->fwdraw, header, headerlen);
+		Fwd_RingWrite(&qtv->fwdraw, data, length);
+	}
+	if (ws)
+	{
+		Fwd_RingWrite(&qtv->fwdws, frame, framelen);
+		Fwd_RingWrite(&qtv->fwdws, header, headerlen);
+		Fwd_RingWrite(&qtv->fwdws, data, length);
+	}
+	return true;
+}
+
 void Net_TryFlushProxyBuffer(cluster_t *cluster, oproxy_t *prox)
 {
-	unsigned char *buffer;
-	int length;
-	int bufpos;
+	unsigned char *data;
+	unsigned int pos, pending, bufpos;
+	int length, seg1, seg2;
 
 //	if (prox->drop)
 //		return;
 
-	while (prox->bufferpos >= MAX_PROXY_BUFFER)
-	{	//so we never get any issues with wrapping..
-		prox->bufferpos -= MAX_PROXY_BUFFER;
-		prox->buffersize -= MAX_PROXY_BUFFER;
+	if (prox->sharedring)
+	{
+		data = prox->sharedring->data;
+		pos = prox->sharedpos;
+		pending = prox->sharedring->head - pos;
 	}
-
-	bufpos = prox->bufferpos&(MAX_PROXY_BUFFER-1);
-	length = prox->buffersize - prox->bufferpos;
-	if (length > MAX_PROXY_BUFFER-bufpos)	//cap the length correctly.
-		length = MAX_PROXY_BUFFER-bufpos;
-	if (!length)
+	else
+	{
+		while (prox->bufferpos >= MAX_PROXY_BUFFER)
+		{	//so we never get any issues with wrapping..
+			prox->bufferpos -= MAX_PROXY_BUFFER;
+			prox->buffersize -= MAX_PROXY_BUFFER;
+		}
+		data = prox->buffer;
+		pos = prox->bufferpos;
+		pending = prox->buffersize - pos;
+	}
+	if (!pending)
 		return;	//already flushed.
-	buffer = prox->buffer + bufpos;
 
-//	CheckMVDConsistancy(prox->buffer, prox->bufferpos, prox->buffersize);
-
-	if (bufpos+length > MAX_PROXY_BUFFER)
+	if (pending > MAX_PROXY_BUFFER)
+	{
 		Sys_Printf(cluster, "oversize flush\n");
+		pending = MAX_PROXY_BUFFER;
+	}
+
+	//the pending data may wrap around the end of the buffer, in which case it's two segments.
+	bufpos = pos&(MAX_PROXY_BUFFER-1);
+	seg1 = pending;
+	if (seg1 > MAX_PROXY_BUFFER-bufpos)	//cap the length correctly.
+		seg1 = MAX_PROXY_BUFFER-bufpos;
+	seg2 = pending - seg1;
+
+//	CheckMVDConsistancy(prox->buffer, prox->bufferpos, prox->buffersize);
 
 	if (prox->file)
-		length = fwrite(buffer, 1, length, prox->file);
+	{
+		length = fwrite(data+bufpos, 1, seg1, prox->file);
+		if (length == seg1 && seg2)
+			length += fwrite(data, 1, seg2, prox->file);
+	}
 	else
-		length = send(prox->sock, buffer, length, 0);
+	{
+#if defined(_WIN32)
+		WSABUF bufs[2];
+		DWORD sent;
+		bufs[0].buf = (char*)data+bufpos;
+		bufs[0].len = seg1;
+		bufs[1].buf = (char*)data;
+		bufs[1].len = seg2;
+		if (WSASend(prox->sock, bufs, seg2?2:1, &sent, 0, NULL, NULL))
+			length = -1;
+		else
+			length = sent;
+#elif defined(FWD_WRITEV)
+		struct iovec iov[2];
+		iov[0].iov_base = data+bufpos;
+		iov[0].iov_len = seg1;
+		iov[1].iov_base = data;
+		iov[1].iov_len = seg2;
+		length = writev(prox->sock, iov, seg2?2:1);
+#else
+		length = send(prox->sock, data+bufpos, seg1, 0);
+		if (length == seg1 && seg2)
+		{
+			int more = send(prox->sock, data, seg2, 0);
+			if (more > 0)
+				length += more;
+		}
+#endif
+	}
 
 
 	switch (length)
@@ -225,7 +391,10 @@ void Net_TryFlushProxyBuffer(cluster_t *cluster, oproxy_t *prox)
 		}
 		break;
 	default:
-		prox->bufferpos += length;
+		if (prox->sharedring)
+			prox->sharedpos += length;
+		else
+			prox->bufferpos += length;
 	}
 }
 
@@ -241,6 +410,8 @@ void Net_ProxySend(cluster_t *cluster, oproxy_t *prox, void *buffer, int length)
 	if (!length)
 		return;
 
+	Fwd_Detach(prox);	//this data is just for them, so it can't go through the shared ring.
+
 	if (prox->websocket.websocket)
 	{
 		unsigned int c;
@@ -367,6 +538,7 @@ void Prox_SendMessage(cluster_t *cluster, oproxy_t *prox, char *buf, int length,
 	if (dem_type == dem_multiple)
 		WriteLong(&msg, playermask);
 
+	Fwd_Detach(prox);
 	if (prox->buffersize-prox->bufferpos + length + msg.cursize > MAX_PROXY_BUFFER)
 	{
 		Net_TryFlushProxyBuffer(cluster, prox);	//try flushing
@@ -386,9 +558,18 @@ void Prox_SendMessage(cluster_t *cluster, oproxy_t *prox, char *buf, int length,
 void Fwd_SendDownstream(sv_t *qtv, void *buffer, int length)
 {	//broadcasts data to all client proxies, with dont-buffer
 	oproxy_t *prox;
+	netmsg_t msg;
+	char tbuf[16];
+	InitNetMsg(&msg, tbuf, sizeof(tbuf));
+	WriteByte(&msg, 0);
+	WriteByte(&msg, dem_qtvdata);
+	WriteLong(&msg, length);
+
+	Fwd_ShareData(qtv, msg.data, msg.cursize, buffer, length);
 	for (prox = qtv->proxies; prox; prox = prox->next)
 	{
-		Prox_SendMessage(qtv->cluster, prox, buffer, length, dem_qtvdata, (unsigned int)-1);
+		if (!prox->sharedring)
+			Prox_SendMessage(qtv->cluster, prox, buffer, length, dem_qtvdata, (unsigned int)-1);
 	}
 }
 
@@ -684,8 +865,24 @@ void SV_ForwardStream(sv_t *qtv, void *buffer, int length)
 		if (prox->drop)
 			continue;
 
-		//add the new data
-		Net_ProxySend(qtv->cluster, prox, buffer, length);
+		//once they've caught up they can read from the shared ring, instead of needing their own copy of everything.
+		if (!prox->sharedring && !prox->flushing && prox->buffersize == prox->bufferpos)
+		{
+			prox->sharedring = prox->websocket.websocket?&qtv->fwdws:&qtv->fwdraw;
+			prox->sharedpos = prox->sharedring->head;
+		}
+	}
+
+	//add the new data
+	Fwd_ShareData(qtv, NULL, 0, buffer, length);
+
+	for (prox = qtv->proxies; prox; prox = prox->next)
+	{
+		if (prox->drop || prox->flushing)	//don't send it if we're trying to empty thier buffer.
+			continue;
+
+		if (!prox->sharedring)
+			Net_ProxySend(qtv->cluster, prox, buffer, length);
 
 		Net_TryFlushProxyBuffer(qtv->cluster, prox);
 //		Net_TryFlushProxyBuffer(qtv->cluster, prox);
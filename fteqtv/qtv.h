@@ -556,6 +556,13 @@ typedef struct
 	int wsbits;
 } wsrbuf_t;
 
+//stream data that is forwarded identically to every up-to-date downstream proxy gets written into one of these just once.
+//each proxy then only tracks how far into it they've sent, instead of needing their own copy.
+typedef struct {
+	unsigned char data[MAX_PROXY_BUFFER];
+	unsigned int head;	//total bytes written. use cyclic buffering.
+} fwdring_t;
+
 //'other proxy', these are mvd stream clients.
 typedef struct oproxy_s {
 	int authkey;
@@ -578,6 +585,9 @@ typedef struct oproxy_s {
 	unsigned char buffer[MAX_PROXY_BUFFER];
 	unsigned int buffersize;	//use cyclic buffering.
 	unsigned int bufferpos;
+
+	fwdring_t *sharedring;	//if set, we're sending from the stream's shared ring instead (and our own buffer is empty).
+	unsigned int sharedpos;	//how far into the shared ring we've sent.
 	struct oproxy_s *next;
 } oproxy_t;
 
@@ -789,6 +799,9 @@ struct sv_s {	//details about a server connection (also known as stream)
 	unsigned char buffer[MAX_PROXY_BUFFER];	//this doesn't cycle.
 	int buffersize;	//it memmoves down
 	int forwardpoint;	//the point in the stream that we've forwarded up to.
+
+	fwdring_t fwdraw;	//forwarded data for up-to-date proxies
+	fwdring_t fwdws;	//the same, but pre-framed for websocket proxies.
 };
 
 typedef struct {
@@ -1032,6 +1045,7 @@ void Sys_Printf(cluster_t *cluster, char *fmt, ...) PRINTFWARNING(2);
 //void Sys_mkdir(char *path);
 void QTV_mkdir(char *path);
 
+void Net_TryFlushProxyBuffer(cluster_t *cluster, oproxy_t *prox);
 void Net_ProxySend(cluster_t *cluster, oproxy_t *prox, void *buffer, int length);
 oproxy_t *Net_FileProxy(sv_t *qtv, char *filename);
 sv_t *QTV_NewServerConnection(cluster_t *cluster, int streamid, char *server, char *password, qboolean force, enum autodisconnect_e autodisconnect, qboolean noduplicates, qboolean query);
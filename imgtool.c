@@ -9,10 +9,55 @@
 #include <windows.h>
 #endif
 static qboolean verbose;
+
+#if !defined(MULTITHREAD)
+	#define IMGTOOL_TLS
+#elif defined(__GNUC__)
+	#define IMGTOOL_TLS __thread
+#elif defined(_MSC_VER)
+	#define IMGTOOL_TLS __declspec(thread)
+#else
+	#undef MULTITHREAD	//no idea how to do thread-local storage here, so no -j.
+	#define IMGTOOL_TLS
+#endif
+//when set, console prints from this thread are collected here instead of being written immediately (so -j doesn't interleave lines).
+static IMGTOOL_TLS struct conbuffer_s
+{
+	char *text;
+	size_t used;
+	size_t max;
+} *con_buffer;
+static void Con_Output(const char *fmt, va_list argptr)
+{
+	struct conbuffer_s *b = con_buffer;
+	va_list	tmp;
+	int len;
+	if (!b)
+	{
+		vfprintf (stderr,fmt,argptr);
+		fflush(stderr);
+		return;
+	}
+	va_copy(tmp, argptr);
+	len = vsnprintf(NULL, 0, fmt, tmp);
+	va_end(tmp);
+	if (len <= 0)
+		return;
+	if (b->used + len + 1 > b->max)
+	{
+		b->max = (b->used + len + 1)*2;
+		b->text = realloc(b->text, b->max);
+	}
+	vsnprintf(b->text+b->used, b->max-b->used, fmt, argptr);
+	b->used += len;
+}
+
 void VARGS Sys_Error (const char *fmt, ...)
 {
 	va_list		argptr;
 
+	if (con_buffer)	//don't lose whatever led up to it.
+		fwrite(con_buffer->text, 1, con_buffer->used, stderr);
 	va_start (argptr,fmt);
 	vfprintf (stderr,fmt,argptr);
 	va_end (argptr);
@@ -25,18 +70,16 @@ void VARGS Con_Printf (const char *fmt, ...)
 	va_list		argptr;
 
 	va_start (argptr,fmt);
-	vfprintf (stderr,fmt,argptr);
+	Con_Output (fmt,argptr);
 	va_end (argptr);
-	fflush(stderr);
 }
 void VARGS Con_TPrintf (const char *fmt, ...)
 {
 	va_list		argptr;
 
 	va_start (argptr,fmt);
-	vfprintf (stderr,fmt,argptr);
+	Con_Output (fmt,argptr);
 	va_end (argptr);
-	fflush(stderr);
 }
 void VARGS Con_DPrintf (const char *fmt, ...)
 {
@@ -45,18 +88,16 @@ void VARGS Con_DPrintf (const char *fmt, ...)
 		return;
 
 	va_start (argptr,fmt);
-	vfprintf (stderr,fmt,argptr);
+	Con_Output (fmt,argptr);
 	va_end (argptr);
-	fflush(stderr);
 }
 void VARGS Con_ThrottlePrintf (float *timer, int developerlevel, const char *fmt, ...)
 {
 	va_list		argptr;
 
 	va_start (argptr,fmt);
-	vfprintf (stderr,fmt,argptr);
+	Con_Output (fmt,argptr);
 	va_end (argptr);
-	fflush(stderr);
 }
 
 void *ZF_Malloc(size_t size)
@@ -317,6 +358,10 @@ vfsfile_t *QDECL FS_OpenVFS(const char *filename, const char *mode, enum fs_rela
 		r->pub.WriteBytes = ImgFile_WriteBytes;
 		r->pub.Seek = ImgFile_Seek;
 		r->pub.Tell = ImgFile_Tell;
+		r->pub.ReadBytesAt = NULL;
+		r->pub.GetMapping = NULL;
+		r->pub.MapPrivate = NULL;
+		r->pub.UnmapPrivate = NULL;
 		if (r->f)
 			return &r->pub;
 		free(r);
@@ -533,6 +578,7 @@ struct opts_s
 	uploadfmt_t newpixelformat;	//try to convert to this pixel format on export.
 
 	int width, height;
+	unsigned int threads;		//for tree conversions, how many files to convert at once.
 };
 
 static qboolean ImgTool_MipExport(struct opts_s *args, vfsfile_t *outfile, struct pendingtextureinfo *in, const char *mipname, int wadtype);
@@ -889,33 +935,34 @@ const char *COM_GetFileExtension (const char *in, const char *term)
 	}
 	return term+strlen(term);
 }
+//takes ownership of indata
+static struct pendingtextureinfo *ImgTool_ReadMemory(struct opts_s *args, const char *inname, qbyte *indata, size_t fsize)
+{
+	struct pendingtextureinfo *in;
+	const char *ex = COM_GetFileExtension(inname, NULL);
+	if (!strcasecmp(ex, ".mip"))
+		in = ImgTool_DecodeMiptex(args, (miptex_t*)indata, fsize, NULL);
+	else
+		in = Image_LoadMipsFromMemory(args->flags|IF_NOMIPMAP, inname, inname, indata, fsize);
+	if (!in)
+	{
+		Con_Printf("%s: unsupported format\n", inname);
+		BZ_Free(indata);
+		return NULL;
+	}
+	Con_DPrintf("%s: %s %s, %i*%i, %i mips\n", inname, imagetypename[in->type], Image_FormatName(in->encoding), in->mip[0].width, in->mip[0].height, in->mipcount);
+	return in;
+}
 static struct pendingtextureinfo *ImgTool_Read(struct opts_s *args, const char *inname)
 {
-	qbyte *indata;
 	size_t fsize;
-	struct pendingtextureinfo *in;
-	indata = FS_LoadMallocFile(inname, &fsize);
+	qbyte *indata = FS_LoadMallocFile(inname, &fsize);
 	if (!indata)
-		Con_Printf("%s: unable to read\n", inname);
-	else
 	{
-		const char *ex = COM_GetFileExtension(inname, NULL);
-		if (!strcasecmp(ex, ".mip"))
-			in = ImgTool_DecodeMiptex(args, (miptex_t*)indata, fsize, NULL);
-		else
-			in = Image_LoadMipsFromMemory(args->flags|IF_NOMIPMAP, inname, inname, indata, fsize);
-		if (!in)
-		{
-			Con_Printf("%s: unsupported format\n", inname);
-			BZ_Free(indata);
-		}
-		else
-		{
-			Con_DPrintf("%s: %s %s, %i*%i, %i mips\n", inname, imagetypename[in->type], Image_FormatName(in->encoding), in->mip[0].width, in->mip[0].height, in->mipcount);
-			return in;
-		}
+		Con_Printf("%s: unable to read\n", inname);
+		return NULL;
 	}
-	return NULL;
+	return ImgTool_ReadMemory(args, inname, indata, fsize);
 }
 static struct pendingtextureinfo *ImgTool_Combine(struct opts_s *args, const char **namelist, unsigned int filecount)
 {
@@ -1987,54 +2034,426 @@ static void ImgTool_TreeScan(struct filelist_s *list, const char *basepath, cons
 	}
 }
 #endif
-static void ImgTool_TreeConvert(struct opts_s *args, const char *destpath, const char *srcpath)
+#ifdef MULTITHREAD
+//just enough threading for -j. the engine's sys_*_threads.c want too much of the rest of the engine.
+struct threadstart_s
+{
+	int (*func)(void *);
+	void *args;
+};
+#ifdef _WIN32
+static DWORD WINAPI ImgTool_ThreadStart(LPVOID arg)
+{
+	struct threadstart_s start = *(struct threadstart_s*)arg;
+	free(arg);
+	return start.func(start.args);
+}
+void *Sys_CreateThread(char *name, int (*func)(void *), void *args, int priority, int stacksize)
+{
+	struct threadstart_s *start = malloc(sizeof(*start));
+	HANDLE h;
+	start->func = func;
+	start->args = args;
+	h = CreateThread(NULL, stacksize, ImgTool_ThreadStart, start, 0, NULL);
+	if (!h)
+		free(start);
+	return h;
+}
+void Sys_WaitOnThread(void *thread)
+{
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+}
+void *QDECL Sys_CreateMutex(void)
+{
+	CRITICAL_SECTION *m = malloc(sizeof(*m));
+	InitializeCriticalSection(m);
+	return m;
+}
+qboolean QDECL Sys_LockMutex(void *mutex)
+{
+	EnterCriticalSection(mutex);
+	return true;
+}
+qboolean QDECL Sys_UnlockMutex(void *mutex)
+{
+	LeaveCriticalSection(mutex);
+	return true;
+}
+void QDECL Sys_DestroyMutex(void *mutex)
+{
+	DeleteCriticalSection(mutex);
+	free(mutex);
+}
+#else
+#include <pthread.h>
+static void *ImgTool_ThreadStart(void *arg)
+{
+	struct threadstart_s start = *(struct threadstart_s*)arg;
+	free(arg);
+	return (void*)(intptr_t)start.func(start.args);
+}
+void *Sys_CreateThread(char *name, int (*func)(void *), void *args, int priority, int stacksize)
+{
+	struct threadstart_s *start = malloc(sizeof(*start));
+	pthread_t *thread = malloc(sizeof(*thread));
+	start->func = func;
+	start->args = args;
+	if (pthread_create(thread, NULL, ImgTool_ThreadStart, start))
+	{
+		free(start);
+		free(thread);
+		return NULL;
+	}
+	return thread;
+}
+void Sys_WaitOnThread(void *thread)
+{
+	pthread_join(*(pthread_t*)thread, NULL);
+	free(thread);
+}
+void *QDECL Sys_CreateMutex(void)
+{
+	pthread_mutex_t *m = malloc(sizeof(*m));
+	pthread_mutex_init(m, NULL);
+	return m;
+}
+qboolean QDECL Sys_LockMutex(void *mutex)
+{
+	return !pthread_mutex_lock(mutex);
+}
+qboolean QDECL Sys_UnlockMutex(void *mutex)
+{
+	return !pthread_mutex_unlock(mutex);
+}
+void QDECL Sys_DestroyMutex(void *mutex)
+{
+	pthread_mutex_destroy(mutex);
+	free(mutex);
+}
+#endif
+#endif
+
+static double ImgTool_Time(void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (double)now.QuadPart / freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec/1000000000.0;
+#endif
+}
+
+//fnv-1a. only needs to notice when a file changed, not resist attacks.
+static quint64_t ImgTool_Hash(quint64_t hash, const void *data, size_t size)
+{
+	const qbyte *in = data;
+	while (size --> 0)
+	{
+		hash ^= *in++;
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+//the hashes of the source files (and options) that the outputs in a tree were last generated from, so touched-but-unchanged files can be skipped.
+#define TREEHASHFILE ".imgtool_hashes"
+struct treehash_s
+{
+	quint64_t hash;
+	const char *name;
+};
+static int QDECL ImgTool_TreeHashCompare(const void *a, const void *b)
+{
+	return strcmp(((const struct treehash_s*)a)->name, ((const struct treehash_s*)b)->name);
+}
+
+struct treeconvert_s
 {
-	size_t newfiles=0, skippedfiles=0, processedfiles=0;
+	struct opts_s *args;
+	const char *srcpath;
+	const char *destpath;
+	struct filelist_s *list;
+	const char **exts;
+
+	quint64_t optionshash;
+	struct treehash_s *oldhash;	//sorted, from the last run
+	size_t numoldhashes;
+	quint64_t *newhash;			//per file, 0 if it shouldn't be remembered
+
+	void *mutex;				//protects everything below
+	size_t nextfile;
+	size_t newfiles, skippedfiles, processedfiles;
+	struct
+	{
+		size_t files;
+		quint64_t bytes;
+		double time;
+	} perext[8];
+};
+static int ImgTool_TreeConvertThread(void *ctx)
+{
+	struct treeconvert_s *tc = ctx;
+	struct conbuffer_s buffer = {NULL};
 	char file[MAX_OSPATH];
 	char dest[MAX_OSPATH];
-	const char *exts[] = {".png", ".bmp", ".tga", ".jpg", ".exr", ".hdr", ".pcx", NULL};
-	struct filelist_s list = {exts};
-	size_t i, destlen = strlen(destpath)+1;
-	ImgTool_TreeScan(&list, srcpath, "");
+	size_t i, e, destlen = strlen(tc->destpath)+1;
+	qbyte *indata;
+	size_t fsize;
+	quint64_t hash;
+	qboolean isnew, convert;
+	double starttime;
+	struct treehash_s *old, key;
+	struct stat statsrc, statdst, statafter;
 
-	if (!list.numfiles)
-		Con_Printf("No suitable files found in directory: %s\n", srcpath);
+	if (tc->args->threads > 1)
+		con_buffer = &buffer;
 
-	for (i = 0; i < list.numfiles; i++)
+	for (;;)
 	{
-		struct stat statsrc, statdst;
-		Q_snprintfz(file, sizeof(file), "%s/%s", srcpath, list.file[i].name);
-		Q_snprintfz(dest, sizeof(dest), "%s/%s", destpath, list.file[i].name);
-		Q_snprintfz(dest+destlen+list.file[i].baselen, sizeof(dest)-destlen-list.file[i].baselen, ".dds");
+		Sys_LockMutex(tc->mutex);
+		i = tc->nextfile++;
+		Sys_UnlockMutex(tc->mutex);
+		if (i >= tc->list->numfiles)
+			break;
 
-		if (stat(file, &statsrc) < 0)
+		starttime = ImgTool_Time();
+		Q_snprintfz(file, sizeof(file), "%s/%s", tc->srcpath, tc->list->file[i].name);
+		Q_snprintfz(dest, sizeof(dest), "%s/%s", tc->destpath, tc->list->file[i].name);
+		Q_snprintfz(dest+destlen+tc->list->file[i].baselen, sizeof(dest)-destlen-tc->list->file[i].baselen, ".dds");
+
+		if (stat(file, &statsrc) < 0 || !(indata = FS_LoadMallocFile(file, &fsize)))
 		{
 			Con_Printf("stat(\"%s\") failed...\n", file);
 			continue;
 		}
-		if (stat(dest, &statdst) < 0)
-		{
-			statdst.st_mtime = INT_MIN; //make it look old
-			newfiles++;
-		}
-		if (statdst.st_mtime <= statsrc.st_mtime)
+		hash = ImgTool_Hash(tc->optionshash, indata, fsize);
+
+		isnew = stat(dest, &statdst) < 0;
+		key.name = tc->list->file[i].name;
+		old = tc->numoldhashes?bsearch(&key, tc->oldhash, tc->numoldhashes, sizeof(*tc->oldhash), ImgTool_TreeHashCompare):NULL;
+		if (isnew)
+			convert = true;
+		else if (old)	//we know what it was made from, so mtimes don't matter.
+			convert = old->hash != hash;
+		else	//no record, fall back on timestamps.
+			convert = statdst.st_mtime <= statsrc.st_mtime;
+
+		if (convert)
 		{
-			processedfiles++;
 //			Con_Printf("Image file %s -> %s\n", file, dest);
 			FS_CreatePath(dest, FS_SYSTEM);
-			ImgTool_Convert(args, ImgTool_Read(args, file), file, dest);
+			ImgTool_Convert(tc->args, ImgTool_ReadMemory(tc->args, file, indata, fsize), file, dest);
+			//only remember it if something actually got written, so failures are retried next time.
+			if (stat(dest, &statafter) >= 0 && (isnew || statafter.st_mtime != statdst.st_mtime || statafter.st_size != statdst.st_size))
+				tc->newhash[i] = hash;
 		}
 		else
 		{
-			skippedfiles++;
 //			Con_Printf("Unmodified image file %s -> %s\n", file, dest);
+			BZ_Free(indata);
+			tc->newhash[i] = hash;
+		}
+
+		for (e = 0; tc->exts[e] && strcasecmp(tc->exts[e], COM_GetFileExtension(tc->list->file[i].name, NULL)); e++)
+			;
+		Sys_LockMutex(tc->mutex);
+		if (isnew)
+			tc->newfiles++;
+		if (convert)
+		{
+			tc->processedfiles++;
+			if (e < countof(tc->perext))
+			{
+				tc->perext[e].files++;
+				tc->perext[e].bytes += fsize;
+				tc->perext[e].time += ImgTool_Time() - starttime;
+			}
 		}
+		else
+			tc->skippedfiles++;
+		if (buffer.used)
+		{	//flush this file's output in one go.
+			fwrite(buffer.text, 1, buffer.used, stderr);
+			fflush(stderr);
+			buffer.used = 0;
+		}
+		Sys_UnlockMutex(tc->mutex);
 	}
-	Con_Printf("found: %u, processed: %u, skipped: %u, new: %u\n", (unsigned int)list.numfiles, (unsigned int)processedfiles, (unsigned int)skippedfiles, (unsigned int)newfiles);
+
+	con_buffer = NULL;
+	free(buffer.text);
+	return 0;
+}
+static void ImgTool_TreeLoadHashes(struct treeconvert_s *tc, char **hashfile)
+{
+	char path[MAX_OSPATH];
+	size_t fsize, max = 0;
+	char *line, *end;
+	quint64_t hash;
+
+	Q_snprintfz(path, sizeof(path), "%s/"TREEHASHFILE, tc->destpath);
+	*hashfile = FS_LoadMallocFile(path, &fsize);
+	for (line = *hashfile; line && *line; line = end)
+	{
+		end = strchr(line, '\n');
+		if (end)
+			*end++ = 0;
+		else
+			end = line+strlen(line);
+		hash = strtoull(line, &line, 16);
+		if (*line++ != ' ' || !*line)
+			continue;
+		if (tc->numoldhashes == max)
+		{
+			max += 1024;
+			tc->oldhash = realloc(tc->oldhash, sizeof(*tc->oldhash)*max);
+		}
+		tc->oldhash[tc->numoldhashes].hash = hash;
+		tc->oldhash[tc->numoldhashes].name = line;
+		tc->numoldhashes++;
+	}
+	qsort(tc->oldhash, tc->numoldhashes, sizeof(*tc->oldhash), ImgTool_TreeHashCompare);
+}
+static void ImgTool_TreeSaveHashes(struct treeconvert_s *tc)
+{
+	char path[MAX_OSPATH];
+	size_t i;
+	FILE *f;
+
+	Q_snprintfz(path, sizeof(path), "%s/"TREEHASHFILE, tc->destpath);
+	FS_CreatePath(path, FS_SYSTEM);
+	f = fopen(path, "wb");
+	if (!f)
+	{
+		Con_Printf("Unable to write %s\n", path);
+		return;
+	}
+	for (i = 0; i < tc->list->numfiles; i++)
+		if (tc->newhash[i])
+			fprintf(f, "%016"PRIx64" %s\n", tc->newhash[i], tc->list->file[i].name);
+	fclose(f);
+}
+static void ImgTool_TreeConvert(struct opts_s *args, const char *destpath, const char *srcpath)
+{
+	const char *exts[] = {".png", ".bmp", ".tga", ".jpg", ".exr", ".hdr", ".pcx", NULL};
+	struct filelist_s list = {exts};
+	struct treeconvert_s tc = {args, srcpath, destpath, &list, exts};
+	char *hashfile;
+	size_t i;
+	unsigned int threads = max(1, args->threads);
+	double starttime = ImgTool_Time(), elapsed;
+	ImgTool_TreeScan(&list, srcpath, "");
+
+	if (!list.numfiles)
+		Con_Printf("No suitable files found in directory: %s\n", srcpath);
+
+	//changing what we're converting to should rebuild everything.
+	tc.optionshash = ImgTool_Hash(0xcbf29ce484222325ull, &args->newpixelformat, sizeof(args->newpixelformat));
+	tc.optionshash = ImgTool_Hash(tc.optionshash, &args->flags, sizeof(args->flags));
+	tc.optionshash = ImgTool_Hash(tc.optionshash, &args->mipnum, sizeof(args->mipnum));
+	tc.optionshash = ImgTool_Hash(tc.optionshash, &args->width, sizeof(args->width));
+	tc.optionshash = ImgTool_Hash(tc.optionshash, &args->height, sizeof(args->height));
+	ImgTool_TreeLoadHashes(&tc, &hashfile);
+	tc.newhash = calloc(max(1,list.numfiles), sizeof(*tc.newhash));
+
+	threads = min(threads, max(1, list.numfiles));
+	tc.mutex = Sys_CreateMutex();
+#ifdef MULTITHREAD
+	if (threads > 1)
+	{
+		void **thread = malloc(sizeof(*thread)*threads);
+		unsigned int t;
+		for (t = 0; t < threads; t++)
+			if (!(thread[t] = Sys_CreateThread("imgtool", ImgTool_TreeConvertThread, &tc, THREADP_NORMAL, 0)))
+				break;
+		if (!t)
+			ImgTool_TreeConvertThread(&tc);	//couldn't start any... do it ourselves.
+		while (t --> 0)
+			Sys_WaitOnThread(thread[t]);
+		free(thread);
+	}
+	else
+#endif
+		ImgTool_TreeConvertThread(&tc);
+	Sys_DestroyMutex(tc.mutex);
+
+	ImgTool_TreeSaveHashes(&tc);
+	elapsed = ImgTool_Time() - starttime;
+
+	Con_Printf("found: %u, processed: %u, skipped: %u, new: %u\n", (unsigned int)list.numfiles, (unsigned int)tc.processedfiles, (unsigned int)tc.skippedfiles, (unsigned int)tc.newfiles);
+	for (i = 0; exts[i] && i < countof(tc.perext); i++)
+	{
+		if (!tc.perext[i].files)
+			continue;
+		Con_Printf("%s: %u files, %.1fMB, %.2fs (%.1f files/s, %.2fMB/s per thread)\n", exts[i]+1, (unsigned int)tc.perext[i].files, tc.perext[i].bytes/(1024.0*1024), tc.perext[i].time,
+			tc.perext[i].files/max(tc.perext[i].time,0.001), tc.perext[i].bytes/(1024.0*1024)/max(tc.perext[i].time,0.001));
+	}
+	Con_Printf("%.2fs with %u thread%s\n", elapsed, threads, threads==1?"":"s");
+
+	free(tc.newhash);
+	free(tc.oldhash);
+	free(hashfile);
 	FileList_Release(&list);
 	return;
 }
 
+//times how long it takes to decompress a file's block-compressed data to something plain (excluding file parsing).
+static void ImgTool_BenchDecode(struct opts_s *args, const char *inname)
+{
+	size_t fsize, m, pixels;
+	qbyte *indata = FS_LoadMallocFile(inname, &fsize);
+	qboolean plainformats[PTI_MAX];
+	struct pendingtextureinfo *in;
+	uploadfmt_t encoding;
+	double start, elapsed = 0;
+	unsigned int runs = 0;
+	int bb, bw, bh, bd;
+
+	if (!indata)
+	{
+		Con_Printf("%s: unable to read\n", inname);
+		return;
+	}
+	for (m = 0; m < PTI_MAX; m++)
+	{
+		Image_BlockSizeForEncoding(m, &bb, &bw, &bh, &bd);
+		plainformats[m] = (bw == 1 && bh == 1 && bd == 1);
+	}
+
+	do
+	{
+		qbyte *copy = BZ_Malloc(fsize);
+		memcpy(copy, indata, fsize);
+		in = ImgTool_ReadMemory(args, inname, copy, fsize);
+		if (!in)
+			break;
+		encoding = in->encoding;
+		if (plainformats[encoding])
+		{
+			Con_Printf("%s: %s is not block-compressed\n", inname, Image_FormatName(encoding));
+			ImgTool_FreeMips(in);
+			break;
+		}
+		for (pixels = 0, m = 0; m < in->mipcount; m++)
+			pixels += in->mip[m].width*in->mip[m].height*in->mip[m].depth;
+
+		start = ImgTool_Time();
+		Image_ChangeFormat(in, plainformats, PTI_INVALID, inname);
+		elapsed += ImgTool_Time() - start;
+		runs++;
+		ImgTool_FreeMips(in);
+	} while (elapsed < 1 && runs < 1000);
+
+	if (runs)
+		Con_Printf("%s: %s, %u runs, %.2fms per run, %.1f Mpixels/s\n", inname, Image_FormatName(encoding), runs, elapsed*1000/runs, pixels*runs/(elapsed*1000000));
+	BZ_Free(indata);
+}
+
 static void ImgTool_WadExtract(struct opts_s *args, const char *wadname)
 {
 	qbyte *indata;
@@ -2755,6 +3174,7 @@ int main(int argc, const char **argv)
 		mode_genwad2,
 		mode_genwad3,
 		mode_extractwad,
+		mode_benchdecode,
 	} mode = mode_unspecified;
 	size_t u, f;
 	qboolean nomoreopts = false;
@@ -2771,6 +3191,7 @@ int main(int argc, const char **argv)
 	args.textype = PTI_ANY;
 	args.defaultext = NULL;
 	args.width = args.height = 0;
+	args.threads = 1;
 
 	if (argc==1)
 		goto showhelp;
@@ -2790,8 +3211,9 @@ showhelp:
 				Con_Printf("compress   : %s [-c] --ext dds --bc3 [--premul] [--nomips] in.png\n\tConvert pixel format (to bc3 aka dxt5) before writing to output file.\n", argv[0]);
 				Con_Printf("convert    : %s [-c] --ext png in.exr [in2.pcx ...]\n\tConvert input file(s) to different file format, while trying to preserve pixel formats.\n", argv[0]);
 				Con_Printf("merge      : %s -o output [--cube|--3d|--2darray|--cubearray] [--bc1] foo_*.png\n\tConvert to different file format, while trying to preserve pixel formats.\n", argv[0]);
-				Con_Printf("recursive  : %s -r [--ext dds] --astc_6x6_ldr destdir srcdir\n\tCompresses the files to dds (writing to an optionally different directory)\n", argv[0]);
+				Con_Printf("recursive  : %s -r [-j 8] [--ext dds] --astc_6x6_ldr destdir srcdir\n\tCompresses the files to dds (writing to an optionally different directory), optionally several at once. Unchanged files are skipped.\n", argv[0]);
 				Con_Printf("decompress : %s --decompress [--exportmip 0] [--nomips] in.ktx out.png\n\tDecompresses any block-compressed pixel data.\n", argv[0]);
+				Con_Printf("benchmark  : %s --benchdecode in.ktx [in2.dds ...]\n\tReports how quickly block-compressed pixel data can be decompressed.\n", argv[0]);
 				Con_Printf("create mips: %s [-c] --ext mip [--bc1] [--resize width height] [--exportmip 2] *.dds\n", argv[0]);
 				Con_Printf("create xwad: %s --genwadx [--exportmip 2] [--bc1] out.wad srcdir\n", argv[0]);
 				Con_Printf("create wad : %s -w [--exportmip 2] out.wad *.mipsrcdir\n", argv[0]);
@@ -2846,6 +3268,8 @@ showhelp:
 					sh_config.texfmt[f] = false;
 				mode = mode_convert;
 			}
+			else if (!files && !strcmp(argv[u], "--benchdecode"))
+				mode = mode_benchdecode;
 			else if (!files && (!strcmp(argv[u], "-r") || !strcmp(argv[u], "--auto")))
 				mode = mode_autotree;
 			else if (!files && (!strcmp(argv[u], "-i") || !strcmp(argv[u], "--info")))
@@ -2938,6 +3362,20 @@ showhelp:
 					return 1;
 				}
 			}
+			else if (!strcmp(argv[u], "-j") || !strcmp(argv[u], "--jobs"))
+			{
+				char *e = "erk";
+				if (u+1 < argc)
+					args.threads = strtoul(argv[++u], &e, 10);
+				if (*e || !args.threads)
+				{
+					Con_Printf("-j requires trailing numeric argument\n");
+					return 1;
+				}
+#ifndef MULTITHREAD
+				args.threads = 1;
+#endif
+			}
 			else
 			{
 				if (argv[u][1] == '-')
@@ -3031,6 +3469,11 @@ showhelp:
 		ImgTool_WadConvert(&args, argv[0], argv+1, files-1, mode-(mode_genwadx-1));
 	else if ((mode == mode_extractwad) && files == 1)
 		ImgTool_WadExtract(&args, argv[0]);
+	else if (mode == mode_benchdecode)
+	{
+		for (u = 0; u < files; u++)
+			ImgTool_BenchDecode(&args, argv[u]);
+	}
 #ifdef FTE_SDL
 	else if (mode == mode_view)
 	{
@@ -3994,6 +3994,10 @@ namespace fte
 					vfsfile_t::Tell = Tell;
 					vfsfile_t::GetLen = GetLen;
 					vfsfile_t::Close = Close;
+					vfsfile_t::ReadBytesAt = NULL;
+					vfsfile_t::GetMapping = NULL;
+					vfsfile_t::MapPrivate = NULL;
+					vfsfile_t::UnmapPrivate = NULL;
 				}
 				stream *f;
 			};
@@ -886,6 +886,10 @@ static vfsfile_t *MPQ_OpenVFS(searchpathfuncs_t *handle, flocation_t *loc, const
 	f->funcs.GetLen = MPQF_getlen;
 	f->funcs.Close = MPQF_close;
 	f->funcs.Flush = MPQF_flush;
+	f->funcs.ReadBytesAt = NULL;
+	f->funcs.GetMapping = NULL;
+	f->funcs.MapPrivate = NULL;
+	f->funcs.UnmapPrivate = NULL;
 
 	Sys_LockMutex(mpq->mutex);
 	mpq->references++;